@@ -0,0 +1,251 @@
+#include "archivepipeline.h"
+#include "processreaper.h"
+#include <QDir>
+#include <QTimer>
+#include <QThread>
+#include <QPointer>
+#include <QDebug>
+
+static const qint64 kPipelineChunkSize = 64 * 1024;
+// 网络阶段的读缓冲上限
+static const qint64 kPipelineReadBufferSize = 1024 * 1024;
+// 写给 tar 但尚未被消费的数据上限，超过后暂停读取网络数据
+static const qint64 kPipelineMaxPending = 4 * 1024 * 1024;
+static const int kTransferTimeoutMs = 30000;
+
+ArchivePipeline::ArchivePipeline(QNetworkAccessManager* networkManager, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(networkManager)
+    , m_reply(nullptr)
+    , m_tar(nullptr)
+    , m_hash(QCryptographicHash::Sha256)
+    , m_replyFinished(false)
+    , m_removing(false)
+    , m_generation(0)
+    , m_received(0)
+    , m_fed(0)
+    , m_lastReceived(0)
+    , m_lastExtracted(0)
+{
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(1000);
+    connect(m_statsTimer, &QTimer::timeout, this, &ArchivePipeline::reportThroughput);
+}
+
+ArchivePipeline::~ArchivePipeline()
+{
+    abort();
+}
+
+void ArchivePipeline::start(const QUrl& url, const QString& destPath)
+{
+    abort();
+
+    m_destPath = destPath;
+    m_existingEntries = QDir(destPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    m_lastError.clear();
+    m_sha256.clear();
+    m_hash.reset();
+    m_replyFinished = false;
+    m_received = 0;
+    m_fed = 0;
+    m_lastReceived = 0;
+    m_lastExtracted = 0;
+    m_chunk.resize(kPipelineChunkSize);
+
+    // 解压阶段：tar 从标准输入读取 gzip 数据
+    m_tar = new QProcess(this);
+    m_tar->setWorkingDirectory(destPath);
+    m_tar->setStandardOutputFile(QProcess::nullDevice());
+    connect(m_tar, &QProcess::bytesWritten, this, &ArchivePipeline::pump);
+    connect(m_tar, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ArchivePipeline::onTarFinished);
+    connect(m_tar, &QProcess::errorOccurred, this, &ArchivePipeline::onTarError);
+    m_tar->start("tar", QStringList() << "-xzf" << "-");
+
+    // 网络阶段
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                        QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setTransferTimeout(kTransferTimeoutMs);
+
+    m_reply = m_networkManager->get(request);
+    m_reply->setReadBufferSize(kPipelineReadBufferSize);
+
+    connect(m_reply, &QNetworkReply::readyRead, this, &ArchivePipeline::pump);
+    connect(m_reply, &QNetworkReply::downloadProgress, this,
+            [this](qint64 received, qint64 total) {
+                m_received = received;
+                emit progress(received, total);
+            });
+    connect(m_reply, &QNetworkReply::finished, this, &ArchivePipeline::onReplyFinished);
+
+    m_statsClock.start();
+    m_statsTimer->start();
+}
+
+void ArchivePipeline::abort()
+{
+    ++m_generation;
+    m_removing = false;
+    cleanup();
+}
+
+void ArchivePipeline::pump()
+{
+    if (!m_reply || !m_tar) {
+        return;
+    }
+
+    if (m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400) {
+        // 错误页不交给 tar，等 finished 处理
+        return;
+    }
+
+    while (m_reply->bytesAvailable() > 0 && m_tar->bytesToWrite() < kPipelineMaxPending) {
+        qint64 n = m_reply->read(m_chunk.data(), m_chunk.size());
+        if (n <= 0) {
+            break;
+        }
+
+        m_hash.addData(QByteArrayView(m_chunk.constData(), n));
+        m_tar->write(m_chunk.constData(), n);
+        m_fed += n;
+    }
+
+    if (m_replyFinished && m_reply->bytesAvailable() == 0) {
+        // 网络数据已全部交给 tar，关闭其标准输入
+        m_sha256 = m_hash.result().toHex();
+        m_reply->disconnect(this);
+        m_reply->deleteLater();
+        m_reply = nullptr;
+        m_tar->closeWriteChannel();
+    }
+}
+
+void ArchivePipeline::onReplyFinished()
+{
+    if (!m_reply) {
+        return;
+    }
+
+    if (m_reply->error() != QNetworkReply::NoError) {
+        fail("下载失败: " + m_reply->errorString());
+        return;
+    }
+
+    m_replyFinished = true;
+    pump();
+}
+
+void ArchivePipeline::onTarFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (!m_tar) {
+        return;
+    }
+
+    if (m_reply) {
+        fail("解压进程提前退出: " + QString::fromLocal8Bit(m_tar->readAllStandardError()).trimmed());
+        return;
+    }
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        fail("解压失败: " + QString::fromLocal8Bit(m_tar->readAllStandardError()).trimmed());
+        return;
+    }
+
+    reportThroughput();
+    qDebug() << "[ArchivePipeline] Extracted" << m_fed << "bytes, sha256" << m_sha256;
+
+    cleanup();
+    emit finished(true);
+}
+
+void ArchivePipeline::onTarError(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart) {
+        fail("无法启动 tar: " + m_tar->errorString());
+    }
+}
+
+void ArchivePipeline::reportThroughput()
+{
+    qint64 elapsed = m_statsClock.restart();
+    if (elapsed <= 0 || !m_tar) {
+        return;
+    }
+
+    qint64 extracted = m_fed - m_tar->bytesToWrite();
+    double downloadRate = (m_received - m_lastReceived) * 1000.0 / elapsed;
+    double extractRate = (extracted - m_lastExtracted) * 1000.0 / elapsed;
+    m_lastReceived = m_received;
+    m_lastExtracted = extracted;
+
+    emit throughput(downloadRate, extractRate);
+}
+
+void ArchivePipeline::fail(const QString& error)
+{
+    qDebug() << "[ArchivePipeline]" << error;
+    m_lastError = error;
+    m_removing = true;
+
+    // tar 还在往目录里写，等它退出后再删；删除在独立线程中进行，本对象被删除也不影响
+    const QString destPath = m_destPath;
+    const QStringList existingEntries = m_existingEntries;
+    const int generation = ++m_generation;
+    QPointer<ArchivePipeline> self(this);
+    cleanup([self, destPath, existingEntries, generation]() {
+        QThread* thread = QThread::create([destPath, existingEntries]() {
+            removeNewDirectories(destPath, existingEntries);
+        });
+        QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+        if (self) {
+            QObject::connect(thread, &QThread::finished, self.data(), [self, generation]() {
+                self->onDirectoriesRemoved(generation);
+            });
+        }
+        thread->start();
+    });
+}
+
+void ArchivePipeline::onDirectoriesRemoved(int generation)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    m_removing = false;
+    emit finished(false);
+}
+
+void ArchivePipeline::cleanup(const std::function<void()>& onTarExited)
+{
+    m_statsTimer->stop();
+
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+
+    if (m_tar) {
+        m_tar->disconnect(this);
+        ProcessReaper::terminate(m_tar, 0, false, onTarExited);
+        m_tar = nullptr;
+    } else if (onTarExited) {
+        onTarExited();
+    }
+}
+
+void ArchivePipeline::removeNewDirectories(const QString& destPath, const QStringList& existingEntries)
+{
+    // 删除本次解压到一半的源码目录
+    QDir dir(destPath);
+    const QStringList entries = dir.entryList(QStringList() << "redis-*", QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        if (!existingEntries.contains(entry)) {
+            QDir(dir.filePath(entry)).removeRecursively();
+        }
+    }
+}
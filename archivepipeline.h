@@ -0,0 +1,83 @@
+#ifndef ARCHIVEPIPELINE_H
+#define ARCHIVEPIPELINE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QProcess>
+#include <functional>
+
+class QTimer;
+
+// 流式安装管道：网络 → gzip/tar 解压，中间不落盘。
+// 网络数据直接写入 `tar -xzf -` 的标准输入；tar 来不及消费时停止读取，
+// 由 QNetworkReply 的有界读缓冲把背压传回 TCP 连接。
+// 失败时等 tar 退出后在工作线程中删除解压到一半的目录，删完才发出 finished(false)。
+class ArchivePipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ArchivePipeline(QNetworkAccessManager* networkManager, QObject *parent = nullptr);
+    ~ArchivePipeline();
+
+    void start(const QUrl& url, const QString& destPath);
+    void abort();
+    bool isRunning() const { return m_reply != nullptr || m_tar != nullptr || m_removing; }
+
+    // 整个数据流的 SHA-256（十六进制），完成后有效
+    QByteArray sha256() const { return m_sha256; }
+    QString getLastError() const { return m_lastError; }
+
+signals:
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
+    // 每秒报告一次各阶段吞吐量（字节/秒）
+    void throughput(double downloadRate, double extractRate);
+    void finished(bool success);
+
+private slots:
+    void pump();
+    void onReplyFinished();
+    void onTarFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onTarError(QProcess::ProcessError error);
+    void reportThroughput();
+
+private:
+    void fail(const QString& error);
+    // onTarExited 在 tar 真正退出后调用
+    void cleanup(const std::function<void()>& onTarExited = {});
+    void onDirectoriesRemoved(int generation);
+    // 删除 destPath 下本次新出现的 redis-* 目录，要遍历整棵树，只在工作线程中调用
+    static void removeNewDirectories(const QString& destPath, const QStringList& existingEntries);
+
+private:
+    QNetworkAccessManager* m_networkManager;
+    QNetworkReply* m_reply;
+    QProcess* m_tar;
+    QTimer* m_statsTimer;
+    QByteArray m_chunk;
+    QCryptographicHash m_hash;
+
+    QString m_destPath;
+    QStringList m_existingEntries;
+    QString m_lastError;
+    QByteArray m_sha256;
+
+    bool m_replyFinished;
+    bool m_removing;
+    // 每次 start / abort 加一，丢弃旧一轮删除完成的通知
+    int m_generation;
+    qint64 m_received;
+    qint64 m_fed;
+    qint64 m_lastReceived;
+    qint64 m_lastExtracted;
+    QElapsedTimer m_statsClock;
+};
+
+#endif // ARCHIVEPIPELINE_H
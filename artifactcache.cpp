@@ -0,0 +1,260 @@
+#include "artifactcache.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+ArtifactCache::ArtifactCache(const QString& cacheDir, QObject *parent)
+    : QObject(parent)
+    , m_cacheDir(cacheDir)
+    , m_maxSize(2LL * 1024 * 1024 * 1024)
+{
+    QDir().mkpath(m_cacheDir + "/objects");
+    loadIndex();
+}
+
+void ArtifactCache::setMaxSize(qint64 bytes)
+{
+    m_maxSize = bytes;
+    evict();
+}
+
+qint64 ArtifactCache::totalSize() const
+{
+    qint64 total = 0;
+    for (auto it = m_objects.constBegin(); it != m_objects.constEnd(); ++it) {
+        total += it.value().toObject().value("size").toInteger();
+    }
+    return total;
+}
+
+QString ArtifactCache::find(const QUrl& url) const
+{
+    QString sha256 = m_urls.value(url.toString()).toObject().value("sha256").toString();
+    if (sha256.isEmpty() || !m_objects.contains(sha256)) {
+        return QString();
+    }
+    return objectPath(sha256.toLatin1());
+}
+
+bool ArtifactCache::verifyObject(const QString& objectPath)
+{
+    // 对象以自己的 SHA-256 命名
+    return sha256OfFile(objectPath) == QFileInfo(objectPath).fileName().toLatin1();
+}
+
+void ArtifactCache::markUsed(const QString& objectPath)
+{
+    touch(QFileInfo(objectPath).fileName().toLatin1());
+    saveIndex();
+}
+
+void ArtifactCache::discard(const QString& objectPath)
+{
+    QByteArray sha256 = QFileInfo(objectPath).fileName().toLatin1();
+    qDebug() << "[ArtifactCache] Integrity check failed, dropping" << sha256;
+    removeObject(sha256);
+    saveIndex();
+}
+
+QByteArray ArtifactCache::etag(const QUrl& url) const
+{
+    return m_urls.value(url.toString()).toObject().value("etag").toString().toLatin1();
+}
+
+QByteArray ArtifactCache::lastModified(const QUrl& url) const
+{
+    return m_urls.value(url.toString()).toObject().value("lastModified").toString().toLatin1();
+}
+
+bool ArtifactCache::isVersionedUrl(const QUrl& url)
+{
+    // redis-7.2.4.tar.gz、Redis-x64-5.0.14.1.zip
+    static const QRegularExpression versionRe("\\d+\\.\\d+");
+    return versionRe.match(url.fileName()).hasMatch();
+}
+
+bool ArtifactCache::importObject(const QString& cacheDir, const QString& filePath, const QByteArray& sha256)
+{
+    QString path = objectPath(cacheDir, sha256);
+    if (QFile::exists(path)) {
+        return true;
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QString tmpPath = path + ".tmp";
+    QFile::remove(tmpPath);
+    if (!QFile::copy(filePath, tmpPath) || !QFile::rename(tmpPath, path)) {
+        QFile::remove(tmpPath);
+        return false;
+    }
+    return true;
+}
+
+void ArtifactCache::addSource(const QUrl& url, const QByteArray& sha256,
+                              const QByteArray& etag, const QByteArray& lastModified)
+{
+    QString path = objectPath(sha256);
+    if (!QFile::exists(path)) {
+        return;
+    }
+
+    QJsonObject entry;
+    entry["size"] = QFileInfo(path).size();
+    entry["lastAccess"] = QDateTime::currentSecsSinceEpoch();
+    m_objects[QString::fromLatin1(sha256)] = entry;
+
+    QJsonObject source;
+    source["sha256"] = QString::fromLatin1(sha256);
+    source["etag"] = QString::fromLatin1(etag);
+    source["lastModified"] = QString::fromLatin1(lastModified);
+    m_urls[url.toString()] = source;
+
+    evict();
+    saveIndex();
+}
+
+bool ArtifactCache::materialize(const QString& cachedPath, const QString& destPath)
+{
+    QFile::remove(destPath);
+
+#ifdef Q_OS_WIN
+    bool linked = CreateHardLinkW(reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(destPath).utf16()),
+                                  reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(cachedPath).utf16()),
+                                  nullptr) != 0;
+#else
+    bool linked = ::link(QFile::encodeName(cachedPath).constData(),
+                         QFile::encodeName(destPath).constData()) == 0;
+#endif
+    if (linked) {
+        return true;
+    }
+
+    return QFile::copy(cachedPath, destPath);
+}
+
+void ArtifactCache::clear()
+{
+    QDir(m_cacheDir + "/objects").removeRecursively();
+    QDir().mkpath(m_cacheDir + "/objects");
+    m_urls = QJsonObject();
+    m_objects = QJsonObject();
+    saveIndex();
+}
+
+QByteArray ArtifactCache::sha256OfFile(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return QByteArray();
+    }
+    return hash.result().toHex();
+}
+
+QString ArtifactCache::objectPath(const QString& cacheDir, const QByteArray& sha256)
+{
+    return cacheDir + "/objects/" + QString::fromLatin1(sha256.left(2)) + "/"
+           + QString::fromLatin1(sha256);
+}
+
+void ArtifactCache::removeObject(const QByteArray& sha256)
+{
+    QString key = QString::fromLatin1(sha256);
+    QFile::remove(objectPath(sha256));
+    m_objects.remove(key);
+
+    for (auto it = m_urls.begin(); it != m_urls.end();) {
+        if (it.value().toObject().value("sha256").toString() == key) {
+            it = m_urls.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ArtifactCache::touch(const QByteArray& sha256)
+{
+    QString key = QString::fromLatin1(sha256);
+    QJsonObject entry = m_objects.value(key).toObject();
+    entry["lastAccess"] = QDateTime::currentSecsSinceEpoch();
+    m_objects[key] = entry;
+}
+
+void ArtifactCache::evict()
+{
+    qint64 total = totalSize();
+    while (total > m_maxSize && !m_objects.isEmpty()) {
+        // 淘汰最久未使用的对象
+        QString oldestKey;
+        qint64 oldestAccess = 0;
+        for (auto it = m_objects.constBegin(); it != m_objects.constEnd(); ++it) {
+            qint64 access = it.value().toObject().value("lastAccess").toInteger();
+            if (oldestKey.isEmpty() || access < oldestAccess) {
+                oldestKey = it.key();
+                oldestAccess = access;
+            }
+        }
+
+        total -= m_objects.value(oldestKey).toObject().value("size").toInteger();
+        qDebug() << "[ArtifactCache] Evicting" << oldestKey;
+        removeObject(oldestKey.toLatin1());
+    }
+}
+
+void ArtifactCache::loadIndex()
+{
+    QFile file(m_cacheDir + "/index.json");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    m_urls = root.value("urls").toObject();
+    m_objects = root.value("objects").toObject();
+
+    // 旧版索引中 URL 直接映射到 SHA-256，没有校验值
+    for (auto it = m_urls.begin(); it != m_urls.end(); ++it) {
+        if (it.value().isString()) {
+            QJsonObject source;
+            source["sha256"] = it.value().toString();
+            it.value() = source;
+        }
+    }
+
+    // 丢弃文件已不存在的条目
+    QStringList keys = m_objects.keys();
+    for (const QString& key : keys) {
+        if (!QFile::exists(objectPath(key.toLatin1()))) {
+            removeObject(key.toLatin1());
+        }
+    }
+}
+
+void ArtifactCache::saveIndex()
+{
+    QJsonObject root;
+    root["urls"] = m_urls;
+    root["objects"] = m_objects;
+
+    QSaveFile file(m_cacheDir + "/index.json");
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toJson());
+        file.commit();
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef ARTIFACTCACHE_H
+#define ARTIFACTCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QByteArray>
+#include <QJsonObject>
+
+// 按内容寻址的本地安装包缓存：文件以 SHA-256 命名存放在 objects/ 下，
+// index.json 记录 URL → SHA-256（以及下载时的 ETag/Last-Modified）的映射，和每个对象的大小、最近访问时间。
+// 使用前重新校验 SHA-256（读完整个文件，由调用方放在工作线程），总大小超过上限时按 LRU 淘汰。
+// 文件名不带版本号的地址（如 redis-stable.tar.gz）内容会变，命中后由调用方用记录的校验值向服务器确认。
+class ArtifactCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ArtifactCache(const QString& cacheDir, QObject *parent = nullptr);
+
+    QString cacheDir() const { return m_cacheDir; }
+
+    void setMaxSize(qint64 bytes);
+    qint64 maxSize() const { return m_maxSize; }
+    qint64 totalSize() const;
+
+    // 按 URL 查找缓存对象的路径，只查索引不读文件；未命中时返回空字符串。
+    // 使用前在工作线程中用 verifyObject() 校验，再回到所属线程调用 markUsed() 或 discard()
+    QString find(const QUrl& url) const;
+    static bool verifyObject(const QString& objectPath);
+    void markUsed(const QString& objectPath);
+    void discard(const QString& objectPath);
+
+    // url 下载时记录的 ETag（强校验值）和 Last-Modified
+    QByteArray etag(const QUrl& url) const;
+    QByteArray lastModified(const QUrl& url) const;
+
+    // 文件名带版本号的地址内容不会变，命中后无需再向服务器确认
+    static bool isVersionedUrl(const QUrl& url);
+
+    // 存入缓存分两步：importObject() 只把文件复制成 cacheDir 下的对象、不碰索引，可以在工作线程中调用；
+    // 之后在所属线程用 addSource() 登记来源地址
+    static bool importObject(const QString& cacheDir, const QString& filePath, const QByteArray& sha256);
+    void addSource(const QUrl& url, const QByteArray& sha256,
+                   const QByteArray& etag = QByteArray(), const QByteArray& lastModified = QByteArray());
+
+    // 把缓存对象放到目标位置（优先硬链接，跨文件系统时复制）
+    static bool materialize(const QString& cachedPath, const QString& destPath);
+
+    void clear();
+
+    static QByteArray sha256OfFile(const QString& filePath);
+
+private:
+    static QString objectPath(const QString& cacheDir, const QByteArray& sha256);
+    QString objectPath(const QByteArray& sha256) const { return objectPath(m_cacheDir, sha256); }
+    void removeObject(const QByteArray& sha256);
+    void touch(const QByteArray& sha256);
+    void evict();
+    void loadIndex();
+    void saveIndex();
+
+private:
+    QString m_cacheDir;
+    qint64 m_maxSize;
+
+    QJsonObject m_urls;      // url -> { sha256, etag, lastModified }
+    QJsonObject m_objects;   // sha256 -> { size, lastAccess }
+};
+
+#endif // ARTIFACTCACHE_H
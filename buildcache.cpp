@@ -0,0 +1,181 @@
+#include "buildcache.h"
+#include "artifactcache.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <algorithm>
+
+static const QFile::Permissions kExecutablePermissions =
+    QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner |
+    QFile::ReadGroup | QFile::ExeGroup |
+    QFile::ReadOther | QFile::ExeOther;
+
+BuildCache::BuildCache(const QString& cacheDir, QObject *parent)
+    : QObject(parent)
+    , m_cacheDir(cacheDir)
+    , m_maxEntries(8)
+    , m_compilerProcess(nullptr)
+{
+    QDir().mkpath(m_cacheDir);
+}
+
+QStringList BuildCache::binaryNames()
+{
+    return QStringList() << "redis-server" << "redis-cli" << "redis-benchmark";
+}
+
+void BuildCache::detectCompiler()
+{
+    if (isCompilerDetected() || m_compilerProcess) {
+        return;
+    }
+
+    m_compilerProcess = new QProcess(this);
+    auto done = [this]() {
+        QString version = QString::fromLocal8Bit(m_compilerProcess->readAllStandardOutput())
+                              .section('\n', 0, 0).trimmed();
+        m_compilerVersion = version.isEmpty() ? QString("unknown") : version;
+        m_compilerProcess->deleteLater();
+        m_compilerProcess = nullptr;
+        emit compilerDetected();
+    };
+    connect(m_compilerProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, done);
+    connect(m_compilerProcess, &QProcess::errorOccurred,
+            this, [done](QProcess::ProcessError error) {
+                if (error == QProcess::FailedToStart) {
+                    done();
+                }
+            });
+    m_compilerProcess->start("cc", QStringList() << "--version");
+}
+
+QByteArray BuildCache::makeKey(const QByteArray& sourceSha256, const QString& compiler,
+                               const QStringList& buildFlags, const QString& allocator)
+{
+    QStringList flags = buildFlags;
+    flags.sort();
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData("source=" + sourceSha256 + "\n");
+    hash.addData("compiler=" + compiler.toUtf8() + "\n");
+    hash.addData("flags=" + flags.join(' ').toUtf8() + "\n");
+    hash.addData("allocator=" + allocator.toUtf8() + "\n");
+    return hash.result().toHex().left(32);
+}
+
+QString BuildCache::entryPath(const QByteArray& key) const
+{
+    return m_cacheDir + "/" + QString::fromLatin1(key);
+}
+
+bool BuildCache::verifyEntry(const QString& path)
+{
+    QFile manifestFile(path + "/manifest.json");
+    if (!manifestFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonObject manifest = QJsonDocument::fromJson(manifestFile.readAll()).object();
+    QJsonObject hashes = manifest.value("sha256").toObject();
+
+    // 校验每个二进制文件，损坏的条目直接丢弃
+    const QStringList names = binaryNames();
+    for (const QString& name : names) {
+        QByteArray expected = hashes.value(name).toString().toLatin1();
+        if (expected.isEmpty() || ArtifactCache::sha256OfFile(path + "/" + name) != expected) {
+            qDebug() << "[BuildCache] Entry" << path << "is corrupt, dropping";
+            manifestFile.close();
+            QDir(path).removeRecursively();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool BuildCache::materializeEntry(const QString& path, const QString& destDir)
+{
+    const QStringList names = binaryNames();
+    for (const QString& name : names) {
+        if (!ArtifactCache::materialize(path + "/" + name, destDir + "/" + name)) {
+            return false;
+        }
+        QFile::setPermissions(destDir + "/" + name, kExecutablePermissions);
+    }
+
+    // 刷新最近使用时间，供 prune() 淘汰
+    QFile manifestFile(path + "/manifest.json");
+    if (manifestFile.open(QIODevice::ReadWrite)) {
+        manifestFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return true;
+}
+
+bool BuildCache::storeEntry(const QString& path, const QString& buildSrcDir, const QString& description)
+{
+    QString tmpPath = path + ".tmp";
+    QDir(tmpPath).removeRecursively();
+    if (!QDir().mkpath(tmpPath)) {
+        return false;
+    }
+
+    QJsonObject hashes;
+    const QStringList names = binaryNames();
+    for (const QString& name : names) {
+        if (!QFile::copy(buildSrcDir + "/" + name, tmpPath + "/" + name)) {
+            QDir(tmpPath).removeRecursively();
+            return false;
+        }
+        QFile::setPermissions(tmpPath + "/" + name, kExecutablePermissions);
+        hashes[name] = QString::fromLatin1(ArtifactCache::sha256OfFile(tmpPath + "/" + name));
+    }
+
+    QJsonObject manifest;
+    manifest["description"] = description;
+    manifest["created"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    manifest["sha256"] = hashes;
+
+    QSaveFile manifestFile(tmpPath + "/manifest.json");
+    if (!manifestFile.open(QIODevice::WriteOnly)) {
+        QDir(tmpPath).removeRecursively();
+        return false;
+    }
+    manifestFile.write(QJsonDocument(manifest).toJson());
+    if (!manifestFile.commit()) {
+        QDir(tmpPath).removeRecursively();
+        return false;
+    }
+
+    // 整个目录就绪后再改名，避免读到不完整的条目
+    QDir(path).removeRecursively();
+    if (!QDir().rename(tmpPath, path)) {
+        QDir(tmpPath).removeRecursively();
+        return false;
+    }
+    return true;
+}
+
+void BuildCache::prune(const QString& cacheDir, int maxEntries)
+{
+    QDir dir(cacheDir);
+    QFileInfoList entries = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+
+    // 按 manifest 的修改时间从新到旧排序，超出上限的删除
+    std::sort(entries.begin(), entries.end(), [](const QFileInfo& a, const QFileInfo& b) {
+        return QFileInfo(a.filePath() + "/manifest.json").lastModified()
+               > QFileInfo(b.filePath() + "/manifest.json").lastModified();
+    });
+
+    for (int i = maxEntries; i < entries.size(); ++i) {
+        qDebug() << "[BuildCache] Pruning" << entries.at(i).fileName();
+        QDir(entries.at(i).filePath()).removeRecursively();
+    }
+}
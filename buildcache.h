@@ -0,0 +1,57 @@
+#ifndef BUILDCACHE_H
+#define BUILDCACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+
+class QProcess;
+
+// 编译产物缓存：以（源码包 SHA-256、编译器版本、编译参数、内存分配器）为键
+// 保存 redis-server / redis-cli / redis-benchmark，重装或新建实例时直接硬链接，
+// 无需重新编译。校验、存入、取出和淘汰要读写整个二进制文件，这些静态函数只操作给定目录，
+// 可以在工作线程中调用。
+class BuildCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BuildCache(const QString& cacheDir, QObject *parent = nullptr);
+
+    static QStringList binaryNames();
+
+    // 编译器版本（cc --version 的第一行），detectCompiler() 异步获取，完成后发出 compilerDetected()；
+    // 整个程序只运行一次
+    void detectCompiler();
+    bool isCompilerDetected() const { return !m_compilerVersion.isEmpty(); }
+    QString compilerVersion() const { return m_compilerVersion; }
+
+    static QByteArray makeKey(const QByteArray& sourceSha256, const QString& compiler,
+                              const QStringList& buildFlags, const QString& allocator);
+
+    QString entryPath(const QByteArray& key) const;
+    // 条目存在且每个二进制文件的 SHA-256 与 manifest 一致，损坏的条目直接删除
+    static bool verifyEntry(const QString& entryPath);
+    // 从编译好的 src 目录写入条目（先写临时目录再改名），之后调用 prune() 淘汰旧条目
+    static bool storeEntry(const QString& entryPath, const QString& buildSrcDir, const QString& description);
+    // 把条目中的二进制文件放到 destDir（优先硬链接，跨文件系统时复制）
+    static bool materializeEntry(const QString& entryPath, const QString& destDir);
+
+    QString cacheDir() const { return m_cacheDir; }
+    void setMaxEntries(int entries) { m_maxEntries = entries; }
+    int maxEntries() const { return m_maxEntries; }
+    // 只保留最近使用的 maxEntries 个条目
+    static void prune(const QString& cacheDir, int maxEntries);
+
+signals:
+    void compilerDetected();
+
+private:
+    QString m_cacheDir;
+    int m_maxEntries;
+    QProcess* m_compilerProcess;
+    QString m_compilerVersion;
+};
+
+#endif // BUILDCACHE_H
@@ -0,0 +1,413 @@
+#include "cputopology.h"
+#include "versionstore.h"
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+#include <QSet>
+#include <QPair>
+#include <QDebug>
+#include <algorithm>
+#include <functional>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// set_mempolicy 的 MPOL_BIND，避免依赖 libnuma 的头文件
+static const int kMpolBind = 2;
+static const int kMaxNodes = 256;
+
+static QByteArray readSysFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll().trimmed();
+}
+#endif
+
+QList<int> CpuTopology::parseCpuList(const QString& text)
+{
+    QList<int> cpus;
+    const QStringList parts = text.trimmed().split(',', Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        bool okFirst = false;
+        bool okLast = false;
+        int dash = part.indexOf('-');
+        int first = part.left(dash < 0 ? part.size() : dash).trimmed().toInt(&okFirst);
+        int last = dash < 0 ? first : part.mid(dash + 1).trimmed().toInt(&okLast);
+        if (!okFirst || (dash >= 0 && !okLast) || first < 0 || last < first) {
+            return QList<int>();
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            if (!cpus.contains(cpu)) {
+                cpus << cpu;
+            }
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    return cpus;
+}
+
+QString CpuTopology::formatCpuList(const QList<int>& cpus)
+{
+    QList<int> sorted = cpus;
+    std::sort(sorted.begin(), sorted.end());
+
+    QStringList ranges;
+    for (int i = 0; i < sorted.size();) {
+        int j = i;
+        while (j + 1 < sorted.size() && sorted.at(j + 1) == sorted.at(j) + 1) {
+            ++j;
+        }
+        ranges << (i == j ? QString::number(sorted.at(i))
+                          : QString("%1-%2").arg(sorted.at(i)).arg(sorted.at(j)));
+        i = j + 1;
+    }
+    return ranges.join(',');
+}
+
+CpuTopology CpuTopology::detect()
+{
+    CpuTopology topology;
+
+#ifdef Q_OS_LINUX
+    const QString cpuRoot = "/sys/devices/system/cpu";
+    const QString nodeRoot = "/sys/devices/system/node";
+
+    QMap<int, int> nodeOfCpu;
+    const QStringList nodeDirs = QDir(nodeRoot).entryList(QStringList() << "node*", QDir::Dirs);
+    for (const QString& dir : nodeDirs) {
+        bool ok = false;
+        int node = dir.mid(4).toInt(&ok);
+        if (!ok) {
+            continue;
+        }
+        const QList<int> cpus = parseCpuList(QString::fromLatin1(readSysFile(nodeRoot + "/" + dir + "/cpulist")));
+        for (int cpu : cpus) {
+            nodeOfCpu.insert(cpu, node);
+        }
+    }
+
+    const QList<int> online = parseCpuList(QString::fromLatin1(readSysFile(cpuRoot + "/online")));
+    for (int cpu : online) {
+        QString dir = QString("%1/cpu%2/topology").arg(cpuRoot).arg(cpu);
+        CpuInfo info;
+        info.cpu = cpu;
+        info.package = readSysFile(dir + "/physical_package_id").toInt();
+        info.core = readSysFile(dir + "/core_id").toInt();
+        // 没有启用 NUMA 的内核没有 node 目录，全部视为节点 0
+        info.node = nodeOfCpu.value(cpu, 0);
+        topology.m_cpus << info;
+    }
+#endif
+
+    return topology;
+}
+
+QList<int> CpuTopology::nodes() const
+{
+    QList<int> result;
+    for (const CpuInfo& info : m_cpus) {
+        if (!result.contains(info.node)) {
+            result << info.node;
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+QList<int> CpuTopology::packages() const
+{
+    QList<int> result;
+    for (const CpuInfo& info : m_cpus) {
+        if (!result.contains(info.package)) {
+            result << info.package;
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+QList<int> CpuTopology::cpusOfNode(int node) const
+{
+    QList<int> result;
+    for (const CpuInfo& info : m_cpus) {
+        if (info.node == node) {
+            result << info.cpu;
+        }
+    }
+    return result;
+}
+
+QList<QList<int>> CpuTopology::coresOfNode(int node) const
+{
+    QList<QList<int>> cores;
+    QMap<QPair<int, int>, int> indexOfCore;
+    for (const CpuInfo& info : m_cpus) {
+        if (info.node != node) {
+            continue;
+        }
+        QPair<int, int> key(info.package, info.core);
+        if (!indexOfCore.contains(key)) {
+            indexOfCore.insert(key, cores.size());
+            cores << QList<int>();
+        }
+        cores[indexOfCore.value(key)] << info.cpu;
+    }
+    return cores;
+}
+
+QString CpuTopology::summary() const
+{
+    if (isEmpty()) {
+        return "无法读取 CPU 拓扑";
+    }
+
+    int coreCount = 0;
+    QStringList nodeTexts;
+    const QList<int> nodeList = nodes();
+    for (int node : nodeList) {
+        coreCount += coresOfNode(node).size();
+        nodeTexts << QString("节点 %1: %2").arg(node).arg(formatCpuList(cpusOfNode(node)));
+    }
+    return QString("%1 个插槽，%2 个 NUMA 节点，%3 个物理核 / %4 个逻辑 CPU\n%5")
+        .arg(packages().size()).arg(nodeList.size()).arg(coreCount).arg(m_cpus.size())
+        .arg(nodeTexts.join("；"));
+}
+
+QList<ThreadPlacement> ThreadPlacement::read(qint64 pid)
+{
+    QList<ThreadPlacement> threads;
+#ifdef Q_OS_LINUX
+    const QString taskRoot = QString("/proc/%1/task").arg(pid);
+    const QStringList tids = QDir(taskRoot).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& tid : tids) {
+        const QString dir = taskRoot + "/" + tid;
+        ThreadPlacement thread;
+        thread.tid = tid.toLongLong();
+        thread.name = QString::fromUtf8(readSysFile(dir + "/comm"));
+
+        const QList<QByteArray> status = readSysFile(dir + "/status").split('\n');
+        for (const QByteArray& line : status) {
+            if (line.startsWith("Cpus_allowed_list:")) {
+                thread.allowedCpus = QString::fromLatin1(line.mid(18).trimmed());
+            } else if (line.startsWith("Mems_allowed_list:")) {
+                thread.allowedNodes = QString::fromLatin1(line.mid(18).trimmed());
+            }
+        }
+
+        // 线程名可能含空格，从最后一个 ')' 之后数字段：state 是第 3 个字段，processor 是第 39 个
+        QByteArray stat = readSysFile(dir + "/stat");
+        const QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 1).trimmed().split(' ');
+        if (fields.size() > 36) {
+            thread.lastCpu = fields.at(36).toInt();
+        }
+        threads << thread;
+    }
+    std::sort(threads.begin(), threads.end(), [](const ThreadPlacement& a, const ThreadPlacement& b) {
+        return a.tid < b.tid;
+    });
+#else
+    Q_UNUSED(pid);
+#endif
+    return threads;
+}
+
+QStringList Placement::redisArguments(const QString& version) const
+{
+    if (serverCpus.isEmpty() || backgroundCpus.isEmpty()
+        || (!version.isEmpty() && VersionStore::compareVersions(version, "6.2") < 0)) {
+        return QStringList();
+    }
+    QString background = CpuTopology::formatCpuList(backgroundCpus);
+    return QStringList() << "--server-cpulist" << CpuTopology::formatCpuList(serverCpus)
+                         << "--bio-cpulist" << background
+                         << "--aof-rewrite-cpulist" << background
+                         << "--bgsave-cpulist" << background;
+}
+
+void Placement::applyTo(QProcess* process) const
+{
+#ifdef Q_OS_LINUX
+    if (isEmpty()) {
+        process->setChildProcessModifier(std::function<void()>());
+        return;
+    }
+
+    // 在 fork 之后、exec 之前的子进程中执行，只能调用异步信号安全的函数，数据提前准备好
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    struct NodeMask {
+        unsigned long bits[kMaxNodes / (8 * sizeof(unsigned long))];
+    } nodeMask = {};
+    for (int node : memoryNodes) {
+        if (node >= 0 && node < kMaxNodes) {
+            nodeMask.bits[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        }
+    }
+    bool bindCpus = !cpus.isEmpty();
+    bool bindMemory = !memoryNodes.isEmpty();
+
+    // 亲和性和内存策略都会被 exec 后的 redis-server 及其线程、fork 出的子进程继承
+    process->setChildProcessModifier([cpuSet, nodeMask, bindCpus, bindMemory]() {
+        if (bindCpus) {
+            sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+        }
+        if (bindMemory) {
+            syscall(SYS_set_mempolicy, kMpolBind, nodeMask.bits, (unsigned long)(kMaxNodes + 1));
+        }
+    });
+#else
+    Q_UNUSED(process);
+#endif
+}
+
+QString PlacementPolicy::modeName(Mode mode)
+{
+    switch (mode) {
+    case PinCores:
+        return "pin";
+    case SingleNode:
+        return "node";
+    case SpreadSockets:
+        return "spread";
+    default:
+        return "none";
+    }
+}
+
+PlacementPolicy::Mode PlacementPolicy::modeFromName(const QString& name)
+{
+    if (name == "pin") {
+        return PinCores;
+    }
+    if (name == "node") {
+        return SingleNode;
+    }
+    if (name == "spread") {
+        return SpreadSockets;
+    }
+    return NoPlacement;
+}
+
+QString PlacementPolicy::modeDescription(Mode mode)
+{
+    switch (mode) {
+    case PinCores:
+        return "绑定到指定的 CPU";
+    case SingleNode:
+        return "限制在一个 NUMA 节点（CPU 和内存）";
+    case SpreadSockets:
+        return "多实例按插槽分散，每个实例使用所在节点的内存";
+    default:
+        return "不限制（由操作系统调度）";
+    }
+}
+
+// 物理核足够多时留出最后一个物理核给后台线程和 fork 出的子进程，避免与主线程争抢
+static void splitServerAndBackground(const QList<QList<int>>& cores, Placement* placement)
+{
+    if (cores.size() < 4) {
+        return;
+    }
+    for (int i = 0; i < cores.size() - 1; ++i) {
+        placement->serverCpus << cores.at(i);
+    }
+    placement->backgroundCpus = cores.last();
+}
+
+Placement PlacementPolicy::compute(const CpuTopology& topology, Mode mode, const QString& cpuList,
+                                   int node, int index, int count)
+{
+    Placement placement;
+    if (mode == NoPlacement || topology.isEmpty()) {
+        return placement;
+    }
+
+    switch (mode) {
+    case PinCores: {
+        QSet<int> online;
+        for (const CpuInfo& info : topology.cpus()) {
+            online.insert(info.cpu);
+        }
+        QList<QList<int>> cores;
+        QMap<QPair<int, int>, int> indexOfCore;
+        const QList<int> requested = CpuTopology::parseCpuList(cpuList);
+        for (const CpuInfo& info : topology.cpus()) {
+            if (!requested.contains(info.cpu)) {
+                continue;
+            }
+            placement.cpus << info.cpu;
+            QPair<int, int> key(info.package, info.core);
+            if (!indexOfCore.contains(key)) {
+                indexOfCore.insert(key, cores.size());
+                cores << QList<int>();
+            }
+            cores[indexOfCore.value(key)] << info.cpu;
+        }
+        if (placement.cpus.isEmpty()) {
+            return placement;
+        }
+        splitServerAndBackground(cores, &placement);
+        placement.description = "CPU " + CpuTopology::formatCpuList(placement.cpus);
+        break;
+    }
+    case SingleNode: {
+        const QList<int> nodes = topology.nodes();
+        int target = nodes.contains(node) ? node : nodes.first();
+        placement.cpus = topology.cpusOfNode(target);
+        placement.memoryNodes << target;
+        splitServerAndBackground(topology.coresOfNode(target), &placement);
+        placement.description = QString("节点 %1（CPU %2）").arg(target)
+                                    .arg(CpuTopology::formatCpuList(placement.cpus));
+        break;
+    }
+    case SpreadSockets: {
+        // 第 i 个实例放在第 i % N 个节点；同一节点上的多个实例平分该节点的物理核
+        const QList<int> nodes = topology.nodes();
+        int nodeCount = nodes.size();
+        count = qMax(1, count);
+        index = qBound(0, index, count - 1);
+        int target = nodes.at(index % nodeCount);
+        int onNode = count / nodeCount + (index % nodeCount < count % nodeCount ? 1 : 0);
+        int slot = index / nodeCount;
+
+        const QList<QList<int>> cores = topology.coresOfNode(target);
+        QList<QList<int>> assigned;
+        if (onNode <= 1) {
+            assigned = cores;
+        } else if (cores.size() >= onNode) {
+            int chunk = cores.size() / onNode;
+            int first = slot * chunk;
+            int last = slot == onNode - 1 ? cores.size() : first + chunk;
+            assigned = cores.mid(first, last - first);
+        } else {
+            // 实例比物理核多，只能共用
+            assigned << cores.at(slot % cores.size());
+        }
+
+        for (const QList<int>& core : assigned) {
+            placement.cpus << core;
+        }
+        std::sort(placement.cpus.begin(), placement.cpus.end());
+        placement.memoryNodes << target;
+        splitServerAndBackground(assigned, &placement);
+        placement.description = QString("节点 %1，CPU %2").arg(target)
+                                    .arg(CpuTopology::formatCpuList(placement.cpus));
+        break;
+    }
+    default:
+        break;
+    }
+
+    qDebug() << "[Placement]" << modeName(mode) << placement.description;
+    return placement;
+}
@@ -0,0 +1,95 @@
+#ifndef CPUTOPOLOGY_H
+#define CPUTOPOLOGY_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+
+class QProcess;
+
+// 一个逻辑 CPU 在物理拓扑中的位置
+struct CpuInfo
+{
+    int cpu = 0;
+    int package = 0;    // 插槽（physical_package_id）
+    int core = 0;       // 插槽内的物理核（core_id），超线程的两个逻辑 CPU 相同
+    int node = 0;       // NUMA 节点
+};
+
+// 从 /sys/devices/system/cpu 和 /sys/devices/system/node 读取的 CPU 拓扑。
+// 只统计在线的 CPU；非 Linux 平台或读取失败时为空
+class CpuTopology
+{
+public:
+    static CpuTopology detect();
+
+    bool isEmpty() const { return m_cpus.isEmpty(); }
+    QList<CpuInfo> cpus() const { return m_cpus; }
+    QList<int> nodes() const;
+    QList<int> packages() const;
+    QList<int> cpusOfNode(int node) const;
+    // 按物理核分组的逻辑 CPU，超线程的兄弟 CPU 在同一组
+    QList<QList<int>> coresOfNode(int node) const;
+    QString summary() const;
+
+    // "0-3,8,10-11" 与 CPU 编号列表互相转换，格式与内核的 cpulist 相同
+    static QList<int> parseCpuList(const QString& text);
+    static QString formatCpuList(const QList<int>& cpus);
+
+private:
+    QList<CpuInfo> m_cpus;
+};
+
+// 进程中一个线程的实际放置情况，来自 /proc/<pid>/task/<tid>/
+struct ThreadPlacement
+{
+    qint64 tid = 0;
+    QString name;           // redis-server、io_thd_1、bio_aof、bio_lazy_free ...
+    QString allowedCpus;    // Cpus_allowed_list
+    QString allowedNodes;   // Mems_allowed_list
+    int lastCpu = -1;       // 最近一次运行所在的 CPU
+
+    static QList<ThreadPlacement> read(qint64 pid);
+};
+
+// 启动 redis-server 时应用的放置：整个进程的 CPU 亲和性和内存节点，
+// 以及 Redis 6.2 起自带的按线程类型绑核参数（server / bio / bgsave / aof-rewrite）
+struct Placement
+{
+    QList<int> cpus;
+    QList<int> memoryNodes;
+    // 主线程和 io-threads
+    QList<int> serverCpus;
+    // 后台线程（bio_close_file、bio_aof、bio_lazy_free）以及 BGSAVE / AOF 重写的子进程
+    QList<int> backgroundCpus;
+    QString description;
+
+    bool isEmpty() const { return cpus.isEmpty() && memoryNodes.isEmpty(); }
+    // 追加到 redis-server 命令行的参数，低于 6.2 的版本没有这些参数
+    QStringList redisArguments(const QString& version) const;
+    // 在子进程 exec 之前设置亲和性和内存策略（Linux），只对下一次 start() 有效
+    void applyTo(QProcess* process) const;
+};
+
+// 放置策略：固定核、单个 NUMA 节点、多实例按插槽分散
+class PlacementPolicy
+{
+public:
+    enum Mode {
+        NoPlacement,
+        PinCores,       // 绑定到指定的 CPU 列表
+        SingleNode,     // CPU 和内存都限制在一个 NUMA 节点
+        SpreadSockets   // 多个实例轮流分配到各个节点，同一节点上的实例分到不相交的物理核
+    };
+
+    static QString modeName(Mode mode);
+    static Mode modeFromName(const QString& name);
+    static QString modeDescription(Mode mode);
+
+    // index / count 为实例在所有受管实例中的序号和总数，只有 SpreadSockets 用到
+    static Placement compute(const CpuTopology& topology, Mode mode, const QString& cpuList,
+                             int node, int index = 0, int count = 1);
+};
+
+#endif // CPUTOPOLOGY_H
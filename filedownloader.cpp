@@ -0,0 +1,451 @@
+#include "filedownloader.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <cstdio>
+#endif
+
+// 下载时每次从网络读取并写入磁盘的块大小
+static const qint64 kDownloadChunkSize = 64 * 1024;
+// QNetworkReply 内部读缓冲上限，超过后由 TCP 流控暂停接收
+static const qint64 kDownloadReadBufferSize = 512 * 1024;
+// 每写入这么多数据刷新一次续传描述文件
+static const qint64 kResumeSaveInterval = 4 * 1024 * 1024;
+// 连接卡住超过该时间视为网络错误，触发续传
+static const int kTransferTimeoutMs = 30000;
+
+FileDownloader::FileDownloader(QNetworkAccessManager* networkManager, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(networkManager)
+    , m_reply(nullptr)
+    , m_file(nullptr)
+    , m_offset(0)
+    , m_written(0)
+    , m_lastSavedOffset(0)
+    , m_headersChecked(false)
+    , m_resumable(true)
+    , m_maxRetries(3)
+    , m_retryCount(0)
+{
+    m_retryTimer = new QTimer(this);
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &FileDownloader::sendRequest);
+}
+
+FileDownloader::~FileDownloader()
+{
+    abort();
+}
+
+void FileDownloader::start(const QUrl& url, const QString& destPath)
+{
+    abort();
+
+    m_url = url;
+    m_destPath = destPath;
+    m_lastError.clear();
+    m_etag.clear();
+    m_lastModified.clear();
+    m_offset = 0;
+    m_retryCount = 0;
+
+    if (m_resumable) {
+        loadResumeState();
+    } else {
+        QFile::remove(partPath());
+        clearResumeState();
+    }
+
+    if (!openPartFile(m_offset)) {
+        fail("无法保存下载文件", false);
+        return;
+    }
+
+    if (m_offset > 0) {
+        qDebug() << "[FileDownloader] Resuming" << m_url.toString() << "from byte" << m_offset;
+    }
+
+    m_chunk.resize(kDownloadChunkSize);
+    sendRequest();
+}
+
+void FileDownloader::abort()
+{
+    m_retryTimer->stop();
+    closeReply();
+
+    if (m_file) {
+        m_file->flush();
+        m_file->close();
+        if (m_resumable) {
+            saveResumeState();
+        }
+        delete m_file;
+        m_file = nullptr;
+    }
+}
+
+bool FileDownloader::isRunning() const
+{
+    return m_reply != nullptr || m_retryTimer->isActive();
+}
+
+void FileDownloader::sendRequest()
+{
+    QNetworkRequest request(m_url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                        QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setTransferTimeout(kTransferTimeoutMs);
+
+    if (m_offset > 0) {
+        // If-Range：文件在服务器上变化时服务器会返回完整内容而不是片段
+        request.setRawHeader("Range", "bytes=" + QByteArray::number(m_offset) + "-");
+        request.setRawHeader("If-Range", !m_etag.isEmpty() ? m_etag : m_lastModified);
+    }
+
+    m_headersChecked = false;
+    m_reply = m_networkManager->get(request);
+    m_reply->setReadBufferSize(kDownloadReadBufferSize);
+
+    connect(m_reply, &QNetworkReply::readyRead,
+            this, &FileDownloader::onReadyRead);
+    connect(m_reply, &QNetworkReply::downloadProgress,
+            this, &FileDownloader::onReplyProgress);
+    connect(m_reply, &QNetworkReply::finished,
+            this, &FileDownloader::onReplyFinished);
+}
+
+bool FileDownloader::checkResponseHeaders()
+{
+    if (m_headersChecked) {
+        return true;
+    }
+
+    int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status >= 400) {
+        // 错误响应的内容不写入文件，等 finished 处理
+        return false;
+    }
+
+    m_headersChecked = true;
+
+    QByteArray etag = m_reply->rawHeader("ETag");
+    if (etag.startsWith("W/")) {
+        // 弱校验值不能用于 If-Range
+        etag.clear();
+    }
+    m_etag = etag;
+    m_lastModified = m_reply->rawHeader("Last-Modified");
+
+    if (m_offset > 0) {
+        bool resumed = false;
+        if (status == 206) {
+            // Content-Range: bytes <start>-<end>/<total>
+            QByteArray range = m_reply->rawHeader("Content-Range");
+            int dash = range.indexOf('-');
+            if (range.startsWith("bytes ") && dash > 6) {
+                bool ok = false;
+                qint64 start = range.mid(6, dash - 6).trimmed().toLongLong(&ok);
+                resumed = ok && start == m_offset;
+            }
+        }
+
+        if (!resumed) {
+            // 服务器忽略了 Range 或文件已变化，丢弃部分文件从头下载
+            qDebug() << "[FileDownloader] Server did not honour Range (status" << status
+                     << "), restarting from zero";
+            if (status == 206) {
+                closeReply();
+                m_etag.clear();
+                m_lastModified.clear();
+                m_offset = 0;
+                if (!openPartFile(0)) {
+                    fail("无法保存下载文件", false);
+                    return false;
+                }
+                sendRequest();
+                return false;
+            }
+
+            m_offset = 0;
+            if (!openPartFile(0)) {
+                fail("无法保存下载文件", false);
+                return false;
+            }
+        }
+    }
+
+    saveResumeState();
+    return true;
+}
+
+void FileDownloader::onReadyRead()
+{
+    if (!m_reply || !m_file) {
+        return;
+    }
+
+    if (!checkResponseHeaders()) {
+        return;
+    }
+
+    while (m_reply && m_reply->bytesAvailable() > 0) {
+        qint64 n = m_reply->read(m_chunk.data(), m_chunk.size());
+        if (n <= 0) {
+            break;
+        }
+
+        if (m_file->write(m_chunk.constData(), n) != n) {
+            fail("写入下载文件失败: " + m_file->errorString(), false);
+            return;
+        }
+        m_written += n;
+    }
+
+    if (m_resumable && m_written - m_lastSavedOffset >= kResumeSaveInterval) {
+        m_file->flush();
+        saveResumeState();
+    }
+}
+
+void FileDownloader::onReplyProgress(qint64 bytesReceived, qint64 bytesTotal)
+{
+    emit progress(m_offset + bytesReceived, bytesTotal > 0 ? m_offset + bytesTotal : -1);
+}
+
+void FileDownloader::onReplyFinished()
+{
+    if (!m_reply) {
+        return;
+    }
+
+    QNetworkReply::NetworkError error = m_reply->error();
+    int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (error == QNetworkReply::NoError) {
+        if (!checkResponseHeaders()) {
+            return;
+        }
+        onReadyRead();
+        if (!m_file) {
+            return;
+        }
+    }
+
+    if (error != QNetworkReply::NoError) {
+        if (m_headersChecked) {
+            // 连接中断前已收到的数据仍然有效
+            onReadyRead();
+            if (!m_file) {
+                return;
+            }
+        }
+
+        QString message = "下载失败: " + m_reply->errorString();
+        bool canResume = !m_etag.isEmpty() || !m_lastModified.isEmpty();
+
+        if (status == 416 && m_offset > 0) {
+            // 请求的范围无效，本地部分文件不可用
+            message.clear();
+            canResume = false;
+        } else if (!isRetryable(error) || m_retryCount >= m_maxRetries || !m_resumable) {
+            fail(message, true);
+            return;
+        }
+
+        closeReply();
+        if (!canResume) {
+            m_etag.clear();
+            m_lastModified.clear();
+        }
+        m_offset = canResume ? m_written : 0;
+        if (!openPartFile(m_offset)) {
+            fail("无法保存下载文件", false);
+            return;
+        }
+
+        if (message.isEmpty()) {
+            sendRequest();
+            return;
+        }
+
+        saveResumeState();
+        int delay = 1000 << m_retryCount;
+        ++m_retryCount;
+        qDebug() << "[FileDownloader]" << message << "- retry" << m_retryCount
+                 << "from byte" << m_offset << "in" << delay << "ms";
+        m_retryTimer->start(delay);
+        return;
+    }
+
+    closeReply();
+
+    bool flushed = m_file->flush();
+    m_file->close();
+    delete m_file;
+    m_file = nullptr;
+
+    if (!flushed || !replaceFile(partPath(), m_destPath)) {
+        QFile::remove(partPath());
+        clearResumeState();
+        m_lastError = "无法保存下载文件";
+        emit finished(false);
+        return;
+    }
+
+    clearResumeState();
+    emit finished(true);
+}
+
+bool FileDownloader::openPartFile(qint64 offset)
+{
+    if (!m_file) {
+        m_file = new QFile(partPath(), this);
+    } else {
+        m_file->close();
+    }
+
+    if (!m_file->open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    if (!m_file->resize(offset) || !m_file->seek(offset)) {
+        return false;
+    }
+
+    m_written = offset;
+    m_lastSavedOffset = offset;
+    return true;
+}
+
+void FileDownloader::loadResumeState()
+{
+    QFile meta(metaPath());
+    if (!meta.open(QIODevice::ReadOnly)) {
+        QFile::remove(partPath());
+        return;
+    }
+
+    QJsonObject obj = QJsonDocument::fromJson(meta.readAll()).object();
+    meta.close();
+
+    qint64 partSize = QFileInfo(partPath()).size();
+    qint64 offset = qMin<qint64>(obj.value("offset").toInteger(), partSize);
+
+    if (obj.value("url").toString() != m_url.toString() || offset <= 0) {
+        QFile::remove(partPath());
+        clearResumeState();
+        return;
+    }
+
+    m_etag = obj.value("etag").toString().toLatin1();
+    m_lastModified = obj.value("lastModified").toString().toLatin1();
+    if (m_etag.isEmpty() && m_lastModified.isEmpty()) {
+        QFile::remove(partPath());
+        clearResumeState();
+        return;
+    }
+
+    m_offset = offset;
+}
+
+void FileDownloader::saveResumeState()
+{
+    if (m_etag.isEmpty() && m_lastModified.isEmpty()) {
+        return;
+    }
+
+    QJsonObject obj;
+    obj["url"] = m_url.toString();
+    obj["etag"] = QString::fromLatin1(m_etag);
+    obj["lastModified"] = QString::fromLatin1(m_lastModified);
+    obj["offset"] = m_written;
+
+    QSaveFile meta(metaPath());
+    if (meta.open(QIODevice::WriteOnly)) {
+        meta.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+        if (meta.commit()) {
+            m_lastSavedOffset = m_written;
+        }
+    }
+}
+
+void FileDownloader::clearResumeState()
+{
+    QFile::remove(metaPath());
+}
+
+void FileDownloader::closeReply()
+{
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+}
+
+void FileDownloader::fail(const QString& error, bool keepPartial)
+{
+    m_retryTimer->stop();
+    closeReply();
+
+    if (m_file) {
+        m_file->flush();
+        m_file->close();
+
+        bool canResume = !m_etag.isEmpty() || !m_lastModified.isEmpty();
+        if (keepPartial && m_resumable && canResume && m_written > 0) {
+            // 保留部分文件，下次下载从断点继续
+            saveResumeState();
+        } else {
+            QFile::remove(partPath());
+            clearResumeState();
+        }
+
+        delete m_file;
+        m_file = nullptr;
+    }
+
+    m_lastError = error;
+    emit finished(false);
+}
+
+bool FileDownloader::isRetryable(QNetworkReply::NetworkError error) const
+{
+    switch (error) {
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::ProxyConnectionClosedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::ServiceUnavailableError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool FileDownloader::replaceFile(const QString& from, const QString& to)
+{
+    // 用目标文件原子替换，避免出现写了一半的安装包
+#ifdef Q_OS_WIN
+    return MoveFileExW(reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(from).utf16()),
+                       reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(to).utf16()),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(QFile::encodeName(from).constData(),
+                       QFile::encodeName(to).constData()) == 0;
+#endif
+}
@@ -0,0 +1,88 @@
+#ifndef FILEDOWNLOADER_H
+#define FILEDOWNLOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QByteArray>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+class QFile;
+class QTimer;
+
+// 单连接流式下载器：边收边写 .part 文件，完成后原子重命名。
+// 可续传模式下保留部分文件和 .part.meta 描述文件（ETag/Last-Modified、偏移），
+// 下次通过 Range 请求从断点继续；服务器不支持 Range 时自动从头下载。
+class FileDownloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileDownloader(QNetworkAccessManager* networkManager, QObject *parent = nullptr);
+    ~FileDownloader();
+
+    void setResumable(bool enabled) { m_resumable = enabled; }
+    bool isResumable() const { return m_resumable; }
+
+    // 网络错误时自动续传的次数
+    void setMaxRetries(int retries) { m_maxRetries = retries; }
+
+    void start(const QUrl& url, const QString& destPath);
+    void abort();
+    bool isRunning() const;
+
+    QString getLastError() const { return m_lastError; }
+    // 最近一次下载的服务器校验值（强 ETag 和 Last-Modified）
+    QByteArray etag() const { return m_etag; }
+    QByteArray lastModified() const { return m_lastModified; }
+
+    static bool replaceFile(const QString& from, const QString& to);
+
+signals:
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
+    void finished(bool success);
+
+private slots:
+    void onReadyRead();
+    void onReplyProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void onReplyFinished();
+
+private:
+    void sendRequest();
+    bool checkResponseHeaders();
+    bool openPartFile(qint64 offset);
+    void loadResumeState();
+    void saveResumeState();
+    void clearResumeState();
+    void closeReply();
+    void fail(const QString& error, bool keepPartial);
+    bool isRetryable(QNetworkReply::NetworkError error) const;
+    QString partPath() const { return m_destPath + ".part"; }
+    QString metaPath() const { return m_destPath + ".part.meta"; }
+
+private:
+    QNetworkAccessManager* m_networkManager;
+    QNetworkReply* m_reply;
+    QFile* m_file;
+    QTimer* m_retryTimer;
+    QByteArray m_chunk;
+
+    QUrl m_url;
+    QString m_destPath;
+    QString m_lastError;
+
+    // 续传状态
+    QByteArray m_etag;
+    QByteArray m_lastModified;
+    qint64 m_offset;
+    qint64 m_written;
+    qint64 m_lastSavedOffset;
+    bool m_headersChecked;
+
+    bool m_resumable;
+    int m_maxRetries;
+    int m_retryCount;
+};
+
+#endif // FILEDOWNLOADER_H
@@ -0,0 +1,248 @@
+#include "hdrhistogram.h"
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// V2 编码的 cookie，低字节的 0x10 表示计数用 ZigZag LEB128 编码
+static const quint32 kEncodingCookie = 0x1c849303 | 0x10;
+static const quint32 kCompressedEncodingCookie = 0x1c849304 | 0x10;
+
+namespace {
+
+template <typename T>
+void appendBigEndian(QByteArray& out, T value)
+{
+    T bigEndian = qToBigEndian(value);
+    out.append(reinterpret_cast<const char*>(&bigEndian), int(sizeof(bigEndian)));
+}
+
+// 有符号数先 ZigZag 变换，再按 LEB128 每字节 7 位输出，最多 9 字节（第 9 字节用满 8 位）
+void appendZigZag(QByteArray& out, qint64 value)
+{
+    quint64 bits = (quint64(value) << 1) ^ quint64(value >> 63);
+    for (int i = 0; i < 8; ++i) {
+        if ((bits >> 7) == 0) {
+            out.append(char(bits));
+            return;
+        }
+        out.append(char((bits & 0x7F) | 0x80));
+        bits >>= 7;
+    }
+    out.append(char(bits));
+}
+
+} // namespace
+
+HdrHistogram::HdrHistogram(qint64 lowest, qint64 highest, int significantDigits)
+    : m_lowest(qMax<qint64>(1, lowest))
+    , m_highest(qMax(highest, 2 * qMax<qint64>(1, lowest)))
+    , m_significantDigits(qBound(1, significantDigits, 5))
+    , m_totalCount(0)
+    , m_minimum(std::numeric_limits<qint64>::max())
+    , m_maximum(0)
+{
+    // 单位精度能覆盖的最大值是 2 * 10^digits，格子数取能容纳它的 2 的幂
+    qint64 largestSingleUnitValue = 2;
+    for (int i = 0; i < m_significantDigits; ++i) {
+        largestSingleUnitValue *= 10;
+    }
+    int subBucketCountMagnitude = int(std::ceil(std::log2(double(largestSingleUnitValue))));
+    m_subBucketHalfCountMagnitude = qMax(subBucketCountMagnitude, 1) - 1;
+    m_unitMagnitude = 63 - qCountLeadingZeroBits(quint64(m_lowest));
+    m_subBucketCount = 1 << (m_subBucketHalfCountMagnitude + 1);
+    m_subBucketHalfCount = m_subBucketCount / 2;
+    m_subBucketMask = qint64(m_subBucketCount - 1) << m_unitMagnitude;
+
+    qint64 smallestUntrackable = qint64(m_subBucketCount) << m_unitMagnitude;
+    m_bucketCount = 1;
+    while (smallestUntrackable <= m_highest) {
+        if (smallestUntrackable > std::numeric_limits<qint64>::max() / 2) {
+            ++m_bucketCount;
+            break;
+        }
+        smallestUntrackable <<= 1;
+        ++m_bucketCount;
+    }
+
+    // 除第一个桶外，每个桶的下半部分和前一个桶重叠，只需要存上半部分
+    m_counts.assign(size_t((m_bucketCount + 1) * m_subBucketHalfCount), 0);
+}
+
+int HdrHistogram::bucketIndex(qint64 value) const
+{
+    int pow2Ceiling = 64 - qCountLeadingZeroBits(quint64(value | m_subBucketMask));
+    return pow2Ceiling - m_unitMagnitude - (m_subBucketHalfCountMagnitude + 1);
+}
+
+int HdrHistogram::subBucketIndex(qint64 value, int bucket) const
+{
+    return int(value >> (bucket + m_unitMagnitude));
+}
+
+int HdrHistogram::countsIndex(qint64 value) const
+{
+    int bucket = bucketIndex(value);
+    int subBucket = subBucketIndex(value, bucket);
+    return ((bucket + 1) << m_subBucketHalfCountMagnitude) + (subBucket - m_subBucketHalfCount);
+}
+
+qint64 HdrHistogram::valueAtIndex(int index) const
+{
+    int bucket = (index >> m_subBucketHalfCountMagnitude) - 1;
+    int subBucket = (index & (m_subBucketHalfCount - 1)) + m_subBucketHalfCount;
+    if (bucket < 0) {
+        subBucket -= m_subBucketHalfCount;
+        bucket = 0;
+    }
+    return qint64(subBucket) << (bucket + m_unitMagnitude);
+}
+
+qint64 HdrHistogram::lowestEquivalent(qint64 value) const
+{
+    int bucket = bucketIndex(value);
+    return qint64(subBucketIndex(value, bucket)) << (bucket + m_unitMagnitude);
+}
+
+qint64 HdrHistogram::highestEquivalent(qint64 value) const
+{
+    int bucket = bucketIndex(value);
+    int adjustedBucket = subBucketIndex(value, bucket) >= m_subBucketCount ? bucket + 1 : bucket;
+    return lowestEquivalent(value) + (qint64(1) << (m_unitMagnitude + adjustedBucket)) - 1;
+}
+
+bool HdrHistogram::sameLayout(const HdrHistogram& other) const
+{
+    return m_lowest == other.m_lowest && m_highest == other.m_highest
+           && m_significantDigits == other.m_significantDigits;
+}
+
+void HdrHistogram::record(qint64 value, qint64 count)
+{
+    if (value < 0 || count <= 0) {
+        return;
+    }
+    value = qMin(value, m_highest);
+    m_counts[size_t(countsIndex(value))] += count;
+    m_totalCount += count;
+    m_minimum = qMin(m_minimum, value);
+    m_maximum = qMax(m_maximum, value);
+}
+
+void HdrHistogram::add(const HdrHistogram& other)
+{
+    if (other.m_totalCount == 0) {
+        return;
+    }
+    if (!sameLayout(other)) {
+        for (size_t i = 0; i < other.m_counts.size(); ++i) {
+            if (other.m_counts[i] > 0) {
+                record(other.valueAtIndex(int(i)), other.m_counts[i]);
+            }
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+        m_counts[i] += other.m_counts[i];
+    }
+    m_totalCount += other.m_totalCount;
+    m_minimum = qMin(m_minimum, other.m_minimum);
+    m_maximum = qMax(m_maximum, other.m_maximum);
+}
+
+void HdrHistogram::reset()
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_totalCount = 0;
+    m_minimum = std::numeric_limits<qint64>::max();
+    m_maximum = 0;
+}
+
+double HdrHistogram::mean() const
+{
+    if (m_totalCount == 0) {
+        return 0;
+    }
+    double sum = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+        if (m_counts[i] > 0) {
+            qint64 low = valueAtIndex(int(i));
+            qint64 high = highestEquivalent(low);
+            sum += double(m_counts[i]) * double(low + (high - low + 1) / 2);
+        }
+    }
+    return sum / double(m_totalCount);
+}
+
+qint64 HdrHistogram::valueAtPercentile(double percentile) const
+{
+    if (m_totalCount == 0) {
+        return 0;
+    }
+    percentile = qBound(0.0, percentile, 100.0);
+    qint64 target = qMax<qint64>(1, qint64(percentile / 100.0 * double(m_totalCount) + 0.5));
+    qint64 running = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+        running += m_counts[i];
+        if (running >= target) {
+            return highestEquivalent(valueAtIndex(int(i)));
+        }
+    }
+    return maximum();
+}
+
+qint64 HdrHistogram::countAbove(qint64 value) const
+{
+    if (value < 0) {
+        return m_totalCount;
+    }
+    qint64 count = 0;
+    for (size_t i = size_t(countsIndex(qMin(value, m_highest))) + 1; i < m_counts.size(); ++i) {
+        count += m_counts[i];
+    }
+    return count;
+}
+
+QByteArray HdrHistogram::encode() const
+{
+    // 只编码到最大值所在的格子；连续的空格子合并为一个负数
+    QByteArray payload;
+    const int limit = m_totalCount > 0 ? countsIndex(m_maximum) + 1 : 0;
+    for (int i = 0; i < limit;) {
+        qint64 count = m_counts[size_t(i++)];
+        qint64 zeros = 0;
+        if (count == 0) {
+            zeros = 1;
+            while (i < limit && m_counts[size_t(i)] == 0) {
+                ++zeros;
+                ++i;
+            }
+        }
+        appendZigZag(payload, zeros > 1 ? -zeros : count);
+    }
+
+    QByteArray raw;
+    appendBigEndian<quint32>(raw, kEncodingCookie);
+    appendBigEndian<qint32>(raw, qint32(payload.size()));
+    appendBigEndian<qint32>(raw, 0);    // normalizingIndexOffset
+    appendBigEndian<qint32>(raw, m_significantDigits);
+    appendBigEndian<qint64>(raw, m_lowest);
+    appendBigEndian<qint64>(raw, m_highest);
+    double conversionRatio = 1.0;
+    quint64 ratioBits = 0;
+    std::memcpy(&ratioBits, &conversionRatio, sizeof(ratioBits));
+    appendBigEndian<quint64>(raw, ratioBits);
+    raw.append(payload);
+
+    // qCompress 的结果是 4 字节的原始长度加上 zlib 流，编码里只要 zlib 流
+    QByteArray deflated = qCompress(raw).mid(4);
+
+    QByteArray encoded;
+    appendBigEndian<quint32>(encoded, kCompressedEncodingCookie);
+    appendBigEndian<qint32>(encoded, qint32(deflated.size()));
+    encoded.append(deflated);
+    return encoded;
+}
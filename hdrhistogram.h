@@ -0,0 +1,65 @@
+#ifndef HDRHISTOGRAM_H
+#define HDRHISTOGRAM_H
+
+#include <QByteArray>
+#include <vector>
+
+// HdrHistogram（High Dynamic Range Histogram），桶布局与 HdrHistogram 参考实现一致：
+// 值按 2 的幂分桶，每个桶再等分为若干格，任何值的相对误差不超过 10^-significantDigits。
+// 记录一个值只是几次位运算和一次数组自增，和值的大小无关；参数相同的直方图逐格相加即可合并。
+// encode() 输出标准的 V2 压缩编码，HdrHistogram 的各语言实现和日志工具都能直接读取、合并
+class HdrHistogram
+{
+public:
+    // lowest >= 1，highest >= 2 * lowest，significantDigits 为 1 ~ 5
+    HdrHistogram(qint64 lowest, qint64 highest, int significantDigits);
+
+    // 超出范围的值按最大可跟踪值记录
+    void record(qint64 value, qint64 count = 1);
+    void add(const HdrHistogram& other);
+    void reset();
+
+    qint64 totalCount() const { return m_totalCount; }
+    qint64 minimum() const { return m_totalCount > 0 ? m_minimum : 0; }
+    qint64 maximum() const { return m_totalCount > 0 ? highestEquivalent(m_maximum) : 0; }
+    double mean() const;
+    // 0 ~ 100，返回该百分位所在格子的最大等价值
+    qint64 valueAtPercentile(double percentile) const;
+    // 落在 value 所在格子之后的记录数，即大于 value 的次数（误差在一个格子内）
+    qint64 countAbove(qint64 value) const;
+
+    qint64 lowestTrackable() const { return m_lowest; }
+    qint64 highestTrackable() const { return m_highest; }
+    int significantDigits() const { return m_significantDigits; }
+
+    // V2 压缩编码（zlib + ZigZag LEB128），写入 .hlog 时再做 base64
+    QByteArray encode() const;
+
+private:
+    int bucketIndex(qint64 value) const;
+    int subBucketIndex(qint64 value, int bucket) const;
+    int countsIndex(qint64 value) const;
+    qint64 valueAtIndex(int index) const;
+    qint64 lowestEquivalent(qint64 value) const;
+    qint64 highestEquivalent(qint64 value) const;
+    bool sameLayout(const HdrHistogram& other) const;
+
+private:
+    qint64 m_lowest;
+    qint64 m_highest;
+    int m_significantDigits;
+
+    int m_unitMagnitude;
+    int m_subBucketHalfCountMagnitude;
+    int m_subBucketCount;
+    int m_subBucketHalfCount;
+    qint64 m_subBucketMask;
+    int m_bucketCount;
+
+    std::vector<qint64> m_counts;
+    qint64 m_totalCount;
+    qint64 m_minimum;
+    qint64 m_maximum;
+};
+
+#endif // HDRHISTOGRAM_H
@@ -0,0 +1,137 @@
+#include "healthmonitor.h"
+#include "respclient.h"
+#include <QTimer>
+#include <QDebug>
+
+static const int kDefaultIntervalMs = 1000;
+static const int kMaxBackgroundIntervalMs = 30000;
+static const int kDefaultTimeoutMs = 3000;
+
+HealthMonitor::HealthMonitor(QObject *parent)
+    : QObject(parent)
+    , m_state(Unknown)
+    , m_baseInterval(kDefaultIntervalMs)
+    , m_interval(kDefaultIntervalMs)
+    , m_timeout(kDefaultTimeoutMs)
+    , m_generation(0)
+    , m_lastRoundTripMs(0)
+    , m_running(false)
+    , m_background(false)
+    , m_pingPending(false)
+{
+    m_client = new RespClient(this);
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &HealthMonitor::tick);
+}
+
+void HealthMonitor::setServer(const QString& host, quint16 port, const QString& password)
+{
+    m_client->disconnectFromServer();
+    m_client->setPassword(password);
+    m_client->setServer(host, port);
+}
+
+void HealthMonitor::start()
+{
+    stop();
+    m_running = true;
+    m_interval = m_baseInterval;
+    m_timer->start(0);
+}
+
+void HealthMonitor::stop()
+{
+    // 让还在路上的回复作废
+    ++m_generation;
+    m_running = false;
+    m_pingPending = false;
+    m_timer->stop();
+    m_client->disconnectFromServer();
+    m_state = Unknown;
+}
+
+void HealthMonitor::setBackground(bool background)
+{
+    if (m_background == background) {
+        return;
+    }
+    m_background = background;
+    if (m_running && !background) {
+        // 回到前台时立即确认一次状态
+        m_interval = m_baseInterval;
+        m_timer->start(0);
+    }
+}
+
+qint64 HealthMonitor::unresponsiveMs() const
+{
+    return m_state == Unresponsive ? m_unresponsiveClock.elapsed() : 0;
+}
+
+void HealthMonitor::tick()
+{
+    if (!m_running) {
+        return;
+    }
+
+    if (m_pingPending) {
+        // 上一个 PING 还没有回复：超时则判定无响应，但不再叠加新的 PING
+        if (m_pingClock.elapsed() >= m_timeout) {
+            setState(Unresponsive);
+        }
+        scheduleNext();
+        return;
+    }
+
+    int generation = m_generation;
+    m_pingPending = true;
+    m_pingClock.start();
+    m_client->send(QByteArray("PING"), [this, generation](const RespValue& reply) {
+        if (generation != m_generation) {
+            return;
+        }
+        m_pingPending = false;
+        m_lastRoundTripMs = m_pingClock.elapsed();
+        // 连接被拒绝或断开时回调收到错误，BUSY 表示脚本长时间占住了主线程；
+        // 这两种情况进程都还在，但无法处理命令
+        bool ok = !reply.isError() || reply.data().startsWith("LOADING");
+        setState(ok ? Responsive : Unresponsive);
+        scheduleNext();
+    });
+    scheduleNext();
+}
+
+void HealthMonitor::setState(State state)
+{
+    if (state == m_state) {
+        // 后台时状态稳定就逐渐放慢
+        if (m_background) {
+            m_interval = qMin(m_interval * 2, kMaxBackgroundIntervalMs);
+        }
+        return;
+    }
+
+    if (state == Unresponsive) {
+        m_unresponsiveClock.start();
+        qDebug() << "[HealthMonitor] Redis unresponsive, no PING reply for" << m_pingClock.elapsed() << "ms";
+    } else if (m_state == Unresponsive) {
+        qDebug() << "[HealthMonitor] Redis responsive again after" << m_unresponsiveClock.elapsed() << "ms";
+    }
+    m_state = state;
+    m_interval = m_baseInterval;
+    emit stateChanged(state);
+}
+
+void HealthMonitor::scheduleNext()
+{
+    if (!m_running) {
+        return;
+    }
+    // 等待回复期间在超时的时刻检查一次，否则按当前间隔发下一个 PING
+    int delay = m_interval;
+    if (m_pingPending && m_state != Unresponsive) {
+        delay = qMax(0, int(m_timeout - m_pingClock.elapsed()));
+    }
+    m_timer->start(delay);
+}
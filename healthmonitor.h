@@ -0,0 +1,73 @@
+#ifndef HEALTHMONITOR_H
+#define HEALTHMONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+
+class QTimer;
+class RespClient;
+
+// 运行中 Redis 的心跳：在一条独立的长连接上定期发送 PING，
+// 超过 unresponsiveTimeout 没有回复（进程还在但卡住，如 SIGSTOP、长时间阻塞的命令）时报告无响应。
+// 进程退出不在这里判断，由 QProcess::finished 直接通知。
+// 窗口隐藏时心跳间隔逐次加倍（最长 30 秒），状态变化或恢复前台时回到基础间隔；
+// 只有状态变化时才发出 stateChanged
+class HealthMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Unknown,
+        Responsive,
+        Unresponsive
+    };
+
+    explicit HealthMonitor(QObject *parent = nullptr);
+
+    void setServer(const QString& host, quint16 port, const QString& password);
+    void setInterval(int ms) { m_baseInterval = ms; }
+    void setUnresponsiveTimeout(int ms) { m_timeout = ms; }
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    // 界面不可见时降低心跳频率
+    void setBackground(bool background);
+
+    State state() const { return m_state; }
+    // 最近一次 PING 的往返时间
+    qint64 lastRoundTripMs() const { return m_lastRoundTripMs; }
+    // 无响应持续的时间
+    qint64 unresponsiveMs() const;
+
+signals:
+    void stateChanged(HealthMonitor::State state);
+
+private slots:
+    void tick();
+
+private:
+    void setState(State state);
+    void scheduleNext();
+
+private:
+    RespClient* m_client;
+    QTimer* m_timer;
+    QElapsedTimer m_pingClock;
+    QElapsedTimer m_unresponsiveClock;
+
+    State m_state;
+    int m_baseInterval;
+    int m_interval;
+    int m_timeout;
+    int m_generation;
+    qint64 m_lastRoundTripMs;
+    bool m_running;
+    bool m_background;
+    bool m_pingPending;
+};
+
+#endif // HEALTHMONITOR_H
@@ -0,0 +1,94 @@
+#include "historychart.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QDateTime>
+
+static const int kMargin = 6;
+
+HistoryChart::HistoryChart(QWidget *parent)
+    : QWidget(parent)
+    , m_from(0)
+    , m_to(0)
+{
+    setMinimumHeight(160);
+}
+
+QSize HistoryChart::sizeHint() const
+{
+    return QSize(600, 240);
+}
+
+void HistoryChart::setPoints(const QVector<MetricPoint>& points, qint64 from, qint64 to)
+{
+    m_points = points;
+    m_from = from;
+    m_to = to;
+    update();
+}
+
+void HistoryChart::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+
+    const int labelHeight = fontMetrics().height();
+    const QRectF plot(kMargin, kMargin + labelHeight, width() - 2 * kMargin,
+                      height() - 2 * kMargin - 2 * labelHeight);
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(plot);
+
+    // 横轴两端的时间
+    const QString format = (m_to - m_from) > 2 * 24 * 3600 * 1000LL ? "MM-dd hh:mm" : "hh:mm:ss";
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(QRectF(kMargin, plot.bottom(), plot.width(), labelHeight), Qt::AlignLeft,
+                     QDateTime::fromMSecsSinceEpoch(m_from).toString(format));
+    painter.drawText(QRectF(kMargin, plot.bottom(), plot.width(), labelHeight), Qt::AlignRight,
+                     QDateTime::fromMSecsSinceEpoch(m_to).toString(format));
+
+    if (m_points.isEmpty() || m_to <= m_from) {
+        painter.drawText(plot, Qt::AlignCenter, "这段时间没有数据");
+        return;
+    }
+
+    double maximum = 0;
+    for (const MetricPoint& point : m_points) {
+        maximum = qMax(maximum, double(point.maximum));
+    }
+    const double scale = maximum > 0 ? maximum * 1.1 : 1;
+    painter.drawText(QRectF(kMargin, kMargin, plot.width(), labelHeight), Qt::AlignLeft,
+                     m_formatter ? m_formatter(maximum) : QString::number(maximum));
+
+    auto xFor = [&](qint64 timestamp) {
+        return plot.left() + plot.width() * double(timestamp - m_from) / double(m_to - m_from);
+    };
+    auto yFor = [&](double value) {
+        return plot.bottom() - plot.height() * value / scale;
+    };
+
+    // 最小 / 最大值的范围
+    QPainterPath band;
+    band.moveTo(xFor(m_points.first().timestamp), yFor(m_points.first().maximum));
+    for (const MetricPoint& point : m_points) {
+        band.lineTo(xFor(point.timestamp), yFor(point.maximum));
+    }
+    for (int i = m_points.size() - 1; i >= 0; --i) {
+        band.lineTo(xFor(m_points.at(i).timestamp), yFor(m_points.at(i).minimum));
+    }
+    band.closeSubpath();
+
+    QColor color("#3498db");
+    QColor fill = color;
+    fill.setAlpha(50);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setClipRect(plot);
+    painter.fillPath(band, fill);
+
+    QPolygonF line;
+    line.reserve(m_points.size());
+    for (const MetricPoint& point : m_points) {
+        line << QPointF(xFor(point.timestamp), yFor(point.mean));
+    }
+    painter.setPen(QPen(color, 1.5));
+    painter.drawPolyline(line);
+}
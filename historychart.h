@@ -0,0 +1,32 @@
+#ifndef HISTORYCHART_H
+#define HISTORYCHART_H
+
+#include <QWidget>
+#include <QVector>
+#include <functional>
+#include "metricsstore.h"
+
+// 历史曲线：平均值折线加上最小 / 最大值的阴影带，横轴为 [from, to]
+class HistoryChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HistoryChart(QWidget *parent = nullptr);
+
+    void setPoints(const QVector<MetricPoint>& points, qint64 from, qint64 to);
+    void setValueFormatter(const std::function<QString(double)>& formatter) { m_formatter = formatter; }
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    QVector<MetricPoint> m_points;
+    qint64 m_from;
+    qint64 m_to;
+    std::function<QString(double)> m_formatter;
+};
+
+#endif // HISTORYCHART_H
@@ -0,0 +1,955 @@
+#include "installjob.h"
+#include "filedownloader.h"
+#include "segmenteddownloader.h"
+#include "archivepipeline.h"
+#include "artifactcache.h"
+#include "buildcache.h"
+#include "redisbuilder.h"
+#include "processreaper.h"
+#include "versionstore.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <memory>
+
+InstallJob::InstallJob(QNetworkAccessManager* networkManager, ArtifactCache* artifactCache,
+                       BuildCache* buildCache, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(networkManager)
+    , m_artifactCache(artifactCache)
+    , m_buildCache(buildCache)
+    , m_extractProcess(nullptr)
+    , m_versionProcess(nullptr)
+    , m_worker(nullptr)
+    , m_revalidateReply(nullptr)
+    , m_step(IdleStep)
+    , m_downloadSegments(4)
+    , m_streaming(false)
+    , m_archiveFromCache(false)
+    , m_builtFromSource(false)
+{
+    m_downloader = new FileDownloader(m_networkManager, this);
+
+    connect(m_downloader, &FileDownloader::progress,
+            this, &InstallJob::downloadProgress);
+    connect(m_downloader, &FileDownloader::finished,
+            this, &InstallJob::onDownloadFinished);
+
+    m_segmentedDownloader = new SegmentedDownloader(m_networkManager, this);
+    m_segmentedDownloader->setSegmentCount(m_downloadSegments);
+
+    connect(m_segmentedDownloader, &SegmentedDownloader::progress,
+            this, &InstallJob::downloadProgress);
+    connect(m_segmentedDownloader, &SegmentedDownloader::finished,
+            this, &InstallJob::onSegmentedDownloadFinished);
+    connect(m_segmentedDownloader, &SegmentedDownloader::rangesUnsupported,
+            this, &InstallJob::onRangesUnsupported);
+
+    m_archivePipeline = new ArchivePipeline(m_networkManager, this);
+
+    connect(m_archivePipeline, &ArchivePipeline::progress,
+            this, &InstallJob::downloadProgress);
+    connect(m_archivePipeline, &ArchivePipeline::throughput,
+            this, &InstallJob::onPipelineThroughput);
+    connect(m_archivePipeline, &ArchivePipeline::finished,
+            this, &InstallJob::onPipelineFinished);
+
+    m_builder = new RedisBuilder(this);
+
+    connect(m_builder, &RedisBuilder::progress,
+            this, &InstallJob::onBuildProgress);
+    connect(m_builder, &RedisBuilder::stageChanged,
+            this, &InstallJob::progressMessage);
+    connect(m_builder, &RedisBuilder::finished,
+            this, &InstallJob::onBuildFinished);
+}
+
+InstallJob::~InstallJob()
+{
+    cancel();
+}
+
+QString InstallJob::stepName(Step step)
+{
+    switch (step) {
+    case DownloadStep:
+        return "下载";
+    case VerifyStep:
+        return "校验";
+    case ExtractStep:
+        return "解压";
+    case BuildStep:
+        return "编译";
+    case InstallStep:
+        return "安装";
+    case ConfigureStep:
+        return "配置";
+    case DoneStep:
+        return "完成";
+    case FailedStep:
+        return "失败";
+    case CanceledStep:
+        return "已取消";
+    case IdleStep:
+    default:
+        return "空闲";
+    }
+}
+
+void InstallJob::setResumable(bool enabled)
+{
+    m_downloader->setResumable(enabled);
+    m_segmentedDownloader->setResumable(enabled);
+}
+
+void InstallJob::setDownloadSegments(int segments)
+{
+    m_downloadSegments = qMax(1, segments);
+    m_segmentedDownloader->setSegmentCount(m_downloadSegments);
+}
+
+bool InstallJob::isRunning() const
+{
+    return m_step >= DownloadStep && m_step <= ConfigureStep;
+}
+
+void InstallJob::start()
+{
+    if (isRunning()) {
+        return;
+    }
+
+    m_timings.clear();
+    m_lastError.clear();
+    m_installedVersion.clear();
+    m_sha256.clear();
+    m_buildKey.clear();
+    m_sourceUrl.clear();
+    m_sourceEtag.clear();
+    m_sourceLastModified.clear();
+    m_archiveFromCache = false;
+    m_builtFromSource = false;
+
+    if (m_archivePath.isEmpty()) {
+        // 每个安装目录使用独立的临时文件，多个任务并行时互不干扰，断点续传也能对上
+        QByteArray tag = QCryptographicHash::hash(m_installPath.toUtf8(), QCryptographicHash::Sha1).toHex().left(8);
+        QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+#ifdef Q_OS_WIN
+        m_archivePath = tempDir + "/redis-" + QString::fromLatin1(tag) + ".zip";
+#else
+        m_archivePath = tempDir + "/redis-" + QString::fromLatin1(tag) + ".tar.gz";
+#endif
+    }
+
+#ifndef Q_OS_WIN
+    // 编译缓存的键需要编译器版本，和下载同时异步获取
+    m_buildCache->detectCompiler();
+#endif
+
+    startDownload();
+}
+
+void InstallJob::cancel()
+{
+    if (!isRunning()) {
+        return;
+    }
+
+    Step step = m_step;
+
+    if (m_revalidateReply) {
+        m_revalidateReply->disconnect(this);
+        m_revalidateReply->abort();
+        m_revalidateReply->deleteLater();
+        m_revalidateReply = nullptr;
+    }
+
+    // 解压、编译到一半的源码树要等 tar / make 真正退出后才能删除，否则它们还在往里写；
+    // 删除在独立线程中进行，不依赖本对象是否还在
+    QString installPath = m_installPath;
+    std::function<void()> removeTree;
+    if (step == ExtractStep || step == BuildStep) {
+        removeTree = [installPath]() {
+            QThread* thread = QThread::create([installPath]() { removeSourceDirs(installPath); });
+            QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+            thread->start();
+        };
+    }
+
+    m_archivePipeline->abort();
+    m_segmentedDownloader->abort();
+    m_downloader->abort();
+
+    bool stopping = false;
+    if (m_builder->isRunning()) {
+        m_builder->cancel(removeTree);
+        stopping = true;
+    } else {
+        m_builder->cancel();
+    }
+
+    if (m_extractProcess) {
+        m_extractProcess->disconnect(this);
+        ProcessReaper::terminate(m_extractProcess, 0, false, removeTree);
+        m_extractProcess = nullptr;
+        stopping = true;
+    }
+
+    if (m_versionProcess) {
+        m_versionProcess->disconnect(this);
+        ProcessReaper::terminate(m_versionProcess, 0);
+        m_versionProcess = nullptr;
+    }
+
+    if (m_worker) {
+        // 工作线程只用按值捕获的数据，不等它结束，结束后自行删除
+        m_worker->disconnect(this);
+        connect(m_worker, &QThread::finished, m_worker, &QObject::deleteLater);
+        m_worker = nullptr;
+    }
+    m_buildCache->disconnect(this);
+
+    if (removeTree && !stopping) {
+        removeTree();
+    }
+
+    m_lastError = "安装已取消";
+    m_step = CanceledStep;
+    qDebug() << "[InstallJob]" << m_installPath << "canceled during" << stepName(step);
+    emit finished(false);
+}
+
+void InstallJob::enterStep(Step step)
+{
+    m_step = step;
+    m_stepClock.start();
+    emit stepStarted(step);
+}
+
+void InstallJob::completeStep()
+{
+    qint64 elapsed = m_stepClock.elapsed();
+    m_timings.append(qMakePair(m_step, elapsed));
+    qDebug() << "[InstallJob]" << stepName(m_step) << "finished in" << elapsed << "ms";
+    emit stepFinished(m_step, elapsed);
+}
+
+void InstallJob::fail(const QString& error)
+{
+    qDebug() << "[InstallJob]" << stepName(m_step) << "failed:" << error;
+    m_lastError = error;
+    m_step = FailedStep;
+    emit finished(false);
+}
+
+// ---------------------------------------------------------------- 下载
+
+void InstallJob::startDownload()
+{
+    enterStep(DownloadStep);
+
+    if (!QDir().mkpath(m_installPath)) {
+        fail("无法创建安装目录");
+        return;
+    }
+
+    // 1. 本地缓存命中，按镜像、官方地址的顺序查找；校验 SHA-256 要读完整个文件，放在工作线程
+    QStringList sources;
+    QStringList paths;
+    const QStringList candidates = remoteSources();
+    for (const QString& source : candidates) {
+        QString cachedPath = m_artifactCache->find(QUrl(source));
+        if (!cachedPath.isEmpty()) {
+            sources << source;
+            paths << cachedPath;
+        }
+    }
+    if (paths.isEmpty()) {
+        fetchArchive();
+        return;
+    }
+
+    // 依次校验，第一个通过的为准，之前校验失败的在 onCacheVerified 中丢弃
+    auto verified = std::make_shared<int>(-1);
+    runInWorker([verified, paths]() {
+        for (int i = 0; i < paths.size(); ++i) {
+            if (ArtifactCache::verifyObject(paths.at(i))) {
+                *verified = i;
+                return;
+            }
+        }
+    }, [this, sources, paths, verified]() {
+        onCacheVerified(sources, paths, *verified);
+    });
+}
+
+void InstallJob::onCacheVerified(const QStringList& sources, const QStringList& paths, int verified)
+{
+    int checked = verified >= 0 ? verified : int(paths.size());
+    for (int i = 0; i < checked; ++i) {
+        m_artifactCache->discard(paths.at(i));
+    }
+    if (verified < 0) {
+        fetchArchive();
+        return;
+    }
+
+    const QString& source = sources.at(verified);
+    const QString& cachedPath = paths.at(verified);
+    m_artifactCache->markUsed(cachedPath);
+    if (ArtifactCache::isVersionedUrl(QUrl(source))) {
+        useCachedArtifact(cachedPath);
+    } else {
+        // redis-stable 之类的地址内容会变，先向服务器确认缓存是否还是最新的
+        revalidateCachedArtifact(source, cachedPath);
+    }
+}
+
+void InstallJob::revalidateCachedArtifact(const QString& source, const QString& cachedPath)
+{
+    if (m_artifactCache->etag(QUrl(source)).isEmpty()
+        && m_artifactCache->lastModified(QUrl(source)).isEmpty()) {
+        // 没有校验值无法确认，重新下载
+        fetchArchive();
+        return;
+    }
+
+    QNetworkRequest request{QUrl(source)};
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                        QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setTransferTimeout(15000);
+    m_revalidateReply = m_networkManager->head(request);
+    connect(m_revalidateReply, &QNetworkReply::finished,
+            this, [this, source, cachedPath]() { onRevalidateFinished(source, cachedPath); });
+}
+
+void InstallJob::onRevalidateFinished(const QString& source, const QString& cachedPath)
+{
+    QNetworkReply* reply = m_revalidateReply;
+    m_revalidateReply = nullptr;
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        // 连不上服务器时下载同样会失败，先用缓存安装
+        qDebug() << "[InstallJob] Cannot revalidate" << source << ":" << reply->errorString();
+        useCachedArtifact(cachedPath);
+        return;
+    }
+
+    QByteArray etag = reply->rawHeader("ETag");
+    if (etag.startsWith("W/")) {
+        etag.clear();
+    }
+    QByteArray lastModified = reply->rawHeader("Last-Modified");
+
+    QByteArray cachedEtag = m_artifactCache->etag(QUrl(source));
+    QByteArray cachedLastModified = m_artifactCache->lastModified(QUrl(source));
+    bool fresh = !cachedEtag.isEmpty() ? cachedEtag == etag
+                                       : !cachedLastModified.isEmpty() && cachedLastModified == lastModified;
+    if (!fresh) {
+        qDebug() << "[InstallJob]" << source << "changed on the server, downloading again";
+        fetchArchive();
+        return;
+    }
+
+    useCachedArtifact(cachedPath);
+}
+
+void InstallJob::useCachedArtifact(const QString& cachedPath)
+{
+    // 硬链接失败（如临时目录在 tmpfs 上）时要复制整个文件，放在工作线程
+    auto linked = std::make_shared<bool>(false);
+    QString archivePath = m_archivePath;
+    runInWorker([linked, cachedPath, archivePath]() {
+        *linked = ArtifactCache::materialize(cachedPath, archivePath);
+    }, [this, linked, cachedPath]() {
+        if (!*linked) {
+            fetchArchive();
+            return;
+        }
+
+        qDebug() << "[InstallJob] Using cached artifact:" << cachedPath;
+        emit progressMessage("使用本地缓存的 Redis 安装包...");
+        m_archiveFromCache = true;
+        completeStep();
+        startVerify();
+    });
+}
+
+void InstallJob::fetchArchive()
+{
+    // 2. file:// 镜像直接从本地目录复制（在工作线程中复制和校验），其余镜像按顺序排在官方地址之前
+    QStringList localPaths;
+    for (const QString& mirror : m_mirrors) {
+        QUrl base(mirror.trimmed());
+        if (base.isLocalFile()) {
+            localPaths << base.toLocalFile() + "/" + m_url.fileName();
+        }
+    }
+    if (localPaths.isEmpty()) {
+        m_downloadCandidates = remoteSources();
+        emit progressMessage("正在下载 Redis...");
+        startNextCandidate();
+        return;
+    }
+
+    auto copied = std::make_shared<QString>();
+    QString archivePath = m_archivePath;
+    runInWorker([copied, localPaths, archivePath]() {
+        for (const QString& path : localPaths) {
+            if (copyFromLocalMirror(path, archivePath)) {
+                *copied = path;
+                return;
+            }
+        }
+    }, [this, copied]() {
+        if (!copied->isEmpty()) {
+            qDebug() << "[InstallJob] Using local mirror:" << *copied;
+            emit progressMessage("从本地镜像获取 Redis 安装包...");
+            completeStep();
+            startVerify();
+            return;
+        }
+
+        m_downloadCandidates = remoteSources();
+        emit progressMessage("正在下载 Redis...");
+        startNextCandidate();
+    });
+}
+
+QStringList InstallJob::remoteSources() const
+{
+    QStringList sources;
+    for (const QString& mirror : m_mirrors) {
+        QUrl base(mirror.trimmed());
+        if (!base.isValid() || base.isEmpty() || base.isLocalFile()) {
+            continue;
+        }
+
+        QString prefix = base.toString();
+        if (!prefix.endsWith('/')) {
+            prefix += '/';
+        }
+        sources << prefix + m_url.fileName();
+    }
+    sources << m_url.toString();
+    return sources;
+}
+
+bool InstallJob::copyFromLocalMirror(const QString& path, const QString& archivePath)
+{
+    if (!QFile::exists(path)) {
+        return false;
+    }
+
+    QFile::remove(archivePath);
+    if (!QFile::copy(path, archivePath)) {
+        return false;
+    }
+
+    // 镜像目录中有 <文件名>.sha256 时校验完整性
+    QFile checksumFile(path + ".sha256");
+    if (checksumFile.open(QIODevice::ReadOnly)) {
+        QByteArray expected = checksumFile.readAll().simplified().split(' ').first().toLower();
+        if (ArtifactCache::sha256OfFile(archivePath) != expected) {
+            qDebug() << "[InstallJob] Checksum mismatch in local mirror:" << path;
+            QFile::remove(archivePath);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void InstallJob::startNextCandidate()
+{
+    m_currentDownloadUrl = m_downloadCandidates.takeFirst();
+    qDebug() << "[InstallJob] Downloading from" << m_currentDownloadUrl;
+
+#ifndef Q_OS_WIN
+    if (m_streaming) {
+        m_archivePipeline->start(QUrl(m_currentDownloadUrl), m_installPath);
+        return;
+    }
+#endif
+
+    // 已有单连接下载留下的部分文件时继续单连接下载，否则优先分段并发下载（分段下载自己续传）
+    bool hasPartial = m_downloader->isResumable() && QFile::exists(m_archivePath + ".part.meta")
+                      && !SegmentedDownloader::hasResumeState(m_archivePath);
+    if (m_downloadSegments > 1 && !hasPartial) {
+        m_segmentedDownloader->start(QUrl(m_currentDownloadUrl), m_archivePath);
+    } else {
+        m_downloader->start(QUrl(m_currentDownloadUrl), m_archivePath);
+    }
+}
+
+void InstallJob::onRangesUnsupported()
+{
+    // 服务器不支持 Range 或文件已变化，退回单连接流式下载
+    m_downloader->start(QUrl(m_currentDownloadUrl), m_archivePath);
+}
+
+void InstallJob::onSegmentedDownloadFinished(bool success)
+{
+    if (!success) {
+        handleDownloadFailure(m_segmentedDownloader->getLastError());
+        return;
+    }
+
+    m_sourceUrl = m_currentDownloadUrl;
+    m_sourceEtag = m_segmentedDownloader->etag();
+    m_sourceLastModified = m_segmentedDownloader->lastModified();
+
+    completeStep();
+    startVerify();
+}
+
+void InstallJob::onDownloadFinished(bool success)
+{
+    if (!success) {
+        handleDownloadFailure(m_downloader->getLastError());
+        return;
+    }
+
+    m_sourceUrl = m_currentDownloadUrl;
+    m_sourceEtag = m_downloader->etag();
+    m_sourceLastModified = m_downloader->lastModified();
+
+    completeStep();
+    startVerify();
+}
+
+void InstallJob::onPipelineThroughput(double downloadRate, double extractRate)
+{
+    emit progressMessage(QString("正在下载并解压 Redis... 下载 %1 MB/s，解压 %2 MB/s")
+                             .arg(downloadRate / (1024 * 1024), 0, 'f', 1)
+                             .arg(extractRate / (1024 * 1024), 0, 'f', 1));
+}
+
+void InstallJob::onPipelineFinished(bool success)
+{
+    if (!success) {
+        handleDownloadFailure(m_archivePipeline->getLastError());
+        return;
+    }
+
+    completeStep();
+
+    // 流式安装边下载边计算了 SHA-256，校验步骤无需再读文件
+    enterStep(VerifyStep);
+    m_sha256 = m_archivePipeline->sha256();
+    afterVerify();
+}
+
+void InstallJob::handleDownloadFailure(const QString& error)
+{
+    if (!m_downloadCandidates.isEmpty()) {
+        qDebug() << "[InstallJob]" << m_currentDownloadUrl << "failed:" << error;
+        startNextCandidate();
+        return;
+    }
+
+    fail(error);
+}
+
+// ---------------------------------------------------------------- 校验
+
+void InstallJob::runInWorker(const std::function<void()>& work, const std::function<void()>& done)
+{
+    m_worker = QThread::create(work);
+    connect(m_worker, &QThread::finished, this, [this, done]() {
+        m_worker->deleteLater();
+        m_worker = nullptr;
+        done();
+    });
+    m_worker->start();
+}
+
+void InstallJob::startVerify()
+{
+    enterStep(VerifyStep);
+
+    // 在工作线程中计算 SHA-256，下载来的文件顺便复制进缓存；索引在 onVerifyFinished 中登记
+    struct VerifyResult
+    {
+        QByteArray sha256;
+        bool imported = false;
+    };
+    auto result = std::make_shared<VerifyResult>();
+    QString path = m_archivePath;
+    QString cacheDir = m_artifactCache->cacheDir();
+    bool import = !m_archiveFromCache && !m_sourceUrl.isEmpty();
+    runInWorker([result, path, cacheDir, import]() {
+        result->sha256 = ArtifactCache::sha256OfFile(path);
+        if (import && !result->sha256.isEmpty()) {
+            result->imported = ArtifactCache::importObject(cacheDir, path, result->sha256);
+        }
+    }, [this, result]() {
+        onVerifyFinished(result->sha256, result->imported);
+    });
+}
+
+void InstallJob::onVerifyFinished(const QByteArray& sha256, bool imported)
+{
+    m_sha256 = sha256;
+    if (m_sha256.isEmpty()) {
+        fail("无法读取下载的 Redis 文件");
+        return;
+    }
+
+    // 本地镜像的文件不进缓存；下载的文件记在实际来源地址名下，镜像的内容不会冒充官方地址
+    if (imported) {
+        m_artifactCache->addSource(QUrl(m_sourceUrl), m_sha256, m_sourceEtag, m_sourceLastModified);
+    }
+
+    afterVerify();
+}
+
+void InstallJob::afterVerify()
+{
+    completeStep();
+
+#ifndef Q_OS_WIN
+    // 编译缓存的键包含编译器版本，start() 时已开始异步获取，一般早已完成
+    if (!m_buildCache->isCompilerDetected()) {
+        connect(m_buildCache, &BuildCache::compilerDetected,
+                this, &InstallJob::checkBuildCache, Qt::SingleShotConnection);
+        m_buildCache->detectCompiler();
+        return;
+    }
+    checkBuildCache();
+#else
+    startExtract();
+#endif
+}
+
+void InstallJob::checkBuildCache()
+{
+    // 相同源码、编译器和编译参数已经编译过时直接复用，跳过解压和编译；
+    // 校验缓存的二进制文件要读完整个文件，放在工作线程
+    m_buildKey = buildCacheKey();
+    QString entryPath = m_buildCache->entryPath(m_buildKey);
+    QString archivePath = m_archivePath;
+    QString installPath = m_installPath;
+    auto cached = std::make_shared<bool>(false);
+    runInWorker([cached, entryPath, archivePath, installPath]() {
+        *cached = BuildCache::verifyEntry(entryPath);
+        if (*cached) {
+            // 用不到的安装包和流式安装已解压的源码一并清理
+            QFile::remove(archivePath);
+            removeSourceDirs(installPath);
+        }
+    }, [this, cached]() {
+        if (*cached) {
+            installFromBuildCache();
+            return;
+        }
+
+        if (m_streaming) {
+            startBuild();
+            return;
+        }
+        startExtract();
+    });
+}
+
+// ---------------------------------------------------------------- 解压
+
+void InstallJob::startExtract()
+{
+    enterStep(ExtractStep);
+    emit progressMessage("正在解压文件...");
+
+#ifdef Q_OS_WIN
+    runExtract();
+#else
+    // 旧的源码目录会让编译步骤选错目录，先在工作线程中清理
+    QString installPath = m_installPath;
+    runInWorker([installPath]() {
+        removeSourceDirs(installPath);
+    }, [this]() {
+        runExtract();
+    });
+#endif
+}
+
+void InstallJob::runExtract()
+{
+    m_extractProcess = new QProcess(this);
+    m_extractProcess->setWorkingDirectory(m_installPath);
+    connect(m_extractProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &InstallJob::onExtractFinished);
+    connect(m_extractProcess, &QProcess::errorOccurred,
+            this, &InstallJob::onExtractError);
+
+#ifdef Q_OS_WIN
+    QString command = QString("Expand-Archive -Path '%1' -DestinationPath '%2' -Force")
+                          .arg(m_archivePath)
+                          .arg(m_installPath);
+    m_extractProcess->start("powershell", QStringList() << "-NoProfile" << "-Command" << command);
+#else
+    m_extractProcess->start("tar", QStringList() << "-xzf" << m_archivePath);
+#endif
+}
+
+void InstallJob::onExtractFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QByteArray errorOutput = m_extractProcess->readAllStandardError();
+    m_extractProcess->deleteLater();
+    m_extractProcess = nullptr;
+
+    // 清理下载文件
+    QFile::remove(m_archivePath);
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        qDebug() << "[InstallJob] Extraction failed:" << errorOutput;
+        QString installPath = m_installPath;
+        runInWorker([installPath]() {
+            removeSourceDirs(installPath);
+        }, [this]() {
+            fail("解压失败");
+        });
+        return;
+    }
+
+    completeStep();
+
+#ifdef Q_OS_WIN
+    // 预编译包解压后即可使用
+    startConfigure();
+#else
+    startBuild();
+#endif
+}
+
+void InstallJob::onExtractError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart) {
+        return;
+    }
+
+    QString message = "无法启动解压程序: " + m_extractProcess->errorString();
+    m_extractProcess->deleteLater();
+    m_extractProcess = nullptr;
+    QFile::remove(m_archivePath);
+    fail(message);
+}
+
+// ---------------------------------------------------------------- 编译
+
+QString InstallJob::buildSourceDir() const
+{
+    QDir dir(m_installPath);
+    QStringList redisDirs = dir.entryList(QStringList() << "redis-*", QDir::Dirs | QDir::NoDotAndDotDot);
+    if (redisDirs.isEmpty()) {
+        return QString();
+    }
+    return dir.filePath(redisDirs.first());
+}
+
+void InstallJob::removeSourceDirs(const QString& installPath)
+{
+    QDir dir(installPath);
+    const QStringList redisDirs = dir.entryList(QStringList() << "redis-*", QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& redisDir : redisDirs) {
+        QDir(dir.filePath(redisDir)).removeRecursively();
+    }
+}
+
+QByteArray InstallJob::buildCacheKey() const
+{
+    return BuildCache::makeKey(m_sha256, m_buildCache->compilerVersion(),
+                               m_builder->buildFlags(), m_builder->allocator());
+}
+
+void InstallJob::startBuild()
+{
+    enterStep(BuildStep);
+
+    QString sourceDir = buildSourceDir();
+    if (sourceDir.isEmpty()) {
+        fail("未找到 Redis 源码目录");
+        return;
+    }
+
+    qDebug() << "[InstallJob] Redis source directory:" << sourceDir;
+    emit progressMessage(QString("正在编译 Redis（%1 个并行任务）...").arg(m_builder->jobs()));
+    m_builder->start(sourceDir);
+}
+
+void InstallJob::onBuildProgress(int done, int total, qint64 etaMs, const QString& currentFile)
+{
+    QString message = QString("正在编译 Redis... %1/%2 (%3%)")
+                          .arg(done)
+                          .arg(total)
+                          .arg(done * 100 / qMax(1, total));
+    if (etaMs >= 0) {
+        message += QString("，预计剩余 %1 秒").arg((etaMs + 999) / 1000);
+    }
+    if (!currentFile.isEmpty()) {
+        message += "  " + currentFile;
+    }
+    emit progressMessage(message);
+}
+
+void InstallJob::onBuildFinished(bool success)
+{
+    if (!success) {
+        // make 和训练进程都已退出，在工作线程中删除源码树
+        QString sourceDir = m_builder->sourceDir();
+        QString error = m_builder->getLastError();
+        runInWorker([sourceDir]() {
+            QDir(sourceDir).removeRecursively();
+        }, [this, error]() {
+            fail(error);
+        });
+        return;
+    }
+
+    completeStep();
+    m_builtFromSource = true;
+    startInstall();
+}
+
+// ---------------------------------------------------------------- 安装
+
+void InstallJob::startInstall()
+{
+    enterStep(InstallStep);
+
+    // 先存入编译缓存（在工作线程中复制并哈希二进制文件），再从缓存链接到安装目录
+    QString sourceDir = m_builder->sourceDir();
+    QString srcDir = sourceDir + "/src";
+    QString entryPath = m_buildCache->entryPath(m_buildKey);
+    QString description = QString("%1 | %2 | %3")
+                              .arg(m_buildCache->compilerVersion(),
+                                   m_builder->buildFlags().join(' '),
+                                   m_builder->allocator());
+    auto stored = std::make_shared<bool>(false);
+    runInWorker([stored, entryPath, srcDir, description]() {
+        *stored = BuildCache::storeEntry(entryPath, srcDir, description);
+    }, [this, stored, sourceDir]() {
+        finishInstall(sourceDir, *stored);
+    });
+}
+
+void InstallJob::finishInstall(const QString& sourceDir, bool stored)
+{
+    // 淘汰旧条目、链接或复制二进制文件、清理源代码目录（包含全部目标文件）都在工作线程中进行
+    QString cacheDir = m_buildCache->cacheDir();
+    int maxEntries = m_buildCache->maxEntries();
+    QString entryPath = m_buildCache->entryPath(m_buildKey);
+    QString installPath = m_installPath;
+    auto error = std::make_shared<QString>();
+    runInWorker([error, cacheDir, maxEntries, entryPath, installPath, sourceDir, stored]() {
+        if (stored) {
+            BuildCache::prune(cacheDir, maxEntries);
+        }
+        bool cached = stored && BuildCache::materializeEntry(entryPath, installPath);
+
+        if (!cached) {
+            // 缓存不可用时直接复制二进制文件
+            const QStringList binaries = BuildCache::binaryNames();
+            for (const QString& binary : binaries) {
+                QFile::remove(installPath + "/" + binary);
+                if (!QFile::copy(sourceDir + "/src/" + binary, installPath + "/" + binary)) {
+                    *error = "无法复制编译好的 " + binary;
+                    break;
+                }
+
+                // 设置执行权限
+                QFile::setPermissions(installPath + "/" + binary,
+                                      QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner |
+                                      QFile::ReadGroup | QFile::ExeGroup |
+                                      QFile::ReadOther | QFile::ExeOther);
+            }
+        }
+
+        QDir(sourceDir).removeRecursively();
+    }, [this, error]() {
+        onInstallCopied(*error);
+    });
+}
+
+void InstallJob::onInstallCopied(const QString& error)
+{
+    if (!error.isEmpty()) {
+        fail(error);
+        return;
+    }
+
+    completeStep();
+    startConfigure();
+}
+
+void InstallJob::installFromBuildCache()
+{
+    enterStep(InstallStep);
+    qDebug() << "[InstallJob] Using cached build" << m_buildKey;
+    emit progressMessage("使用已缓存的编译结果...");
+
+    QString entryPath = m_buildCache->entryPath(m_buildKey);
+    QString installPath = m_installPath;
+    auto error = std::make_shared<QString>();
+    runInWorker([error, entryPath, installPath]() {
+        if (!BuildCache::materializeEntry(entryPath, installPath)) {
+            *error = "无法复制缓存的 Redis 程序";
+        }
+    }, [this, error]() {
+        onInstallCopied(*error);
+    });
+}
+
+// ---------------------------------------------------------------- 配置
+
+void InstallJob::startConfigure()
+{
+    enterStep(ConfigureStep);
+    emit progressMessage("正在创建配置文件...");
+
+    // 版本号决定提交到哪个版本目录，异步读取 redis-server --version，不在界面线程上等待
+#ifdef Q_OS_WIN
+    QString redisExe = m_installPath + "/redis-server.exe";
+#else
+    QString redisExe = m_installPath + "/redis-server";
+#endif
+    m_versionProcess = new QProcess(this);
+    connect(m_versionProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &InstallJob::onVersionDetected);
+    connect(m_versionProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            onVersionDetected();
+        }
+    });
+    m_versionProcess->start(redisExe, QStringList() << "--version");
+}
+
+void InstallJob::onVersionDetected()
+{
+    m_installedVersion = VersionStore::parseVersion(m_versionProcess->readAllStandardOutput());
+    m_versionProcess->disconnect(this);
+    m_versionProcess->deleteLater();
+    m_versionProcess = nullptr;
+
+    if (m_installedVersion.isEmpty()) {
+        fail("无法识别安装的 Redis 版本");
+        return;
+    }
+
+    if (m_configurator && !m_configurator(m_installPath, m_installedVersion)) {
+        fail("创建配置文件失败");
+        return;
+    }
+
+    completeStep();
+
+    m_step = DoneStep;
+    emit progressMessage("安装完成！");
+    emit finished(true);
+}
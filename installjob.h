@@ -0,0 +1,186 @@
+#ifndef INSTALLJOB_H
+#define INSTALLJOB_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QProcess>
+#include <functional>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QThread;
+class FileDownloader;
+class SegmentedDownloader;
+class ArchivePipeline;
+class ArtifactCache;
+class BuildCache;
+class RedisBuilder;
+
+// 一次 Redis 安装的异步状态机：下载 → 校验 → 解压 → 编译 → 安装 → 配置。
+// 每一步都由信号驱动、可取消并记录耗时，GUI 线程上不做任何阻塞等待：
+// 哈希、缓存复制和删除源码树在工作线程中进行，子进程在取消时不等待退出，
+// 它们写入的源码树等进程真正退出后再删除；
+// 每个任务有自己的下载器和编译器，多个任务（不同安装目录）可以同时进行。
+class InstallJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Step {
+        IdleStep,
+        DownloadStep,
+        VerifyStep,
+        ExtractStep,
+        BuildStep,
+        InstallStep,
+        ConfigureStep,
+        DoneStep,
+        FailedStep,
+        CanceledStep
+    };
+
+    // 配置步骤的回调：在安装目录中写入配置文件，成功返回 true；version 为安装好的版本号
+    using Configurator = std::function<bool(const QString& installPath, const QString& version)>;
+
+    InstallJob(QNetworkAccessManager* networkManager, ArtifactCache* artifactCache,
+               BuildCache* buildCache, QObject *parent = nullptr);
+    ~InstallJob();
+
+    void setInstallPath(const QString& path) { m_installPath = path; }
+    QString installPath() const { return m_installPath; }
+
+    void setDownloadUrl(const QUrl& url) { m_url = url; }
+    QUrl downloadUrl() const { return m_url; }
+
+    // 下载文件的存放位置，默认按安装目录在临时目录下生成
+    void setArchivePath(const QString& path) { m_archivePath = path; }
+
+    // 镜像（http(s):// 或 file:// 目录），按顺序优先于官方地址
+    void setMirrors(const QStringList& mirrors) { m_mirrors = mirrors; }
+
+    void setResumable(bool enabled);
+    void setDownloadSegments(int segments);
+    void setStreaming(bool enabled) { m_streaming = enabled; }
+    void setConfigurator(const Configurator& configurator) { m_configurator = configurator; }
+
+    // 编译参数（任务数、配置、分配器）直接在 builder 上设置
+    RedisBuilder* builder() const { return m_builder; }
+
+    void start();
+    void cancel();
+    bool isRunning() const;
+
+    Step step() const { return m_step; }
+    static QString stepName(Step step);
+
+    // 已完成的步骤及耗时（毫秒）
+    QList<QPair<Step, qint64>> stepTimings() const { return m_timings; }
+    // 本次安装是否从源码编译（而不是使用编译缓存或预编译包）
+    bool builtFromSource() const { return m_builtFromSource; }
+    // 安装好的 redis-server 报告的版本号，配置步骤开始后可用
+    QString installedVersion() const { return m_installedVersion; }
+    QString getLastError() const { return m_lastError; }
+
+signals:
+    void stepStarted(InstallJob::Step step);
+    void stepFinished(InstallJob::Step step, qint64 elapsedMs);
+    void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void progressMessage(const QString& message);
+    void finished(bool success);
+
+private slots:
+    void onDownloadFinished(bool success);
+    void onSegmentedDownloadFinished(bool success);
+    void onRangesUnsupported();
+    void onPipelineThroughput(double downloadRate, double extractRate);
+    void onPipelineFinished(bool success);
+    void onExtractFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onExtractError(QProcess::ProcessError error);
+    void onBuildProgress(int done, int total, qint64 etaMs, const QString& currentFile);
+    void onBuildFinished(bool success);
+    void onVersionDetected();
+
+private:
+    void enterStep(Step step);
+    void completeStep();
+    void fail(const QString& error);
+
+    void startDownload();
+    void onCacheVerified(const QStringList& sources, const QStringList& paths, int verified);
+    void revalidateCachedArtifact(const QString& source, const QString& cachedPath);
+    void onRevalidateFinished(const QString& source, const QString& cachedPath);
+    void useCachedArtifact(const QString& cachedPath);
+    void fetchArchive();
+    // http(s) 镜像上的同名文件和官方地址，按优先顺序
+    QStringList remoteSources() const;
+    void startNextCandidate();
+    static bool copyFromLocalMirror(const QString& path, const QString& archivePath);
+    void handleDownloadFailure(const QString& error);
+
+    // 在工作线程中执行 work（只能使用按值捕获的数据），结束后在本线程调用 done
+    void runInWorker(const std::function<void()>& work, const std::function<void()>& done);
+
+    void startVerify();
+    void onVerifyFinished(const QByteArray& sha256, bool imported);
+    void afterVerify();
+    void checkBuildCache();
+    void startExtract();
+    void runExtract();
+    void startBuild();
+    void startInstall();
+    void finishInstall(const QString& sourceDir, bool stored);
+    void onInstallCopied(const QString& error);
+    void installFromBuildCache();
+    void startConfigure();
+
+    QString buildSourceDir() const;
+    // 删除安装目录下解压出的 redis-* 源码目录，要遍历整棵树，只在工作线程中调用
+    static void removeSourceDirs(const QString& installPath);
+    QByteArray buildCacheKey() const;
+
+private:
+    QNetworkAccessManager* m_networkManager;
+    ArtifactCache* m_artifactCache;
+    BuildCache* m_buildCache;
+    FileDownloader* m_downloader;
+    SegmentedDownloader* m_segmentedDownloader;
+    ArchivePipeline* m_archivePipeline;
+    RedisBuilder* m_builder;
+    QProcess* m_extractProcess;
+    QProcess* m_versionProcess;
+    QThread* m_worker;
+    QNetworkReply* m_revalidateReply;
+    Configurator m_configurator;
+
+    QUrl m_url;
+    QStringList m_mirrors;
+    QString m_installPath;
+    QString m_archivePath;
+    QString m_currentDownloadUrl;
+    QStringList m_downloadCandidates;
+    // 安装包实际来自的地址和服务器校验值，按这个地址存入缓存（镜像下载的内容不能记在官方地址名下）
+    QString m_sourceUrl;
+    QByteArray m_sourceEtag;
+    QByteArray m_sourceLastModified;
+    QByteArray m_sha256;
+    QByteArray m_buildKey;
+    QString m_lastError;
+    QString m_installedVersion;
+
+    Step m_step;
+    QElapsedTimer m_stepClock;
+    QList<QPair<Step, qint64>> m_timings;
+
+    int m_downloadSegments;
+    bool m_streaming;
+    bool m_archiveFromCache;
+    bool m_builtFromSource;
+};
+
+#endif // INSTALLJOB_H
@@ -0,0 +1,312 @@
+#include "instanceregistry.h"
+#include "redisconfig.h"
+#include "serviceconfig.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTcpServer>
+#include <QHostAddress>
+#include <QDebug>
+
+InstanceRegistry::InstanceRegistry(const QString& root, QObject *parent)
+    : QObject(parent)
+    , m_root(root)
+    , m_batchTarget(RedisInstance::Running)
+    , m_batchSucceeded(0)
+    , m_batchFailed(0)
+    , m_firstPort(10900)
+    , m_lastPort(10999)
+    , m_batchActive(false)
+{
+    reload();
+}
+
+InstanceRegistry::~InstanceRegistry()
+{
+    shutdownAll(30000);
+}
+
+void InstanceRegistry::setPortRange(int firstPort, int lastPort)
+{
+    m_firstPort = qBound(1, firstPort, 65535);
+    m_lastPort = qBound(m_firstPort, lastPort, 65535);
+}
+
+void InstanceRegistry::reload()
+{
+    const QStringList entries = QDir(m_root).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        if (!m_instances.contains(entry) && QFile::exists(m_root + "/" + entry + "/redis.conf")) {
+            addInstance(entry);
+        }
+    }
+}
+
+RedisInstance* InstanceRegistry::addInstance(const QString& name)
+{
+    RedisInstance* instance = new RedisInstance(name, m_root + "/" + name, this);
+    connect(instance, &RedisInstance::stateChanged, this, [this, instance](RedisInstance::State state) {
+        onInstanceStateChanged(instance, state);
+    });
+    m_instances.insert(name, instance);
+    return instance;
+}
+
+QList<RedisInstance*> InstanceRegistry::instances() const
+{
+    return m_instances.values();
+}
+
+RedisInstance* InstanceRegistry::instance(const QString& name) const
+{
+    return m_instances.value(name);
+}
+
+bool InstanceRegistry::isPortFree(int port)
+{
+    // 能绑定上说明没有其他进程监听
+    QTcpServer server;
+    return server.listen(QHostAddress::Any, quint16(port));
+}
+
+int InstanceRegistry::allocatePort(const QSet<int>& taken) const
+{
+    for (int port = m_firstPort; port <= m_lastPort; ++port) {
+        if (!taken.contains(port) && isPortFree(port)) {
+            return port;
+        }
+    }
+    return 0;
+}
+
+bool InstanceRegistry::writeInstanceConfig(const QString& configPath, const QString& bind, int port,
+                                           const QString& password, const ResourceSizer::Proposal& proposal)
+{
+    RedisConfig config;
+    config.parse("# Redis Configuration File\n"
+                 "# Generated by RedisInstall (instance)\n"
+                 "\n");
+    config.setValue("bind", bind);
+    config.setValue("port", QString::number(port));
+    config.setValue("protected-mode", "yes");
+    config.setValue("daemonize", "no");
+    // 相对路径以实例目录（进程的工作目录）为准
+    config.setValue("pidfile", "redis.pid");
+    config.setValue("loglevel", "notice");
+    config.setValue("logfile", "redis.log");
+    config.setValue("databases", "16");
+    config.setValue("stop-writes-on-bgsave-error", "yes");
+    config.setValue("rdbcompression", "yes");
+    config.setValue("rdbchecksum", "yes");
+    config.setValue("dbfilename", "dump.rdb");
+    config.setValue("dir", "./");
+    if (!password.isEmpty()) {
+        config.setValue("requirepass", password);
+    }
+
+    config.appendLine(QString());
+    config.appendLine("# " + proposal.notes.join("；"));
+    for (auto it = proposal.values.constBegin(); it != proposal.values.constEnd(); ++it) {
+        config.setValue(it.key(), it.value());
+    }
+    return config.save(configPath);
+}
+
+QList<RedisInstance*> InstanceRegistry::createInstances(int count, const QString& bind, const QString& password,
+                                                        ResourceSizer::Workload workload, const QString& version)
+{
+    QList<RedisInstance*> created;
+    if (count <= 0) {
+        return created;
+    }
+
+    // 已有实例配置中的端口，即使实例没有运行也不能再分配
+    QSet<int> taken;
+    const QList<RedisInstance*> existing = m_instances.values();
+    for (RedisInstance* instance : existing) {
+        taken.insert(instance->port());
+    }
+
+    // 每个实例只跑一个主线程，按实例总数平分内存和磁盘，不再推荐 io-threads
+    HostResources host = HostResources::detect(m_root);
+    int total = m_instances.size() + count;
+    host.totalMemory /= total;
+    if (host.cgroupMemoryLimit > 0) {
+        host.cgroupMemoryLimit /= total;
+    }
+    if (host.diskFree > 0) {
+        host.diskFree /= total;
+    }
+    host.cpuCount = 1;
+    ResourceSizer::Proposal proposal = ResourceSizer::propose(host, workload, version);
+    proposal.notes.prepend(QString("%1，共 %2 个实例").arg(ResourceSizer::workloadDescription(workload)).arg(total));
+
+    QDir().mkpath(m_root);
+    for (int i = 0; i < count; ++i) {
+        int port = allocatePort(taken);
+        if (port == 0) {
+            m_lastError = QString("端口范围 %1-%2 内没有空闲端口").arg(m_firstPort).arg(m_lastPort);
+            break;
+        }
+        taken.insert(port);
+
+        QString name = QString("redis-%1").arg(port);
+        QString dir = m_root + "/" + name;
+        if (!QDir().mkpath(dir) || !writeInstanceConfig(dir + "/redis.conf", bind, port, password, proposal)) {
+            m_lastError = "无法创建实例目录 " + dir;
+            break;
+        }
+
+        qDebug() << "[InstanceRegistry] Created instance" << name << "maxmemory" << proposal.values.value("maxmemory");
+        created << addInstance(name);
+        emit instanceAdded(name);
+    }
+    return created;
+}
+
+bool InstanceRegistry::removeInstance(const QString& name)
+{
+    RedisInstance* instance = m_instances.value(name);
+    if (!instance) {
+        return true;
+    }
+    if (instance->state() != RedisInstance::Stopped && instance->state() != RedisInstance::Failed) {
+        m_lastError = "请先停止实例 " + name;
+        return false;
+    }
+    m_instances.remove(name);
+    m_batchPending.remove(name);
+    instance->disconnect(this);
+    if (instance->processId() > 0) {
+        // 就绪探测失败但进程还活着
+        instance->beginShutdown();
+        instance->waitForStopped(5000);
+    }
+    instance->deleteLater();
+
+    QDir(m_root + "/" + name).removeRecursively();
+    emit instanceRemoved(name);
+    return true;
+}
+
+void InstanceRegistry::startInstances(const QStringList& names)
+{
+    beginBatch(RedisInstance::Running);
+
+    // 先全部登记再启动，避免第一个实例的状态变化提前结束本轮
+    for (const QString& name : names) {
+        RedisInstance* instance = m_instances.value(name);
+        if (instance && (instance->state() == RedisInstance::Stopped
+                         || (instance->state() == RedisInstance::Failed && instance->processId() <= 0))) {
+            m_batchPending.insert(name);
+        }
+    }
+    // 按名称排序后的位置决定分散放置时所在的节点，与同时运行哪些实例无关
+    CpuTopology topology = CpuTopology::detect();
+    const ServiceConfig& config = ServiceConfig::instance();
+    PlacementPolicy::Mode mode = PlacementPolicy::modeFromName(config.getPlacementMode());
+    const QStringList allNames = m_instances.keys();
+
+    const QSet<QString> pending = m_batchPending;
+    for (const QString& name : pending) {
+        RedisInstance* instance = m_instances.value(name);
+        instance->setPlacement(PlacementPolicy::compute(topology, mode, config.getPlacementCpus(),
+                                                        config.getPlacementNode(),
+                                                        allNames.indexOf(name) + 1, allNames.size() + 1));
+        // 找不到可执行文件等同步失败时状态可能没有变化，直接记为失败
+        if (!instance->start(m_serverExecutable, m_serverVersion) && m_batchPending.remove(name)) {
+            ++m_batchFailed;
+        }
+    }
+    finishBatchIfDone();
+}
+
+void InstanceRegistry::stopInstances(const QStringList& names, bool save)
+{
+    beginBatch(RedisInstance::Stopped);
+
+    for (const QString& name : names) {
+        RedisInstance* instance = m_instances.value(name);
+        if (instance && instance->state() != RedisInstance::Stopped && instance->state() != RedisInstance::Stopping) {
+            m_batchPending.insert(name);
+        }
+    }
+    const QSet<QString> pending = m_batchPending;
+    for (const QString& name : pending) {
+        m_instances.value(name)->stop(save);
+    }
+    finishBatchIfDone();
+}
+
+void InstanceRegistry::beginBatch(RedisInstance::State target)
+{
+    m_batchPending.clear();
+    m_batchTarget = target;
+    m_batchSucceeded = 0;
+    m_batchFailed = 0;
+    m_batchActive = true;
+}
+
+void InstanceRegistry::finishBatchIfDone()
+{
+    if (!m_batchActive || !m_batchPending.isEmpty()) {
+        return;
+    }
+    m_batchActive = false;
+    qDebug() << "[InstanceRegistry] Batch finished:" << m_batchSucceeded << "ok," << m_batchFailed << "failed";
+    emit batchFinished(m_batchSucceeded, m_batchFailed);
+}
+
+void InstanceRegistry::startAll()
+{
+    startInstances(m_instances.keys());
+}
+
+void InstanceRegistry::stopAll(bool save)
+{
+    stopInstances(m_instances.keys(), save);
+}
+
+void InstanceRegistry::shutdownAll(int timeoutMs)
+{
+    m_batchPending.clear();
+    m_batchActive = false;
+    const QList<RedisInstance*> all = m_instances.values();
+    for (RedisInstance* instance : all) {
+        instance->beginShutdown();
+    }
+    for (RedisInstance* instance : all) {
+        instance->waitForStopped(timeoutMs);
+    }
+}
+
+int InstanceRegistry::runningCount() const
+{
+    int running = 0;
+    for (RedisInstance* instance : m_instances) {
+        if (instance->state() == RedisInstance::Running) {
+            ++running;
+        }
+    }
+    return running;
+}
+
+void InstanceRegistry::onInstanceStateChanged(RedisInstance* instance, RedisInstance::State state)
+{
+    emit instanceStateChanged(instance->name(), state);
+
+    if (!m_batchPending.contains(instance->name())
+        || state == RedisInstance::Starting || state == RedisInstance::Stopping) {
+        return;
+    }
+
+    // 启动批次以 Running 为成功，停止批次以 Stopped 为成功；停止时 Redis 拒绝关闭会回到 Running
+    m_batchPending.remove(instance->name());
+    if (state == m_batchTarget) {
+        ++m_batchSucceeded;
+    } else {
+        ++m_batchFailed;
+        qDebug() << "[InstanceRegistry]" << instance->name() << "failed:" << instance->lastError();
+    }
+    finishBatchIfDone();
+}
@@ -0,0 +1,98 @@
+#ifndef INSTANCEREGISTRY_H
+#define INSTANCEREGISTRY_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include "redisinstance.h"
+#include "resourcesizer.h"
+
+// 同一台机器上的多个 Redis 实例。Redis 的命令执行基本是单线程的，
+// 按 CPU 数开多个实例才能用满多核。每个实例占用 <root>/<名称>/ 一个目录，
+// 目录中的 redis.conf 就是它的全部注册信息：启动时扫描 <root> 重建列表，
+// 不另外保存状态。端口从 [firstPort, lastPort] 中分配。
+class InstanceRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InstanceRegistry(const QString& root, QObject *parent = nullptr);
+    ~InstanceRegistry();
+
+    QString root() const { return m_root; }
+
+    // 当前版本的 redis-server，切换版本后由 RedisManager 更新
+    void setServerExecutable(const QString& path, const QString& version)
+    {
+        m_serverExecutable = path;
+        m_serverVersion = version;
+    }
+    QString serverExecutable() const { return m_serverExecutable; }
+
+    void setPortRange(int firstPort, int lastPort);
+    int firstPort() const { return m_firstPort; }
+    int lastPort() const { return m_lastPort; }
+
+    // 按名称排序
+    QList<RedisInstance*> instances() const;
+    RedisInstance* instance(const QString& name) const;
+    int count() const { return m_instances.size(); }
+
+    // 新建 count 个实例，各自分配一个空闲端口；内存按新建后的实例总数平分本机预算，
+    // 已有实例的配置不变。返回新建的实例，端口不够时只建能建的部分
+    QList<RedisInstance*> createInstances(int count, const QString& bind, const QString& password,
+                                          ResourceSizer::Workload workload, const QString& version);
+    // 删除实例及其目录（包括数据），运行中的实例不能删除
+    bool removeInstance(const QString& name);
+
+    // 批量启动 / 停止：各实例的进程同时拉起或同时 SHUTDOWN，全部进入稳定状态后发出 batchFinished。
+    // 启动前按 ServiceConfig 中的放置策略计算每个实例的 CPU / NUMA 放置，主实例占第 0 个位置
+    void startInstances(const QStringList& names);
+    void stopInstances(const QStringList& names, bool save = true);
+    void startAll();
+    void stopAll(bool save = true);
+    // 没有事件循环时（析构、卸载）阻塞地停止全部实例，先同时发出 SHUTDOWN 再逐个等待
+    void shutdownAll(int timeoutMs);
+
+    int runningCount() const;
+    QString getLastError() const { return m_lastError; }
+
+signals:
+    void instanceAdded(const QString& name);
+    void instanceRemoved(const QString& name);
+    void instanceStateChanged(const QString& name, RedisInstance::State state);
+    // 本轮批量操作的结果：成功进入目标状态的实例数和失败的实例数
+    void batchFinished(int succeeded, int failed);
+
+private:
+    void reload();
+    RedisInstance* addInstance(const QString& name);
+    void onInstanceStateChanged(RedisInstance* instance, RedisInstance::State state);
+    void beginBatch(RedisInstance::State target);
+    void finishBatchIfDone();
+    int allocatePort(const QSet<int>& taken) const;
+    static bool isPortFree(int port);
+    static bool writeInstanceConfig(const QString& configPath, const QString& bind, int port,
+                                    const QString& password, const ResourceSizer::Proposal& proposal);
+
+private:
+    QString m_root;
+    QString m_serverExecutable;
+    QString m_serverVersion;
+    QString m_lastError;
+    QMap<QString, RedisInstance*> m_instances;
+
+    // 当前批量操作中还没有进入稳定状态的实例
+    QSet<QString> m_batchPending;
+    RedisInstance::State m_batchTarget;
+    int m_batchSucceeded;
+    int m_batchFailed;
+    int m_firstPort;
+    int m_lastPort;
+    bool m_batchActive;
+};
+
+#endif // INSTANCEREGISTRY_H
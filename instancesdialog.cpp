@@ -0,0 +1,312 @@
+#include "instancesdialog.h"
+#include "instanceregistry.h"
+#include "metricsdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QSpinBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+#include <QThread>
+
+enum Column {
+    NameColumn,
+    PortColumn,
+    StateColumn,
+    PidColumn,
+    ReadyColumn,
+    CpuColumn,
+    DirColumn,
+    ColumnCount
+};
+
+InstancesDialog::InstancesDialog(InstanceRegistry* registry, const QString& bind, const QString& password,
+                                 const QString& workload, const QString& version, QWidget *parent)
+    : QDialog(parent)
+    , m_registry(registry)
+    , m_bind(bind)
+    , m_password(password)
+    , m_workload(workload)
+    , m_version(version)
+{
+    setWindowTitle("多实例");
+    setMinimumSize(720, 420);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QLabel* hintLabel = new QLabel(QString("每个实例有独立的目录、配置、端口（%1-%2）、日志和 PID 文件，内存按实例数平分。")
+                                       .arg(registry->firstPort()).arg(registry->lastPort()));
+    hintLabel->setWordWrap(true);
+    mainLayout->addWidget(hintLabel);
+
+    QWidget* createWidget = new QWidget();
+    QHBoxLayout* createLayout = new QHBoxLayout(createWidget);
+    createLayout->setContentsMargins(0, 0, 0, 0);
+
+    // Redis 主线程只用一个核，默认每个核一个实例
+    m_countSpin = new QSpinBox();
+    m_countSpin->setRange(1, 64);
+    m_countSpin->setValue(qMax(1, QThread::idealThreadCount() - registry->count()));
+    QPushButton* createButton = new QPushButton("新建实例");
+    createButton->setObjectName("applyButton");
+    connect(createButton, &QPushButton::clicked, this, &InstancesDialog::onCreateClicked);
+
+    createLayout->addWidget(new QLabel("数量:"));
+    createLayout->addWidget(m_countSpin);
+    createLayout->addWidget(createButton);
+    createLayout->addStretch();
+    mainLayout->addWidget(createWidget);
+
+    m_table = new QTableWidget(0, ColumnCount);
+    m_table->setHorizontalHeaderLabels(QStringList() << "实例" << "端口" << "状态" << "PID" << "启动耗时" << "CPU" << "目录");
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    mainLayout->addWidget(m_table);
+
+    const QList<RedisInstance*> instances = registry->instances();
+    for (RedisInstance* instance : instances) {
+        addRow(instance);
+    }
+
+    m_summaryLabel = new QLabel();
+    m_summaryLabel->setObjectName("hintLabel");
+    mainLayout->addWidget(m_summaryLabel);
+
+    m_batchLabel = new QLabel();
+    m_batchLabel->setWordWrap(true);
+    mainLayout->addWidget(m_batchLabel);
+
+    QWidget* actionWidget = new QWidget();
+    QHBoxLayout* actionLayout = new QHBoxLayout(actionWidget);
+    actionLayout->setContentsMargins(0, 0, 0, 0);
+
+    QPushButton* startButton = new QPushButton("▶ 启动选中");
+    QPushButton* stopButton = new QPushButton("■ 停止选中");
+    QPushButton* removeButton = new QPushButton("删除选中");
+    QPushButton* metricsButton = new QPushButton("指标");
+    m_startAllButton = new QPushButton("全部启动");
+    m_stopAllButton = new QPushButton("全部停止");
+    startButton->setObjectName("startButton");
+    stopButton->setObjectName("stopButton");
+    removeButton->setObjectName("uninstallButton");
+
+    connect(startButton, &QPushButton::clicked, this, &InstancesDialog::onStartSelectedClicked);
+    connect(stopButton, &QPushButton::clicked, this, &InstancesDialog::onStopSelectedClicked);
+    connect(removeButton, &QPushButton::clicked, this, &InstancesDialog::onRemoveSelectedClicked);
+    connect(metricsButton, &QPushButton::clicked, this, &InstancesDialog::onMetricsClicked);
+    connect(m_startAllButton, &QPushButton::clicked, this, [this]() {
+        m_batchLabel->setText("正在启动全部实例...");
+        m_registry->startAll();
+    });
+    connect(m_stopAllButton, &QPushButton::clicked, this, [this]() {
+        m_batchLabel->setText("正在停止全部实例...");
+        m_registry->stopAll();
+    });
+
+    actionLayout->addWidget(startButton);
+    actionLayout->addWidget(stopButton);
+    actionLayout->addWidget(removeButton);
+    actionLayout->addWidget(metricsButton);
+    actionLayout->addStretch();
+    actionLayout->addWidget(m_startAllButton);
+    actionLayout->addWidget(m_stopAllButton);
+    mainLayout->addWidget(actionWidget);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttons);
+
+    connect(registry, &InstanceRegistry::instanceAdded, this, &InstancesDialog::onInstanceAdded);
+    connect(registry, &InstanceRegistry::instanceRemoved, this, &InstancesDialog::onInstanceRemoved);
+    connect(registry, &InstanceRegistry::instanceStateChanged, this, &InstancesDialog::onInstanceStateChanged);
+    connect(registry, &InstanceRegistry::batchFinished, this, &InstancesDialog::onBatchFinished);
+
+    updateSummary();
+}
+
+void InstancesDialog::addRow(RedisInstance* instance)
+{
+    int row = m_table->rowCount();
+    m_table->insertRow(row);
+    for (int column = 0; column < ColumnCount; ++column) {
+        m_table->setItem(row, column, new QTableWidgetItem());
+    }
+    updateRow(row, instance);
+
+    // 加载数据期间显示进度
+    connect(instance, &RedisInstance::loadingProgress, this, [this, instance]() {
+        int current = rowOf(instance->name());
+        if (current >= 0) {
+            updateRow(current, instance);
+        }
+    });
+}
+
+void InstancesDialog::updateRow(int row, RedisInstance* instance)
+{
+    QString state = RedisInstance::stateName(instance->state());
+    if (instance->state() == RedisInstance::Starting && instance->loadingPercent() > 0) {
+        state += QString(" %1%").arg(instance->loadingPercent(), 0, 'f', 0);
+    }
+
+    m_table->item(row, NameColumn)->setText(instance->name());
+    m_table->item(row, PortColumn)->setText(QString::number(instance->port()));
+    m_table->item(row, StateColumn)->setText(state);
+    m_table->item(row, StateColumn)->setToolTip(instance->lastError());
+    m_table->item(row, PidColumn)->setText(instance->processId() > 0 ? QString::number(instance->processId()) : QString());
+    m_table->item(row, ReadyColumn)->setText(instance->timeToReadyMs() >= 0
+                                                 ? QString("%1 ms").arg(instance->timeToReadyMs())
+                                                 : QString());
+    // 主线程（TID 与 PID 相同）实际的亲和性，放置策略见 instance->placement()
+    QString cpus;
+    if (instance->processId() > 0) {
+        const QList<ThreadPlacement> threads = ThreadPlacement::read(instance->processId());
+        if (!threads.isEmpty()) {
+            cpus = threads.first().allowedCpus;
+        }
+    }
+    m_table->item(row, CpuColumn)->setText(cpus);
+    m_table->item(row, CpuColumn)->setToolTip(instance->placement().description);
+    m_table->item(row, DirColumn)->setText(instance->dir());
+}
+
+int InstancesDialog::rowOf(const QString& name) const
+{
+    for (int row = 0; row < m_table->rowCount(); ++row) {
+        if (m_table->item(row, NameColumn)->text() == name) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+QStringList InstancesDialog::selectedNames() const
+{
+    QStringList names;
+    const QModelIndexList rows = m_table->selectionModel()->selectedRows();
+    for (const QModelIndex& index : rows) {
+        names << m_table->item(index.row(), NameColumn)->text();
+    }
+    return names;
+}
+
+void InstancesDialog::updateSummary()
+{
+    m_summaryLabel->setText(QString("共 %1 个实例，%2 个运行中").arg(m_registry->count()).arg(m_registry->runningCount()));
+    m_startAllButton->setEnabled(m_registry->count() > 0);
+    m_stopAllButton->setEnabled(m_registry->runningCount() > 0);
+}
+
+void InstancesDialog::onCreateClicked()
+{
+    int count = m_countSpin->value();
+    QList<RedisInstance*> created = m_registry->createInstances(count, m_bind, m_password,
+                                                                ResourceSizer::workloadFromName(m_workload),
+                                                                m_version);
+    if (created.size() < count) {
+        QMessageBox::warning(this, "新建实例", QString("只创建了 %1 个实例：%2")
+                                                   .arg(created.size()).arg(m_registry->getLastError()));
+    }
+}
+
+void InstancesDialog::onStartSelectedClicked()
+{
+    QStringList names = selectedNames();
+    if (names.isEmpty()) {
+        return;
+    }
+    m_batchLabel->setText(QString("正在启动 %1 个实例...").arg(names.size()));
+    m_registry->startInstances(names);
+}
+
+void InstancesDialog::onStopSelectedClicked()
+{
+    QStringList names = selectedNames();
+    if (names.isEmpty()) {
+        return;
+    }
+    m_batchLabel->setText(QString("正在停止 %1 个实例...").arg(names.size()));
+    m_registry->stopInstances(names);
+}
+
+void InstancesDialog::onRemoveSelectedClicked()
+{
+    QStringList names = selectedNames();
+    if (names.isEmpty()) {
+        return;
+    }
+
+    QMessageBox::StandardButton reply = QMessageBox::question(
+        this, "删除实例",
+        QString("确定要删除 %1 吗？\n\n实例目录中的配置和数据都会被删除。").arg(names.join("、")),
+        QMessageBox::Yes | QMessageBox::No);
+    if (reply != QMessageBox::Yes) {
+        return;
+    }
+
+    QStringList errors;
+    for (const QString& name : names) {
+        if (!m_registry->removeInstance(name)) {
+            errors << m_registry->getLastError();
+        }
+    }
+    if (!errors.isEmpty()) {
+        QMessageBox::warning(this, "删除实例", errors.join("\n"));
+    }
+}
+
+void InstancesDialog::onMetricsClicked()
+{
+    // 查看选中的第一个实例的实时和历史指标
+    QStringList names = selectedNames();
+    RedisInstance* instance = names.isEmpty() ? nullptr : m_registry->instance(names.first());
+    if (!instance) {
+        return;
+    }
+    MetricsDialog dialog(instance->metricsSampler(), instance->metricsStore(), this);
+    dialog.setWindowTitle("指标 - " + instance->name());
+    dialog.exec();
+}
+
+void InstancesDialog::onInstanceAdded(const QString& name)
+{
+    if (RedisInstance* instance = m_registry->instance(name)) {
+        addRow(instance);
+    }
+    updateSummary();
+}
+
+void InstancesDialog::onInstanceRemoved(const QString& name)
+{
+    int row = rowOf(name);
+    if (row >= 0) {
+        m_table->removeRow(row);
+    }
+    updateSummary();
+}
+
+void InstancesDialog::onInstanceStateChanged(const QString& name, RedisInstance::State state)
+{
+    Q_UNUSED(state);
+    int row = rowOf(name);
+    RedisInstance* instance = m_registry->instance(name);
+    if (row >= 0 && instance) {
+        updateRow(row, instance);
+    }
+    updateSummary();
+}
+
+void InstancesDialog::onBatchFinished(int succeeded, int failed)
+{
+    if (failed == 0) {
+        m_batchLabel->setText(QString("✅ %1 个实例已完成").arg(succeeded));
+    } else {
+        m_batchLabel->setText(QString("⚠️ %1 个实例完成，%2 个失败（将鼠标移到状态上查看原因）")
+                                  .arg(succeeded).arg(failed));
+    }
+}
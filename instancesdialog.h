@@ -0,0 +1,59 @@
+#ifndef INSTANCESDIALOG_H
+#define INSTANCESDIALOG_H
+
+#include <QDialog>
+#include <QString>
+#include <QStringList>
+#include "redisinstance.h"
+
+class InstanceRegistry;
+class QTableWidget;
+class QSpinBox;
+class QLabel;
+class QPushButton;
+
+// 多实例列表：每行一个实例，显示端口、状态、PID 和启动耗时，状态变化时实时刷新。
+// 批量启动 / 停止时所有选中的实例同时进行
+class InstancesDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // bind / password / workload / version 用于新建实例的配置文件
+    InstancesDialog(InstanceRegistry* registry, const QString& bind, const QString& password,
+                    const QString& workload, const QString& version, QWidget *parent = nullptr);
+
+private slots:
+    void onCreateClicked();
+    void onStartSelectedClicked();
+    void onStopSelectedClicked();
+    void onRemoveSelectedClicked();
+    void onMetricsClicked();
+    void onInstanceAdded(const QString& name);
+    void onInstanceRemoved(const QString& name);
+    void onInstanceStateChanged(const QString& name, RedisInstance::State state);
+    void onBatchFinished(int succeeded, int failed);
+
+private:
+    void addRow(RedisInstance* instance);
+    void updateRow(int row, RedisInstance* instance);
+    int rowOf(const QString& name) const;
+    QStringList selectedNames() const;
+    void updateSummary();
+
+private:
+    InstanceRegistry* m_registry;
+    QString m_bind;
+    QString m_password;
+    QString m_workload;
+    QString m_version;
+
+    QTableWidget* m_table;
+    QSpinBox* m_countSpin;
+    QLabel* m_summaryLabel;
+    QLabel* m_batchLabel;
+    QPushButton* m_startAllButton;
+    QPushButton* m_stopAllButton;
+};
+
+#endif // INSTANCESDIALOG_H
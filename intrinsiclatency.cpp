@@ -0,0 +1,432 @@
+#include "intrinsiclatency.h"
+#include <QThread>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QRegularExpression>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+
+// 间隔的范围：1 ns ~ 10 s，3 位有效数字
+static const qint64 kHighestGapNs = 10LL * 1000 * 1000 * 1000;
+static const qint64 kNsPerSecond = 1000LL * 1000 * 1000;
+// 报告中列出的最差秒数
+static const int kWorstSeconds = 10;
+// 相关系数达到多少算明显相关
+static const double kStrongCorrelation = 0.5;
+
+namespace {
+
+QString readFirstLine(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readLine()).trimmed();
+}
+
+QString cpuModel()
+{
+    QFile file("/proc/cpuinfo");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QSysInfo::currentCpuArchitecture();
+    }
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine());
+        if (line.startsWith("model name")) {
+            return line.section(':', 1).trimmed();
+        }
+    }
+    return QSysInfo::currentCpuArchitecture();
+}
+
+QString formatNs(double ns)
+{
+    if (ns < 1000) {
+        return QString("%1 ns").arg(ns, 0, 'f', 0);
+    }
+    if (ns < 1000.0 * 1000) {
+        return QString("%1 µs").arg(ns / 1000.0, 0, 'f', 1);
+    }
+    if (ns < 1000.0 * 1000 * 1000) {
+        return QString("%1 ms").arg(ns / (1000.0 * 1000), 0, 'f', 2);
+    }
+    return QString("%1 s").arg(ns / (1000.0 * 1000 * 1000), 0, 'f', 2);
+}
+
+// 皮尔逊相关系数，样本不足或某一列没有变化时返回 NaN
+double correlation(const QList<double>& x, const QList<double>& y)
+{
+    const int n = int(x.size());
+    if (n < 3) {
+        return std::nan("");
+    }
+    double meanX = 0;
+    double meanY = 0;
+    for (int i = 0; i < n; ++i) {
+        meanX += x.at(i);
+        meanY += y.at(i);
+    }
+    meanX /= n;
+    meanY /= n;
+    double covariance = 0;
+    double varianceX = 0;
+    double varianceY = 0;
+    for (int i = 0; i < n; ++i) {
+        double dx = x.at(i) - meanX;
+        double dy = y.at(i) - meanY;
+        covariance += dx * dy;
+        varianceX += dx * dx;
+        varianceY += dy * dy;
+    }
+    if (varianceX <= 0 || varianceY <= 0) {
+        return std::nan("");
+    }
+    return covariance / std::sqrt(varianceX * varianceY);
+}
+
+} // namespace
+
+IntrinsicLatencyTest::IntrinsicLatencyTest(QObject *parent)
+    : QObject(parent)
+    , m_thread(nullptr)
+    , m_cancel(false)
+    , m_cpu(-1)
+    , m_durationSeconds(0)
+    , m_pinned(false)
+    , m_startTime(0)
+    , m_histogram(1, kHighestGapNs, 3)
+    , m_maxGapNs(0)
+    , m_pressureAvailable(false)
+{
+    for (qint64& total : m_lastPressure) {
+        total = -1;
+    }
+}
+
+IntrinsicLatencyTest::~IntrinsicLatencyTest()
+{
+    // 还没送达的结果随对象一起丢弃
+    if (m_thread) {
+        m_cancel = true;
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+}
+
+QString IntrinsicLatencyTest::resourceName(Resource resource)
+{
+    switch (resource) {
+    case CpuPressure:
+        return "CPU";
+    case MemoryPressure:
+        return "内存";
+    case IoPressure:
+        return "IO";
+    default:
+        return QString();
+    }
+}
+
+bool IntrinsicLatencyTest::start(int cpu, int seconds, const QStringList& occupants)
+{
+    if (m_thread) {
+        return false;
+    }
+
+    m_cpu = cpu;
+    m_durationSeconds = qMax(1, seconds);
+    m_occupants = occupants;
+    m_startTime = QDateTime::currentMSecsSinceEpoch();
+    m_histogram.reset();
+    m_seconds.clear();
+    m_maxGapNs = 0;
+    m_pinned = false;
+    m_reportPath.clear();
+    m_pressureAvailable = readPressure(m_lastPressure);
+
+    m_cancel = false;
+    const qint64 durationNs = qint64(m_durationSeconds) * kNsPerSecond;
+    m_thread = QThread::create([this, cpu, durationNs]() { run(cpu, durationNs); });
+    m_thread->start();
+    qDebug() << "[IntrinsicLatency] Running on cpu" << cpu << "for" << m_durationSeconds << "s";
+    return true;
+}
+
+void IntrinsicLatencyTest::cancel()
+{
+    // 空转线程在下一次循环时退出，已经测到的部分照常生成报告
+    m_cancel = true;
+}
+
+void IntrinsicLatencyTest::run(int cpu, qint64 durationNs)
+{
+    bool pinned = false;
+#ifdef Q_OS_LINUX
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpu, &cpuSet);
+        // pid 为 0 时只作用于调用线程
+        pinned = sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0;
+    }
+#else
+    Q_UNUSED(cpu);
+#endif
+
+    // 空转循环里只有读时钟、记直方图和比较，每次几十纳秒；每秒把这一秒的最大间隔交给主线程
+    HdrHistogram histogram(1, kHighestGapNs, 3);
+    QElapsedTimer clock;
+    clock.start();
+    qint64 last = clock.nsecsElapsed();
+    qint64 windowEnd = kNsPerSecond;
+    qint64 windowMax = 0;
+    qint64 windowIterations = 0;
+    while (!m_cancel.load(std::memory_order_relaxed)) {
+        const qint64 now = clock.nsecsElapsed();
+        const qint64 gap = now - last;
+        last = now;
+        histogram.record(gap);
+        windowMax = qMax(windowMax, gap);
+        ++windowIterations;
+
+        if (now >= windowEnd) {
+            QMetaObject::invokeMethod(this, [this, windowMax, windowIterations]() {
+                onSecond(windowMax, windowIterations);
+            }, Qt::QueuedConnection);
+            windowMax = 0;
+            windowIterations = 0;
+            // 整个线程停了超过一秒时直接对齐到下一个整秒
+            windowEnd = (now / kNsPerSecond + 1) * kNsPerSecond;
+            if (now >= durationNs) {
+                break;
+            }
+        }
+    }
+
+    QMetaObject::invokeMethod(this, [this, histogram, pinned]() {
+        onFinished(histogram, pinned);
+    }, Qt::QueuedConnection);
+}
+
+bool IntrinsicLatencyTest::readPressure(qint64* totals) const
+{
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=123456
+    static const char* const files[ResourceCount] = {
+        "/proc/pressure/cpu", "/proc/pressure/memory", "/proc/pressure/io"
+    };
+    bool available = false;
+    for (int i = 0; i < ResourceCount; ++i) {
+        totals[i] = -1;
+        QFile file(files[i]);
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            continue;
+        }
+        const QByteArray line = file.readLine();
+        int pos = line.indexOf("total=");
+        if (!line.startsWith("some ") || pos < 0) {
+            continue;
+        }
+        totals[i] = line.mid(pos + 6).trimmed().toLongLong();
+        available = true;
+    }
+    return available;
+}
+
+void IntrinsicLatencyTest::onSecond(qint64 maxGapNs, qint64 iterations)
+{
+    Second second;
+    second.timestamp = QDateTime::currentMSecsSinceEpoch();
+    second.maxGapNs = maxGapNs;
+    second.iterations = iterations;
+
+    // 压力的累计停顿时间取差值，得到这一秒内的停顿
+    qint64 totals[ResourceCount];
+    if (m_pressureAvailable && readPressure(totals)) {
+        for (int i = 0; i < ResourceCount; ++i) {
+            if (totals[i] >= 0 && m_lastPressure[i] >= 0) {
+                second.stallMicros[i] = totals[i] - m_lastPressure[i];
+            }
+            m_lastPressure[i] = totals[i];
+        }
+    }
+
+    m_seconds.append(second);
+    m_maxGapNs = qMax(m_maxGapNs, maxGapNs);
+    emit progress(int(m_seconds.size()), m_maxGapNs);
+}
+
+void IntrinsicLatencyTest::onFinished(const HdrHistogram& histogram, bool pinned)
+{
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+    m_histogram = histogram;
+    m_pinned = pinned;
+    m_maxGapNs = qMax(m_maxGapNs, histogram.maximum());
+    m_reportPath = saveReport();
+    qDebug() << "[IntrinsicLatency] Finished, max gap" << m_maxGapNs << "ns";
+    emit finished();
+}
+
+QString IntrinsicLatencyTest::report() const
+{
+    QStringList lines;
+    const QString cpuDir = QString("/sys/devices/system/cpu/cpu%1/cpufreq/").arg(m_cpu);
+    const QString governor = m_cpu >= 0 ? readFirstLine(cpuDir + "scaling_governor") : QString();
+    const QString frequency = m_cpu >= 0 ? readFirstLine(cpuDir + "scaling_cur_freq") : QString();
+    const QString thpEnabled = readFirstLine("/sys/kernel/mm/transparent_hugepage/enabled");
+    const QString thpDefrag = readFirstLine("/sys/kernel/mm/transparent_hugepage/defrag");
+
+    lines << "主机内在延迟报告"
+          << "================"
+          << QString("主机:         %1").arg(QSysInfo::machineHostName())
+          << QString("系统:         %1（内核 %2）").arg(QSysInfo::prettyProductName(), QSysInfo::kernelVersion())
+          << QString("CPU 型号:     %1，%2 个逻辑 CPU").arg(cpuModel()).arg(QThread::idealThreadCount())
+          << QString("开始时间:     %1").arg(QDateTime::fromMSecsSinceEpoch(m_startTime).toString("yyyy-MM-dd hh:mm:ss"))
+          << QString("测试时长:     %1 秒（计划 %2 秒）").arg(m_seconds.size()).arg(m_durationSeconds);
+
+    QString cpuLine = m_cpu < 0 ? QString("未指定") : QString("CPU %1").arg(m_cpu);
+    if (m_cpu >= 0) {
+        cpuLine += m_pinned ? "，已绑定" : "，绑定失败（线程可能在核之间迁移）";
+    }
+    if (!governor.isEmpty()) {
+        cpuLine += QString("；调频策略 %1").arg(governor);
+    }
+    if (!frequency.isEmpty()) {
+        cpuLine += QString("，当前频率 %1 MHz").arg(frequency.toLongLong() / 1000);
+    }
+    lines << QString("测试核:       %1").arg(cpuLine)
+          << QString("同核的 Redis: %1").arg(m_occupants.isEmpty() ? QString("无") : m_occupants.join(", "));
+    if (!thpEnabled.isEmpty()) {
+        lines << QString("透明大页:     enabled %1；defrag %2").arg(thpEnabled, thpDefrag);
+    }
+
+    qint64 iterations = m_histogram.totalCount();
+    double averageNs = iterations > 0 ? double(m_seconds.size()) * kNsPerSecond / double(iterations) : 0;
+    lines << QString()
+          << "时钟读取间隔"
+          << QString("  循环 %1 次，平均每次 %2").arg(iterations).arg(formatNs(averageNs))
+          << QString("  p50 %1，p99 %2，p99.9 %3，p99.99 %4，最大 %5")
+                 .arg(formatNs(m_histogram.valueAtPercentile(50)))
+                 .arg(formatNs(m_histogram.valueAtPercentile(99)))
+                 .arg(formatNs(m_histogram.valueAtPercentile(99.9)))
+                 .arg(formatNs(m_histogram.valueAtPercentile(99.99)))
+                 .arg(formatNs(m_maxGapNs))
+          << QString("  超过 100 µs %1 次，超过 1 ms %2 次，超过 10 ms %3 次")
+                 .arg(m_histogram.countAbove(100LL * 1000))
+                 .arg(m_histogram.countAbove(1000LL * 1000))
+                 .arg(m_histogram.countAbove(10LL * 1000 * 1000));
+
+    // 每秒最大间隔和各类压力的相关性
+    lines << QString() << "每秒最大间隔与系统压力（/proc/pressure 的 some 停顿，µs/s）";
+    QString strongest;
+    double strongestCorrelation = 0;
+    if (!m_pressureAvailable) {
+        lines << "  不可用：内核没有开启 PSI（需要 4.20 以上，部分发行版还要在启动参数中加 psi=1）";
+    } else {
+        for (int i = 0; i < ResourceCount; ++i) {
+            QList<double> gaps;
+            QList<double> stalls;
+            qint64 maxStall = 0;
+            for (const Second& second : m_seconds) {
+                if (second.stallMicros[i] >= 0) {
+                    gaps << double(second.maxGapNs);
+                    stalls << double(second.stallMicros[i]);
+                    maxStall = qMax(maxStall, second.stallMicros[i]);
+                }
+            }
+            if (stalls.isEmpty()) {
+                lines << QString("  %1: 不可用").arg(resourceName(Resource(i)));
+                continue;
+            }
+            double sum = 0;
+            for (double stall : stalls) {
+                sum += stall;
+            }
+            double coefficient = correlation(gaps, stalls);
+            lines << QString("  %1: 平均 %2，最大 %3，相关系数 %4")
+                         .arg(resourceName(Resource(i)))
+                         .arg(sum / stalls.size(), 0, 'f', 0)
+                         .arg(maxStall)
+                         .arg(std::isnan(coefficient) ? QString("-") : QString::number(coefficient, 'f', 2));
+            if (!std::isnan(coefficient) && coefficient > strongestCorrelation) {
+                strongestCorrelation = coefficient;
+                strongest = resourceName(Resource(i));
+            }
+        }
+    }
+
+    QList<Second> worst = m_seconds;
+    std::sort(worst.begin(), worst.end(), [](const Second& a, const Second& b) {
+        return a.maxGapNs > b.maxGapNs;
+    });
+    lines << QString() << QString("最差的 %1 秒（最大间隔；CPU / 内存 / IO 停顿 µs）").arg(qMin(kWorstSeconds, int(worst.size())));
+    for (int i = 0; i < worst.size() && i < kWorstSeconds; ++i) {
+        const Second& second = worst.at(i);
+        QStringList stalls;
+        for (qint64 stall : second.stallMicros) {
+            stalls << (stall >= 0 ? QString::number(stall) : QString("-"));
+        }
+        lines << QString("  %1  %2  %3")
+                     .arg(QDateTime::fromMSecsSinceEpoch(second.timestamp).toString("hh:mm:ss"))
+                     .arg(formatNs(second.maxGapNs), 10)
+                     .arg(stalls.join(" / "));
+    }
+
+    QStringList hints;
+    if (m_maxGapNs > 1000LL * 1000) {
+        hints << QString("出现了 %1 的停顿，同一时刻 Redis 的请求也会被拖慢同样久。").arg(formatNs(m_maxGapNs));
+        if (strongestCorrelation >= kStrongCorrelation) {
+            hints << QString("最大间隔与%1压力明显相关（r = %2），停顿多半来自%1争用。")
+                         .arg(strongest).arg(strongestCorrelation, 0, 'f', 2);
+        }
+    }
+    if (!m_occupants.isEmpty()) {
+        hints << "测试核上运行着 Redis，测到的间隔包含与它的争用；要测主机本身请换一个空闲的核。";
+    }
+    if (!governor.isEmpty() && governor != "performance") {
+        hints << QString("调频策略为 %1，空闲后升频会带来抖动，对延迟敏感时可改为 performance。").arg(governor);
+    }
+    if (thpEnabled.contains("[always]")) {
+        hints << "透明大页为 always，内存整理可能造成停顿，Redis 建议设为 madvise 或 never。";
+    }
+    if (hints.isEmpty()) {
+        hints << "没有发现明显的主机停顿。";
+    }
+    lines << QString() << "提示";
+    for (const QString& hint : hints) {
+        lines << "  - " + hint;
+    }
+    return lines.join("\n") + "\n";
+}
+
+QString IntrinsicLatencyTest::saveReport() const
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/reports";
+    QDir().mkpath(dir);
+    QString host = QSysInfo::machineHostName();
+    host.replace(QRegularExpression("[^A-Za-z0-9._-]"), "_");
+    QString path = dir + QString("/intrinsic-latency-%1-%2.txt")
+                             .arg(host, QDateTime::fromMSecsSinceEpoch(m_startTime).toString("yyyyMMdd-hhmmss"));
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)
+        || file.write(report().toUtf8()) < 0) {
+        qDebug() << "[IntrinsicLatency] Cannot write report" << path << file.errorString();
+        return QString();
+    }
+    return path;
+}
@@ -0,0 +1,86 @@
+#ifndef INTRINSICLATENCY_H
+#define INTRINSICLATENCY_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <atomic>
+#include "hdrhistogram.h"
+
+class QThread;
+
+// 主机的内在延迟测试，和 redis-cli --intrinsic-latency 的原理相同：一个线程绑在指定的核上空转，
+// 不停读取单调时钟，两次读数之间的间隔（纳秒）记入 HdrHistogram。正常情况下间隔只有几十纳秒，
+// 大的间隔说明线程被抢占或整机停顿过（其他进程抢核、CPU 降频、透明大页整理、虚拟机被挂起等）。
+// 每秒的最大间隔和同一秒内 /proc/pressure/{cpu,memory,io} 的 some 停顿时间一起记录，
+// 结束后生成报告，给出间隔分布、各类压力与最大间隔的相关系数和最差的几秒，
+// 报告保存在 <应用数据目录>/reports/，文件名带主机名
+class IntrinsicLatencyTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Resource {
+        CpuPressure,
+        MemoryPressure,
+        IoPressure,
+        ResourceCount
+    };
+
+    // 一秒内的最大间隔和各类压力的 some 停顿时间（微秒，-1 表示不可用）
+    struct Second
+    {
+        qint64 timestamp = 0;   // msecs since epoch
+        qint64 maxGapNs = 0;
+        qint64 iterations = 0;
+        qint64 stallMicros[ResourceCount] = {-1, -1, -1};
+    };
+
+    explicit IntrinsicLatencyTest(QObject *parent = nullptr);
+    ~IntrinsicLatencyTest();
+
+    static QString resourceName(Resource resource);
+
+    // cpu < 0 时不绑核；occupants 为同一个核上运行的 Redis 实例，写入报告
+    bool start(int cpu, int seconds, const QStringList& occupants = QStringList());
+    void cancel();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    int cpu() const { return m_cpu; }
+    const HdrHistogram& histogram() const { return m_histogram; }
+    QList<Second> seconds() const { return m_seconds; }
+    qint64 maxGapNs() const { return m_maxGapNs; }
+
+    QString report() const;
+    // 最近一次测试的报告文件
+    QString reportPath() const { return m_reportPath; }
+
+signals:
+    void progress(int elapsedSeconds, qint64 maxGapNs);
+    void finished();
+
+private:
+    void run(int cpu, qint64 durationNs);
+    void onSecond(qint64 maxGapNs, qint64 iterations);
+    void onFinished(const HdrHistogram& histogram, bool pinned);
+    bool readPressure(qint64* totals) const;
+    QString saveReport() const;
+
+private:
+    QThread* m_thread;
+    std::atomic<bool> m_cancel;
+
+    int m_cpu;
+    int m_durationSeconds;
+    bool m_pinned;
+    QStringList m_occupants;
+    qint64 m_startTime;
+    HdrHistogram m_histogram;
+    QList<Second> m_seconds;
+    qint64 m_maxGapNs;
+    qint64 m_lastPressure[ResourceCount];
+    bool m_pressureAvailable;
+    QString m_reportPath;
+};
+
+#endif // INTRINSICLATENCY_H
@@ -0,0 +1,167 @@
+#include "intrinsiclatencydialog.h"
+#include "intrinsiclatency.h"
+#include "redismanager.h"
+#include "instanceregistry.h"
+#include "redisinstance.h"
+#include "cputopology.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QFontDatabase>
+#include <QDialogButtonBox>
+#include <QThread>
+
+IntrinsicLatencyDialog::IntrinsicLatencyDialog(RedisManager* manager, QWidget *parent)
+    : QDialog(parent)
+    , m_manager(manager)
+{
+    setWindowTitle("主机延迟");
+    resize(720, 560);
+
+    m_test = new IntrinsicLatencyTest(this);
+    connect(m_test, &IntrinsicLatencyTest::progress, this, &IntrinsicLatencyDialog::onProgress);
+    connect(m_test, &IntrinsicLatencyTest::finished, this, &IntrinsicLatencyDialog::onFinished);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QLabel* hintLabel = new QLabel("在选定的核上空转并不停读取时钟，记录两次读数之间的间隔。"
+                                   "大的间隔说明主机本身停顿过（抢核、降频、透明大页整理等），"
+                                   "与 Redis 无关；同时记录 /proc/pressure 以便对照。测试期间该核会满载。");
+    hintLabel->setObjectName("hintLabel");
+    hintLabel->setWordWrap(true);
+    mainLayout->addWidget(hintLabel);
+
+    collectOccupants();
+
+    QWidget* settingsWidget = new QWidget();
+    QHBoxLayout* settingsLayout = new QHBoxLayout(settingsWidget);
+    settingsLayout->setContentsMargins(0, 0, 0, 0);
+
+    QList<int> cpus;
+    const QList<CpuInfo> topology = CpuTopology::detect().cpus();
+    for (const CpuInfo& info : topology) {
+        cpus << info.cpu;
+    }
+    if (cpus.isEmpty()) {
+        for (int cpu = 0; cpu < QThread::idealThreadCount(); ++cpu) {
+            cpus << cpu;
+        }
+    }
+
+    m_cpuCombo = new QComboBox();
+    int defaultIndex = -1;
+    for (int cpu : cpus) {
+        const QStringList occupants = m_occupants.value(cpu);
+        QString text = QString("CPU %1").arg(cpu);
+        if (!occupants.isEmpty()) {
+            text += "（" + occupants.join(", ") + "）";
+        } else if (defaultIndex < 0) {
+            defaultIndex = m_cpuCombo->count();
+        }
+        m_cpuCombo->addItem(text, cpu);
+    }
+    m_cpuCombo->setCurrentIndex(qMax(0, defaultIndex));
+
+    m_durationSpin = new QSpinBox();
+    m_durationSpin->setRange(5, 3600);
+    m_durationSpin->setValue(60);
+    m_durationSpin->setSuffix(" 秒");
+
+    m_startButton = new QPushButton("开始");
+    m_startButton->setObjectName("applyButton");
+    connect(m_startButton, &QPushButton::clicked, this, &IntrinsicLatencyDialog::onStartClicked);
+
+    settingsLayout->addWidget(new QLabel("测试核:"));
+    settingsLayout->addWidget(m_cpuCombo);
+    settingsLayout->addWidget(new QLabel("时长:"));
+    settingsLayout->addWidget(m_durationSpin);
+    settingsLayout->addStretch();
+    settingsLayout->addWidget(m_startButton);
+    mainLayout->addWidget(settingsWidget);
+
+    m_progressBar = new QProgressBar();
+    m_progressBar->setValue(0);
+    mainLayout->addWidget(m_progressBar);
+
+    m_statusLabel = new QLabel();
+    m_statusLabel->setObjectName("hintLabel");
+    m_statusLabel->setWordWrap(true);
+    m_statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    mainLayout->addWidget(m_statusLabel);
+
+    m_reportEdit = new QPlainTextEdit();
+    m_reportEdit->setReadOnly(true);
+    m_reportEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    mainLayout->addWidget(m_reportEdit, 1);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttons);
+}
+
+void IntrinsicLatencyDialog::collectOccupants()
+{
+    // 只有绑了核的实例才确定在哪个核上；未绑核的实例可能出现在任何核
+    if (m_manager->isRedisRunning()) {
+        const QList<int> cpus = m_manager->redisPlacement().cpus;
+        for (int cpu : cpus) {
+            m_occupants[cpu] << "main";
+        }
+    }
+    const QList<RedisInstance*> instances = m_manager->instanceRegistry()->instances();
+    for (RedisInstance* instance : instances) {
+        if (instance->state() != RedisInstance::Running) {
+            continue;
+        }
+        const QList<int> cpus = instance->placement().cpus;
+        for (int cpu : cpus) {
+            m_occupants[cpu] << instance->name();
+        }
+    }
+}
+
+void IntrinsicLatencyDialog::onStartClicked()
+{
+    if (m_test->isRunning()) {
+        m_test->cancel();
+        m_startButton->setEnabled(false);
+        return;
+    }
+
+    int cpu = m_cpuCombo->currentData().toInt();
+    if (!m_test->start(cpu, m_durationSpin->value(), m_occupants.value(cpu))) {
+        return;
+    }
+    m_cpuCombo->setEnabled(false);
+    m_durationSpin->setEnabled(false);
+    m_startButton->setText("停止");
+    m_progressBar->setRange(0, m_durationSpin->value());
+    m_progressBar->setValue(0);
+    m_statusLabel->setText("测试中…");
+    m_reportEdit->clear();
+}
+
+void IntrinsicLatencyDialog::onProgress(int elapsedSeconds, qint64 maxGapNs)
+{
+    m_progressBar->setValue(elapsedSeconds);
+    m_statusLabel->setText(QString("已运行 %1 秒，目前最大间隔 %2 µs")
+                               .arg(elapsedSeconds)
+                               .arg(maxGapNs / 1000.0, 0, 'f', 1));
+}
+
+void IntrinsicLatencyDialog::onFinished()
+{
+    m_cpuCombo->setEnabled(true);
+    m_durationSpin->setEnabled(true);
+    m_startButton->setEnabled(true);
+    m_startButton->setText("开始");
+    m_reportEdit->setPlainText(m_test->report());
+    m_statusLabel->setText(m_test->reportPath().isEmpty()
+                               ? QString("报告保存失败")
+                               : "报告已保存到 " + m_test->reportPath());
+}
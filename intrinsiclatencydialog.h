@@ -0,0 +1,48 @@
+#ifndef INTRINSICLATENCYDIALOG_H
+#define INTRINSICLATENCYDIALOG_H
+
+#include <QDialog>
+#include <QMap>
+#include <QStringList>
+
+class RedisManager;
+class IntrinsicLatencyTest;
+class QComboBox;
+class QSpinBox;
+class QPushButton;
+class QProgressBar;
+class QLabel;
+class QPlainTextEdit;
+
+// 主机内在延迟测试界面：选择核和时长，运行时显示进度和目前的最大间隔，结束后显示并保存报告。
+// 核的列表标出绑在上面的 Redis 实例（主实例和多实例），默认选一个没有实例的核
+class IntrinsicLatencyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    IntrinsicLatencyDialog(RedisManager* manager, QWidget *parent = nullptr);
+
+private slots:
+    void onStartClicked();
+    void onProgress(int elapsedSeconds, qint64 maxGapNs);
+    void onFinished();
+
+private:
+    void collectOccupants();
+
+private:
+    RedisManager* m_manager;
+    IntrinsicLatencyTest* m_test;
+    // CPU 编号 → 绑在该核上的运行中的实例
+    QMap<int, QStringList> m_occupants;
+
+    QComboBox* m_cpuCombo;
+    QSpinBox* m_durationSpin;
+    QPushButton* m_startButton;
+    QProgressBar* m_progressBar;
+    QLabel* m_statusLabel;
+    QPlainTextEdit* m_reportEdit;
+};
+
+#endif // INTRINSICLATENCYDIALOG_H
@@ -0,0 +1,262 @@
+#include "latencydialog.h"
+#include "latencyprober.h"
+#include "sparkline.h"
+#include "serviceconfig.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QLabel>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QTabWidget>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDateTime>
+#include <QDir>
+
+LatencyDialog::LatencyDialog(const QList<LatencyProber*>& probers, QWidget *parent)
+    : QDialog(parent)
+    , m_probers(probers)
+    , m_prober(nullptr)
+{
+    setWindowTitle("延迟");
+    resize(720, 600);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QWidget* instanceWidget = new QWidget();
+    QHBoxLayout* instanceLayout = new QHBoxLayout(instanceWidget);
+    instanceLayout->setContentsMargins(0, 0, 0, 0);
+    m_instanceCombo = new QComboBox();
+    for (LatencyProber* prober : probers) {
+        m_instanceCombo->addItem(prober->tag());
+    }
+    instanceLayout->addWidget(new QLabel("实例:"));
+    instanceLayout->addWidget(m_instanceCombo);
+    instanceLayout->addStretch();
+    mainLayout->addWidget(instanceWidget);
+
+    static const char* const colors[] = {"#27ae60", "#f39c12", "#e74c3c", "#8e44ad"};
+
+    QGridLayout* grid = new QGridLayout();
+    grid->setColumnStretch(2, 1);
+    for (int i = 0; i < LatencyProber::PercentileCount; ++i) {
+        QLabel* valueLabel = new QLabel("-");
+        valueLabel->setMinimumWidth(100);
+        valueLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        Sparkline* sparkline = new Sparkline();
+        sparkline->setColor(QColor(colors[i]));
+
+        grid->addWidget(new QLabel(LatencyProber::percentileName(LatencyProber::Percentile(i))), i, 0);
+        grid->addWidget(valueLabel, i, 1);
+        grid->addWidget(sparkline, i, 2);
+        m_valueLabels << valueLabel;
+        m_sparklines << sparkline;
+    }
+    mainLayout->addLayout(grid);
+
+    m_summaryLabel = new QLabel();
+    m_summaryLabel->setObjectName("hintLabel");
+    m_summaryLabel->setWordWrap(true);
+    mainLayout->addWidget(m_summaryLabel);
+
+    // 探测设置对所有实例生效
+    QWidget* settingsWidget = new QWidget();
+    QHBoxLayout* settingsLayout = new QHBoxLayout(settingsWidget);
+    settingsLayout->setContentsMargins(0, 0, 0, 0);
+    m_commandsEdit = new QLineEdit(ServiceConfig::instance().getLatencyCommands().join("; "));
+    m_commandsEdit->setObjectName("inputField");
+    m_commandsEdit->setToolTip("轮流发送的命令，用分号分隔，如 PING; GET key");
+    m_intervalSpin = new QSpinBox();
+    m_intervalSpin->setRange(1, 1000);
+    m_intervalSpin->setSuffix(" ms");
+    m_intervalSpin->setValue(ServiceConfig::instance().getLatencyProbeInterval());
+    QPushButton* applyButton = new QPushButton("应用");
+    applyButton->setObjectName("applyButton");
+    settingsLayout->addWidget(new QLabel("探测命令:"));
+    settingsLayout->addWidget(m_commandsEdit, 1);
+    settingsLayout->addWidget(new QLabel("间隔:"));
+    settingsLayout->addWidget(m_intervalSpin);
+    settingsLayout->addWidget(applyButton);
+    mainLayout->addWidget(settingsWidget);
+    connect(applyButton, &QPushButton::clicked, this, &LatencyDialog::onApplyClicked);
+
+    QTabWidget* tabs = new QTabWidget();
+    m_eventTable = new QTableWidget(0, 5);
+    m_eventTable->setHorizontalHeaderLabels(QStringList() << "事件" << "最近发生" << "最近" << "最大" << "历史记录");
+    m_eventTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_eventTable->verticalHeader()->setVisible(false);
+    m_eventTable->horizontalHeader()->setStretchLastSection(true);
+    tabs->addTab(m_eventTable, "LATENCY LATEST");
+
+    m_statsTable = new QTableWidget(0, 1);
+    m_statsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_statsTable->verticalHeader()->setVisible(false);
+    m_statsTable->horizontalHeader()->setStretchLastSection(true);
+    tabs->addTab(m_statsTable, "INFO latencystats");
+    mainLayout->addWidget(tabs, 1);
+
+    m_serverLabel = new QLabel();
+    m_serverLabel->setObjectName("hintLabel");
+    m_serverLabel->setWordWrap(true);
+    mainLayout->addWidget(m_serverLabel);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    QPushButton* exportButton = buttons->addButton("导出直方图…", QDialogButtonBox::ActionRole);
+    connect(exportButton, &QPushButton::clicked, this, &LatencyDialog::onExportClicked);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttons);
+
+    connect(m_instanceCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &LatencyDialog::onInstanceChanged);
+    onInstanceChanged(m_instanceCombo->currentIndex());
+}
+
+void LatencyDialog::onInstanceChanged(int index)
+{
+    if (m_prober) {
+        disconnect(m_prober, nullptr, this, nullptr);
+    }
+    m_prober = (index >= 0 && index < m_probers.size()) ? m_probers.at(index) : nullptr;
+    if (!m_prober) {
+        return;
+    }
+
+    connect(m_prober, &LatencyProber::intervalFinished, this, &LatencyDialog::onIntervalFinished);
+    connect(m_prober, &LatencyProber::serverStatsUpdated, this, &LatencyDialog::onServerStatsUpdated);
+    for (int i = 0; i < LatencyProber::PercentileCount; ++i) {
+        const MetricSeries& series = m_prober->series(LatencyProber::Percentile(i));
+        m_sparklines[i]->setSeries(&series);
+        m_valueLabels[i]->setText(series.isEmpty() ? QString("-") : LatencyProber::formatMicros(series.last()));
+    }
+    updateSummary();
+    onServerStatsUpdated();
+}
+
+void LatencyDialog::onIntervalFinished()
+{
+    for (int i = 0; i < LatencyProber::PercentileCount; ++i) {
+        const MetricSeries& series = m_prober->series(LatencyProber::Percentile(i));
+        m_valueLabels[i]->setText(LatencyProber::formatMicros(series.last()));
+        m_sparklines[i]->appendLatest();
+    }
+    updateSummary();
+}
+
+void LatencyDialog::updateSummary()
+{
+    if (!m_prober->isRunning()) {
+        m_summaryLabel->setText("实例未运行，就绪后开始探测");
+        return;
+    }
+    const HdrHistogram& total = m_prober->totalHistogram();
+    m_summaryLabel->setText(QString("累计 %1 次探测：p50 %2，p99 %3，p99.9 %4，最大 %5；连接全忙跳过 %6 次，出错 %7 次")
+                                .arg(total.totalCount())
+                                .arg(LatencyProber::formatMicros(total.valueAtPercentile(50)))
+                                .arg(LatencyProber::formatMicros(total.valueAtPercentile(99)))
+                                .arg(LatencyProber::formatMicros(total.valueAtPercentile(99.9)))
+                                .arg(LatencyProber::formatMicros(total.maximum()))
+                                .arg(m_prober->skippedCount())
+                                .arg(m_prober->errorCount()));
+}
+
+void LatencyDialog::onServerStatsUpdated()
+{
+    const QList<LatencyProber::LatencyEvent> events = m_prober->latencyEvents();
+    m_eventTable->setRowCount(events.size());
+    for (int row = 0; row < events.size(); ++row) {
+        const LatencyProber::LatencyEvent& event = events.at(row);
+        qint64 historyMax = 0;
+        QStringList historyLines;
+        for (const auto& sample : event.history) {
+            historyMax = qMax(historyMax, sample.second);
+            historyLines << QString("%1  %2 ms")
+                                .arg(QDateTime::fromSecsSinceEpoch(sample.first).toString("MM-dd hh:mm:ss"))
+                                .arg(sample.second);
+        }
+
+        QStringList cells;
+        cells << event.name
+              << QDateTime::fromSecsSinceEpoch(event.timestamp).toString("MM-dd hh:mm:ss")
+              << QString("%1 ms").arg(event.latestMs)
+              << QString("%1 ms").arg(event.maxMs)
+              << QString("%1 条，其中最大 %2 ms").arg(event.history.size()).arg(historyMax);
+        for (int column = 0; column < cells.size(); ++column) {
+            QTableWidgetItem* item = new QTableWidgetItem(cells.at(column));
+            item->setToolTip(historyLines.join("\n"));
+            m_eventTable->setItem(row, column, item);
+        }
+    }
+
+    // 百分位由服务器的 latency-tracking-info-percentiles 决定，表头按第一个命令生成
+    const QList<LatencyProber::CommandLatency> latencies = m_prober->commandLatencies();
+    QStringList headers;
+    headers << "命令";
+    if (!latencies.isEmpty()) {
+        for (const auto& percentile : latencies.first().percentiles) {
+            headers << percentile.first;
+        }
+    }
+    m_statsTable->setColumnCount(headers.size());
+    m_statsTable->setHorizontalHeaderLabels(headers);
+    m_statsTable->setRowCount(latencies.size());
+    for (int row = 0; row < latencies.size(); ++row) {
+        const LatencyProber::CommandLatency& latency = latencies.at(row);
+        m_statsTable->setItem(row, 0, new QTableWidgetItem(latency.command));
+        for (int i = 0; i < latency.percentiles.size() && i + 1 < headers.size(); ++i) {
+            m_statsTable->setItem(row, i + 1,
+                                  new QTableWidgetItem(LatencyProber::formatMicros(latency.percentiles.at(i).second)));
+        }
+    }
+
+    QStringList hints;
+    if (events.isEmpty()) {
+        hints << "没有延迟事件：Redis 只在 latency-monitor-threshold 大于 0 时记录。";
+    }
+    if (!m_prober->hasLatencyStats()) {
+        hints << "INFO latencystats 没有数据：需要 Redis 7 及以上并开启 latency-tracking。";
+    }
+    m_serverLabel->setText(hints.join(" "));
+}
+
+void LatencyDialog::onApplyClicked()
+{
+    QStringList commands;
+    const QStringList parts = m_commandsEdit->text().split(';', Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        if (!part.trimmed().isEmpty()) {
+            commands << part.trimmed();
+        }
+    }
+    if (commands.isEmpty()) {
+        QMessageBox::warning(this, "延迟", "至少需要一个探测命令");
+        return;
+    }
+
+    ServiceConfig::instance().setLatencyCommands(commands);
+    ServiceConfig::instance().setLatencyProbeInterval(m_intervalSpin->value());
+    ServiceConfig::instance().save();
+    for (LatencyProber* prober : m_probers) {
+        prober->setCommands(commands);
+        prober->setProbeInterval(m_intervalSpin->value());
+    }
+}
+
+void LatencyDialog::onExportClicked()
+{
+    QString path = QFileDialog::getSaveFileName(this, "导出延迟直方图",
+                                                QDir::homePath() + "/" + m_prober->tag() + "-latency.hlog",
+                                                "HdrHistogram 日志 (*.hlog)");
+    if (path.isEmpty()) {
+        return;
+    }
+    QString error;
+    if (!m_prober->exportLog(path, &error)) {
+        QMessageBox::warning(this, "导出直方图", "导出失败：" + error);
+    }
+}
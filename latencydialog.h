@@ -0,0 +1,50 @@
+#ifndef LATENCYDIALOG_H
+#define LATENCYDIALOG_H
+
+#include <QDialog>
+#include <QList>
+
+class LatencyProber;
+class Sparkline;
+class QLabel;
+class QComboBox;
+class QLineEdit;
+class QSpinBox;
+class QTableWidget;
+
+// 延迟面板。选择一个实例，显示探测得到的 p50 / p99 / p99.9 / 最大值的每秒曲线和累计统计，
+// 以及 Redis 自己记录的 LATENCY LATEST 事件和 INFO latencystats；可以把每秒直方图导出为 .hlog
+class LatencyDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // probers 的第一个为主实例，其余为多实例中的实例
+    LatencyDialog(const QList<LatencyProber*>& probers, QWidget *parent = nullptr);
+
+private slots:
+    void onInstanceChanged(int index);
+    void onIntervalFinished();
+    void onServerStatsUpdated();
+    void onApplyClicked();
+    void onExportClicked();
+
+private:
+    void updateSummary();
+
+private:
+    QList<LatencyProber*> m_probers;
+    LatencyProber* m_prober;
+
+    QComboBox* m_instanceCombo;
+    QList<QLabel*> m_valueLabels;
+    QList<Sparkline*> m_sparklines;
+    QLabel* m_summaryLabel;
+    QLineEdit* m_commandsEdit;
+    QSpinBox* m_intervalSpin;
+    QTableWidget* m_eventTable;
+    QTableWidget* m_statsTable;
+    QLabel* m_serverLabel;
+};
+
+#endif // LATENCYDIALOG_H
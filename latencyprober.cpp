@@ -0,0 +1,417 @@
+#include "latencyprober.h"
+#include "respclient.h"
+#include <QTimer>
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+#include <QRegularExpression>
+
+static const int kMinProbeIntervalMs = 1;
+static const int kMaxConnections = 16;
+// 直方图的范围：1 µs ~ 60 s，3 位有效数字
+static const qint64 kHighestMicros = 60LL * 1000 * 1000;
+static const int kSignificantDigits = 3;
+// 百分位序列保留的秒数，和导出时保留的每秒直方图个数
+static const int kHistorySeconds = 600;
+static const int kKeptIntervals = 3600;
+static const int kStatsIntervalMs = 10000;
+
+LatencyProber::LatencyProber(QObject *parent)
+    : QObject(parent)
+    , m_tag("redis")
+    , m_port(0)
+    , m_nextCommand(0)
+    , m_nextConnection(0)
+    , m_connectionCount(2)
+    , m_probeInterval(10)
+    , m_interval(1, kHighestMicros, kSignificantDigits)
+    , m_total(1, kHighestMicros, kSignificantDigits)
+    , m_series(size_t(PercentileCount), MetricSeries(kHistorySeconds))
+    , m_intervalStart(0)
+    , m_skipped(0)
+    , m_pendingSkipCount(0)
+    , m_firstSkipAt(0)
+    , m_errors(0)
+    , m_hasLatencyStats(false)
+    , m_statsPending(false)
+    , m_generation(0)
+    , m_running(false)
+{
+    m_statsClient = new RespClient(this);
+
+    m_probeTimer = new QTimer(this);
+    m_probeTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_probeTimer, &QTimer::timeout, this, &LatencyProber::probe);
+
+    m_intervalTimer = new QTimer(this);
+    m_intervalTimer->setInterval(1000);
+    connect(m_intervalTimer, &QTimer::timeout, this, &LatencyProber::finishInterval);
+
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(kStatsIntervalMs);
+    connect(m_statsTimer, &QTimer::timeout, this, &LatencyProber::pollServerStats);
+
+    setCommands(QStringList() << "PING");
+}
+
+QString LatencyProber::percentileName(Percentile percentile)
+{
+    switch (percentile) {
+    case P50:
+        return "p50";
+    case P99:
+        return "p99";
+    case P999:
+        return "p99.9";
+    case Max:
+        return "最大";
+    default:
+        return QString();
+    }
+}
+
+QString LatencyProber::formatMicros(double micros)
+{
+    if (micros < 1000) {
+        return QString("%1 µs").arg(micros, 0, 'f', 0);
+    }
+    if (micros < 1000 * 1000) {
+        return QString("%1 ms").arg(micros / 1000.0, 0, 'f', 2);
+    }
+    return QString("%1 s").arg(micros / (1000.0 * 1000.0), 0, 'f', 2);
+}
+
+void LatencyProber::setServer(const QString& host, quint16 port, const QString& password)
+{
+    m_host = host;
+    m_port = port;
+    m_password = password;
+    for (Connection& connection : m_connections) {
+        connection.client->disconnectFromServer();
+        connection.client->setPassword(password);
+        connection.client->setServer(host, port);
+    }
+    m_statsClient->disconnectFromServer();
+    m_statsClient->setPassword(password);
+    m_statsClient->setServer(host, port);
+}
+
+void LatencyProber::setCommands(const QStringList& commands)
+{
+    m_commandText.clear();
+    m_commands.clear();
+    for (const QString& command : commands) {
+        const QStringList parts = command.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+        if (parts.isEmpty()) {
+            continue;
+        }
+        QList<QByteArray> args;
+        for (const QString& part : parts) {
+            args << part.toUtf8();
+        }
+        m_commands << args;
+        m_commandText << parts.join(' ');
+    }
+    m_nextCommand = 0;
+}
+
+void LatencyProber::setProbeInterval(int ms)
+{
+    m_probeInterval = qMax(kMinProbeIntervalMs, ms);
+    m_probeTimer->setInterval(m_probeInterval);
+}
+
+void LatencyProber::setConnectionCount(int count)
+{
+    m_connectionCount = qBound(1, count, kMaxConnections);
+}
+
+void LatencyProber::createConnections()
+{
+    for (Connection& connection : m_connections) {
+        delete connection.client;
+    }
+    m_connections.assign(size_t(m_connectionCount), Connection());
+    for (Connection& connection : m_connections) {
+        connection.client = new RespClient(this);
+        connection.client->setPassword(m_password);
+        connection.client->setServer(m_host, m_port);
+    }
+    m_nextConnection = 0;
+}
+
+void LatencyProber::start()
+{
+    stop();
+    createConnections();
+
+    m_interval.reset();
+    m_total.reset();
+    for (MetricSeries& series : m_series) {
+        series.clear();
+    }
+    m_intervals.clear();
+    m_events.clear();
+    m_commandLatencies.clear();
+    m_hasLatencyStats = false;
+    m_skipped = 0;
+    m_pendingSkipCount = 0;
+    m_errors = 0;
+    m_running = true;
+    m_clock.start();
+    m_intervalStart = QDateTime::currentMSecsSinceEpoch();
+
+    // 第一个命令的往返包含建立连接和认证，先各发一个 PING 预热，不计入直方图
+    int generation = m_generation;
+    for (size_t i = 0; i < m_connections.size(); ++i) {
+        m_connections[i].busy = true;
+        m_connections[i].client->send(QByteArray("PING"), [this, generation, i](const RespValue&) {
+            if (generation == m_generation) {
+                m_connections[i].busy = false;
+            }
+        });
+    }
+
+    m_probeTimer->start(m_probeInterval);
+    m_intervalTimer->start();
+    m_statsTimer->start();
+    pollServerStats();
+}
+
+void LatencyProber::stop()
+{
+    // 让还在路上的回复作废
+    ++m_generation;
+    m_running = false;
+    m_statsPending = false;
+    m_pendingSkipCount = 0;
+    m_probeTimer->stop();
+    m_intervalTimer->stop();
+    m_statsTimer->stop();
+    for (Connection& connection : m_connections) {
+        connection.busy = false;
+        connection.client->disconnectFromServer();
+    }
+    m_statsClient->disconnectFromServer();
+}
+
+void LatencyProber::probe()
+{
+    if (!m_running || m_commands.isEmpty() || m_connections.empty()) {
+        return;
+    }
+
+    // 从上次用过的下一条开始找空闲的连接
+    const size_t count = m_connections.size();
+    size_t index = count;
+    for (size_t i = 0; i < count; ++i) {
+        size_t candidate = (size_t(m_nextConnection) + i) % count;
+        if (!m_connections[candidate].busy) {
+            index = candidate;
+            break;
+        }
+    }
+    if (index == count) {
+        ++m_skipped;
+        if (m_pendingSkipCount == 0) {
+            m_firstSkipAt = m_clock.nsecsElapsed();
+        }
+        ++m_pendingSkipCount;
+        return;
+    }
+    m_nextConnection = int((index + 1) % count);
+
+    const QList<QByteArray>& command = m_commands.at(m_nextCommand);
+    m_nextCommand = (m_nextCommand + 1) % m_commands.size();
+
+    int generation = m_generation;
+    qint64 sentAt = m_clock.nsecsElapsed();
+    m_connections[index].busy = true;
+    m_connections[index].client->send(command, [this, generation, index, sentAt](const RespValue& reply) {
+        if (generation != m_generation) {
+            return;
+        }
+        m_connections[index].busy = false;
+        // 连接断开、认证失败或命令本身出错都不计入延迟
+        if (reply.isError()) {
+            ++m_errors;
+            m_pendingSkipCount = 0;
+            return;
+        }
+        qint64 now = m_clock.nsecsElapsed();
+        m_interval.record(qMax<qint64>(1, (now - sentAt) / 1000));
+        // 被跳过的探测最早也要现在才能发出：第 k 个按计划在 first + k·interval 发出，
+        // 补记 now - first、now - first - interval …（同 HdrHistogram 的 recordValueWithExpectedInterval）
+        const qint64 intervalNs = qint64(m_probeInterval) * 1000000;
+        for (qint64 k = 0; k < m_pendingSkipCount; ++k) {
+            qint64 waited = now - (m_firstSkipAt + k * intervalNs);
+            if (waited <= 0) {
+                break;
+            }
+            m_interval.record(qMax<qint64>(1, waited / 1000));
+        }
+        m_pendingSkipCount = 0;
+    });
+}
+
+void LatencyProber::finishInterval()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_interval.totalCount() > 0) {
+        m_series[P50].append(double(m_interval.valueAtPercentile(50)));
+        m_series[P99].append(double(m_interval.valueAtPercentile(99)));
+        m_series[P999].append(double(m_interval.valueAtPercentile(99.9)));
+        m_series[Max].append(double(m_interval.maximum()));
+
+        IntervalRecord record;
+        record.start = m_intervalStart;
+        record.lengthMs = now - m_intervalStart;
+        record.maxMicros = m_interval.maximum();
+        record.encoded = m_interval.encode();
+        m_intervals.append(record);
+        while (m_intervals.size() > kKeptIntervals) {
+            m_intervals.removeFirst();
+        }
+
+        m_total.add(m_interval);
+        m_interval.reset();
+        emit intervalFinished();
+    }
+    m_intervalStart = now;
+}
+
+void LatencyProber::pollServerStats()
+{
+    if (!m_running || m_statsPending) {
+        return;
+    }
+
+    int generation = m_generation;
+    m_statsPending = true;
+    m_statsClient->send(QList<QByteArray>() << "LATENCY" << "LATEST",
+                        [this, generation](const RespValue& reply) {
+                            if (generation != m_generation) {
+                                return;
+                            }
+                            handleLatencyLatest(reply.isError() ? QList<RespValue>() : reply.elements(),
+                                                generation);
+                        });
+}
+
+void LatencyProber::handleLatencyLatest(const QList<RespValue>& events, int generation)
+{
+    // 每个事件：名称、最近一次的时间戳、最近一次的毫秒数、历史最大毫秒数
+    m_pendingEvents.clear();
+    for (const RespValue& event : events) {
+        const QList<RespValue>& fields = event.elements();
+        if (fields.size() < 4) {
+            continue;
+        }
+        LatencyEvent latencyEvent;
+        latencyEvent.name = fields.at(0).toString();
+        latencyEvent.timestamp = fields.at(1).toInteger();
+        latencyEvent.latestMs = fields.at(2).toInteger();
+        latencyEvent.maxMs = fields.at(3).toInteger();
+        m_pendingEvents.append(latencyEvent);
+    }
+
+    for (int i = 0; i < m_pendingEvents.size(); ++i) {
+        m_statsClient->send(QList<QByteArray>() << "LATENCY" << "HISTORY" << m_pendingEvents.at(i).name.toUtf8(),
+                            [this, generation, i](const RespValue& reply) {
+                                if (generation != m_generation || reply.isError()) {
+                                    return;
+                                }
+                                for (const RespValue& sample : reply.elements()) {
+                                    if (sample.elements().size() >= 2) {
+                                        m_pendingEvents[i].history.append(
+                                            qMakePair(sample.elements().at(0).toInteger(),
+                                                      sample.elements().at(1).toInteger()));
+                                    }
+                                }
+                            });
+    }
+
+    // 回复按发送顺序到达，INFO 的回复到了说明所有 HISTORY 都已处理
+    m_statsClient->send(QList<QByteArray>() << "INFO" << "latencystats",
+                        [this, generation](const RespValue& reply) {
+                            if (generation != m_generation) {
+                                return;
+                            }
+                            m_statsPending = false;
+                            m_events = m_pendingEvents;
+                            handleLatencyStats(reply.isError() ? QByteArray() : reply.data());
+                            emit serverStatsUpdated();
+                        });
+}
+
+void LatencyProber::handleLatencyStats(const QByteArray& info)
+{
+    // latency_percentiles_usec_get:p50=1.003,p99=2.007,p99.9=4.015
+    static const QByteArray prefix("latency_percentiles_usec_");
+    m_commandLatencies.clear();
+    const QMap<QByteArray, QByteArray> fields = RespClient::parseInfo(info);
+    for (auto it = fields.constBegin(); it != fields.constEnd(); ++it) {
+        if (!it.key().startsWith(prefix)) {
+            continue;
+        }
+        CommandLatency latency;
+        latency.command = QString::fromUtf8(it.key().mid(prefix.size()));
+        const QList<QByteArray> parts = it.value().split(',');
+        for (const QByteArray& part : parts) {
+            int equals = part.indexOf('=');
+            if (equals > 0) {
+                latency.percentiles.append(qMakePair(QString::fromUtf8(part.left(equals)),
+                                                     part.mid(equals + 1).toDouble()));
+            }
+        }
+        m_commandLatencies.append(latency);
+    }
+    m_hasLatencyStats = !m_commandLatencies.isEmpty();
+}
+
+bool LatencyProber::exportLog(const QString& path, QString* error) const
+{
+    if (m_intervals.isEmpty()) {
+        if (error) {
+            *error = "还没有探测数据";
+        }
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+
+    // HdrHistogram 日志格式 1.3：时间戳是绝对时间（BaseTime 为 0），标签区分来源
+    QString tag = m_tag;
+    tag.replace(QRegularExpression("[\\s,]"), "_");
+    const qint64 startTime = m_intervals.first().start;
+    QTextStream out(&file);
+    out << "#[Histogram log format version 1.3]\n";
+    out << QString("#[StartTime: %1 (seconds since epoch), %2]\n")
+               .arg(startTime / 1000.0, 0, 'f', 3)
+               .arg(QDateTime::fromMSecsSinceEpoch(startTime).toString(Qt::ISODate));
+    out << "#[BaseTime: 0.000 (seconds since epoch)]\n";
+    out << "# values in microseconds, Interval_Max in milliseconds\n";
+    out << "\"StartTimestamp\",\"Interval_Length\",\"Interval_Max\",\"Interval_Compressed_Histogram\"\n";
+    for (const IntervalRecord& record : m_intervals) {
+        out << "Tag=" << tag << ","
+            << QString::number(record.start / 1000.0, 'f', 3) << ","
+            << QString::number(record.lengthMs / 1000.0, 'f', 3) << ","
+            << QString::number(record.maxMicros / 1000.0, 'f', 3) << ","
+            << record.encoded.toBase64() << "\n";
+    }
+    out.flush();
+
+    if (out.status() != QTextStream::Ok || file.error() != QFileDevice::NoError) {
+        if (error) {
+            *error = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
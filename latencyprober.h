@@ -0,0 +1,162 @@
+#ifndef LATENCYPROBER_H
+#define LATENCYPROBER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QElapsedTimer>
+#include <vector>
+#include "hdrhistogram.h"
+#include "metricsampler.h"
+
+class QTimer;
+class RespClient;
+class RespValue;
+
+// 延迟探测。在几条专用连接上按固定节奏轮流发送一组轻量命令，往返时间（微秒）记入 HdrHistogram；
+// 每条连接同一时间只有一个命令在路上，测到的是单次往返而不是排队时间。连接全忙时跳过本次探测，
+// 记下跳过的时刻，等下一个回复到达（有连接空出来）时按各自等待的时间补记，避免服务器卡顿时漏记慢样本。
+// 每秒把这一秒的直方图汇总成百分位的时间序列并并入累计直方图，最近一小时的每秒直方图保留压缩编码，
+// 可以导出为 HdrHistogram 日志（.hlog），和其他实例、其他时段的日志直接合并。
+// 另有一条连接每 10 秒读取 Redis 自己记录的延迟：LATENCY LATEST / HISTORY 和 INFO latencystats
+class LatencyProber : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Percentile {
+        P50,
+        P99,
+        P999,
+        Max,
+        PercentileCount
+    };
+
+    // LATENCY LATEST 的一个事件，history 为 LATENCY HISTORY 的（时间戳, 毫秒）
+    struct LatencyEvent
+    {
+        QString name;
+        qint64 timestamp = 0;
+        qint64 latestMs = 0;
+        qint64 maxMs = 0;
+        QList<QPair<qint64, qint64>> history;
+    };
+
+    // INFO latencystats 中一个命令的百分位（微秒）
+    struct CommandLatency
+    {
+        QString command;
+        QList<QPair<QString, double>> percentiles;
+    };
+
+    explicit LatencyProber(QObject *parent = nullptr);
+
+    static QString percentileName(Percentile percentile);
+    // 微秒按大小换成 µs / ms / s
+    static QString formatMicros(double micros);
+
+    // 导出日志中区分来源的标签，如实例名
+    void setTag(const QString& tag) { m_tag = tag; }
+    QString tag() const { return m_tag; }
+
+    void setServer(const QString& host, quint16 port, const QString& password);
+    void setCommands(const QStringList& commands);
+    QStringList commands() const { return m_commandText; }
+    void setProbeInterval(int ms);
+    int probeInterval() const { return m_probeInterval; }
+    // 运行中修改在下次 start() 时生效
+    void setConnectionCount(int count);
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    const MetricSeries& series(Percentile percentile) const { return m_series[percentile]; }
+    // 从 start() 起的全部探测
+    const HdrHistogram& totalHistogram() const { return m_total; }
+    qint64 skippedCount() const { return m_skipped; }
+    qint64 errorCount() const { return m_errors; }
+
+    QList<LatencyEvent> latencyEvents() const { return m_events; }
+    QList<CommandLatency> commandLatencies() const { return m_commandLatencies; }
+    // INFO latencystats 是否有内容（Redis 7 之前没有这个段）
+    bool hasLatencyStats() const { return m_hasLatencyStats; }
+
+    // 写出每秒直方图组成的 .hlog，失败时返回 false 并填写 error
+    bool exportLog(const QString& path, QString* error) const;
+
+signals:
+    // 每个百分位都追加了一个新值
+    void intervalFinished();
+    void serverStatsUpdated();
+
+private slots:
+    void probe();
+    void finishInterval();
+    void pollServerStats();
+
+private:
+    struct Connection
+    {
+        RespClient* client = nullptr;
+        bool busy = false;
+    };
+
+    struct IntervalRecord
+    {
+        qint64 start;       // msecs since epoch
+        qint64 lengthMs;
+        qint64 maxMicros;
+        QByteArray encoded;
+    };
+
+    void createConnections();
+    void handleLatencyLatest(const QList<RespValue>& events, int generation);
+    void handleLatencyStats(const QByteArray& info);
+
+private:
+    QString m_tag;
+    QString m_host;
+    quint16 m_port;
+    QString m_password;
+
+    QStringList m_commandText;
+    QList<QList<QByteArray>> m_commands;
+    int m_nextCommand;
+    int m_nextConnection;
+    int m_connectionCount;
+    int m_probeInterval;
+
+    std::vector<Connection> m_connections;
+    RespClient* m_statsClient;
+    QTimer* m_probeTimer;
+    QTimer* m_intervalTimer;
+    QTimer* m_statsTimer;
+    QElapsedTimer m_clock;
+
+    HdrHistogram m_interval;
+    HdrHistogram m_total;
+    std::vector<MetricSeries> m_series;
+    QList<IntervalRecord> m_intervals;
+    qint64 m_intervalStart;
+    qint64 m_skipped;
+    // 连接全忙时跳过、还没有补记的探测：个数和第一次跳过的时刻（m_clock 的纳秒），
+    // 之后的按探测间隔推算，不逐个保存
+    qint64 m_pendingSkipCount;
+    qint64 m_firstSkipAt;
+    qint64 m_errors;
+
+    QList<LatencyEvent> m_events;
+    QList<LatencyEvent> m_pendingEvents;
+    QList<CommandLatency> m_commandLatencies;
+    bool m_hasLatencyStats;
+    bool m_statsPending;
+
+    int m_generation;
+    bool m_running;
+};
+
+#endif // LATENCYPROBER_H
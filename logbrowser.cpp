@@ -0,0 +1,334 @@
+#include "logbrowser.h"
+#include "mappedlog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QSplitter>
+#include <QTableView>
+#include <QHeaderView>
+#include <QListWidget>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QDateTimeEdit>
+#include <QPushButton>
+#include <QLabel>
+#include <QMessageBox>
+#include <QDialogButtonBox>
+#include <QRegularExpression>
+#include <QColor>
+#include <climits>
+
+// 搜索结果最多列出的行数
+static const int kMaxSearchResults = 1000;
+
+LogFileModel::LogFileModel(MappedLog* log, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_log(log)
+    , m_rows(0)
+    , m_cachedLineNumber(-1)
+{
+    connect(log, &MappedLog::indexProgress, this, &LogFileModel::onIndexProgress);
+    connect(log, &MappedLog::indexFinished, this, &LogFileModel::onIndexProgress);
+    connect(log, &MappedLog::indexReset, this, &LogFileModel::onIndexReset);
+}
+
+int LogFileModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows;
+}
+
+int LogFileModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+void LogFileModel::onIndexProgress()
+{
+    // 视图的行号是 int，超过 21 亿行的部分只能通过跳转之外的方式查看
+    int rows = int(qMin<qint64>(m_log->lineCount(), INT_MAX));
+    if (rows > m_rows) {
+        beginInsertRows(QModelIndex(), m_rows, rows - 1);
+        m_rows = rows;
+        endInsertRows();
+    }
+}
+
+void LogFileModel::onIndexReset()
+{
+    beginResetModel();
+    m_rows = 0;
+    m_cachedLineNumber = -1;
+    endResetModel();
+}
+
+QVariant LogFileModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows) {
+        return QVariant();
+    }
+
+    qint64 number = index.row();
+    if (number != m_cachedLineNumber) {
+        m_cachedLine = LogLine::parse(m_log->lineData(number));
+        m_cachedLineNumber = number;
+    }
+    const LogLine& line = m_cachedLine;
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case LineColumn:
+            return number + 1;
+        case TimeColumn:
+            return QString::fromLatin1(line.timeText);
+        case PidColumn:
+            return line.pid > 0 ? QVariant(line.pid) : QVariant();
+        case RoleColumn:
+            return LogLine::roleName(line.role);
+        case LevelColumn:
+            return LogLine::levelName(line.level);
+        case MessageColumn:
+            return QString::fromUtf8(line.message);
+        default:
+            break;
+        }
+    } else if (role == Qt::ForegroundRole) {
+        if (line.level == LogLine::Warning) {
+            return QColor("#c62828");
+        }
+        if (line.level == LogLine::Debug || line.level == LogLine::Verbose) {
+            return QColor("#757575");
+        }
+    }
+    return QVariant();
+}
+
+QVariant LogFileModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case LineColumn:
+        return "行";
+    case TimeColumn:
+        return "时间";
+    case PidColumn:
+        return "PID";
+    case RoleColumn:
+        return "角色";
+    case LevelColumn:
+        return "级别";
+    case MessageColumn:
+        return "消息";
+    default:
+        return QVariant();
+    }
+}
+
+LogBrowserDialog::LogBrowserDialog(const QString& path, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("历史日志");
+    resize(1000, 700);
+
+    m_log = new MappedLog(this);
+    m_model = new LogFileModel(m_log, this);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QLabel* pathLabel = new QLabel(path);
+    pathLabel->setObjectName("hintLabel");
+    mainLayout->addWidget(pathLabel);
+
+    QWidget* jumpWidget = new QWidget();
+    QHBoxLayout* jumpLayout = new QHBoxLayout(jumpWidget);
+    jumpLayout->setContentsMargins(0, 0, 0, 0);
+    m_timeEdit = new QDateTimeEdit(QDateTime::currentDateTime());
+    m_timeEdit->setDisplayFormat("yyyy-MM-dd hh:mm:ss");
+    m_timeEdit->setCalendarPopup(true);
+    QPushButton* jumpButton = new QPushButton("跳转到时间");
+    QPushButton* reloadButton = new QPushButton("重新加载");
+    reloadButton->setToolTip("文件继续写入后，从上次的位置接着建立索引");
+    jumpLayout->addWidget(m_timeEdit);
+    jumpLayout->addWidget(jumpButton);
+    jumpLayout->addStretch();
+    jumpLayout->addWidget(reloadButton);
+    mainLayout->addWidget(jumpWidget);
+
+    QWidget* searchWidget = new QWidget();
+    QHBoxLayout* searchLayout = new QHBoxLayout(searchWidget);
+    searchLayout->setContentsMargins(0, 0, 0, 0);
+    m_searchEdit = new QLineEdit();
+    m_searchEdit->setObjectName("inputField");
+    m_searchEdit->setPlaceholderText("正则表达式，如 Background saving|OOM");
+    m_caseCheck = new QCheckBox("区分大小写");
+    m_searchButton = new QPushButton("搜索");
+    searchLayout->addWidget(m_searchEdit, 1);
+    searchLayout->addWidget(m_caseCheck);
+    searchLayout->addWidget(m_searchButton);
+    mainLayout->addWidget(searchWidget);
+
+    m_view = new QTableView();
+    m_view->setModel(m_model);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_view->setWordWrap(false);
+    m_view->verticalHeader()->setVisible(false);
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(fontMetrics().height() + 4);
+    m_view->horizontalHeader()->setStretchLastSection(true);
+    m_view->setColumnWidth(LogFileModel::LineColumn, 90);
+    m_view->setColumnWidth(LogFileModel::TimeColumn, 190);
+    m_view->setColumnWidth(LogFileModel::PidColumn, 70);
+    m_view->setColumnWidth(LogFileModel::RoleColumn, 60);
+    m_view->setColumnWidth(LogFileModel::LevelColumn, 70);
+
+    m_resultList = new QListWidget();
+    m_resultList->setUniformItemSizes(true);
+
+    QWidget* resultWidget = new QWidget();
+    QVBoxLayout* resultLayout = new QVBoxLayout(resultWidget);
+    resultLayout->setContentsMargins(0, 0, 0, 0);
+    m_searchLabel = new QLabel();
+    m_searchLabel->setObjectName("hintLabel");
+    resultLayout->addWidget(m_searchLabel);
+    resultLayout->addWidget(m_resultList);
+
+    QSplitter* splitter = new QSplitter(Qt::Vertical);
+    splitter->addWidget(m_view);
+    splitter->addWidget(resultWidget);
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 1);
+    mainLayout->addWidget(splitter, 1);
+
+    m_statusLabel = new QLabel();
+    m_statusLabel->setObjectName("hintLabel");
+    mainLayout->addWidget(m_statusLabel);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttons);
+
+    connect(jumpButton, &QPushButton::clicked, this, &LogBrowserDialog::onJumpClicked);
+    connect(reloadButton, &QPushButton::clicked, this, &LogBrowserDialog::onReloadClicked);
+    connect(m_searchButton, &QPushButton::clicked, this, &LogBrowserDialog::onSearchClicked);
+    connect(m_searchEdit, &QLineEdit::returnPressed, this, &LogBrowserDialog::onSearchClicked);
+    connect(m_resultList, &QListWidget::itemClicked, this, &LogBrowserDialog::onResultClicked);
+    connect(m_log, &MappedLog::indexProgress, this, &LogBrowserDialog::updateStatus);
+    connect(m_log, &MappedLog::indexFinished, this, &LogBrowserDialog::onIndexFinished);
+    connect(m_log, &MappedLog::searchFinished, this, &LogBrowserDialog::onSearchFinished);
+    // 可能在表格绘制或后台线程中发出，排队到事件循环里再重新映射
+    connect(m_log, &MappedLog::fileShrunk, this, &LogBrowserDialog::onFileShrunk, Qt::QueuedConnection);
+
+    if (!m_log->open(path)) {
+        m_statusLabel->setText("无法打开日志文件：" + m_log->errorString());
+        return;
+    }
+    updateStatus();
+}
+
+void LogBrowserDialog::updateStatus()
+{
+    if (!m_log->size()) {
+        m_statusLabel->setText("日志文件为空");
+        return;
+    }
+    double totalMb = m_log->size() / (1024.0 * 1024.0);
+    if (m_log->isIndexing()) {
+        m_statusLabel->setText(QString("正在建立索引：%1 / %2 MB，%3 行")
+                                   .arg(m_log->indexedBytes() / (1024.0 * 1024.0), 0, 'f', 1)
+                                   .arg(totalMb, 0, 'f', 1).arg(m_log->lineCount()));
+    } else {
+        m_statusLabel->setText(QString("%1 MB，%2 行").arg(totalMb, 0, 'f', 1).arg(m_log->lineCount()));
+    }
+}
+
+void LogBrowserDialog::onIndexFinished()
+{
+    updateStatus();
+    // 默认跳转时间取最后一行的时间，方便往前查
+    qint64 last = LogLine::parseTimestamp(m_log->lineData(m_log->lineCount() - 1));
+    if (last >= 0) {
+        m_timeEdit->setDateTime(QDateTime::fromMSecsSinceEpoch(last));
+    }
+}
+
+void LogBrowserDialog::onReloadClicked()
+{
+    if (!m_log->refresh() && !m_log->open(m_log->path())) {
+        m_statusLabel->setText("无法打开日志文件：" + m_log->errorString());
+        return;
+    }
+    m_searchButton->setEnabled(true);
+    updateStatus();
+}
+
+void LogBrowserDialog::onFileShrunk()
+{
+    m_resultList->clear();
+    m_searchLabel->setText("日志文件被截断或轮转，已重新加载");
+    onReloadClicked();
+}
+
+void LogBrowserDialog::showLine(qint64 line)
+{
+    if (line < 0 || line >= m_model->rowCount()) {
+        return;
+    }
+    QModelIndex index = m_model->index(int(line), LogFileModel::MessageColumn);
+    m_view->scrollTo(index, QAbstractItemView::PositionAtCenter);
+    m_view->selectRow(int(line));
+}
+
+void LogBrowserDialog::onJumpClicked()
+{
+    qint64 line = m_log->lineAtTime(m_timeEdit->dateTime().toMSecsSinceEpoch());
+    if (line < 0) {
+        return;
+    }
+    showLine(line);
+    if (m_log->isIndexing()) {
+        m_statusLabel->setText("索引尚未完成，只在已索引的部分中查找");
+    }
+}
+
+void LogBrowserDialog::onSearchClicked()
+{
+    QString text = m_searchEdit->text();
+    if (text.isEmpty()) {
+        return;
+    }
+    QRegularExpression pattern(text, m_caseCheck->isChecked()
+                                         ? QRegularExpression::NoPatternOption
+                                         : QRegularExpression::CaseInsensitiveOption);
+    if (!pattern.isValid()) {
+        QMessageBox::warning(this, "搜索", "正则表达式无效：" + pattern.errorString());
+        return;
+    }
+
+    m_resultList->clear();
+    m_searchLabel->setText("正在搜索…");
+    m_searchButton->setEnabled(false);
+    m_log->startSearch(pattern, kMaxSearchResults);
+}
+
+void LogBrowserDialog::onSearchFinished(const QList<qint64>& offsets, bool truncated, qint64 elapsedMs)
+{
+    m_searchButton->setEnabled(true);
+    m_searchLabel->setText(QString("找到 %1%2 行，用时 %3 ms")
+                               .arg(offsets.size()).arg(truncated ? "+" : "").arg(elapsedMs));
+
+    for (qint64 offset : offsets) {
+        qint64 line = m_log->lineAtOffset(offset);
+        QByteArray data = line >= 0 ? m_log->lineData(line) : QByteArray();
+        QString text = line >= 0
+                           ? QString("%1: %2").arg(line + 1).arg(QString::fromUtf8(data.left(300)))
+                           : QString("偏移 %1（尚未索引）").arg(offset);
+        QListWidgetItem* item = new QListWidgetItem(text, m_resultList);
+        item->setData(Qt::UserRole, line);
+    }
+}
+
+void LogBrowserDialog::onResultClicked(QListWidgetItem* item)
+{
+    showLine(item->data(Qt::UserRole).toLongLong());
+}
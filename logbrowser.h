@@ -0,0 +1,86 @@
+#ifndef LOGBROWSER_H
+#define LOGBROWSER_H
+
+#include <QAbstractTableModel>
+#include <QDialog>
+#include "logbuffer.h"
+
+class MappedLog;
+class QTableView;
+class QListWidget;
+class QListWidgetItem;
+class QLineEdit;
+class QCheckBox;
+class QDateTimeEdit;
+class QPushButton;
+class QLabel;
+
+// MappedLog 的表格模型，行数随索引进度增长，每行在显示时才从映射中读取和解析
+class LogFileModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        LineColumn,
+        TimeColumn,
+        PidColumn,
+        RoleColumn,
+        LevelColumn,
+        MessageColumn,
+        ColumnCount
+    };
+
+    explicit LogFileModel(MappedLog* log, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private slots:
+    void onIndexProgress();
+    void onIndexReset();
+
+private:
+    MappedLog* m_log;
+    int m_rows;
+    mutable qint64 m_cachedLineNumber;
+    mutable LogLine m_cachedLine;
+};
+
+// 历史日志浏览：按时间跳转、正则搜索整个文件，文件大小不影响内存占用
+class LogBrowserDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LogBrowserDialog(const QString& path, QWidget *parent = nullptr);
+
+private slots:
+    void onReloadClicked();
+    void onJumpClicked();
+    void onSearchClicked();
+    void onSearchFinished(const QList<qint64>& offsets, bool truncated, qint64 elapsedMs);
+    void onResultClicked(QListWidgetItem* item);
+    void onIndexFinished();
+    void onFileShrunk();
+    void updateStatus();
+
+private:
+    void showLine(qint64 line);
+
+private:
+    MappedLog* m_log;
+    LogFileModel* m_model;
+    QTableView* m_view;
+    QDateTimeEdit* m_timeEdit;
+    QLineEdit* m_searchEdit;
+    QCheckBox* m_caseCheck;
+    QPushButton* m_searchButton;
+    QListWidget* m_resultList;
+    QLabel* m_statusLabel;
+    QLabel* m_searchLabel;
+};
+
+#endif // LOGBROWSER_H
@@ -0,0 +1,239 @@
+#include "logbuffer.h"
+#include <QDate>
+#include <QTime>
+#include <QDateTime>
+#include <cstring>
+
+static qint64 parseTimeText(const QByteArray& text)
+{
+    // "17 Oct 2026 10:00:00.123"
+    static const char* const months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+
+    const QList<QByteArray> parts = text.split(' ');
+    if (parts.size() != 4 || parts.at(1).size() != 3) {
+        return -1;
+    }
+    int month = 0;
+    for (int i = 0; i < 12; ++i) {
+        if (parts.at(1) == months[i]) {
+            month = i + 1;
+            break;
+        }
+    }
+    QDate date(parts.at(2).toInt(), month, parts.at(0).toInt());
+    QTime time = QTime::fromString(QString::fromLatin1(parts.at(3)), "hh:mm:ss.zzz");
+    if (!date.isValid() || !time.isValid()) {
+        return -1;
+    }
+    return QDateTime(date, time).toMSecsSinceEpoch();
+}
+
+// 找到 "pid:R <时间> L " 的各个位置，不是这种格式时返回 false
+static bool splitHeader(const QByteArray& raw, int* colon, int* timeEnd)
+{
+    *colon = raw.indexOf(':');
+    if (*colon <= 0 || *colon > 10 || *colon + 3 >= raw.size() || raw.at(*colon + 2) != ' ') {
+        return false;
+    }
+    for (int i = 0; i < *colon; ++i) {
+        if (raw.at(i) < '0' || raw.at(i) > '9') {
+            return false;
+        }
+    }
+
+    // 时间由 4 段组成，后面是级别字符
+    int pos = *colon + 3;
+    for (int field = 0; field < 4; ++field) {
+        pos = raw.indexOf(' ', pos);
+        if (pos < 0) {
+            return false;
+        }
+        ++pos;
+    }
+    *timeEnd = pos - 1;
+    return pos < raw.size() && std::strchr(".-*#", raw.at(pos)) != nullptr;
+}
+
+LogLine LogLine::parse(const QByteArray& raw)
+{
+    LogLine line;
+    int colon = 0;
+    int timeEnd = 0;
+    if (!splitHeader(raw, &colon, &timeEnd)) {
+        line.message = raw;
+        return line;
+    }
+
+    line.pid = raw.left(colon).toLongLong();
+    line.role = raw.at(colon + 1);
+    line.timeText = raw.mid(colon + 3, timeEnd - colon - 3);
+    line.timestamp = parseTimeText(line.timeText);
+    switch (raw.at(timeEnd + 1)) {
+    case '.':
+        line.level = Debug;
+        break;
+    case '-':
+        line.level = Verbose;
+        break;
+    case '*':
+        line.level = Notice;
+        break;
+    default:
+        line.level = Warning;
+        break;
+    }
+    line.message = raw.mid(timeEnd + 3);
+    return line;
+}
+
+qint64 LogLine::parseTimestamp(const QByteArray& raw)
+{
+    int colon = 0;
+    int timeEnd = 0;
+    if (!splitHeader(raw, &colon, &timeEnd)) {
+        return -1;
+    }
+    return parseTimeText(raw.mid(colon + 3, timeEnd - colon - 3));
+}
+
+QString LogLine::levelName(Level level)
+{
+    switch (level) {
+    case Debug:
+        return "debug";
+    case Verbose:
+        return "verbose";
+    case Notice:
+        return "notice";
+    case Warning:
+        return "warning";
+    default:
+        return QString();
+    }
+}
+
+QString LogLine::roleName(char role)
+{
+    switch (role) {
+    case 'M':
+        return "主节点";
+    case 'S':
+        return "副本";
+    case 'C':
+        return "子进程";
+    case 'X':
+        return "哨兵";
+    default:
+        return QString();
+    }
+}
+
+LogRingBuffer::LogRingBuffer(qint64 capacity, QObject *parent)
+    : QObject(parent)
+    , m_written(0)
+    , m_pendingStart(0)
+    , m_firstLine(0)
+    , m_maxLines(qMax<qint64>(1024, capacity / 16))
+{
+    m_data.resize(int(qMax<qint64>(4096, capacity)));
+}
+
+void LogRingBuffer::clear()
+{
+    m_lineStarts.clear();
+    m_firstLine = m_written = m_pendingStart = 0;
+    emit linesDropped(0);
+}
+
+void LogRingBuffer::copyIn(const char* data, qint64 size)
+{
+    const qint64 capacity = m_data.size();
+    char* buffer = m_data.data();
+    while (size > 0) {
+        qint64 offset = m_written % capacity;
+        qint64 chunk = qMin(size, capacity - offset);
+        std::memcpy(buffer + offset, data, size_t(chunk));
+        data += chunk;
+        size -= chunk;
+        m_written += chunk;
+    }
+}
+
+void LogRingBuffer::append(const QByteArray& data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    qint64 before = endLine();
+    qint64 base = m_written;
+
+    // 只记录换行的位置，不做任何解析
+    const char* begin = data.constData();
+    const char* end = begin + data.size();
+    for (const char* p = begin; p < end;) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        if (!newline) {
+            break;
+        }
+        m_lineStarts.push_back(m_pendingStart);
+        m_pendingStart = base + (newline - begin) + 1;
+        p = newline + 1;
+    }
+
+    // 一次写入超过容量时只有最后 capacity 字节有意义
+    qint64 skip = qMax<qint64>(0, data.size() - m_data.size());
+    m_written += skip;
+    copyIn(begin + skip, data.size() - skip);
+
+    qint64 first = m_firstLine;
+    dropLines();
+    if (m_firstLine != first) {
+        emit linesDropped(m_firstLine);
+    }
+    if (endLine() > before) {
+        emit linesAppended(qMax(before, m_firstLine), endLine());
+    }
+}
+
+void LogRingBuffer::dropLines()
+{
+    qint64 oldest = m_written - m_data.size();
+    while (!m_lineStarts.empty()
+           && (m_lineStarts.front() < oldest || qint64(m_lineStarts.size()) > m_maxLines)) {
+        m_lineStarts.pop_front();
+        ++m_firstLine;
+    }
+    // 超长的一行开头已被覆盖，保留剩下的部分
+    if (m_pendingStart < oldest) {
+        m_pendingStart = oldest;
+    }
+}
+
+QByteArray LogRingBuffer::lineData(qint64 line) const
+{
+    if (line < m_firstLine || line >= endLine()) {
+        return QByteArray();
+    }
+
+    size_t index = size_t(line - m_firstLine);
+    qint64 start = m_lineStarts[index];
+    qint64 stop = (index + 1 < m_lineStarts.size() ? m_lineStarts[index + 1] : m_pendingStart) - 1;
+    if (stop > start && m_data.at(int((stop - 1) % m_data.size())) == '\r') {
+        --stop;
+    }
+
+    const qint64 capacity = m_data.size();
+    QByteArray result;
+    result.resize(int(stop - start));
+    qint64 copied = 0;
+    while (copied < result.size()) {
+        qint64 offset = (start + copied) % capacity;
+        qint64 chunk = qMin<qint64>(result.size() - copied, capacity - offset);
+        std::memcpy(result.data() + copied, m_data.constData() + offset, size_t(chunk));
+        copied += chunk;
+    }
+    return result;
+}
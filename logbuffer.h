@@ -0,0 +1,79 @@
+#ifndef LOGBUFFER_H
+#define LOGBUFFER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <deque>
+
+// redis.log 中的一行：
+//   12345:M 17 Oct 2026 10:00:00.123 * Ready to accept connections tcp
+// 角色 M 主节点、S 副本、C 子进程（BGSAVE / AOF 重写）、X 哨兵；
+// 级别 '.' debug、'-' verbose、'*' notice、'#' warning。
+// 不符合这个格式的行（如启动前打印的 logo）整行作为消息，级别为 Unknown
+struct LogLine
+{
+    enum Level {
+        Debug,
+        Verbose,
+        Notice,
+        Warning,
+        Unknown
+    };
+
+    qint64 pid = 0;
+    char role = 0;
+    qint64 timestamp = -1;      // 本地时间的毫秒数（msecs since epoch），解析失败为 -1
+    Level level = Unknown;
+    QByteArray timeText;
+    QByteArray message;
+
+    static LogLine parse(const QByteArray& raw);
+    // 只解析时间戳，供按时间定位使用
+    static qint64 parseTimestamp(const QByteArray& raw);
+    static QString levelName(Level level);
+    static QString roleName(char role);
+};
+
+// 固定内存的日志环形缓冲区：只保存原始字节和每行的起始位置，
+// 行的内容在显示时才解析（LogLine::parse）。写满后覆盖最旧的数据。
+// 行号是从启动开始的序号，不随覆盖变化，[firstLine(), endLine()) 为当前保留的行
+class LogRingBuffer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LogRingBuffer(qint64 capacity = 8 * 1024 * 1024, QObject *parent = nullptr);
+
+    qint64 capacity() const { return m_data.size(); }
+    void append(const QByteArray& data);
+    void clear();
+
+    qint64 firstLine() const { return m_firstLine; }
+    qint64 endLine() const { return m_firstLine + qint64(m_lineStarts.size()); }
+    // 不含换行符
+    QByteArray lineData(qint64 line) const;
+    LogLine line(qint64 line) const { return LogLine::parse(lineData(line)); }
+
+signals:
+    // 新增了 [first, end) 行
+    void linesAppended(qint64 first, qint64 end);
+    // 最旧的行被覆盖，现在从 first 开始
+    void linesDropped(qint64 first);
+
+private:
+    void copyIn(const char* data, qint64 size);
+    void dropLines();
+
+private:
+    QByteArray m_data;
+    // 从启动开始写入的总字节数；位置 p 的字节保存在 m_data[p % capacity]
+    qint64 m_written;
+    // 已完整（遇到换行）的每一行的起始位置，以及正在写入的最后一行的起始位置
+    std::deque<qint64> m_lineStarts;
+    qint64 m_pendingStart;
+    qint64 m_firstLine;
+    // 行数上限，避免大量空行使行索引占用的内存超过数据本身
+    qint64 m_maxLines;
+};
+
+#endif // LOGBUFFER_H
@@ -0,0 +1,172 @@
+#include "logtailer.h"
+#include "logbuffer.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <QFileSystemWatcher>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// 每次最多读取的字节数，大量追加时分多次读完，不一次占用大块内存
+static const qint64 kReadChunk = 1024 * 1024;
+
+LogTailer::LogTailer(LogRingBuffer* buffer, QObject *parent)
+    : QObject(parent)
+    , m_buffer(buffer)
+    , m_offset(0)
+    , m_inotifyFd(-1)
+    , m_notifier(nullptr)
+    , m_watcher(nullptr)
+{
+}
+
+LogTailer::~LogTailer()
+{
+    stop();
+}
+
+void LogTailer::start(const QString& path)
+{
+    stop();
+    m_path = path;
+    QString dir = QFileInfo(path).absolutePath();
+    QDir().mkpath(dir);
+
+#ifdef Q_OS_LINUX
+    // 监视目录而不是文件：文件还不存在或被轮转时同样能收到事件
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0
+        && inotify_add_watch(m_inotifyFd, QFile::encodeName(dir).constData(),
+                             IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) >= 0) {
+        m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &LogTailer::onInotifyEvent);
+    } else {
+        qDebug() << "[LogTailer] inotify unavailable, falling back to QFileSystemWatcher";
+        if (m_inotifyFd >= 0) {
+            ::close(m_inotifyFd);
+            m_inotifyFd = -1;
+        }
+    }
+#endif
+
+    if (!m_notifier) {
+        m_watcher = new QFileSystemWatcher(this);
+        m_watcher->addPath(dir);
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &LogTailer::readNew);
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &LogTailer::readNew);
+    }
+
+    reopen();
+}
+
+void LogTailer::stop()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    delete m_watcher;
+    m_watcher = nullptr;
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+#endif
+    m_file.close();
+    m_path.clear();
+}
+
+void LogTailer::reopen()
+{
+    m_file.close();
+    m_file.setFileName(m_path);
+    m_offset = 0;
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    // 已有的大文件只取最后一段，从下一个完整行开始
+    qint64 size = m_file.size();
+    if (size > m_buffer->capacity()) {
+        m_offset = size - m_buffer->capacity();
+        m_file.seek(m_offset);
+        QByteArray partial = m_file.readLine(kReadChunk);
+        m_offset += partial.size();
+    }
+    if (m_watcher && !m_watcher->files().contains(m_path)) {
+        m_watcher->addPath(m_path);
+    }
+    readNew();
+}
+
+void LogTailer::onInotifyEvent()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char events[4096];
+    const QByteArray name = QFile::encodeName(QFileInfo(m_path).fileName());
+    bool modified = false;
+    bool replaced = false;
+
+    for (;;) {
+        ssize_t length = ::read(m_inotifyFd, events, sizeof(events));
+        if (length <= 0) {
+            break;
+        }
+        for (char* p = events; p < events + length;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0 || name != event->name) {
+                continue;
+            }
+            if (event->mask & (IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE)) {
+                replaced = true;
+            } else if (event->mask & IN_MODIFY) {
+                modified = true;
+            }
+        }
+    }
+
+    if (replaced) {
+        // 轮转前的文件可能还有没读完的内容，先读完再切换
+        if (m_file.isOpen()) {
+            readNew();
+        }
+        reopen();
+    } else if (modified) {
+        readNew();
+    }
+#endif
+}
+
+void LogTailer::readNew()
+{
+    if (!m_file.isOpen()) {
+        if (QFile::exists(m_path)) {
+            reopen();
+        }
+        return;
+    }
+
+    qint64 size = m_file.size();
+    if (size < m_offset) {
+        // 被截断（如 > redis.log）后从头读
+        m_offset = 0;
+    }
+    if (m_watcher && !QFile::exists(m_path)) {
+        m_file.close();
+        return;
+    }
+
+    m_file.seek(m_offset);
+    while (m_offset < size) {
+        QByteArray data = m_file.read(qMin(kReadChunk, size - m_offset));
+        if (data.isEmpty()) {
+            break;
+        }
+        m_offset += data.size();
+        m_buffer->append(data);
+    }
+}
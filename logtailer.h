@@ -0,0 +1,45 @@
+#ifndef LOGTAILER_H
+#define LOGTAILER_H
+
+#include <QObject>
+#include <QString>
+#include <QFile>
+
+class LogRingBuffer;
+class QSocketNotifier;
+class QFileSystemWatcher;
+
+// 跟踪 redis.log 的新增内容并写入 LogRingBuffer。Linux 上用 inotify 监视所在目录，
+// 文件被创建、轮转（改名后重新创建）或截断时都能接上；其他平台用 QFileSystemWatcher。
+// 开始时只读取文件末尾不超过缓冲区容量的部分，几 GB 的日志也不会整个读入
+class LogTailer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LogTailer(LogRingBuffer* buffer, QObject *parent = nullptr);
+    ~LogTailer();
+
+    void start(const QString& path);
+    void stop();
+    bool isRunning() const { return !m_path.isEmpty(); }
+    QString path() const { return m_path; }
+
+private slots:
+    void onInotifyEvent();
+    void readNew();
+
+private:
+    void reopen();
+
+private:
+    LogRingBuffer* m_buffer;
+    QString m_path;
+    QFile m_file;
+    qint64 m_offset;
+    int m_inotifyFd;
+    QSocketNotifier* m_notifier;
+    QFileSystemWatcher* m_watcher;
+};
+
+#endif // LOGTAILER_H
@@ -0,0 +1,320 @@
+#include "logviewer.h"
+#include "logbrowser.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QTableView>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTimer>
+#include <QDateTime>
+#include <QColor>
+#include <QDialogButtonBox>
+#include <QPushButton>
+
+static const int kAllLevels = (1 << (LogLine::Unknown + 1)) - 1;
+
+LogModel::LogModel(LogRingBuffer* buffer, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_buffer(buffer)
+    , m_levels(kAllLevels)
+    , m_shownFirst(buffer->firstLine())
+    , m_shownEnd(buffer->endLine())
+    , m_cachedLineNumber(-1)
+{
+    connect(buffer, &LogRingBuffer::linesAppended, this, &LogModel::onLinesAppended);
+    connect(buffer, &LogRingBuffer::linesDropped, this, &LogModel::onLinesDropped);
+}
+
+int LogModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return isFiltering() ? int(m_rows.size()) : int(m_shownEnd - m_shownFirst);
+}
+
+int LogModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+bool LogModel::isFiltering() const
+{
+    return m_levels != kAllLevels || !m_search.isEmpty();
+}
+
+qint64 LogModel::lineAt(int row) const
+{
+    return isFiltering() ? m_rows[size_t(row)] : m_shownFirst + row;
+}
+
+const LogLine& LogModel::cachedLine(qint64 line) const
+{
+    if (line != m_cachedLineNumber) {
+        m_cachedLine = m_buffer->line(line);
+        m_cachedLineNumber = line;
+    }
+    return m_cachedLine;
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+
+    const LogLine& line = cachedLine(lineAt(index.row()));
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case TimeColumn:
+            return QString::fromLatin1(line.timeText);
+        case PidColumn:
+            return line.pid > 0 ? QVariant(line.pid) : QVariant();
+        case RoleColumn:
+            return LogLine::roleName(line.role);
+        case LevelColumn:
+            return LogLine::levelName(line.level);
+        case MessageColumn:
+            return QString::fromUtf8(line.message);
+        default:
+            break;
+        }
+    } else if (role == Qt::ForegroundRole) {
+        if (line.level == LogLine::Warning) {
+            return QColor("#c62828");
+        }
+        if (line.level == LogLine::Debug || line.level == LogLine::Verbose) {
+            return QColor("#757575");
+        }
+    } else if (role == Qt::ToolTipRole && index.column() == TimeColumn && line.timestamp >= 0) {
+        return QDateTime::fromMSecsSinceEpoch(line.timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz");
+    }
+    return QVariant();
+}
+
+QVariant LogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case TimeColumn:
+        return "时间";
+    case PidColumn:
+        return "PID";
+    case RoleColumn:
+        return "角色";
+    case LevelColumn:
+        return "级别";
+    case MessageColumn:
+        return "消息";
+    default:
+        return QVariant();
+    }
+}
+
+bool LogModel::matches(qint64 line) const
+{
+    QByteArray raw = m_buffer->lineData(line);
+    if (m_levels != kAllLevels && !(m_levels & (1 << LogLine::parse(raw).level))) {
+        return false;
+    }
+    return m_search.isEmpty() || raw.toLower().contains(m_search);
+}
+
+void LogModel::setFilter(int levels, const QString& search)
+{
+    beginResetModel();
+    m_levels = levels & kAllLevels;
+    m_search = search.trimmed().toLower().toUtf8();
+    m_rows.clear();
+    m_shownFirst = m_buffer->firstLine();
+    m_shownEnd = m_buffer->endLine();
+    if (isFiltering()) {
+        for (qint64 line = m_shownFirst; line < m_shownEnd; ++line) {
+            if (matches(line)) {
+                m_rows.push_back(line);
+            }
+        }
+    }
+    m_cachedLineNumber = -1;
+    endResetModel();
+}
+
+void LogModel::onLinesAppended(qint64 first, qint64 end)
+{
+    if (!isFiltering()) {
+        first = qMax(first, m_shownEnd);
+        if (end <= first) {
+            return;
+        }
+        beginInsertRows(QModelIndex(), rowCount(), rowCount() + int(end - first) - 1);
+        m_shownEnd = end;
+        endInsertRows();
+        return;
+    }
+
+    QList<qint64> added;
+    for (qint64 line = qMax(first, m_shownEnd); line < end; ++line) {
+        if (matches(line)) {
+            added << line;
+        }
+    }
+    m_shownEnd = end;
+    if (added.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + added.size() - 1);
+    m_rows.insert(m_rows.end(), added.begin(), added.end());
+    endInsertRows();
+}
+
+void LogModel::onLinesDropped(qint64 first)
+{
+    if (first < m_shownFirst || m_buffer->endLine() < m_shownEnd) {
+        // 缓冲区被清空，行号从头开始
+        setFilter(m_levels, QString::fromUtf8(m_search));
+        return;
+    }
+
+    m_cachedLineNumber = -1;
+    if (!isFiltering()) {
+        qint64 end = qMin(first, m_shownEnd);
+        if (end > m_shownFirst) {
+            beginRemoveRows(QModelIndex(), 0, int(end - m_shownFirst) - 1);
+            m_shownFirst = end;
+            endRemoveRows();
+        }
+        m_shownFirst = first;
+        m_shownEnd = qMax(m_shownEnd, first);
+        return;
+    }
+
+    int count = 0;
+    while (count < int(m_rows.size()) && m_rows[size_t(count)] < first) {
+        ++count;
+    }
+    m_shownFirst = first;
+    if (count > 0) {
+        beginRemoveRows(QModelIndex(), 0, count - 1);
+        m_rows.erase(m_rows.begin(), m_rows.begin() + count);
+        endRemoveRows();
+    }
+}
+
+LogViewerDialog::LogViewerDialog(LogRingBuffer* buffer, const QString& logPath, QWidget *parent)
+    : QDialog(parent)
+    , m_buffer(buffer)
+{
+    setWindowTitle("Redis 日志");
+    resize(900, 600);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QLabel* pathLabel = new QLabel(logPath);
+    pathLabel->setObjectName("hintLabel");
+    mainLayout->addWidget(pathLabel);
+
+    QWidget* filterWidget = new QWidget();
+    QHBoxLayout* filterLayout = new QHBoxLayout(filterWidget);
+    filterLayout->setContentsMargins(0, 0, 0, 0);
+
+    const QList<LogLine::Level> levels = QList<LogLine::Level>()
+        << LogLine::Warning << LogLine::Notice << LogLine::Verbose << LogLine::Debug << LogLine::Unknown;
+    for (LogLine::Level level : levels) {
+        QCheckBox* check = new QCheckBox(level == LogLine::Unknown ? QString("其他") : LogLine::levelName(level));
+        check->setChecked(true);
+        check->setProperty("level", int(level));
+        connect(check, &QCheckBox::toggled, this, &LogViewerDialog::applyFilter);
+        filterLayout->addWidget(check);
+        m_levelChecks << check;
+    }
+
+    m_searchEdit = new QLineEdit();
+    m_searchEdit->setObjectName("inputField");
+    m_searchEdit->setPlaceholderText("搜索");
+    m_searchEdit->setClearButtonEnabled(true);
+    filterLayout->addWidget(m_searchEdit, 1);
+
+    m_followCheck = new QCheckBox("跟随最新");
+    m_followCheck->setChecked(true);
+    filterLayout->addWidget(m_followCheck);
+    mainLayout->addWidget(filterWidget);
+
+    // 输入停顿后再过滤，避免每个字符都扫描一遍缓冲区
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(250);
+    connect(m_searchEdit, &QLineEdit::textChanged, m_searchTimer, QOverload<>::of(&QTimer::start));
+    connect(m_searchTimer, &QTimer::timeout, this, &LogViewerDialog::applyFilter);
+
+    m_model = new LogModel(buffer, this);
+    m_view = new QTableView();
+    m_view->setModel(m_model);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setWordWrap(false);
+    m_view->setAlternatingRowColors(true);
+    // 固定行高：视图只查询可见的行，几十万行也能直接滚动
+    m_view->verticalHeader()->setVisible(false);
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(fontMetrics().height() + 4);
+    m_view->horizontalHeader()->setStretchLastSection(true);
+    m_view->setColumnWidth(LogModel::TimeColumn, 190);
+    m_view->setColumnWidth(LogModel::PidColumn, 70);
+    m_view->setColumnWidth(LogModel::RoleColumn, 60);
+    m_view->setColumnWidth(LogModel::LevelColumn, 70);
+    mainLayout->addWidget(m_view);
+
+    m_statusLabel = new QLabel();
+    m_statusLabel->setObjectName("hintLabel");
+    mainLayout->addWidget(m_statusLabel);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    // 缓冲区只保留最近 8 MB，更早的内容在完整的日志文件中查看
+    QPushButton* historyButton = buttons->addButton("历史日志…", QDialogButtonBox::ActionRole);
+    connect(historyButton, &QPushButton::clicked, this, [this, logPath]() {
+        LogBrowserDialog dialog(logPath, this);
+        dialog.exec();
+    });
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttons);
+
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &LogViewerDialog::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, &LogViewerDialog::updateStatus);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &LogViewerDialog::updateStatus);
+
+    updateStatus();
+    m_view->scrollToBottom();
+}
+
+void LogViewerDialog::applyFilter()
+{
+    int levels = 0;
+    for (QCheckBox* check : m_levelChecks) {
+        if (check->isChecked()) {
+            levels |= 1 << check->property("level").toInt();
+        }
+    }
+    m_model->setFilter(levels, m_searchEdit->text());
+    if (m_followCheck->isChecked()) {
+        m_view->scrollToBottom();
+    }
+}
+
+void LogViewerDialog::onRowsInserted()
+{
+    updateStatus();
+    if (m_followCheck->isChecked()) {
+        m_view->scrollToBottom();
+    }
+}
+
+void LogViewerDialog::updateStatus()
+{
+    m_statusLabel->setText(QString("显示 %1 / %2 行（缓冲区 %3 MB）")
+                               .arg(m_model->rowCount()).arg(m_model->totalLines())
+                               .arg(m_buffer->capacity() / (1024 * 1024)));
+}
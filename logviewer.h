@@ -0,0 +1,91 @@
+#ifndef LOGVIEWER_H
+#define LOGVIEWER_H
+
+#include <QAbstractTableModel>
+#include <QDialog>
+#include <QString>
+#include <deque>
+#include "logbuffer.h"
+
+class QTableView;
+class QCheckBox;
+class QLineEdit;
+class QLabel;
+class QTimer;
+
+// LogRingBuffer 的表格模型。没有过滤条件时行号直接对应缓冲区的行，不额外占内存；
+// 有过滤条件时保存匹配的行号，新增的行只检查新增部分。每行在显示时才解析
+class LogModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        TimeColumn,
+        PidColumn,
+        RoleColumn,
+        LevelColumn,
+        MessageColumn,
+        ColumnCount
+    };
+
+    explicit LogModel(LogRingBuffer* buffer, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // levels 为按 LogLine::Level 编号的位掩码；search 不区分大小写，为空时不过滤
+    void setFilter(int levels, const QString& search);
+    bool isFiltering() const;
+    qint64 totalLines() const { return m_buffer->endLine() - m_buffer->firstLine(); }
+
+private slots:
+    void onLinesAppended(qint64 first, qint64 end);
+    void onLinesDropped(qint64 first);
+
+private:
+    bool matches(qint64 line) const;
+    qint64 lineAt(int row) const;
+    const LogLine& cachedLine(qint64 line) const;
+
+private:
+    LogRingBuffer* m_buffer;
+    int m_levels;
+    QByteArray m_search;
+    // 不过滤时显示 [m_shownFirst, m_shownEnd)；过滤时显示 m_rows 中的行
+    qint64 m_shownFirst;
+    qint64 m_shownEnd;
+    std::deque<qint64> m_rows;
+
+    // 同一行的各列依次取数据，只解析一次
+    mutable qint64 m_cachedLineNumber;
+    mutable LogLine m_cachedLine;
+};
+
+// 实时日志窗口：按级别过滤、搜索，默认跟随最新的日志
+class LogViewerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LogViewerDialog(LogRingBuffer* buffer, const QString& logPath, QWidget *parent = nullptr);
+
+private slots:
+    void applyFilter();
+    void onRowsInserted();
+    void updateStatus();
+
+private:
+    LogRingBuffer* m_buffer;
+    LogModel* m_model;
+    QTableView* m_view;
+    QList<QCheckBox*> m_levelChecks;
+    QLineEdit* m_searchEdit;
+    QCheckBox* m_followCheck;
+    QLabel* m_statusLabel;
+    QTimer* m_searchTimer;
+};
+
+#endif // LOGVIEWER_H
@@ -4,6 +4,17 @@
 #include "redismanager.h"
 #include "serviceconfig.h"
 #include "portchecker.h"
+#include "redisconfig.h"
+#include "tuningdialog.h"
+#include "instancesdialog.h"
+#include "placementdialog.h"
+#include "logviewer.h"
+#include "metricsdialog.h"
+#include "latencydialog.h"
+#include "latencyprober.h"
+#include "intrinsiclatencydialog.h"
+#include "instanceregistry.h"
+#include "redisinstance.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
@@ -11,18 +22,20 @@
 #include <QRegularExpressionValidator>
 #include <QRegularExpression>
 #include <QProgressBar>
+#include <QShowEvent>
+#include <QHideEvent>
 #include <QDebug>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , m_isServiceRunning(false)
+    , m_stopRequested(false)
 {
     ui->setupUi(this);
     
     m_serviceManager = new ServiceManager(this);
     m_redisManager = new RedisManager(this);
-    m_statusTimer = new QTimer(this);
     
     setupUI();
     applyModernStyle();
@@ -34,12 +47,36 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onRedisDownloadFinished);
     connect(m_redisManager, &RedisManager::installationProgress,
             this, &MainWindow::onRedisInstallationProgress);
+    connect(m_redisManager, &RedisManager::activeVersionChanged,
+            this, &MainWindow::refreshVersionList);
+    connect(m_redisManager, &RedisManager::installationStepFinished,
+            this, &MainWindow::onRedisInstallationStepFinished);
     connect(m_redisManager, &RedisManager::installationFinished,
             this, &MainWindow::onRedisInstallationFinished);
+    connect(m_redisManager, &RedisManager::benchmarkFinished,
+            this, &MainWindow::onRedisBenchmarkFinished);
+    connect(m_redisManager, &RedisManager::redisReady,
+            this, &MainWindow::onRedisReady);
+    connect(m_redisManager, &RedisManager::redisLoadingProgress,
+            this, &MainWindow::onRedisLoadingProgress);
+    connect(m_redisManager, &RedisManager::redisStartFailed,
+            this, &MainWindow::onRedisStartFailed);
+    connect(m_redisManager, &RedisManager::redisStopped,
+            this, &MainWindow::onRedisStopped);
+    connect(m_redisManager, &RedisManager::redisStopProgress,
+            this, &MainWindow::onRedisStopProgress);
+    connect(m_redisManager, &RedisManager::redisStopFailed,
+            this, &MainWindow::onRedisStopFailed);
+    connect(m_redisManager, &RedisManager::configApplied,
+            this, &MainWindow::onRedisConfigApplied);
     
-    // 每 2 秒更新服务状态
-    connect(m_statusTimer, &QTimer::timeout, this, &MainWindow::updateServiceStatus);
-    m_statusTimer->start(2000);
+    // 状态由事件驱动：进程启动 / 退出来自 QProcess，卡住与恢复来自心跳，不再定时轮询
+    connect(m_redisManager, &RedisManager::redisStarted,
+            this, &MainWindow::updateServiceStatus);
+    connect(m_redisManager, &RedisManager::redisHealthChanged,
+            this, &MainWindow::updateServiceStatus);
+    connect(m_redisManager, &RedisManager::errorOccurred,
+            this, &MainWindow::updateServiceStatus);
     
     // 启动时立即检查服务状态
     QTimer::singleShot(100, this, &MainWindow::updateServiceStatus);
@@ -159,7 +196,40 @@ void MainWindow::setupUI()
     m_applyButton = new QPushButton("应用更改");
     m_applyButton->setObjectName("applyButton");
     
+    m_tuningButton = new QPushButton("⚙ 性能参数");
+    m_tuningButton->setObjectName("applyButton");
+    
+    m_instancesButton = new QPushButton("🗂 多实例");
+    m_instancesButton->setObjectName("applyButton");
+    
     configLayout->addWidget(m_applyButton);
+    configLayout->addWidget(m_tuningButton);
+    configLayout->addWidget(m_instancesButton);
+    
+    // 读取 /sys 下的 CPU 拓扑并在启动时设置亲和性，只支持 Linux
+    m_placementButton = new QPushButton("🧭 CPU 放置");
+    m_placementButton->setObjectName("applyButton");
+#ifdef Q_OS_LINUX
+    configLayout->addWidget(m_placementButton);
+#else
+    m_placementButton->setVisible(false);
+#endif
+    
+    m_logButton = new QPushButton("📄 日志");
+    m_logButton->setObjectName("applyButton");
+    configLayout->addWidget(m_logButton);
+    
+    m_metricsButton = new QPushButton("📈 指标");
+    m_metricsButton->setObjectName("applyButton");
+    configLayout->addWidget(m_metricsButton);
+    
+    m_latencyButton = new QPushButton("⏱ 延迟");
+    m_latencyButton->setObjectName("applyButton");
+    configLayout->addWidget(m_latencyButton);
+    
+    m_hostLatencyButton = new QPushButton("🩺 主机延迟");
+    m_hostLatencyButton->setObjectName("applyButton");
+    configLayout->addWidget(m_hostLatencyButton);
     mainLayout->addWidget(configGroup);
     
     QGroupBox* redisGroup = new QGroupBox("Redis 信息");
@@ -179,9 +249,20 @@ void MainWindow::setupUI()
                                      m_redisManager->getRedisVersion() : "未安装");
     m_redisVersionLabel->setObjectName("statusLabel");
     
+    // 已安装的各个版本，可直接切换
+    m_versionCombo = new QComboBox();
+    m_activateVersionButton = new QPushButton("切换版本");
+    m_activateVersionButton->setObjectName("applyButton");
+    
     versionLayout->addWidget(versionTitleLabel);
     versionLayout->addWidget(m_redisVersionLabel);
     versionLayout->addStretch();
+    versionLayout->addWidget(m_versionCombo);
+    versionLayout->addWidget(m_activateVersionButton);
+    
+    connect(m_activateVersionButton, &QPushButton::clicked,
+            this, &MainWindow::onActivateVersionClicked);
+    refreshVersionList();
     
     redisLayout->addWidget(versionWidget);
     
@@ -201,11 +282,55 @@ void MainWindow::setupUI()
     
     redisLayout->addWidget(pathWidget);
     
+    m_buildProfileCombo = nullptr;
+    m_allocatorCombo = nullptr;
+    
     if (!m_redisManager->isRedisInstalled()) {
+#ifndef Q_OS_WIN
+        // Linux 从源码编译，可选编译配置和内存分配器
+        QWidget* buildWidget = new QWidget();
+        QHBoxLayout* buildLayout = new QHBoxLayout(buildWidget);
+        buildLayout->setContentsMargins(0, 0, 0, 0);
+        
+        QLabel* profileTitleLabel = new QLabel("编译配置:");
+        profileTitleLabel->setObjectName("fieldLabel");
+        
+        m_buildProfileCombo = new QComboBox();
+        m_buildProfileCombo->addItem("默认", "default");
+        m_buildProfileCombo->addItem("-O3 -flto", "lto");
+        m_buildProfileCombo->addItem("-march=native（仅本机）", "native");
+        m_buildProfileCombo->addItem("PGO（两遍编译，较慢）", "pgo");
+        m_buildProfileCombo->setCurrentIndex(
+            qMax(0, m_buildProfileCombo->findData(m_redisManager->buildProfile())));
+        
+        QLabel* allocatorTitleLabel = new QLabel("内存分配器:");
+        allocatorTitleLabel->setObjectName("fieldLabel");
+        
+        m_allocatorCombo = new QComboBox();
+        m_allocatorCombo->addItem("jemalloc", "jemalloc");
+        m_allocatorCombo->addItem("libc", "libc");
+        m_allocatorCombo->setCurrentIndex(
+            qMax(0, m_allocatorCombo->findData(m_redisManager->buildAllocator())));
+        
+        buildLayout->addWidget(profileTitleLabel);
+        buildLayout->addWidget(m_buildProfileCombo);
+        buildLayout->addSpacing(12);
+        buildLayout->addWidget(allocatorTitleLabel);
+        buildLayout->addWidget(m_allocatorCombo);
+        buildLayout->addStretch();
+        
+        redisLayout->addWidget(buildWidget);
+#endif
+        
         m_downloadRedisButton = new QPushButton("📥 下载并安装 Redis");
         m_downloadRedisButton->setObjectName("downloadButton");
         redisLayout->addWidget(m_downloadRedisButton);
         
+        m_cancelInstallButton = new QPushButton("✖ 取消安装");
+        m_cancelInstallButton->setObjectName("cancelButton");
+        m_cancelInstallButton->setVisible(false);
+        redisLayout->addWidget(m_cancelInstallButton);
+        
         m_downloadProgressBar = new QProgressBar();
         m_downloadProgressBar->setObjectName("progressBar");
         m_downloadProgressBar->setVisible(false);
@@ -219,8 +344,11 @@ void MainWindow::setupUI()
         
         connect(m_downloadRedisButton, &QPushButton::clicked, 
                 this, &MainWindow::onDownloadRedisClicked);
+        connect(m_cancelInstallButton, &QPushButton::clicked,
+                this, &MainWindow::onCancelInstallClicked);
     } else {
         m_downloadRedisButton = nullptr;
+        m_cancelInstallButton = nullptr;
         m_downloadProgressBar = nullptr;
         m_installStatusLabel = nullptr;
     }
@@ -233,6 +361,13 @@ void MainWindow::setupUI()
     connect(m_stopButton, &QPushButton::clicked, this, &MainWindow::onStopServiceClicked);
     connect(m_uninstallButton, &QPushButton::clicked, this, &MainWindow::onUninstallClicked);
     connect(m_applyButton, &QPushButton::clicked, this, &MainWindow::onApplyConfigClicked);
+    connect(m_tuningButton, &QPushButton::clicked, this, &MainWindow::onTuningClicked);
+    connect(m_instancesButton, &QPushButton::clicked, this, &MainWindow::onInstancesClicked);
+    connect(m_placementButton, &QPushButton::clicked, this, &MainWindow::onPlacementClicked);
+    connect(m_logButton, &QPushButton::clicked, this, &MainWindow::onLogClicked);
+    connect(m_metricsButton, &QPushButton::clicked, this, &MainWindow::onMetricsClicked);
+    connect(m_latencyButton, &QPushButton::clicked, this, &MainWindow::onLatencyClicked);
+    connect(m_hostLatencyButton, &QPushButton::clicked, this, &MainWindow::onHostLatencyClicked);
     connect(m_portEdit, &QLineEdit::textChanged, this, &MainWindow::onPortTextChanged);
 }
 
@@ -386,6 +521,15 @@ void MainWindow::applyModernStyle()
             background-color: #95a5a6;
         }
         
+        #cancelButton {
+            background-color: #95a5a6;
+            color: white;
+        }
+        
+        #cancelButton:hover {
+            background-color: #7f8c8d;
+        }
+        
         #progressBar {
             border: 2px solid #e0e0e0;
             border-radius: 6px;
@@ -425,7 +569,8 @@ void MainWindow::onStartServiceClicked()
     QString password = m_passwordEdit->text();
     
     if (m_redisManager->startRedis(ip, port, password)) {
-        QMessageBox::information(this, "成功", "Redis 服务启动成功！");
+        // 就绪（数据加载完）后在 onRedisReady 中提示
+        m_loadingStatus.clear();
         updateServiceStatus();
     } else {
         QMessageBox::warning(this, "错误", "Redis 启动失败: " + m_redisManager->getLastError());
@@ -434,12 +579,11 @@ void MainWindow::onStartServiceClicked()
 
 void MainWindow::onStopServiceClicked()
 {
-    if (m_redisManager->stopRedis()) {
-        QMessageBox::information(this, "成功", "Redis 服务停止成功！");
-        updateServiceStatus();
-    } else {
-        QMessageBox::warning(this, "错误", "Redis 停止失败: " + m_redisManager->getLastError());
-    }
+    // 停止完成（快照保存完毕）后在 onRedisStopped 中提示
+    m_stopRequested = true;
+    m_stopStatus.clear();
+    m_redisManager->stopRedis();
+    updateServiceStatus();
 }
 
 void MainWindow::onUninstallClicked()
@@ -483,13 +627,122 @@ void MainWindow::onApplyConfigClicked()
     ServiceConfig::instance().setPassword(password);
     ServiceConfig::instance().save();
     
+    if (m_redisManager->isRedisReady()) {
+        // 运行中：能热更新的参数立即生效，结果在 onRedisConfigApplied 中提示
+        QMap<QString, QString> desired;
+        desired.insert("bind", ip);
+        desired.insert("port", QString::number(port));
+        desired.insert("requirepass", password);
+        m_applyButton->setEnabled(false);
+        m_redisManager->applyConfig(desired);
+        return;
+    }
+    
     if (m_redisManager->isRedisInstalled()) {
         m_redisManager->updateRedisConfig(ip, port, password);
     }
     
     QMessageBox::information(this, "成功", 
                             "配置更新成功！\n\n"
-                            "请重启 Redis 服务使更改生效。");
+                            "下次启动 Redis 服务时生效。");
+}
+
+void MainWindow::onTuningClicked()
+{
+    if (!m_redisManager->isRedisInstalled()) {
+        QMessageBox::warning(this, "错误", "Redis 尚未安装，请先下载并安装 Redis。");
+        return;
+    }
+    
+    TuningDialog dialog(m_redisManager->loadRedisConfig(), m_redisManager->activeVersion(),
+                        HostResources::detect(m_redisManager->getRedisPath()),
+                        ServiceConfig::instance().getWorkloadProfile(), this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    
+    ServiceConfig::instance().setWorkloadProfile(dialog.workload());
+    ServiceConfig::instance().save();
+    
+    QMap<QString, QString> changed = dialog.changedValues();
+    if (!changed.isEmpty()) {
+        m_applyButton->setEnabled(false);
+        m_redisManager->applyConfig(changed);
+    }
+}
+
+void MainWindow::onInstancesClicked()
+{
+    if (!m_redisManager->isRedisInstalled()) {
+        QMessageBox::warning(this, "多实例", "请先安装 Redis");
+        return;
+    }
+    
+    InstancesDialog dialog(m_redisManager->instanceRegistry(), m_ipEdit->text().trimmed(),
+                           m_passwordEdit->text(), ServiceConfig::instance().getWorkloadProfile(),
+                           m_redisManager->activeVersion(), this);
+    dialog.exec();
+}
+
+void MainWindow::onPlacementClicked()
+{
+    PlacementDialog dialog(m_redisManager, this);
+    dialog.exec();
+}
+
+void MainWindow::onLogClicked()
+{
+    LogViewerDialog dialog(m_redisManager->logBuffer(), m_redisManager->redisLogPath(), this);
+    dialog.exec();
+}
+
+void MainWindow::onMetricsClicked()
+{
+    MetricsDialog dialog(m_redisManager->metricsSampler(), m_redisManager->metricsStore(), this);
+    dialog.exec();
+}
+
+void MainWindow::onLatencyClicked()
+{
+    QList<LatencyProber*> probers;
+    probers << m_redisManager->latencyProber();
+    const QList<RedisInstance*> instances = m_redisManager->instanceRegistry()->instances();
+    for (RedisInstance* instance : instances) {
+        probers << instance->latencyProber();
+    }
+    LatencyDialog dialog(probers, this);
+    dialog.exec();
+}
+
+void MainWindow::onHostLatencyClicked()
+{
+    IntrinsicLatencyDialog dialog(m_redisManager, this);
+    dialog.exec();
+}
+
+void MainWindow::onRedisConfigApplied(const QStringList& appliedLive, const QStringList& restartRequired,
+                                      const QStringList& failed)
+{
+    m_applyButton->setEnabled(true);
+    
+    if (appliedLive.isEmpty() && restartRequired.isEmpty() && failed.isEmpty()) {
+        QMessageBox::information(this, "成功", "配置没有变化。");
+        return;
+    }
+    
+    QString message;
+    if (!appliedLive.isEmpty()) {
+        message += "已立即生效（无需重启）：" + appliedLive.join(", ") + "\n";
+    }
+    if (!restartRequired.isEmpty()) {
+        message += "已写入配置文件，重启 Redis 服务后生效：" + restartRequired.join(", ") + "\n";
+    }
+    if (!failed.isEmpty()) {
+        message += "\n设置失败：\n" + failed.join("\n");
+        QMessageBox::warning(this, "部分配置未生效", message);
+        return;
+    }
+    QMessageBox::information(this, "成功", "配置更新成功！\n\n" + message);
 }
 
 void MainWindow::onPortTextChanged(const QString& text)
@@ -513,38 +766,101 @@ void MainWindow::onPortTextChanged(const QString& text)
 
 void MainWindow::updateServiceStatus()
 {
-    bool isRunning = m_redisManager->isRedisRunning();
-    
-    qDebug() << "[MainWindow] Checking service status:" << (isRunning ? "Running" : "Stopped");
+    m_isServiceRunning = m_redisManager->isRedisRunning();
     
-    m_isServiceRunning = isRunning;
-    
-    if (m_isServiceRunning) {
-        m_statusIconLabel->setText("🟢");
-        m_statusLabel->setText("Redis 运行中");
-        m_statusLabel->setStyleSheet("color: #27ae60; font-weight: bold;");
-        qDebug() << "[MainWindow] Service status: RUNNING";
+    QString icon;
+    QString text;
+    QString color;
+    if (m_isServiceRunning && m_redisManager->isRedisStopping()) {
+        icon = "🟡";
+        text = m_stopStatus.isEmpty() ? QString("Redis 停止中...") : m_stopStatus;
+        color = "#f39c12";
+    } else if (m_isServiceRunning && !m_redisManager->isRedisReady()) {
+        icon = "🟡";
+        text = m_loadingStatus.isEmpty() ? QString("Redis 启动中...") : m_loadingStatus;
+        color = "#f39c12";
+    } else if (m_isServiceRunning && !m_redisManager->isRedisResponsive()) {
+        icon = "🟠";
+        text = "Redis 无响应（进程仍在运行）";
+        color = "#e67e22";
+    } else if (m_isServiceRunning) {
+        icon = "🟢";
+        text = "Redis 运行中";
+        color = "#27ae60";
     } else {
-        m_statusIconLabel->setText("🔴");
-        m_statusLabel->setText("Redis 已停止");
-        m_statusLabel->setStyleSheet("color: #e74c3c; font-weight: bold;");
-        qDebug() << "[MainWindow] Service status: STOPPED";
+        icon = "🔴";
+        text = "Redis 已停止";
+        color = "#e74c3c";
+    }
+    
+    QString status = icon + text;
+    if (status != m_shownStatus) {
+        m_shownStatus = status;
+        m_statusIconLabel->setText(icon);
+        m_statusLabel->setText(text);
+        m_statusLabel->setStyleSheet(QString("color: %1; font-weight: bold;").arg(color));
+        if (!m_redisManager->isRedisResponsive() && m_isServiceRunning) {
+            m_statusLabel->setToolTip("超过 3 秒没有回复 PING，可能被长时间运行的命令或脚本阻塞，或进程被暂停");
+        } else {
+            m_statusLabel->setToolTip(QString());
+        }
     }
     
     updateButtons();
 }
 
+void MainWindow::showEvent(QShowEvent* event)
+{
+    QMainWindow::showEvent(event);
+    m_redisManager->setStatusMonitorBackground(isMinimized());
+}
+
+void MainWindow::hideEvent(QHideEvent* event)
+{
+    QMainWindow::hideEvent(event);
+    m_redisManager->setStatusMonitorBackground(true);
+}
+
+void MainWindow::changeEvent(QEvent* event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange) {
+        m_redisManager->setStatusMonitorBackground(isMinimized() || !isVisible());
+    }
+}
+
 void MainWindow::onDownloadRedisClicked()
 {
+    if (m_buildProfileCombo && m_allocatorCombo) {
+        QString profile = m_buildProfileCombo->currentData().toString();
+        QString allocator = m_allocatorCombo->currentData().toString();
+        m_redisManager->setBuildProfile(profile);
+        m_redisManager->setBuildAllocator(allocator);
+        
+        ServiceConfig::instance().setBuildProfile(profile);
+        ServiceConfig::instance().setBuildAllocator(allocator);
+        ServiceConfig::instance().save();
+        
+        m_buildProfileCombo->setEnabled(false);
+        m_allocatorCombo->setEnabled(false);
+    }
+    
     if (m_downloadRedisButton) {
         m_downloadRedisButton->setEnabled(false);
+        m_cancelInstallButton->setVisible(true);
         m_downloadProgressBar->setVisible(true);
         m_installStatusLabel->setVisible(true);
     }
     
+    m_installTimings.clear();
     m_redisManager->downloadRedis();
 }
 
+void MainWindow::onCancelInstallClicked()
+{
+    m_redisManager->cancelInstallation();
+}
+
 void MainWindow::onRedisDownloadProgress(qint64 received, qint64 total)
 {
     if (m_downloadProgressBar && total > 0) {
@@ -558,6 +874,11 @@ void MainWindow::onRedisDownloadFinished(bool success)
     if (!success) {
         if (m_downloadRedisButton) {
             m_downloadRedisButton->setEnabled(true);
+            m_cancelInstallButton->setVisible(false);
+            if (m_buildProfileCombo) {
+                m_buildProfileCombo->setEnabled(true);
+                m_allocatorCombo->setEnabled(true);
+            }
             m_downloadProgressBar->setVisible(false);
             m_installStatusLabel->setVisible(false);
         }
@@ -572,10 +893,53 @@ void MainWindow::onRedisInstallationProgress(const QString& message)
     }
 }
 
+void MainWindow::refreshVersionList()
+{
+    const QStringList versions = m_redisManager->installedVersions();
+    QString active = m_redisManager->activeVersion();
+    
+    m_versionCombo->clear();
+    for (const QString& version : versions) {
+        m_versionCombo->addItem(version == active ? version + "（当前）" : version, version);
+    }
+    m_versionCombo->setCurrentIndex(qMax(0, m_versionCombo->findData(active)));
+    
+    // 只有一个版本时无需切换
+    m_versionCombo->setVisible(versions.size() > 1);
+    m_activateVersionButton->setVisible(versions.size() > 1);
+    
+    if (m_redisManager->isRedisInstalled()) {
+        m_redisVersionLabel->setText(m_redisManager->getRedisVersion());
+    }
+}
+
+void MainWindow::onActivateVersionClicked()
+{
+    QString version = m_versionCombo->currentData().toString();
+    if (version.isEmpty() || version == m_redisManager->activeVersion()) {
+        return;
+    }
+    
+    if (!m_redisManager->activateVersion(version)) {
+        QMessageBox::warning(this, "错误", "切换版本失败: " + m_redisManager->getLastError());
+        return;
+    }
+    
+    if (m_redisManager->isRedisRunning()) {
+        QMessageBox::information(this, "提示", "已切换到 Redis " + version + "，重启服务后生效。");
+    }
+}
+
+void MainWindow::onRedisInstallationStepFinished(const QString& step, qint64 elapsedMs)
+{
+    m_installTimings << QString("%1 %2 秒").arg(step).arg(elapsedMs / 1000.0, 0, 'f', 1);
+}
+
 void MainWindow::onRedisInstallationFinished(bool success)
 {
     if (success) {
-        QMessageBox::information(this, "成功", "Redis 安装成功！\n\n现在可以启动 Redis 服务了。");
+        QMessageBox::information(this, "成功", "Redis 安装成功！\n\n现在可以启动 Redis 服务了。\n\n各步骤耗时："
+                                 + m_installTimings.join("，"));
         
         if (m_redisVersionLabel) {
             m_redisVersionLabel->setText(m_redisManager->getRedisVersion());
@@ -586,6 +950,10 @@ void MainWindow::onRedisInstallationFinished(bool success)
         
         if (m_downloadRedisButton) {
             m_downloadRedisButton->setVisible(false);
+            m_cancelInstallButton->setVisible(false);
+        }
+        if (m_buildProfileCombo) {
+            m_buildProfileCombo->parentWidget()->setVisible(false);
         }
         if (m_downloadProgressBar) {
             m_downloadProgressBar->setVisible(false);
@@ -598,16 +966,46 @@ void MainWindow::onRedisInstallationFinished(bool success)
         
         if (m_downloadRedisButton) {
             m_downloadRedisButton->setEnabled(true);
+            m_cancelInstallButton->setVisible(false);
+            if (m_buildProfileCombo) {
+                m_buildProfileCombo->setEnabled(true);
+                m_allocatorCombo->setEnabled(true);
+            }
             m_downloadProgressBar->setVisible(false);
             m_installStatusLabel->setVisible(false);
         }
     }
 }
 
+void MainWindow::onRedisBenchmarkFinished(const QString& build, const QMap<QString, double>& results)
+{
+    // 与同一分配器下默认配置的结果对比
+    QString baseline = "default-" + m_redisManager->buildAllocator();
+    QVariantMap baselineResults;
+    if (build != baseline) {
+        baselineResults = ServiceConfig::instance().getBenchmarkResults(baseline);
+    }
+    
+    QString text = QString("编译配置 %1 的基准测试结果（请求/秒）：\n\n").arg(build);
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+        text += QString("%1: %2").arg(it.key()).arg(it.value(), 0, 'f', 0);
+        double base = baselineResults.value(it.key()).toDouble();
+        if (base > 0) {
+            text += QString("  (%1%2% 对比 %3)")
+                        .arg(it.value() >= base ? "+" : "")
+                        .arg((it.value() - base) * 100.0 / base, 0, 'f', 1)
+                        .arg(baseline);
+        }
+        text += "\n";
+    }
+    
+    QMessageBox::information(this, "基准测试", text);
+}
+
 void MainWindow::updateButtons()
 {
     m_startButton->setEnabled(!m_isServiceRunning);
-    m_stopButton->setEnabled(m_isServiceRunning);
+    m_stopButton->setEnabled(m_isServiceRunning && !m_redisManager->isRedisStopping());
 }
 
 bool MainWindow::validatePort(int port, QString& errorMsg)
@@ -632,3 +1030,61 @@ bool MainWindow::validatePort(int port, QString& errorMsg)
 
     return true;
 }
+
+void MainWindow::onRedisReady(qint64 timeToReadyMs, double loadBytesPerSecond)
+{
+    m_loadingStatus.clear();
+    updateServiceStatus();
+    
+    QString message = QString("Redis 服务启动成功！\n\n启动耗时 %1 秒").arg(timeToReadyMs / 1000.0, 0, 'f', 2);
+    if (loadBytesPerSecond > 0) {
+        message += QString("，数据加载速度 %1 MB/s").arg(loadBytesPerSecond / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    QMessageBox::information(this, "成功", message);
+}
+
+void MainWindow::onRedisLoadingProgress(double percent, qint64 etaSeconds)
+{
+    m_loadingStatus = QString("Redis 加载数据 %1%（剩余约 %2 秒）").arg(percent, 0, 'f', 1).arg(etaSeconds);
+    updateServiceStatus();
+}
+
+void MainWindow::onRedisStartFailed(const QString& error)
+{
+    m_loadingStatus.clear();
+    updateServiceStatus();
+    QMessageBox::warning(this, "错误", "Redis 启动失败: " + error);
+}
+
+void MainWindow::onRedisStopProgress(const QString& message, qint64 elapsedMs)
+{
+    m_stopStatus = QString("%1（%2 秒）").arg(message).arg(elapsedMs / 1000);
+    updateServiceStatus();
+}
+
+void MainWindow::onRedisStopped()
+{
+    m_stopStatus.clear();
+    updateServiceStatus();
+    
+    if (m_stopRequested) {
+        m_stopRequested = false;
+        QMessageBox::information(this, "成功", "Redis 服务停止成功！");
+    }
+}
+
+void MainWindow::onRedisStopFailed(const QString& error)
+{
+    m_stopStatus.clear();
+    m_stopRequested = false;
+    updateServiceStatus();
+    
+    auto reply = QMessageBox::question(this, "停止失败",
+                                       error + "\n\n是否不保存数据直接停止？",
+                                       QMessageBox::Yes | QMessageBox::No);
+    if (reply == QMessageBox::Yes) {
+        m_stopRequested = true;
+        m_redisManager->stopRedis(false);
+        updateServiceStatus();
+    }
+}
@@ -7,6 +7,9 @@
 #include <QLineEdit>
 #include <QTimer>
 #include <QProgressBar>
+#include <QComboBox>
+#include <QStringList>
+#include <QMap>
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -25,20 +28,45 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+    void changeEvent(QEvent* event) override;
+
 private slots:
     void onStartServiceClicked();
     void onStopServiceClicked();
     void onUninstallClicked();
     void onApplyConfigClicked();
+    void onTuningClicked();
+    void onInstancesClicked();
+    void onPlacementClicked();
+    void onLogClicked();
+    void onMetricsClicked();
+    void onLatencyClicked();
+    void onHostLatencyClicked();
     void onPortTextChanged(const QString& text);
     void updateServiceStatus();
     
     // Redis management slots
     void onDownloadRedisClicked();
+    void onCancelInstallClicked();
     void onRedisDownloadProgress(qint64 received, qint64 total);
     void onRedisDownloadFinished(bool success);
     void onRedisInstallationProgress(const QString& message);
+    void onRedisInstallationStepFinished(const QString& step, qint64 elapsedMs);
     void onRedisInstallationFinished(bool success);
+    void onActivateVersionClicked();
+    void refreshVersionList();
+    void onRedisBenchmarkFinished(const QString& build, const QMap<QString, double>& results);
+    void onRedisReady(qint64 timeToReadyMs, double loadBytesPerSecond);
+    void onRedisLoadingProgress(double percent, qint64 etaSeconds);
+    void onRedisStartFailed(const QString& error);
+    void onRedisStopProgress(const QString& message, qint64 elapsedMs);
+    void onRedisStopped();
+    void onRedisStopFailed(const QString& error);
+    void onRedisConfigApplied(const QStringList& appliedLive, const QStringList& restartRequired,
+                              const QStringList& failed);
 
 private:
     void setupUI();
@@ -51,7 +79,6 @@ private:
     
     ServiceManager* m_serviceManager;
     RedisManager* m_redisManager;
-    QTimer* m_statusTimer;
     
     // UI Components
     QLabel* m_statusLabel;
@@ -60,18 +87,36 @@ private:
     QPushButton* m_stopButton;
     QPushButton* m_uninstallButton;
     QPushButton* m_downloadRedisButton;
+    QPushButton* m_cancelInstallButton;
+    QComboBox* m_versionCombo;
+    QPushButton* m_activateVersionButton;
+    QComboBox* m_buildProfileCombo;
+    QComboBox* m_allocatorCombo;
     
     QLineEdit* m_ipEdit;
     QLineEdit* m_portEdit;
     QLineEdit* m_passwordEdit;
     QLabel* m_portStatusLabel;
     QPushButton* m_applyButton;
+    QPushButton* m_tuningButton;
+    QPushButton* m_instancesButton;
+    QPushButton* m_placementButton;
+    QPushButton* m_logButton;
+    QPushButton* m_metricsButton;
+    QPushButton* m_latencyButton;
+    QPushButton* m_hostLatencyButton;
     
     QLabel* m_redisVersionLabel;
     QLabel* m_redisPathLabel;
     QProgressBar* m_downloadProgressBar;
     QLabel* m_installStatusLabel;
+    QStringList m_installTimings;
+    QString m_loadingStatus;
+    QString m_stopStatus;
+    // 当前显示的状态，没有变化时不重新设置标签
+    QString m_shownStatus;
     
     bool m_isServiceRunning;
+    bool m_stopRequested;
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,664 @@
+#include "mappedlog.h"
+#include "logbuffer.h"
+#include <QThread>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+#ifdef Q_OS_LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <csetjmp>
+#include <csignal>
+#endif
+
+// 每扫描这么多字节发布一次索引进度，并释放已扫描过的页面
+static const qint64 kIndexWindow = 32 * 1024 * 1024;
+// 解析时间戳只需要行首这么多字节
+static const int kHeaderBytes = 64;
+
+// 顺序扫描过的页面不会很快再用到，交还给系统（文件映射的页面随时可以从文件重新读入）
+static void releasePages(const char* data, qint64 from, qint64 to)
+{
+#ifdef Q_OS_LINUX
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    qint64 begin = from & ~(pageSize - 1);
+    qint64 end = to & ~(pageSize - 1);
+    if (end > begin) {
+        madvise(const_cast<char*>(data) + begin, size_t(end - begin), MADV_DONTNEED);
+    }
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(from);
+    Q_UNUSED(to);
+#endif
+}
+
+#ifdef Q_OS_LINUX
+// 文件被原地截断后，访问映射中越过新文件末尾的页面会收到 SIGBUS。读映射的地方都经过
+// guardedMemchr / guardedCopy：出错时跳回调用处返回失败，由调用者按文件变短处理
+static thread_local sigjmp_buf* t_faultJump = nullptr;
+static struct sigaction s_previousSigbus;
+
+static void onSigbus(int signal, siginfo_t* info, void* context)
+{
+    if (t_faultJump) {
+        siglongjmp(*t_faultJump, 1);
+    }
+    // 不是读映射时发生的，交给原来的处理函数
+    if (s_previousSigbus.sa_flags & SA_SIGINFO) {
+        s_previousSigbus.sa_sigaction(signal, info, context);
+    } else if (s_previousSigbus.sa_handler != SIG_DFL && s_previousSigbus.sa_handler != SIG_IGN) {
+        s_previousSigbus.sa_handler(signal);
+    } else {
+        // 返回后出错的指令重新执行，按默认方式终止进程
+        std::signal(SIGBUS, SIG_DFL);
+    }
+}
+
+static void installSigbusHandler()
+{
+    static std::once_flag once;
+    std::call_once(once, []() {
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = onSigbus;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, &s_previousSigbus);
+    });
+}
+
+static bool guardedMemchr(const char* begin, size_t length, const char** result)
+{
+    sigjmp_buf jump;
+    if (sigsetjmp(jump, 1)) {
+        t_faultJump = nullptr;
+        return false;
+    }
+    t_faultJump = &jump;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    *result = static_cast<const char*>(std::memchr(begin, '\n', length));
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    t_faultJump = nullptr;
+    return true;
+}
+
+static bool guardedCopy(char* dest, const char* source, size_t length)
+{
+    sigjmp_buf jump;
+    if (sigsetjmp(jump, 1)) {
+        t_faultJump = nullptr;
+        return false;
+    }
+    t_faultJump = &jump;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    std::memcpy(dest, source, length);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    t_faultJump = nullptr;
+    return true;
+}
+#else
+// Windows 不允许截断仍被映射的文件，直接读
+static void installSigbusHandler()
+{
+}
+
+static bool guardedMemchr(const char* begin, size_t length, const char** result)
+{
+    *result = static_cast<const char*>(std::memchr(begin, '\n', length));
+    return true;
+}
+
+static bool guardedCopy(char* dest, const char* source, size_t length)
+{
+    std::memcpy(dest, source, length);
+    return true;
+}
+#endif
+
+MappedLog::MappedLog(QObject *parent)
+    : QObject(parent)
+    , m_data(nullptr)
+    , m_size(0)
+    , m_indexedBytes(0)
+    , m_lineCount(0)
+    , m_indexThread(nullptr)
+    , m_searchThread(nullptr)
+    , m_cancelIndex(false)
+    , m_cancelSearch(false)
+    , m_shrunk(false)
+    , m_cachedBlock(-1)
+{
+    installSigbusHandler();
+}
+
+MappedLog::~MappedLog()
+{
+    close();
+}
+
+bool MappedLog::open(const QString& path)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+    if (!mapFile()) {
+        m_file.close();
+        return false;
+    }
+    emit indexReset();
+    startIndexing();
+    return true;
+}
+
+void MappedLog::close()
+{
+    cancelSearch();
+    stopIndexing();
+    if (m_data) {
+        m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+        m_data = nullptr;
+    }
+    m_size = 0;
+    m_file.close();
+
+    QMutexLocker locker(&m_mutex);
+    m_checkpoints.clear();
+    m_checkpoints.shrink_to_fit();
+    m_indexedBytes = 0;
+    m_lineCount = 0;
+    m_cachedBlock = -1;
+}
+
+bool MappedLog::mapFile()
+{
+    m_shrunk = false;
+    m_size = m_file.size();
+    if (m_size == 0) {
+        m_data = nullptr;
+        return true;
+    }
+    uchar* data = m_file.map(0, m_size);
+    if (!data) {
+        m_errorString = m_file.errorString();
+        m_size = 0;
+        return false;
+    }
+    m_data = reinterpret_cast<const char*>(data);
+#ifdef Q_OS_LINUX
+    madvise(data, size_t(m_size), MADV_RANDOM);
+#endif
+    return true;
+}
+
+bool MappedLog::isMappingIntact() const
+{
+    if (m_shrunk) {
+        return false;
+    }
+#ifdef Q_OS_LINUX
+    // 用打开的句柄取大小：按路径轮转（改名）后映射的旧文件仍然完整
+    struct stat info;
+    if (m_data && fstat(m_file.handle(), &info) == 0 && qint64(info.st_size) < m_size) {
+        reportShrunk();
+        return false;
+    }
+#endif
+    // Windows 不允许截断仍被映射的文件
+    return true;
+}
+
+void MappedLog::reportShrunk() const
+{
+    if (!m_shrunk.exchange(true)) {
+        qDebug() << "[MappedLog]" << m_file.fileName() << "is shorter than the mapped" << m_size << "bytes";
+        emit const_cast<MappedLog*>(this)->fileShrunk();
+    }
+}
+
+bool MappedLog::refresh()
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+    cancelSearch();
+    stopIndexing();
+    m_errorString.clear();
+    if (m_data) {
+        m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+        m_data = nullptr;
+    }
+
+    // 截断后即使又写回超过原长度，已索引的偏移也对不上了
+    bool shrunk = m_shrunk;
+
+    // 按路径重新打开：轮转后路径指向的是新文件
+    QString path = m_file.fileName();
+    m_file.close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly) || !mapFile()) {
+        if (m_errorString.isEmpty()) {
+            m_errorString = m_file.errorString();
+        }
+        return false;
+    }
+
+    bool reset = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_cachedBlock = -1;
+        if (shrunk || m_size < m_indexedBytes) {
+            m_checkpoints.clear();
+            m_indexedBytes = 0;
+            m_lineCount = 0;
+            reset = true;
+        }
+    }
+    if (reset) {
+        emit indexReset();
+    }
+    startIndexing();
+    return true;
+}
+
+bool MappedLog::isIndexing() const
+{
+    return m_indexThread && m_indexThread->isRunning();
+}
+
+qint64 MappedLog::indexedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_indexedBytes;
+}
+
+qint64 MappedLog::lineCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_lineCount;
+}
+
+void MappedLog::startIndexing()
+{
+    m_cancelIndex = false;
+    m_indexThread = QThread::create([this]() { buildIndex(); });
+    m_indexThread->start(QThread::LowPriority);
+}
+
+void MappedLog::stopIndexing()
+{
+    if (!m_indexThread) {
+        return;
+    }
+    m_cancelIndex = true;
+    m_indexThread->wait();
+    delete m_indexThread;
+    m_indexThread = nullptr;
+}
+
+void MappedLog::buildIndex()
+{
+    qint64 pos = 0;
+    qint64 lines = 0;
+    qint64 lastTimestamp = -1;
+    {
+        QMutexLocker locker(&m_mutex);
+        pos = m_indexedBytes;
+        lines = m_lineCount;
+        if (!m_checkpoints.empty()) {
+            lastTimestamp = m_checkpoints.back().timestamp;
+        }
+    }
+#ifdef Q_OS_LINUX
+    if (m_size > pos) {
+        madvise(const_cast<char*>(m_data), size_t(m_size), MADV_SEQUENTIAL);
+    }
+#endif
+
+    std::vector<Checkpoint> batch;
+    qint64 released = pos;
+    bool complete = true;
+    while (pos < m_size) {
+        if (m_cancelIndex) {
+            complete = false;
+            break;
+        }
+
+        if (!isMappingIntact()) {
+            complete = false;
+            break;
+        }
+
+        qint64 windowEnd = qMin(m_size, pos + kIndexWindow);
+        bool partialLine = false;
+        while (pos < windowEnd) {
+            const char* newline = findNewline(pos);
+            if (!newline) {
+                // 最后一行还没写完（或文件已被截断），下次 refresh() 时再索引
+                partialLine = true;
+                break;
+            }
+            if (lines % kLinesPerCheckpoint == 0) {
+                char header[kHeaderBytes];
+                int length = int(qMin<qint64>(kHeaderBytes, newline - (m_data + pos)));
+                if (!copyData(pos, length, header)) {
+                    partialLine = true;
+                    break;
+                }
+                qint64 timestamp = LogLine::parseTimestamp(QByteArray::fromRawData(header, length));
+                lastTimestamp = qMax(lastTimestamp, timestamp);
+                batch.push_back({pos, lastTimestamp});
+            }
+            ++lines;
+            pos = newline - m_data + 1;
+        }
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_checkpoints.insert(m_checkpoints.end(), batch.begin(), batch.end());
+            m_indexedBytes = pos;
+            m_lineCount = lines;
+        }
+        batch.clear();
+        releasePages(m_data, released, pos);
+        released = pos;
+        emit indexProgress(pos, m_size);
+        if (partialLine) {
+            break;
+        }
+    }
+
+#ifdef Q_OS_LINUX
+    if (m_data) {
+        madvise(const_cast<char*>(m_data), size_t(m_size), MADV_RANDOM);
+    }
+#endif
+    if (complete && !m_shrunk) {
+        emit indexFinished();
+    }
+}
+
+const char* MappedLog::findNewline(qint64 from, qint64 to) const
+{
+    if (to < 0) {
+        to = m_size;
+    }
+    if (from >= to) {
+        return nullptr;
+    }
+    const char* newline = nullptr;
+    if (!guardedMemchr(m_data + from, size_t(to - from), &newline)) {
+        reportShrunk();
+        return nullptr;
+    }
+    return newline;
+}
+
+bool MappedLog::copyData(qint64 from, qint64 length, char* dest) const
+{
+    if (length <= 0) {
+        return true;
+    }
+    if (!guardedCopy(dest, m_data + from, size_t(length))) {
+        reportShrunk();
+        return false;
+    }
+    return true;
+}
+
+void MappedLog::loadBlock(qint64 block) const
+{
+    qint64 start = 0;
+    qint64 count = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        start = m_checkpoints[size_t(block)].offset;
+        count = qMin<qint64>(kLinesPerCheckpoint, m_lineCount - block * kLinesPerCheckpoint);
+    }
+
+    m_blockOffsets.clear();
+    m_blockOffsets.reserve(size_t(count));
+    qint64 pos = start;
+    for (qint64 i = 0; i < count; ++i) {
+        m_blockOffsets.push_back(pos);
+        const char* newline = findNewline(pos);
+        pos = newline ? newline - m_data + 1 : m_size;
+    }
+    m_cachedBlock = block;
+}
+
+qint64 MappedLog::lineOffset(qint64 line) const
+{
+    if (line < 0 || line >= lineCount() || !isMappingIntact()) {
+        return -1;
+    }
+    qint64 block = line / kLinesPerCheckpoint;
+    qint64 index = line % kLinesPerCheckpoint;
+    // 最后一个区间在索引过程中还会变长
+    if (block != m_cachedBlock || index >= qint64(m_blockOffsets.size())) {
+        loadBlock(block);
+    }
+    return m_blockOffsets[size_t(index)];
+}
+
+QByteArray MappedLog::lineData(qint64 line) const
+{
+    qint64 start = lineOffset(line);
+    if (start < 0) {
+        return QByteArray();
+    }
+    const char* newline = findNewline(start);
+    if (!newline && m_shrunk) {
+        return QByteArray();
+    }
+    qint64 stop = newline ? newline - m_data : m_size;
+    QByteArray data(int(stop - start), Qt::Uninitialized);
+    if (!copyData(start, data.size(), data.data())) {
+        return QByteArray();
+    }
+    if (data.endsWith('\r')) {
+        data.chop(1);
+    }
+    return data;
+}
+
+qint64 MappedLog::lineAtOffset(qint64 offset) const
+{
+    qint64 block = 0;
+    qint64 pos = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (offset < 0 || offset >= m_indexedBytes || m_checkpoints.empty() || !isMappingIntact()) {
+            return -1;
+        }
+        auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), offset,
+                                   [](qint64 value, const Checkpoint& checkpoint) {
+                                       return value < checkpoint.offset;
+                                   });
+        block = qint64(it - m_checkpoints.begin()) - 1;
+        pos = m_checkpoints[size_t(block)].offset;
+    }
+
+    qint64 line = block * kLinesPerCheckpoint;
+    for (;;) {
+        const char* newline = findNewline(pos);
+        if (!newline || newline - m_data >= offset) {
+            return line;
+        }
+        pos = newline - m_data + 1;
+        ++line;
+    }
+}
+
+qint64 MappedLog::lineAtTime(qint64 msecs) const
+{
+    qint64 line = 0;
+    qint64 count = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        count = m_lineCount;
+        if (count == 0) {
+            return -1;
+        }
+        // 第一个时间不早于 msecs 的检查点之前的那个区间里一定包含目标行
+        auto it = std::lower_bound(m_checkpoints.begin(), m_checkpoints.end(), msecs,
+                                   [](const Checkpoint& checkpoint, qint64 value) {
+                                       return checkpoint.timestamp < value;
+                                   });
+        qint64 block = qMax<qint64>(0, qint64(it - m_checkpoints.begin()) - 1);
+        line = block * kLinesPerCheckpoint;
+    }
+
+    for (; line < count; ++line) {
+        qint64 start = lineOffset(line);
+        if (start < 0) {
+            return -1;
+        }
+        const char* newline = findNewline(start);
+        char header[kHeaderBytes];
+        int length = int(qMin<qint64>(kHeaderBytes, (newline ? newline - m_data : m_size) - start));
+        if (m_shrunk || !copyData(start, length, header)) {
+            return -1;
+        }
+        qint64 timestamp = LogLine::parseTimestamp(QByteArray::fromRawData(header, length));
+        if (timestamp >= msecs) {
+            return line;
+        }
+    }
+    return count - 1;
+}
+
+void MappedLog::startSearch(const QRegularExpression& pattern, int maxResults)
+{
+    cancelSearch();
+    if (!m_data || !isMappingIntact()) {
+        emit searchFinished(QList<qint64>(), false, 0);
+        return;
+    }
+
+    m_cancelSearch = false;
+    m_searchThread = QThread::create([this, pattern, maxResults]() {
+        QElapsedTimer timer;
+        timer.start();
+        bool truncated = false;
+        QList<qint64> offsets = runSearch(pattern, maxResults, &truncated);
+        // 文件中途被截断时结果已不可信，等 fileShrunk 触发重新加载后再搜
+        if (!m_cancelSearch && !m_shrunk) {
+            emit searchFinished(offsets, truncated, timer.elapsed());
+        }
+    });
+    m_searchThread->start();
+}
+
+void MappedLog::cancelSearch()
+{
+    if (!m_searchThread) {
+        return;
+    }
+    m_cancelSearch = true;
+    m_searchThread->wait();
+    delete m_searchThread;
+    m_searchThread = nullptr;
+}
+
+bool MappedLog::isSearching() const
+{
+    return m_searchThread && m_searchThread->isRunning();
+}
+
+QList<qint64> MappedLog::runSearch(const QRegularExpression& pattern, int maxResults, bool* truncated)
+{
+    // 分块边界对齐到行首，每块由一个线程从头到尾匹配
+    const int chunkCount = qMax(1, QThread::idealThreadCount());
+    std::vector<qint64> bounds;
+    bounds.push_back(0);
+    for (int i = 1; i < chunkCount; ++i) {
+        qint64 bound = qMax(bounds.back(), m_size * i / chunkCount);
+        const char* newline = findNewline(bound);
+        bounds.push_back(newline ? qMax(bounds.back(), qint64(newline - m_data + 1)) : m_size);
+    }
+    bounds.push_back(m_size);
+
+    std::vector<QList<qint64>> found(size_t(chunkCount));
+    std::vector<char> capped(size_t(chunkCount), 0);
+    QList<QThread*> workers;
+    for (int i = 0; i < chunkCount; ++i) {
+        qint64 begin = bounds[size_t(i)];
+        qint64 end = bounds[size_t(i) + 1];
+        if (begin >= end) {
+            continue;
+        }
+        QThread* worker = QThread::create([this, i, begin, end, maxResults, &pattern, &found, &capped]() {
+            // 每个线程使用独立的正则对象
+            QRegularExpression regex(pattern.pattern(), pattern.patternOptions());
+            QList<qint64>& results = found[size_t(i)];
+            // 每行先从映射复制出来再匹配，截断时只是复制失败
+            QByteArray buffer;
+            qint64 pos = begin;
+            qint64 released = begin;
+            int checked = 0;
+            while (pos < end) {
+                if ((++checked & 0xfff) == 0 && (m_cancelSearch || !isMappingIntact())) {
+                    break;
+                }
+                const char* newline = findNewline(pos, end);
+                if (!newline && m_shrunk) {
+                    break;
+                }
+                qint64 stop = newline ? newline - m_data : end;
+                buffer.resize(int(stop - pos));
+                if (!copyData(pos, buffer.size(), buffer.data())) {
+                    break;
+                }
+                if (buffer.endsWith('\r')) {
+                    buffer.chop(1);
+                }
+                if (regex.match(QString::fromUtf8(buffer)).hasMatch()) {
+                    results << pos;
+                    if (results.size() >= maxResults) {
+                        capped[size_t(i)] = 1;
+                        break;
+                    }
+                }
+                pos = stop + 1;
+                if (pos - released >= kIndexWindow) {
+                    releasePages(m_data, released, pos);
+                    released = pos;
+                }
+            }
+            releasePages(m_data, released, qMin(pos, end));
+        });
+        workers << worker;
+        worker->start();
+    }
+    for (QThread* worker : workers) {
+        worker->wait();
+        delete worker;
+    }
+
+    QList<qint64> offsets;
+    *truncated = false;
+    for (int i = 0; i < chunkCount; ++i) {
+        for (qint64 offset : found[size_t(i)]) {
+            if (offsets.size() >= maxResults) {
+                *truncated = true;
+                return offsets;
+            }
+            offsets << offset;
+        }
+        if (capped[size_t(i)]) {
+            *truncated = true;
+            return offsets;
+        }
+    }
+    return offsets;
+}
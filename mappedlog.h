@@ -0,0 +1,109 @@
+#ifndef MAPPEDLOG_H
+#define MAPPEDLOG_H
+
+#include <QObject>
+#include <QString>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QRegularExpression>
+#include <atomic>
+#include <vector>
+
+class QThread;
+
+// 以内存映射方式浏览任意大小的日志文件（如几 GB 的 redis.log）。
+// 后台线程顺序扫描一遍文件，每 kLinesPerCheckpoint 行记录一个检查点（偏移和时间戳），
+// 索引大小约为每千行 16 字节；按行号、偏移、时间定位都从最近的检查点出发。
+// 扫描过的页面随即通过 madvise 交还给系统，进程内存不随文件大小增长
+class MappedLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int kLinesPerCheckpoint = 1024;
+
+    explicit MappedLog(QObject *parent = nullptr);
+    ~MappedLog();
+
+    bool open(const QString& path);
+    void close();
+    // 文件继续写入后重新映射，从上次的位置接着建索引；文件变小（被轮转或截断）时重建索引
+    bool refresh();
+
+    QString path() const { return m_file.fileName(); }
+    QString errorString() const { return m_errorString; }
+    qint64 size() const { return m_size; }
+
+    bool isIndexing() const;
+    qint64 indexedBytes() const;
+    // 已建立索引的完整行数
+    qint64 lineCount() const;
+
+    // 行号从 0 开始，不含换行符；超出已索引范围时返回空
+    QByteArray lineData(qint64 line) const;
+    qint64 lineOffset(qint64 line) const;
+    // 包含该字节偏移的行号，未索引到时返回 -1
+    qint64 lineAtOffset(qint64 offset) const;
+    // 第一行时间不早于 msecs 的行号；全部早于它时返回最后一行，没有行时返回 -1
+    qint64 lineAtTime(qint64 msecs) const;
+
+    // 把整个文件按 CPU 数分块并行匹配（每行单独匹配），结果为匹配行的偏移，
+    // 按在文件中的顺序最多 maxResults 个。通过 searchFinished 返回
+    void startSearch(const QRegularExpression& pattern, int maxResults);
+    void cancelSearch();
+    bool isSearching() const;
+
+signals:
+    void indexProgress(qint64 indexedBytes, qint64 totalBytes);
+    void indexFinished();
+    // 索引从头重建（打开新文件、文件被截断），已显示的行号全部失效
+    void indexReset();
+    // 发现文件比映射的长度短（copytruncate 轮转、> redis.log），此后读不到任何行，需要 refresh()
+    void fileShrunk();
+    void searchFinished(const QList<qint64>& offsets, bool truncated, qint64 elapsedMs);
+
+private:
+    struct Checkpoint
+    {
+        qint64 offset;
+        qint64 timestamp;   // 该行的时间；无法解析时沿用前一个检查点的时间，保证单调
+    };
+
+    bool mapFile();
+    // 文件被截断后访问映射末尾的页面会触发 SIGBUS：先用文件大小尽早发现，
+    // 真正读映射只经过 findNewline / copyData，读到已不存在的页面时返回失败并报告 fileShrunk
+    bool isMappingIntact() const;
+    void reportShrunk() const;
+    void startIndexing();
+    void stopIndexing();
+    void buildIndex();
+    QList<qint64> runSearch(const QRegularExpression& pattern, int maxResults, bool* truncated);
+    // 在 [from, to) 中找换行符，to 为 -1 时找到映射末尾；没有或文件已被截断时返回 nullptr
+    const char* findNewline(qint64 from, qint64 to = -1) const;
+    bool copyData(qint64 from, qint64 length, char* dest) const;
+    void loadBlock(qint64 block) const;
+
+private:
+    QFile m_file;
+    QString m_errorString;
+    const char* m_data;
+    qint64 m_size;
+
+    mutable QMutex m_mutex;
+    std::vector<Checkpoint> m_checkpoints;
+    qint64 m_indexedBytes;
+    qint64 m_lineCount;
+
+    QThread* m_indexThread;
+    QThread* m_searchThread;
+    std::atomic<bool> m_cancelIndex;
+    std::atomic<bool> m_cancelSearch;
+    mutable std::atomic<bool> m_shrunk;
+
+    // 最近访问的一个检查点区间内每行的偏移，表格滚动时连续的行不用重复扫描
+    mutable qint64 m_cachedBlock;
+    mutable std::vector<qint64> m_blockOffsets;
+};
+
+#endif // MAPPEDLOG_H
@@ -0,0 +1,252 @@
+#include "metricsampler.h"
+#include "respclient.h"
+#include <QTimer>
+#include <QDateTime>
+#include <cstring>
+
+static const int kMinIntervalMs = 100;
+// 每个指标保留的采样点数
+static const int kHistorySamples = 600;
+
+MetricSeries::MetricSeries(int capacity)
+    : m_values(size_t(qMax(1, capacity)), 0.0)
+    , m_head(0)
+    , m_size(0)
+{
+}
+
+void MetricSeries::append(double value)
+{
+    const int count = capacity();
+    if (m_size < count) {
+        m_values[size_t((m_head + m_size) % count)] = value;
+        ++m_size;
+    } else {
+        m_values[size_t(m_head)] = value;
+        m_head = (m_head + 1) % count;
+    }
+}
+
+void MetricSeries::clear()
+{
+    m_head = 0;
+    m_size = 0;
+}
+
+double MetricSeries::maximum(int count) const
+{
+    double result = 0;
+    for (int i = qMax(0, m_size - count); i < m_size; ++i) {
+        result = qMax(result, at(i));
+    }
+    return result;
+}
+
+MetricsSampler::MetricsSampler(QObject *parent)
+    : QObject(parent)
+    , m_series(size_t(MetricCount), MetricSeries(kHistorySamples))
+    , m_previousMs(0)
+    , m_hasPrevious(false)
+    , m_interval(1000)
+    , m_generation(0)
+    , m_running(false)
+    , m_pending(false)
+    , m_lastSampleTime(0)
+    , m_parseMicros(0)
+{
+    m_client = new RespClient(this);
+    m_timer = new QTimer(this);
+    m_timer->setInterval(m_interval);
+    connect(m_timer, &QTimer::timeout, this, &MetricsSampler::tick);
+}
+
+QString MetricsSampler::metricName(Metric metric)
+{
+    switch (metric) {
+    case OpsPerSecond:
+        return "命令 / 秒";
+    case NetInputKbps:
+        return "网络输入";
+    case NetOutputKbps:
+        return "网络输出";
+    case HitRatio:
+        return "键空间命中率";
+    case EvictedPerSecond:
+        return "淘汰 / 秒";
+    case ExpiredPerSecond:
+        return "过期 / 秒";
+    case UsedMemory:
+        return "已用内存";
+    case ConnectedClients:
+        return "客户端连接";
+    default:
+        return QString();
+    }
+}
+
+QString MetricsSampler::formatValue(Metric metric, double value)
+{
+    switch (metric) {
+    case NetInputKbps:
+    case NetOutputKbps:
+        return QString("%1 KB/s").arg(value, 0, 'f', 1);
+    case HitRatio:
+        return QString("%1 %").arg(value, 0, 'f', 1);
+    case UsedMemory:
+        return QString("%1 MB").arg(value / (1024.0 * 1024.0), 0, 'f', 1);
+    case ConnectedClients:
+        return QString::number(qint64(value));
+    default:
+        return QString::number(value, 'f', value < 10 ? 1 : 0);
+    }
+}
+
+void MetricsSampler::setServer(const QString& host, quint16 port, const QString& password)
+{
+    m_client->disconnectFromServer();
+    m_client->setPassword(password);
+    m_client->setServer(host, port);
+}
+
+void MetricsSampler::setInterval(int ms)
+{
+    m_interval = qMax(kMinIntervalMs, ms);
+    m_timer->setInterval(m_interval);
+}
+
+void MetricsSampler::start()
+{
+    stop();
+    for (MetricSeries& series : m_series) {
+        series.clear();
+    }
+    m_running = true;
+    m_previous = Counters();
+    m_hasPrevious = false;
+    m_clock.start();
+    m_timer->start();
+    tick();
+}
+
+void MetricsSampler::stop()
+{
+    // 让还在路上的回复作废
+    ++m_generation;
+    m_running = false;
+    m_pending = false;
+    m_timer->stop();
+    m_client->disconnectFromServer();
+}
+
+void MetricsSampler::tick()
+{
+    if (!m_running || m_pending) {
+        return;
+    }
+
+    int generation = m_generation;
+    m_pending = true;
+    m_client->send(QList<QByteArray>() << "INFO" << "all", [this, generation](const RespValue& reply) {
+        if (generation != m_generation) {
+            return;
+        }
+        m_pending = false;
+        if (!reply.isError()) {
+            handleInfo(reply.data());
+        }
+    });
+}
+
+MetricsSampler::Counters MetricsSampler::parseCounters(const QByteArray& info)
+{
+    struct Field
+    {
+        const char* name;
+        size_t length;
+        qint64 Counters::*member;
+    };
+    static const Field fields[] = {
+        {"total_commands_processed", 24, &Counters::commands},
+        {"total_net_input_bytes", 21, &Counters::netInput},
+        {"total_net_output_bytes", 22, &Counters::netOutput},
+        {"keyspace_hits", 13, &Counters::hits},
+        {"keyspace_misses", 15, &Counters::misses},
+        {"evicted_keys", 12, &Counters::evicted},
+        {"expired_keys", 12, &Counters::expired},
+        {"used_memory", 11, &Counters::usedMemory},
+        {"connected_clients", 17, &Counters::clients},
+    };
+
+    Counters counters;
+    const char* p = info.constData();
+    const char* end = p + info.size();
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', size_t(lineEnd - p)));
+        if (colon && *p != '#') {
+            size_t keyLength = size_t(colon - p);
+            for (const Field& field : fields) {
+                if (field.length == keyLength && std::memcmp(p, field.name, keyLength) == 0) {
+                    qint64 value = 0;
+                    for (const char* digit = colon + 1; digit < lineEnd && *digit >= '0' && *digit <= '9'; ++digit) {
+                        value = value * 10 + (*digit - '0');
+                    }
+                    counters.*field.member = value;
+                    break;
+                }
+            }
+        }
+        p = lineEnd + 1;
+    }
+    return counters;
+}
+
+void MetricsSampler::handleInfo(const QByteArray& info)
+{
+    QElapsedTimer parseTimer;
+    parseTimer.start();
+
+    Counters current = parseCounters(info);
+    qint64 nowMs = m_clock.elapsed();
+
+    // 第一次只记录基准；计数器变小说明 Redis 重启过（或执行了 CONFIG RESETSTAT），重新建立基准
+    bool reset = current.commands < m_previous.commands || current.netInput < m_previous.netInput;
+    bool appended = m_hasPrevious && !reset && nowMs > m_previousMs;
+    if (appended) {
+        double seconds = (nowMs - m_previousMs) / 1000.0;
+        auto rate = [seconds](qint64 now, qint64 before) {
+            return qMax<qint64>(0, now - before) / seconds;
+        };
+
+        m_series[OpsPerSecond].append(rate(current.commands, m_previous.commands));
+        m_series[NetInputKbps].append(rate(current.netInput, m_previous.netInput) / 1024.0);
+        m_series[NetOutputKbps].append(rate(current.netOutput, m_previous.netOutput) / 1024.0);
+
+        // 这段时间内没有读操作时沿用上一个值
+        qint64 lookups = (current.hits - m_previous.hits) + (current.misses - m_previous.misses);
+        MetricSeries& hitRatio = m_series[HitRatio];
+        double ratio = lookups > 0 ? 100.0 * (current.hits - m_previous.hits) / lookups
+                                   : (hitRatio.isEmpty() ? 0.0 : hitRatio.last());
+        hitRatio.append(ratio);
+
+        m_series[EvictedPerSecond].append(rate(current.evicted, m_previous.evicted));
+        m_series[ExpiredPerSecond].append(rate(current.expired, m_previous.expired));
+        m_series[UsedMemory].append(double(current.usedMemory));
+        m_series[ConnectedClients].append(double(current.clients));
+        m_lastSampleTime = QDateTime::currentMSecsSinceEpoch();
+    }
+
+    m_previous = current;
+    m_previousMs = nowMs;
+    m_hasPrevious = true;
+
+    double micros = parseTimer.nsecsElapsed() / 1000.0;
+    m_parseMicros = m_parseMicros == 0 ? micros : m_parseMicros * 0.9 + micros * 0.1;
+
+    if (appended) {
+        emit sampled();
+    }
+}
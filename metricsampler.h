@@ -0,0 +1,118 @@
+#ifndef METRICSAMPLER_H
+#define METRICSAMPLER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <vector>
+
+class QTimer;
+class RespClient;
+
+// 单个指标的定长环形缓冲区：一块连续的 double 数组，写满后覆盖最旧的值，之后不再分配内存
+class MetricSeries
+{
+public:
+    explicit MetricSeries(int capacity = 600);
+
+    int capacity() const { return int(m_values.size()); }
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    // 0 为保留的最旧的值
+    double at(int index) const { return m_values[size_t((m_head + index) % capacity())]; }
+    double last() const { return at(m_size - 1); }
+    // 最近 count 个值中的最大值
+    double maximum(int count) const;
+
+    void append(double value);
+    void clear();
+
+private:
+    std::vector<double> m_values;
+    int m_head;
+    int m_size;
+};
+
+// 在一条保持的连接上定时发送 INFO all，由计数器的差值算出速率，每个指标写入自己的 MetricSeries。
+// 上一次的回复还没到时跳过本次采样，不会堆积请求；解析时只比对需要的字段，不构造完整的字段表
+class MetricsSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Metric {
+        OpsPerSecond,
+        NetInputKbps,
+        NetOutputKbps,
+        HitRatio,
+        EvictedPerSecond,
+        ExpiredPerSecond,
+        UsedMemory,
+        ConnectedClients,
+        MetricCount
+    };
+
+    explicit MetricsSampler(QObject *parent = nullptr);
+
+    static QString metricName(Metric metric);
+    // 按指标的单位格式化
+    static QString formatValue(Metric metric, double value);
+
+    void setServer(const QString& host, quint16 port, const QString& password);
+    void setInterval(int ms);
+    int interval() const { return m_interval; }
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    const MetricSeries& series(Metric metric) const { return m_series[metric]; }
+    // 最近一次采样的时间（msecs since epoch）
+    qint64 lastSampleTime() const { return m_lastSampleTime; }
+    // 解析一次 INFO 回复的平均耗时（微秒），用于确认采样本身的开销
+    double averageParseMicros() const { return m_parseMicros; }
+
+signals:
+    // 每个指标都追加了一个新值
+    void sampled();
+
+private slots:
+    void tick();
+
+private:
+    struct Counters
+    {
+        qint64 commands = 0;
+        qint64 netInput = 0;
+        qint64 netOutput = 0;
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evicted = 0;
+        qint64 expired = 0;
+        qint64 usedMemory = 0;
+        qint64 clients = 0;
+    };
+
+    static Counters parseCounters(const QByteArray& info);
+    void handleInfo(const QByteArray& info);
+
+private:
+    RespClient* m_client;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+    std::vector<MetricSeries> m_series;
+
+    Counters m_previous;
+    qint64 m_previousMs;
+    bool m_hasPrevious;
+
+    int m_interval;
+    int m_generation;
+    bool m_running;
+    bool m_pending;
+    qint64 m_lastSampleTime;
+    double m_parseMicros;
+};
+
+#endif // METRICSAMPLER_H
@@ -0,0 +1,203 @@
+#include "metricsdialog.h"
+#include "metricsampler.h"
+#include "sparkline.h"
+#include "metricsstore.h"
+#include "historychart.h"
+#include "serviceconfig.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QLabel>
+#include <QSpinBox>
+#include <QDialogButtonBox>
+#include <QTabWidget>
+#include <QComboBox>
+#include <QPushButton>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+MetricsDialog::MetricsDialog(MetricsSampler* sampler, MetricsStore* store, QWidget *parent)
+    : QDialog(parent)
+    , m_sampler(sampler)
+    , m_store(store)
+{
+    setWindowTitle("实时指标");
+    resize(680, 520);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QTabWidget* tabs = new QTabWidget();
+    tabs->addTab(createLivePage(), "实时");
+    tabs->addTab(createHistoryPage(), "历史");
+    mainLayout->addWidget(tabs);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttons);
+
+    connect(sampler, &MetricsSampler::sampled, this, &MetricsDialog::onSampled);
+    connect(tabs, &QTabWidget::currentChanged, this, [this](int index) {
+        if (index == 1) {
+            refreshHistory();
+        }
+    });
+
+    // 打开前已经采集的数据直接显示
+    for (int i = 0; i < MetricsSampler::MetricCount; ++i) {
+        const MetricSeries& series = sampler->series(MetricsSampler::Metric(i));
+        if (!series.isEmpty()) {
+            m_valueLabels[i]->setText(MetricsSampler::formatValue(MetricsSampler::Metric(i), series.last()));
+        }
+    }
+    updateStatus();
+}
+
+QWidget* MetricsDialog::createLivePage()
+{
+    QWidget* page = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout(page);
+
+    QWidget* intervalWidget = new QWidget();
+    QHBoxLayout* intervalLayout = new QHBoxLayout(intervalWidget);
+    intervalLayout->setContentsMargins(0, 0, 0, 0);
+    intervalLayout->addWidget(new QLabel("采样间隔:"));
+    m_intervalSpin = new QSpinBox();
+    m_intervalSpin->setRange(100, 60000);
+    m_intervalSpin->setSingleStep(100);
+    m_intervalSpin->setSuffix(" ms");
+    m_intervalSpin->setKeyboardTracking(false);
+    m_intervalSpin->setValue(m_sampler->interval());
+    intervalLayout->addWidget(m_intervalSpin);
+    intervalLayout->addStretch();
+    layout->addWidget(intervalWidget);
+    connect(m_intervalSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+            this, &MetricsDialog::onIntervalChanged);
+
+    static const char* const colors[] = {
+        "#3498db", "#27ae60", "#16a085", "#8e44ad", "#e74c3c", "#f39c12", "#2c3e50", "#7f8c8d"
+    };
+
+    QGridLayout* grid = new QGridLayout();
+    grid->setColumnStretch(2, 1);
+    for (int i = 0; i < MetricsSampler::MetricCount; ++i) {
+        MetricsSampler::Metric metric = MetricsSampler::Metric(i);
+
+        QLabel* nameLabel = new QLabel(MetricsSampler::metricName(metric));
+        QLabel* valueLabel = new QLabel("-");
+        valueLabel->setMinimumWidth(100);
+        valueLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        Sparkline* sparkline = new Sparkline();
+        sparkline->setColor(QColor(colors[i % 8]));
+        sparkline->setSeries(&m_sampler->series(metric));
+
+        grid->addWidget(nameLabel, i, 0);
+        grid->addWidget(valueLabel, i, 1);
+        grid->addWidget(sparkline, i, 2);
+        m_valueLabels << valueLabel;
+        m_sparklines << sparkline;
+    }
+    layout->addLayout(grid);
+
+    m_statusLabel = new QLabel();
+    m_statusLabel->setObjectName("hintLabel");
+    layout->addWidget(m_statusLabel);
+    return page;
+}
+
+QWidget* MetricsDialog::createHistoryPage()
+{
+    QWidget* page = new QWidget();
+    QVBoxLayout* layout = new QVBoxLayout(page);
+
+    QWidget* selectWidget = new QWidget();
+    QHBoxLayout* selectLayout = new QHBoxLayout(selectWidget);
+    selectLayout->setContentsMargins(0, 0, 0, 0);
+    m_historyMetricCombo = new QComboBox();
+    for (int i = 0; i < MetricsSampler::MetricCount; ++i) {
+        m_historyMetricCombo->addItem(MetricsSampler::metricName(MetricsSampler::Metric(i)), i);
+    }
+    m_historyRangeCombo = new QComboBox();
+    m_historyRangeCombo->addItem("最近 1 小时", 3600);
+    m_historyRangeCombo->addItem("最近 6 小时", 6 * 3600);
+    m_historyRangeCombo->addItem("最近 24 小时", 24 * 3600);
+    m_historyRangeCombo->addItem("最近 7 天", 7 * 24 * 3600);
+    QPushButton* refreshButton = new QPushButton("刷新");
+    selectLayout->addWidget(m_historyMetricCombo);
+    selectLayout->addWidget(m_historyRangeCombo);
+    selectLayout->addStretch();
+    selectLayout->addWidget(refreshButton);
+    layout->addWidget(selectWidget);
+
+    m_historyChart = new HistoryChart();
+    layout->addWidget(m_historyChart, 1);
+
+    m_historyLabel = new QLabel();
+    m_historyLabel->setObjectName("hintLabel");
+    layout->addWidget(m_historyLabel);
+
+    connect(m_historyMetricCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MetricsDialog::refreshHistory);
+    connect(m_historyRangeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MetricsDialog::refreshHistory);
+    connect(refreshButton, &QPushButton::clicked, this, &MetricsDialog::refreshHistory);
+    return page;
+}
+
+void MetricsDialog::refreshHistory()
+{
+    if (!m_store) {
+        m_historyLabel->setText("历史数据不可用");
+        return;
+    }
+
+    MetricsSampler::Metric metric = MetricsSampler::Metric(m_historyMetricCombo->currentData().toInt());
+    qint64 to = QDateTime::currentMSecsSinceEpoch();
+    qint64 from = to - m_historyRangeCombo->currentData().toLongLong() * 1000;
+
+    QElapsedTimer timer;
+    timer.start();
+    MetricsStore::Resolution resolution = MetricsStore::Raw;
+    QVector<MetricPoint> points = m_store->query(metric, from, to, qMax(100, m_historyChart->width()),
+                                                 &resolution);
+    qint64 elapsedMs = timer.elapsed();
+
+    m_historyChart->setValueFormatter([metric](double value) {
+        return MetricsSampler::formatValue(metric, value);
+    });
+    m_historyChart->setPoints(points, from, to);
+    m_historyLabel->setText(QString("分辨率 %1，%2 个点，查询用时 %3 ms；历史数据共占用 %4 MB")
+                                .arg(MetricsStore::resolutionName(resolution))
+                                .arg(points.size()).arg(elapsedMs)
+                                .arg(m_store->diskUsage() / (1024.0 * 1024.0), 0, 'f', 1));
+}
+
+void MetricsDialog::onSampled()
+{
+    for (int i = 0; i < MetricsSampler::MetricCount; ++i) {
+        MetricsSampler::Metric metric = MetricsSampler::Metric(i);
+        m_valueLabels[i]->setText(MetricsSampler::formatValue(metric, m_sampler->series(metric).last()));
+        m_sparklines[i]->appendLatest();
+    }
+    updateStatus();
+}
+
+void MetricsDialog::onIntervalChanged(int ms)
+{
+    m_sampler->setInterval(ms);
+    ServiceConfig::instance().setMetricsInterval(ms);
+    ServiceConfig::instance().save();
+    updateStatus();
+}
+
+void MetricsDialog::updateStatus()
+{
+    if (!m_sampler->isRunning()) {
+        m_statusLabel->setText("Redis 未运行，就绪后开始采样");
+        return;
+    }
+    const MetricSeries& series = m_sampler->series(MetricsSampler::OpsPerSecond);
+    m_statusLabel->setText(QString("每个指标保留最近 %1 个点（约 %2 秒）；解析一次 INFO 平均 %3 µs")
+                               .arg(series.capacity())
+                               .arg(series.capacity() * m_sampler->interval() / 1000)
+                               .arg(m_sampler->averageParseMicros(), 0, 'f', 0));
+}
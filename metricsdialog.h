@@ -0,0 +1,48 @@
+#ifndef METRICSDIALOG_H
+#define METRICSDIALOG_H
+
+#include <QDialog>
+#include <QList>
+
+class MetricsSampler;
+class MetricsStore;
+class Sparkline;
+class HistoryChart;
+class QLabel;
+class QSpinBox;
+class QComboBox;
+
+// 指标面板。实时页每个指标一行，当前值和最近一段时间的迷你折线图；
+// 历史页从 MetricsStore 查询选定指标在最近 1 小时到 7 天内的曲线
+class MetricsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    MetricsDialog(MetricsSampler* sampler, MetricsStore* store, QWidget *parent = nullptr);
+
+private slots:
+    void onSampled();
+    void onIntervalChanged(int ms);
+    void refreshHistory();
+
+private:
+    QWidget* createLivePage();
+    QWidget* createHistoryPage();
+    void updateStatus();
+
+private:
+    MetricsSampler* m_sampler;
+    MetricsStore* m_store;
+    QList<QLabel*> m_valueLabels;
+    QList<Sparkline*> m_sparklines;
+    QSpinBox* m_intervalSpin;
+    QLabel* m_statusLabel;
+
+    QComboBox* m_historyMetricCombo;
+    QComboBox* m_historyRangeCombo;
+    HistoryChart* m_historyChart;
+    QLabel* m_historyLabel;
+};
+
+#endif // METRICSDIALOG_H
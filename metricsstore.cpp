@@ -0,0 +1,464 @@
+#include "metricsstore.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// 段文件头，之后紧跟 capacity 条 MetricRecord
+struct SegmentHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 recordSize;
+    quint32 metricCount;
+    qint64 resolutionMs;
+    qint64 firstTimestamp;
+    quint64 capacity;
+    // 已写入的记录数，先写记录再增加计数，中途退出不会留下半条记录
+    quint64 count;
+    char reserved[16];
+};
+
+struct MetricRecord
+{
+    qint64 timestamp;
+    quint32 count;      // 汇总了多少个原始采样
+    quint32 reserved;
+    float mean[MetricsStore::kMetricCount];
+    float minimum[MetricsStore::kMetricCount];
+    float maximum[MetricsStore::kMetricCount];
+};
+
+static_assert(sizeof(SegmentHeader) == 64, "segment header must stay 64 bytes");
+static_assert(sizeof(MetricRecord) == 112, "metric record must stay 112 bytes");
+
+static const char kMagic[4] = {'R', 'M', 'T', 'S'};
+static const quint32 kVersion = 1;
+
+namespace {
+
+struct TierConfig
+{
+    const char* name;
+    qint64 resolutionMs;
+    qint64 retentionMs;
+    quint64 capacity;
+};
+
+const qint64 kHour = 3600 * 1000LL;
+const qint64 kDay = 24 * kHour;
+
+// 原始采样的间隔由采样设置决定（100 ms ~ 60 s），其余按固定分辨率汇总
+const TierConfig kTiers[MetricsStore::ResolutionCount] = {
+    {"raw", 0, 6 * kHour, 65536},
+    {"1s", 1000, 2 * kDay, 21600},
+    {"1m", 60 * 1000, 35 * kDay, 10080},
+    {"1h", kHour, 400 * kDay, 8760},
+};
+
+// 原始数据只用于查询很短的时间范围
+const qint64 kRawQueryRangeMs = 10 * 60 * 1000;
+// 选择分辨率时允许读取的记录数是目标点数的多少倍，多出的部分合并后返回
+const int kReadFactor = 16;
+
+const SegmentHeader* headerOf(const uchar* map)
+{
+    return reinterpret_cast<const SegmentHeader*>(map);
+}
+
+const MetricRecord* recordsOf(const uchar* map)
+{
+    return reinterpret_cast<const MetricRecord*>(map + sizeof(SegmentHeader));
+}
+
+bool validHeader(const SegmentHeader* header, qint64 fileSize)
+{
+    return std::memcmp(header->magic, kMagic, 4) == 0
+           && header->version == kVersion
+           && header->recordSize == sizeof(MetricRecord)
+           && header->metricCount == quint32(MetricsStore::kMetricCount)
+           && header->count <= header->capacity
+           && qint64(sizeof(SegmentHeader) + header->capacity * sizeof(MetricRecord)) == fileSize;
+}
+
+} // namespace
+
+MetricsStore::MetricsStore(const QString& directory, QObject *parent)
+    : QObject(parent)
+    , m_directory(directory)
+{
+    for (int i = 0; i < ResolutionCount; ++i) {
+        openTier(Resolution(i));
+    }
+    for (int i = Second; i < ResolutionCount; ++i) {
+        reloadBucket(Resolution(i));
+    }
+    expire();
+
+    m_expireTimer = new QTimer(this);
+    connect(m_expireTimer, &QTimer::timeout, this, &MetricsStore::expire);
+    m_expireTimer->start(int(kHour / 6));
+}
+
+MetricsStore::~MetricsStore()
+{
+    // 未结束的汇总桶不写入：下一级的记录都已落盘，重新打开时由 reloadBucket() 恢复
+    for (Tier& tier : m_tiers) {
+        closeSegment(tier);
+    }
+}
+
+QString MetricsStore::resolutionName(Resolution resolution)
+{
+    switch (resolution) {
+    case Raw:
+        return "原始采样";
+    case Second:
+        return "1 秒";
+    case Minute:
+        return "1 分钟";
+    case Hour:
+        return "1 小时";
+    default:
+        return QString();
+    }
+}
+
+void MetricsStore::openTier(Resolution resolution)
+{
+    Tier& tier = m_tiers[resolution];
+    tier.resolutionMs = kTiers[resolution].resolutionMs;
+    tier.retentionMs = kTiers[resolution].retentionMs;
+    tier.capacity = kTiers[resolution].capacity;
+    tier.path = m_directory + "/" + kTiers[resolution].name;
+    QDir().mkpath(tier.path);
+
+    QDir dir(tier.path);
+    const QStringList files = dir.entryList(QStringList() << "*.seg", QDir::Files, QDir::Name);
+    for (const QString& name : files) {
+        bool ok = false;
+        qint64 first = QFileInfo(name).completeBaseName().toLongLong(&ok);
+        if (ok) {
+            tier.segments.append({first, dir.filePath(name)});
+        }
+    }
+    if (tier.segments.isEmpty()) {
+        return;
+    }
+
+    // 继续写最后一个段；已写满时只取最后的时间，下一条记录新建段
+    QFile* file = new QFile(tier.segments.last().path);
+    uchar* map = nullptr;
+    if (file->open(QIODevice::ReadWrite) && file->size() >= qint64(sizeof(SegmentHeader))) {
+        map = file->map(0, file->size());
+    }
+    if (!map || !validHeader(headerOf(map), file->size())) {
+        qDebug() << "[MetricsStore] Ignoring damaged segment" << file->fileName();
+        delete file;
+        tier.segments.removeLast();
+        return;
+    }
+
+    const SegmentHeader* header = headerOf(map);
+    if (header->count > 0) {
+        tier.lastTimestamp = recordsOf(map)[header->count - 1].timestamp;
+    }
+    if (header->count < header->capacity) {
+        tier.file = file;
+        tier.map = map;
+    } else {
+        file->unmap(map);
+        delete file;
+    }
+}
+
+void MetricsStore::reloadBucket(Resolution resolution)
+{
+    // 下一级最新的数据所在的时间段如果还没写入本级，说明上次退出时这个桶没有结束
+    const Tier& finer = m_tiers[resolution - 1];
+    Tier& tier = m_tiers[resolution];
+    qint64 latest = qMax(finer.lastTimestamp, finer.bucket.start);
+    if (latest < 0) {
+        return;
+    }
+    qint64 start = latest - latest % tier.resolutionMs;
+    if (tier.lastTimestamp >= start) {
+        return;
+    }
+
+    // 下一级未结束的桶稍后结束时会照常汇总上来，这里只取已写入的记录
+    forEachRecord(finer, start, start + tier.resolutionMs - 1, [this, resolution](const MetricRecord& record) {
+        accumulate(resolution, record);
+    });
+}
+
+void MetricsStore::closeSegment(Tier& tier)
+{
+    if (tier.file) {
+        if (tier.map) {
+            tier.file->unmap(tier.map);
+        }
+        tier.file->close();
+        delete tier.file;
+    }
+    tier.file = nullptr;
+    tier.map = nullptr;
+}
+
+bool MetricsStore::startSegment(Tier& tier, qint64 timestamp)
+{
+    closeSegment(tier);
+
+    QString path = tier.path + QString("/%1.seg").arg(timestamp, 16, 10, QChar('0'));
+    QFile* file = new QFile(path);
+    qint64 size = qint64(sizeof(SegmentHeader) + tier.capacity * sizeof(MetricRecord));
+    // 预先分配好全部空间再映射，写入时不再改变文件大小
+    if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate) || !file->resize(size)) {
+        qDebug() << "[MetricsStore] Cannot create segment" << path << file->errorString();
+        delete file;
+        return false;
+    }
+    uchar* map = file->map(0, size);
+    if (!map) {
+        qDebug() << "[MetricsStore] Cannot map segment" << path << file->errorString();
+        delete file;
+        QFile::remove(path);
+        return false;
+    }
+
+    SegmentHeader* header = reinterpret_cast<SegmentHeader*>(map);
+    std::memset(header, 0, sizeof(SegmentHeader));
+    std::memcpy(header->magic, kMagic, 4);
+    header->version = kVersion;
+    header->recordSize = sizeof(MetricRecord);
+    header->metricCount = kMetricCount;
+    header->resolutionMs = tier.resolutionMs;
+    header->firstTimestamp = timestamp;
+    header->capacity = tier.capacity;
+    header->count = 0;
+
+    tier.file = file;
+    tier.map = map;
+    tier.segments.append({timestamp, path});
+    return true;
+}
+
+void MetricsStore::writeRecord(Resolution resolution, const MetricRecord& record)
+{
+    Tier& tier = m_tiers[resolution];
+    if (record.timestamp <= tier.lastTimestamp) {
+        return;
+    }
+    if (!tier.map || headerOf(tier.map)->count >= tier.capacity) {
+        if (!startSegment(tier, record.timestamp)) {
+            return;
+        }
+    }
+
+    SegmentHeader* header = reinterpret_cast<SegmentHeader*>(tier.map);
+    MetricRecord* records = reinterpret_cast<MetricRecord*>(tier.map + sizeof(SegmentHeader));
+    records[header->count] = record;
+    header->count = header->count + 1;
+    tier.lastTimestamp = record.timestamp;
+}
+
+void MetricsStore::append(qint64 timestamp, const float* values)
+{
+    if (timestamp <= m_tiers[Raw].lastTimestamp) {
+        return;
+    }
+
+    MetricRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.timestamp = timestamp;
+    record.count = 1;
+    for (int i = 0; i < kMetricCount; ++i) {
+        record.mean[i] = record.minimum[i] = record.maximum[i] = values[i];
+    }
+    writeRecord(Raw, record);
+    accumulate(Second, record);
+}
+
+void MetricsStore::accumulate(Resolution resolution, const MetricRecord& record)
+{
+    Tier& tier = m_tiers[resolution];
+    qint64 start = record.timestamp - record.timestamp % tier.resolutionMs;
+    if (tier.bucket.start >= 0 && tier.bucket.start != start) {
+        flushBucket(resolution);
+    }
+
+    Bucket& bucket = tier.bucket;
+    if (bucket.start < 0) {
+        bucket.start = start;
+        bucket.count = 0;
+        for (int i = 0; i < kMetricCount; ++i) {
+            bucket.sum[i] = 0;
+            bucket.minimum[i] = std::numeric_limits<float>::max();
+            bucket.maximum[i] = std::numeric_limits<float>::lowest();
+        }
+    }
+    for (int i = 0; i < kMetricCount; ++i) {
+        bucket.sum[i] += double(record.mean[i]) * record.count;
+        bucket.minimum[i] = qMin(bucket.minimum[i], record.minimum[i]);
+        bucket.maximum[i] = qMax(bucket.maximum[i], record.maximum[i]);
+    }
+    bucket.count += record.count;
+}
+
+void MetricsStore::flushBucket(Resolution resolution)
+{
+    Bucket& bucket = m_tiers[resolution].bucket;
+    if (bucket.start < 0 || bucket.count == 0) {
+        return;
+    }
+
+    MetricRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.timestamp = bucket.start;
+    record.count = bucket.count;
+    for (int i = 0; i < kMetricCount; ++i) {
+        record.mean[i] = float(bucket.sum[i] / bucket.count);
+        record.minimum[i] = bucket.minimum[i];
+        record.maximum[i] = bucket.maximum[i];
+    }
+    bucket.start = -1;
+
+    writeRecord(resolution, record);
+    if (resolution + 1 < ResolutionCount) {
+        accumulate(Resolution(resolution + 1), record);
+    }
+}
+
+void MetricsStore::forEachRecord(const Tier& tier, qint64 from, qint64 to,
+                                 const std::function<void(const MetricRecord&)>& visit) const
+{
+    for (int i = 0; i < tier.segments.size(); ++i) {
+        const Segment& segment = tier.segments.at(i);
+        if (segment.firstTimestamp > to) {
+            break;
+        }
+        if (i + 1 < tier.segments.size() && tier.segments.at(i + 1).firstTimestamp <= from) {
+            continue;
+        }
+
+        // 正在写入的段直接用已有的映射，其余的临时映射
+        QFile file(segment.path);
+        const uchar* map = nullptr;
+        bool active = tier.file && tier.file->fileName() == segment.path;
+        if (active) {
+            map = tier.map;
+        } else if (file.open(QIODevice::ReadOnly) && file.size() >= qint64(sizeof(SegmentHeader))) {
+            map = file.map(0, file.size());
+            if (map && !validHeader(headerOf(map), file.size())) {
+                file.unmap(const_cast<uchar*>(map));
+                map = nullptr;
+            }
+        }
+        if (!map) {
+            continue;
+        }
+
+        const MetricRecord* begin = recordsOf(map);
+        const MetricRecord* end = begin + headerOf(map)->count;
+        const MetricRecord* it = std::lower_bound(begin, end, from,
+                                                  [](const MetricRecord& record, qint64 value) {
+                                                      return record.timestamp < value;
+                                                  });
+        for (; it != end && it->timestamp <= to; ++it) {
+            visit(*it);
+        }
+
+        if (!active) {
+            file.unmap(const_cast<uchar*>(map));
+        }
+    }
+}
+
+void MetricsStore::readRange(const Tier& tier, int metric, qint64 from, qint64 to,
+                             QVector<MetricPoint>& points, QVector<quint32>& counts) const
+{
+    forEachRecord(tier, from, to, [&](const MetricRecord& record) {
+        points.append({record.timestamp, record.mean[metric], record.minimum[metric], record.maximum[metric]});
+        counts.append(record.count);
+    });
+}
+
+QVector<MetricPoint> MetricsStore::query(int metric, qint64 from, qint64 to, int maxPoints,
+                                         Resolution* resolution) const
+{
+    QVector<MetricPoint> points;
+    if (metric < 0 || metric >= kMetricCount || to < from || maxPoints <= 0) {
+        return points;
+    }
+
+    // 选择保留时间覆盖起点、记录数又不太多的最细分辨率
+    const qint64 age = QDateTime::currentMSecsSinceEpoch() - from;
+    const qint64 range = to - from;
+    Resolution chosen = Hour;
+    for (int i = 0; i < ResolutionCount; ++i) {
+        const Tier& tier = m_tiers[i];
+        bool fits = i == Raw ? range <= kRawQueryRangeMs
+                             : range / tier.resolutionMs <= qint64(maxPoints) * kReadFactor;
+        if (fits && age <= tier.retentionMs) {
+            chosen = Resolution(i);
+            break;
+        }
+    }
+    if (resolution) {
+        *resolution = chosen;
+    }
+
+    QVector<quint32> counts;
+    readRange(m_tiers[chosen], metric, from, to, points, counts);
+    if (points.size() <= maxPoints) {
+        return points;
+    }
+
+    // 相邻的记录合并为一个点：按采样数加权平均，最小 / 最大值取极值
+    const int group = (points.size() + maxPoints - 1) / maxPoints;
+    QVector<MetricPoint> merged;
+    merged.reserve(maxPoints);
+    for (int start = 0; start < points.size(); start += group) {
+        int stop = qMin(int(points.size()), start + group);
+        MetricPoint point = points.at(start);
+        double sum = 0;
+        quint64 total = 0;
+        for (int i = start; i < stop; ++i) {
+            sum += double(points.at(i).mean) * counts.at(i);
+            total += counts.at(i);
+            point.minimum = qMin(point.minimum, points.at(i).minimum);
+            point.maximum = qMax(point.maximum, points.at(i).maximum);
+        }
+        point.mean = total > 0 ? float(sum / total) : point.mean;
+        merged.append(point);
+    }
+    return merged;
+}
+
+void MetricsStore::expire()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (Tier& tier : m_tiers) {
+        // 下一个段的起点早于保留时间，说明这个段的全部记录都已过期；最后一个段保留
+        while (tier.segments.size() > 1 && tier.segments.at(1).firstTimestamp < now - tier.retentionMs) {
+            QFile::remove(tier.segments.first().path);
+            tier.segments.removeFirst();
+        }
+    }
+}
+
+qint64 MetricsStore::diskUsage() const
+{
+    qint64 total = 0;
+    for (const Tier& tier : m_tiers) {
+        for (const Segment& segment : tier.segments) {
+            total += QFileInfo(segment.path).size();
+        }
+    }
+    return total;
+}
@@ -0,0 +1,110 @@
+#ifndef METRICSSTORE_H
+#define METRICSSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <functional>
+
+class QFile;
+class QTimer;
+struct MetricRecord;
+
+// 查询结果中的一个点：该时间段内的平均值、最小值和最大值
+struct MetricPoint
+{
+    qint64 timestamp;   // 时间段的起点（msecs since epoch）
+    float mean;
+    float minimum;
+    float maximum;
+};
+
+// 指标历史的磁盘存储。每种分辨率一个目录，目录下是若干只追加的段文件：
+//   <目录>/<分辨率>/<第一条记录的时间>.seg
+// 段文件预先分配好固定条数并整个内存映射，记录定长（所有指标的平均 / 最小 / 最大值），
+// 按时间顺序写入，查询时二分定位起点后顺序读取。
+// 原始采样逐级汇总为 1 秒、1 分钟、1 小时的记录，只写入已结束的时间段；重新打开时
+// 用下一级已写入的记录恢复未结束的汇总桶，继续累加。每种分辨率有自己的保留时间，
+// 整个段都过期后删除文件。查询时按时间范围自动选择分辨率，7 天只需读 1 万条左右的分钟记录
+class MetricsStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int kMetricCount = 8;
+
+    enum Resolution {
+        Raw,
+        Second,
+        Minute,
+        Hour,
+        ResolutionCount
+    };
+
+    explicit MetricsStore(const QString& directory, QObject *parent = nullptr);
+    ~MetricsStore();
+
+    QString directory() const { return m_directory; }
+    static QString resolutionName(Resolution resolution);
+
+    // 时间不晚于上一条的采样被忽略（系统时间回拨）
+    void append(qint64 timestamp, const float* values);
+
+    // [from, to] 内某个指标的数据，最多 maxPoints 个点；resolution 返回实际使用的分辨率
+    QVector<MetricPoint> query(int metric, qint64 from, qint64 to, int maxPoints,
+                               Resolution* resolution = nullptr) const;
+
+    // 删除所有记录都早于各自保留时间的段
+    void expire();
+    qint64 diskUsage() const;
+
+private:
+    struct Segment
+    {
+        qint64 firstTimestamp;
+        QString path;
+    };
+
+    struct Bucket
+    {
+        qint64 start = -1;
+        quint32 count = 0;
+        double sum[kMetricCount] = {};
+        float minimum[kMetricCount] = {};
+        float maximum[kMetricCount] = {};
+    };
+
+    struct Tier
+    {
+        qint64 resolutionMs = 0;
+        qint64 retentionMs = 0;
+        quint64 capacity = 0;
+        QString path;
+        QList<Segment> segments;
+        // 正在写入的最后一个段
+        QFile* file = nullptr;
+        uchar* map = nullptr;
+        qint64 lastTimestamp = -1;
+        Bucket bucket;
+    };
+
+    void openTier(Resolution resolution);
+    void reloadBucket(Resolution resolution);
+    void closeSegment(Tier& tier);
+    bool startSegment(Tier& tier, qint64 timestamp);
+    void writeRecord(Resolution resolution, const MetricRecord& record);
+    void accumulate(Resolution resolution, const MetricRecord& record);
+    void flushBucket(Resolution resolution);
+    void forEachRecord(const Tier& tier, qint64 from, qint64 to,
+                       const std::function<void(const MetricRecord&)>& visit) const;
+    void readRange(const Tier& tier, int metric, qint64 from, qint64 to, QVector<MetricPoint>& points,
+                   QVector<quint32>& counts) const;
+
+private:
+    QString m_directory;
+    Tier m_tiers[ResolutionCount];
+    QTimer* m_expireTimer;
+};
+
+#endif // METRICSSTORE_H
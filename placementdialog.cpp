@@ -0,0 +1,188 @@
+#include "placementdialog.h"
+#include "redismanager.h"
+#include "instanceregistry.h"
+#include "serviceconfig.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+#include <QTimer>
+
+PlacementDialog::PlacementDialog(RedisManager* manager, QWidget *parent)
+    : QDialog(parent)
+    , m_manager(manager)
+    , m_topology(CpuTopology::detect())
+{
+    setWindowTitle("CPU 放置");
+    setMinimumSize(640, 520);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QLabel* topologyLabel = new QLabel(m_topology.summary());
+    topologyLabel->setWordWrap(true);
+    mainLayout->addWidget(topologyLabel);
+
+    QFormLayout* form = new QFormLayout();
+
+    m_modeCombo = new QComboBox();
+    const QList<PlacementPolicy::Mode> modes = QList<PlacementPolicy::Mode>()
+        << PlacementPolicy::NoPlacement << PlacementPolicy::PinCores
+        << PlacementPolicy::SingleNode << PlacementPolicy::SpreadSockets;
+    for (PlacementPolicy::Mode mode : modes) {
+        m_modeCombo->addItem(PlacementPolicy::modeDescription(mode), PlacementPolicy::modeName(mode));
+    }
+    m_modeCombo->setCurrentIndex(qMax(0, m_modeCombo->findData(ServiceConfig::instance().getPlacementMode())));
+    form->addRow("策略:", m_modeCombo);
+
+    m_cpusEdit = new QLineEdit(ServiceConfig::instance().getPlacementCpus());
+    m_cpusEdit->setObjectName("inputField");
+    m_cpusEdit->setPlaceholderText("例如 2-5,8");
+    form->addRow("CPU 列表:", m_cpusEdit);
+
+    m_nodeCombo = new QComboBox();
+    const QList<int> nodes = m_topology.nodes();
+    for (int node : nodes) {
+        m_nodeCombo->addItem(QString("节点 %1（CPU %2）").arg(node)
+                                 .arg(CpuTopology::formatCpuList(m_topology.cpusOfNode(node))), node);
+    }
+    m_nodeCombo->setCurrentIndex(qMax(0, m_nodeCombo->findData(ServiceConfig::instance().getPlacementNode())));
+    form->addRow("NUMA 节点:", m_nodeCombo);
+    mainLayout->addLayout(form);
+
+    m_previewLabel = new QLabel();
+    m_previewLabel->setObjectName("hintLabel");
+    m_previewLabel->setWordWrap(true);
+    mainLayout->addWidget(m_previewLabel);
+
+    connect(m_modeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PlacementDialog::onModeChanged);
+    connect(m_nodeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PlacementDialog::onModeChanged);
+    connect(m_cpusEdit, &QLineEdit::textChanged, this, &PlacementDialog::onModeChanged);
+
+    QWidget* processWidget = new QWidget();
+    QHBoxLayout* processLayout = new QHBoxLayout(processWidget);
+    processLayout->setContentsMargins(0, 0, 0, 0);
+    m_processCombo = new QComboBox();
+    processLayout->addWidget(new QLabel("进程:"));
+    processLayout->addWidget(m_processCombo, 1);
+    mainLayout->addWidget(processWidget);
+
+    m_threadTable = new QTableWidget(0, 5);
+    m_threadTable->setHorizontalHeaderLabels(QStringList() << "TID" << "线程" << "允许的 CPU" << "内存节点" << "当前 CPU");
+    m_threadTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_threadTable->verticalHeader()->setVisible(false);
+    m_threadTable->horizontalHeader()->setStretchLastSection(true);
+    mainLayout->addWidget(m_threadTable);
+
+    connect(m_processCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &PlacementDialog::refreshThreads);
+
+    QLabel* restartLabel = new QLabel("修改策略后需要重启 Redis / 实例才能生效");
+    restartLabel->setObjectName("hintLabel");
+    mainLayout->addWidget(restartLabel);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, &QDialogButtonBox::accepted, this, &PlacementDialog::onAccept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    mainLayout->addWidget(buttons);
+
+    // 线程会被调度器迁移，定时刷新才能看到实际运行的 CPU
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(1000);
+    connect(m_refreshTimer, &QTimer::timeout, this, &PlacementDialog::refreshThreads);
+    m_refreshTimer->start();
+
+    onModeChanged();
+    refreshProcesses();
+}
+
+PlacementPolicy::Mode PlacementDialog::selectedMode() const
+{
+    return PlacementPolicy::modeFromName(m_modeCombo->currentData().toString());
+}
+
+void PlacementDialog::onModeChanged()
+{
+    PlacementPolicy::Mode mode = selectedMode();
+    m_cpusEdit->setEnabled(mode == PlacementPolicy::PinCores);
+    m_nodeCombo->setEnabled(mode == PlacementPolicy::SingleNode);
+
+    int count = m_manager->instanceRegistry()->count() + 1;
+    Placement placement = PlacementPolicy::compute(m_topology, mode, m_cpusEdit->text(),
+                                                   m_nodeCombo->currentData().toInt(), 0, count);
+    if (mode == PlacementPolicy::NoPlacement) {
+        m_previewLabel->setText("不设置亲和性，所有线程由操作系统调度");
+    } else if (placement.isEmpty()) {
+        m_previewLabel->setText("⚠️ 没有可用的 CPU");
+    } else {
+        QString text = "主实例: " + placement.description;
+        if (!placement.serverCpus.isEmpty()) {
+            text += QString("\n主线程和 io-threads: %1；后台线程、BGSAVE / AOF 重写: %2（Redis 6.2 起）")
+                        .arg(CpuTopology::formatCpuList(placement.serverCpus))
+                        .arg(CpuTopology::formatCpuList(placement.backgroundCpus));
+        }
+        if (mode == PlacementPolicy::SpreadSockets && count > 1) {
+            text += QString("\n共 %1 个实例，依次轮流分配到各个节点").arg(count);
+        }
+        m_previewLabel->setText(text);
+    }
+}
+
+void PlacementDialog::refreshProcesses()
+{
+    m_processCombo->clear();
+    if (m_manager->redisProcessId() > 0) {
+        m_processCombo->addItem(QString("主实例（PID %1）").arg(m_manager->redisProcessId()),
+                                m_manager->redisProcessId());
+    }
+    const QList<RedisInstance*> instances = m_manager->instanceRegistry()->instances();
+    for (RedisInstance* instance : instances) {
+        if (instance->processId() > 0) {
+            m_processCombo->addItem(QString("%1（PID %2）").arg(instance->name()).arg(instance->processId()),
+                                    instance->processId());
+        }
+    }
+    refreshThreads();
+}
+
+void PlacementDialog::refreshThreads()
+{
+    qint64 pid = m_processCombo->currentData().toLongLong();
+    const QList<ThreadPlacement> threads = pid > 0 ? ThreadPlacement::read(pid) : QList<ThreadPlacement>();
+
+    m_threadTable->setRowCount(threads.size());
+    for (int row = 0; row < threads.size(); ++row) {
+        const ThreadPlacement& thread = threads.at(row);
+        const QStringList texts = QStringList()
+            << QString::number(thread.tid) << thread.name << thread.allowedCpus << thread.allowedNodes
+            << (thread.lastCpu >= 0 ? QString::number(thread.lastCpu) : QString());
+        for (int column = 0; column < texts.size(); ++column) {
+            QTableWidgetItem* item = m_threadTable->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                m_threadTable->setItem(row, column, item);
+            }
+            item->setText(texts.at(column));
+        }
+    }
+}
+
+void PlacementDialog::onAccept()
+{
+    PlacementPolicy::Mode mode = selectedMode();
+    if (mode == PlacementPolicy::PinCores && CpuTopology::parseCpuList(m_cpusEdit->text()).isEmpty()) {
+        QMessageBox::warning(this, "CPU 放置", "CPU 列表格式无效，例如 2-5,8");
+        return;
+    }
+
+    ServiceConfig& config = ServiceConfig::instance();
+    config.setPlacementMode(PlacementPolicy::modeName(mode));
+    config.setPlacementCpus(m_cpusEdit->text().trimmed());
+    config.setPlacementNode(m_nodeCombo->currentData().toInt());
+    config.save();
+    accept();
+}
@@ -0,0 +1,45 @@
+#ifndef PLACEMENTDIALOG_H
+#define PLACEMENTDIALOG_H
+
+#include <QDialog>
+#include "cputopology.h"
+
+class RedisManager;
+class QComboBox;
+class QLineEdit;
+class QLabel;
+class QTableWidget;
+class QTimer;
+
+// CPU / NUMA 放置策略的设置，以及运行中各 Redis 进程每个线程实际的亲和性。
+// 线程列表每秒刷新一次；策略保存后在下次启动实例时生效
+class PlacementDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit PlacementDialog(RedisManager* manager, QWidget *parent = nullptr);
+
+private slots:
+    void onModeChanged();
+    void onAccept();
+    void refreshProcesses();
+    void refreshThreads();
+
+private:
+    PlacementPolicy::Mode selectedMode() const;
+
+private:
+    RedisManager* m_manager;
+    CpuTopology m_topology;
+
+    QComboBox* m_modeCombo;
+    QLineEdit* m_cpusEdit;
+    QComboBox* m_nodeCombo;
+    QLabel* m_previewLabel;
+    QComboBox* m_processCombo;
+    QTableWidget* m_threadTable;
+    QTimer* m_refreshTimer;
+};
+
+#endif // PLACEMENTDIALOG_H
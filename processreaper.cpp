@@ -0,0 +1,105 @@
+#include "processreaper.h"
+#include <QProcess>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#ifndef Q_OS_WIN
+#include <signal.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+// 组长退出后检查组内其余进程的间隔，和最多再等多久
+const int kGroupPollMs = 50;
+const int kGroupGraceMs = 10000;
+
+void sendSignal(QProcess* process, qint64 pid, bool processGroup, bool force)
+{
+#ifndef Q_OS_WIN
+    if (processGroup && pid > 0) {
+        ::kill(pid_t(-pid), force ? SIGKILL : SIGTERM);
+        return;
+    }
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(processGroup);
+#endif
+    if (force) {
+        process->kill();
+    } else {
+        process->terminate();
+    }
+}
+
+// 组长已经退出，等组内剩下的进程（make 启动的编译器）也退出；超过 killAfterMs 仍在的强制结束
+void waitForGroup(qint64 pid, QElapsedTimer clock, int killAfterMs, const std::function<void()>& onExited)
+{
+#ifndef Q_OS_WIN
+    bool alive = pid > 0 && (::kill(pid_t(-pid), 0) == 0 || errno == EPERM);
+    if (alive && clock.elapsed() < qMax(0, killAfterMs) + kGroupGraceMs) {
+        if (clock.elapsed() >= killAfterMs) {
+            ::kill(pid_t(-pid), SIGKILL);
+        }
+        QTimer::singleShot(kGroupPollMs, [pid, clock, killAfterMs, onExited]() {
+            waitForGroup(pid, clock, killAfterMs, onExited);
+        });
+        return;
+    }
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(clock);
+    Q_UNUSED(killAfterMs);
+#endif
+    if (onExited) {
+        onExited();
+    }
+}
+
+} // namespace
+
+void ProcessReaper::terminate(QProcess* process, int killAfterMs, bool processGroup,
+                              const std::function<void()>& onExited)
+{
+    if (process->state() == QProcess::NotRunning) {
+        process->deleteLater();
+        if (onExited) {
+            onExited();
+        }
+        return;
+    }
+
+    const qint64 pid = process->processId();
+    QElapsedTimer clock;
+    clock.start();
+    auto exited = [process, pid, processGroup, clock, killAfterMs, onExited]() {
+        process->deleteLater();
+        if (processGroup) {
+            waitForGroup(pid, clock, killAfterMs, onExited);
+        } else if (onExited) {
+            onExited();
+        }
+    };
+
+    // QProcess 的析构函数会阻塞等待进程退出，所以不能留在父对象下随父对象删除
+    process->setParent(nullptr);
+    QObject::connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                     process, exited);
+    QObject::connect(process, &QProcess::errorOccurred, process, [exited](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            exited();
+        }
+    });
+
+    if (killAfterMs <= 0) {
+        sendSignal(process, pid, processGroup, true);
+        return;
+    }
+
+    sendSignal(process, pid, processGroup, false);
+    QTimer::singleShot(killAfterMs, process, [process, pid, processGroup]() {
+        if (process->state() != QProcess::NotRunning) {
+            sendSignal(process, pid, processGroup, true);
+        }
+    });
+}
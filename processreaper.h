@@ -0,0 +1,22 @@
+#ifndef PROCESSREAPER_H
+#define PROCESSREAPER_H
+
+#include <functional>
+
+class QProcess;
+
+// 取消操作时停止子进程，但不在 GUI 线程上等待它退出：
+// 先发终止信号，超时仍未退出再强制结束，进程对象在真正退出后自行删除。
+// 调用方交出进程对象后不能再使用它
+class ProcessReaper
+{
+public:
+    // killAfterMs <= 0 时直接强制结束；processGroup 为 true 时向整个进程组发信号（仅 Linux，
+    // 进程需以 setsid 启动，make 的子编译器一起结束）。
+    // onExited 在进程（processGroup 时为整个进程组）全部退出后在本线程调用，
+    // 之后才能安全地删除它们正在写入的目录
+    static void terminate(QProcess* process, int killAfterMs, bool processGroup = false,
+                          const std::function<void()>& onExited = std::function<void()>());
+};
+
+#endif // PROCESSREAPER_H
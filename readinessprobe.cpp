@@ -0,0 +1,125 @@
+#include "readinessprobe.h"
+#include "respclient.h"
+#include <QTimer>
+#include <QDebug>
+#include <memory>
+
+static const int kInitialIntervalMs = 10;
+static const int kMaxIntervalMs = 500;
+
+ReadinessProbe::ReadinessProbe(RespClient* client, QObject *parent)
+    : QObject(parent)
+    , m_client(client)
+    , m_interval(kInitialIntervalMs)
+    , m_connectTimeout(30000)
+    , m_generation(0)
+    , m_dataSize(0)
+    , m_loadBytes(0)
+    , m_running(false)
+    , m_connected(false)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &ReadinessProbe::poll);
+}
+
+void ReadinessProbe::start()
+{
+    stop();
+
+    m_running = true;
+    m_connected = false;
+    m_loadBytes = 0;
+    m_interval = kInitialIntervalMs;
+    m_clock.start();
+    m_timer->start(0);
+}
+
+void ReadinessProbe::stop()
+{
+    // 让还在路上的回复作废
+    ++m_generation;
+    m_running = false;
+    m_timer->stop();
+}
+
+void ReadinessProbe::poll()
+{
+    if (!m_running) {
+        return;
+    }
+
+    if (!m_connected && m_clock.elapsed() > m_connectTimeout) {
+        fail(QString("%1 秒内无法连接到 Redis").arg(m_connectTimeout / 1000));
+        return;
+    }
+
+    // PING 和 INFO 一起流水线发出，一次往返得到两个结果
+    int generation = m_generation;
+    auto pingOk = std::make_shared<bool>(false);
+    m_client->send(QByteArray("PING"), [this, pingOk, generation](const RespValue& reply) {
+        if (generation != m_generation) {
+            return;
+        }
+        if (reply.isError() && (reply.data().startsWith("NOAUTH") || reply.data().startsWith("WRONGPASS"))) {
+            fail("Redis 认证失败: " + reply.toString());
+            return;
+        }
+        *pingOk = !reply.isError();
+    });
+    m_client->send(QList<QByteArray>() << "INFO" << "persistence",
+                   [this, pingOk, generation](const RespValue& reply) {
+        handleInfo(reply, *pingOk, generation);
+    });
+}
+
+void ReadinessProbe::handleInfo(const RespValue& reply, bool pingOk, int generation)
+{
+    if (generation != m_generation || !m_running) {
+        return;
+    }
+    if (m_client->isConnected()) {
+        m_connected = true;
+    }
+    if (reply.isError()) {
+        scheduleNext();
+        return;
+    }
+
+    const QMap<QByteArray, QByteArray> info = RespClient::parseInfo(reply.data());
+    bool loading = info.value("loading") == "1" || info.value("async_loading") == "1";
+
+    if (loading) {
+        m_loadBytes = qMax(m_loadBytes, info.value("loading_total_bytes").toLongLong());
+        emit loadingProgress(info.value("loading_loaded_perc").toDouble(),
+                             info.value("loading_eta_seconds").toLongLong());
+        scheduleNext();
+        return;
+    }
+
+    if (!pingOk) {
+        scheduleNext();
+        return;
+    }
+
+    qint64 elapsedMs = m_clock.elapsed();
+    qint64 loadedBytes = m_loadBytes > 0 ? m_loadBytes : m_dataSize;
+    double rate = (loadedBytes > 0 && elapsedMs > 0) ? loadedBytes * 1000.0 / elapsedMs : 0.0;
+
+    qDebug() << "[ReadinessProbe] Redis ready after" << elapsedMs << "ms, load rate" << rate << "B/s";
+    stop();
+    emit ready(elapsedMs, rate);
+}
+
+void ReadinessProbe::scheduleNext()
+{
+    m_timer->start(m_interval);
+    m_interval = qMin(kMaxIntervalMs, m_interval * 2);
+}
+
+void ReadinessProbe::fail(const QString& error)
+{
+    qDebug() << "[ReadinessProbe]" << error;
+    stop();
+    emit failed(error);
+}
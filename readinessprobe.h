@@ -0,0 +1,58 @@
+#ifndef READINESSPROBE_H
+#define READINESSPROBE_H
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+
+class QTimer;
+class RespClient;
+class RespValue;
+
+// 判断刚启动的 Redis 是否可以提供服务：反复发送 PING + INFO persistence，
+// 直到 PING 成功且 loading:0。连接失败时按指数退避重试（10ms 起，最长 500ms），
+// 加载数据期间报告进度。就绪时给出从启动到就绪的耗时和 RDB/AOF 加载速度。
+class ReadinessProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReadinessProbe(RespClient* client, QObject *parent = nullptr);
+
+    // 一直连不上时放弃的时间；开始加载数据后不再超时，由进程退出判断失败
+    void setConnectTimeout(int ms) { m_connectTimeout = ms; }
+    // 数据文件（dump.rdb / AOF）的大小；加载太快、INFO 里看不到进度时用于估算加载速度
+    void setDataSize(qint64 bytes) { m_dataSize = bytes; }
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+signals:
+    void loadingProgress(double percent, qint64 etaSeconds);
+    void ready(qint64 elapsedMs, double loadBytesPerSecond);
+    void failed(const QString& error);
+
+private slots:
+    void poll();
+
+private:
+    void scheduleNext();
+    void handleInfo(const RespValue& reply, bool pingOk, int generation);
+    void fail(const QString& error);
+
+private:
+    RespClient* m_client;
+    QTimer* m_timer;
+    QElapsedTimer m_clock;
+
+    int m_interval;
+    int m_connectTimeout;
+    int m_generation;
+    qint64 m_dataSize;
+    qint64 m_loadBytes;
+    bool m_running;
+    bool m_connected;
+};
+
+#endif // READINESSPROBE_H
@@ -0,0 +1,217 @@
+#include "redisbenchmark.h"
+#include "processreaper.h"
+#include <QTimer>
+#include <QTcpServer>
+#include <QHostAddress>
+#include <QTemporaryDir>
+#include <QDebug>
+#include <memory>
+
+static const int kServerStartupTimeoutMs = 10000;
+
+RedisBenchmark::RedisBenchmark(QObject *parent)
+    : QObject(parent)
+    , m_server(nullptr)
+    , m_benchmark(nullptr)
+    , m_dataDir(nullptr)
+    , m_port(0)
+    , m_requests(100000)
+    , m_clients(50)
+    , m_pipeline(16)
+{
+    m_tests << "ping_mbulk" << "set" << "get" << "incr" << "lpush" << "rpop"
+            << "sadd" << "hset" << "zadd" << "mset";
+
+    m_startupTimer = new QTimer(this);
+    m_startupTimer->setSingleShot(true);
+    connect(m_startupTimer, &QTimer::timeout, this, &RedisBenchmark::onStartupTimeout);
+}
+
+RedisBenchmark::~RedisBenchmark()
+{
+    abort();
+}
+
+int RedisBenchmark::findFreePort()
+{
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost, 0)) {
+        return 0;
+    }
+    return server.serverPort();
+}
+
+void RedisBenchmark::start(const QString& binaryDir)
+{
+    abort();
+
+    m_binaryDir = binaryDir;
+    m_serverOutput.clear();
+    m_results.clear();
+    m_lastError.clear();
+
+    m_port = findFreePort();
+    if (m_port == 0) {
+        finish(false, "找不到可用端口");
+        return;
+    }
+
+    m_dataDir = new QTemporaryDir();
+
+    m_server = new QProcess(this);
+    m_server->setProcessChannelMode(QProcess::MergedChannels);
+    m_server->setWorkingDirectory(m_dataDir->path());
+    connect(m_server, &QProcess::readyReadStandardOutput,
+            this, &RedisBenchmark::onServerOutput);
+    connect(m_server, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &RedisBenchmark::onServerFinished);
+
+    // 临时实例：只监听本机，不做任何持久化
+    QStringList args;
+    args << "--port" << QString::number(m_port)
+         << "--bind" << "127.0.0.1"
+         << "--save" << ""
+         << "--appendonly" << "no"
+         << "--daemonize" << "no"
+         << "--dir" << m_dataDir->path();
+    m_server->start(m_binaryDir + "/redis-server", args);
+    m_startupTimer->start(kServerStartupTimeoutMs);
+}
+
+void RedisBenchmark::abort(const std::function<void()>& onStopped)
+{
+    m_startupTimer->stop();
+
+    // 先占一个计数，两个进程都交给 ProcessReaper 之后再释放
+    auto pending = std::make_shared<int>(1);
+    auto release = [pending, onStopped]() {
+        if (--*pending == 0 && onStopped) {
+            onStopped();
+        }
+    };
+
+    if (m_benchmark) {
+        m_benchmark->disconnect(this);
+        ++*pending;
+        ProcessReaper::terminate(m_benchmark, 0, false, release);
+        m_benchmark = nullptr;
+    }
+
+    if (m_server) {
+        m_server->disconnect(this);
+        ++*pending;
+        ProcessReaper::terminate(m_server, 3000, false, release);
+        m_server = nullptr;
+    }
+    release();
+
+    delete m_dataDir;
+    m_dataDir = nullptr;
+}
+
+void RedisBenchmark::onServerOutput()
+{
+    m_serverOutput += m_server->readAllStandardOutput();
+
+    if (!m_benchmark && m_serverOutput.contains("Ready to accept connections")) {
+        m_startupTimer->stop();
+        startBenchmark();
+    }
+
+    if (m_serverOutput.size() > 8192) {
+        m_serverOutput = m_serverOutput.right(8192);
+    }
+}
+
+void RedisBenchmark::onServerFinished()
+{
+    finish(false, "测试用 redis-server 意外退出: " + QString::fromLocal8Bit(m_serverOutput).trimmed());
+}
+
+void RedisBenchmark::onStartupTimeout()
+{
+    finish(false, "测试用 redis-server 启动超时");
+}
+
+void RedisBenchmark::startBenchmark()
+{
+    m_benchmark = new QProcess(this);
+    m_benchmark->setProcessChannelMode(QProcess::SeparateChannels);
+    connect(m_benchmark, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &RedisBenchmark::onBenchmarkFinished);
+
+    QStringList args;
+    args << "-h" << "127.0.0.1"
+         << "-p" << QString::number(m_port)
+         << "-n" << QString::number(m_requests)
+         << "-c" << QString::number(m_clients)
+         << "-P" << QString::number(m_pipeline)
+         << "-t" << m_tests.join(',')
+         << "--csv";
+    m_benchmark->start(m_binaryDir + "/redis-benchmark", args);
+}
+
+void RedisBenchmark::onBenchmarkFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        finish(false, "redis-benchmark 执行失败: "
+                      + QString::fromLocal8Bit(m_benchmark->readAllStandardError()).trimmed());
+        return;
+    }
+
+    parseResults(m_benchmark->readAllStandardOutput());
+    if (m_results.isEmpty()) {
+        finish(false, "无法解析 redis-benchmark 输出");
+        return;
+    }
+
+    finish(true);
+}
+
+void RedisBenchmark::parseResults(const QByteArray& csv)
+{
+    // 新版本: "test","rps","avg_latency_ms",...   旧版本: "SET","123456.78"
+    const QList<QByteArray> lines = csv.split('\n');
+    for (const QByteArray& line : lines) {
+        QList<QByteArray> fields = line.trimmed().split(',');
+        if (fields.size() < 2) {
+            continue;
+        }
+
+        QString name = QString::fromLatin1(fields.at(0)).remove('"');
+        bool ok = false;
+        double rps = QString::fromLatin1(fields.at(1)).remove('"').toDouble(&ok);
+        if (ok && !name.isEmpty()) {
+            m_results.insert(name, rps);
+        }
+    }
+}
+
+void RedisBenchmark::finish(bool success, const QString& error)
+{
+    m_lastError = error;
+    if (!success) {
+        qDebug() << "[RedisBenchmark]" << error;
+    }
+
+    if (m_server && m_server->state() != QProcess::NotRunning) {
+        // 插桩版本在退出时才写出 .gcda，服务器真正退出后再报告完成，但不在 GUI 线程上等待
+        m_startupTimer->stop();
+        if (m_benchmark) {
+            m_benchmark->disconnect(this);
+            ProcessReaper::terminate(m_benchmark, 0);
+            m_benchmark = nullptr;
+        }
+        m_server->disconnect(this);
+        connect(m_server, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, [this, success]() {
+                    abort();
+                    emit finished(success);
+                });
+        ProcessReaper::terminate(m_server, 3000);
+        return;
+    }
+
+    abort();
+    emit finished(success);
+}
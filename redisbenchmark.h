@@ -0,0 +1,74 @@
+#ifndef REDISBENCHMARK_H
+#define REDISBENCHMARK_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QByteArray>
+#include <QProcess>
+#include <functional>
+
+class QTimer;
+class QTemporaryDir;
+
+// 用指定目录下的 redis-server / redis-benchmark 跑一轮短基准测试：
+// 在空闲端口上启动一个不持久化的临时实例，执行 redis-benchmark 后关闭。
+// 也用作 PGO 编译的训练负载。
+class RedisBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RedisBenchmark(QObject *parent = nullptr);
+    ~RedisBenchmark();
+
+    void setRequests(int requests) { m_requests = requests; }
+    void setClients(int clients) { m_clients = clients; }
+    void setPipeline(int pipeline) { m_pipeline = pipeline; }
+    void setTests(const QStringList& tests) { m_tests = tests; }
+
+    void start(const QString& binaryDir);
+    // onStopped 在两个子进程都退出后调用（插桩版本此时已写完 .gcda）
+    void abort(const std::function<void()>& onStopped = std::function<void()>());
+    bool isRunning() const { return m_server != nullptr; }
+
+    // 测试名 → 每秒请求数
+    QMap<QString, double> results() const { return m_results; }
+    QString getLastError() const { return m_lastError; }
+
+    static int findFreePort();
+
+signals:
+    void finished(bool success);
+
+private slots:
+    void onServerOutput();
+    void onServerFinished();
+    void onBenchmarkFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onStartupTimeout();
+
+private:
+    void startBenchmark();
+    void parseResults(const QByteArray& csv);
+    void finish(bool success, const QString& error = QString());
+
+private:
+    QProcess* m_server;
+    QProcess* m_benchmark;
+    QTimer* m_startupTimer;
+    QTemporaryDir* m_dataDir;
+
+    QString m_binaryDir;
+    QByteArray m_serverOutput;
+    QMap<QString, double> m_results;
+    QString m_lastError;
+
+    int m_port;
+    int m_requests;
+    int m_clients;
+    int m_pipeline;
+    QStringList m_tests;
+};
+
+#endif // REDISBENCHMARK_H
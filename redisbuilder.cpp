@@ -0,0 +1,366 @@
+#include "redisbuilder.h"
+#include "redisbenchmark.h"
+#include "processreaper.h"
+#include <QDir>
+#include <QThread>
+#include <QRegularExpression>
+#include <QDebug>
+#include <memory>
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
+// 编译失败时保留的输出尾部长度
+static const int kErrorTailSize = 4096;
+
+RedisBuilder::RedisBuilder(QObject *parent)
+    : QObject(parent)
+    , m_process(nullptr)
+    , m_allocator("jemalloc")
+    , m_profile(DefaultProfile)
+    , m_stage(IdleStage)
+    , m_jobs(defaultJobs())
+    , m_done(0)
+    , m_total(0)
+{
+    // PGO 训练负载：覆盖常用命令，量不必大，插桩版本本身就慢
+    m_trainer = new RedisBenchmark(this);
+    m_trainer->setRequests(20000);
+    connect(m_trainer, &RedisBenchmark::finished, this, &RedisBuilder::onTrainingFinished);
+}
+
+RedisBuilder::~RedisBuilder()
+{
+    cancel();
+}
+
+int RedisBuilder::defaultJobs()
+{
+#ifdef Q_OS_WIN
+    return qMax(1, QThread::idealThreadCount());
+#else
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return online > 0 ? int(online) : qMax(1, QThread::idealThreadCount());
+#endif
+}
+
+void RedisBuilder::setJobs(int jobs)
+{
+    m_jobs = jobs > 0 ? jobs : defaultJobs();
+}
+
+QString RedisBuilder::profileName(Profile profile)
+{
+    switch (profile) {
+    case LtoProfile:
+        return "lto";
+    case NativeProfile:
+        return "native";
+    case PgoProfile:
+        return "pgo";
+    case DefaultProfile:
+    default:
+        return "default";
+    }
+}
+
+RedisBuilder::Profile RedisBuilder::profileFromName(const QString& name)
+{
+    if (name == "lto") {
+        return LtoProfile;
+    }
+    if (name == "native") {
+        return NativeProfile;
+    }
+    if (name == "pgo") {
+        return PgoProfile;
+    }
+    return DefaultProfile;
+}
+
+void RedisBuilder::setAllocator(const QString& allocator)
+{
+    m_allocator = allocator == "libc" ? QString("libc") : QString("jemalloc");
+}
+
+QStringList RedisBuilder::buildFlags() const
+{
+    QStringList flags;
+    flags << "profile=" + profileName(m_profile) << m_makeVariables;
+    return flags;
+}
+
+QString RedisBuilder::profileDataDir() const
+{
+    return m_sourceDir + "/pgo-data";
+}
+
+QStringList RedisBuilder::makeArguments(Stage stage) const
+{
+    QStringList args;
+    args << QString("-j%1").arg(m_jobs);
+
+    if (stage == CleanStage) {
+        args << "clean";
+        return args;
+    }
+
+    args << "MALLOC=" + m_allocator;
+
+    // 命令行上的 REDIS_CFLAGS 会覆盖 Makefile 里追加的默认值，所以各配置都给出完整的参数
+    switch (m_profile) {
+    case LtoProfile:
+        args << "OPTIMIZATION=-O3 -flto"
+             << "REDIS_LDFLAGS=-O3 -flto";
+        break;
+    case NativeProfile:
+        args << "REDIS_CFLAGS=-march=native -mtune=native"
+             << "REDIS_LDFLAGS=-march=native";
+        break;
+    case PgoProfile:
+        if (stage == CompileStage) {
+            args << "REDIS_CFLAGS=-fprofile-generate=" + profileDataDir()
+                 << "REDIS_LDFLAGS=-fprofile-generate=" + profileDataDir();
+        } else {
+            // -fprofile-correction 容忍多线程下计数不一致，没跑到的文件不报警告
+            args << "REDIS_CFLAGS=-fprofile-use=" + profileDataDir()
+                    + " -fprofile-correction -Wno-missing-profile"
+                 << "REDIS_LDFLAGS=-fprofile-use=" + profileDataDir();
+        }
+        break;
+    case DefaultProfile:
+    default:
+        break;
+    }
+
+    args << m_makeVariables;
+    return args;
+}
+
+void RedisBuilder::start(const QString& sourceDir)
+{
+    cancel();
+
+    m_sourceDir = sourceDir;
+    m_lastError.clear();
+    m_done = 0;
+    m_total = countSourceFiles();
+    if (m_profile == PgoProfile) {
+        m_total *= 2;
+        QDir(profileDataDir()).removeRecursively();
+    }
+
+    m_clock.start();
+    emit progress(0, m_total, -1, QString());
+    runMake(CompileStage);
+}
+
+void RedisBuilder::runMake(Stage stage)
+{
+    m_stage = stage;
+    m_lineBuffer.clear();
+    m_errorTail.clear();
+
+    m_process = new QProcess(this);
+    m_process->setWorkingDirectory(m_sourceDir);
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+#ifndef Q_OS_WIN
+    // make 单独成一个进程组，取消时连同编译子进程一起结束
+    m_process->setChildProcessModifier([]() { ::setpgid(0, 0); });
+#endif
+
+    connect(m_process, &QProcess::readyReadStandardOutput,
+            this, &RedisBuilder::onReadyRead);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &RedisBuilder::onProcessFinished);
+    connect(m_process, &QProcess::errorOccurred,
+            this, &RedisBuilder::onProcessError);
+
+    QStringList args = makeArguments(stage);
+    qDebug() << "[RedisBuilder] make" << args << "in" << m_sourceDir
+             << "(" << m_total << "source files)";
+
+    switch (stage) {
+    case CompileStage:
+        emit stageChanged(m_profile == PgoProfile ? "正在编译插桩版本（PGO 第 1 遍）..."
+                                                  : "正在编译 Redis...");
+        break;
+    case CleanStage:
+        emit stageChanged("正在清理插桩编译产物...");
+        break;
+    case ProfiledCompileStage:
+        emit stageChanged("正在使用训练数据重新编译（PGO 第 2 遍）...");
+        break;
+    default:
+        break;
+    }
+
+    m_process->start("make", args);
+}
+
+void RedisBuilder::cancel(const std::function<void()>& onStopped)
+{
+    auto pending = std::make_shared<int>(2);
+    auto release = [pending, onStopped]() {
+        if (--*pending == 0 && onStopped) {
+            onStopped();
+        }
+    };
+
+    m_trainer->abort(release);
+
+    if (m_process) {
+        // make 以自己为组长启动，向整个进程组发信号才能一起结束正在运行的编译器
+        m_process->disconnect(this);
+        ProcessReaper::terminate(m_process, 3000, true, release);
+        m_process = nullptr;
+    } else {
+        release();
+    }
+
+    m_stage = IdleStage;
+}
+
+int RedisBuilder::countSourceFiles() const
+{
+    // Redis 自身的 src/*.c 加上 deps 下默认会编译的库
+    static const char* const dirs[] = {
+        "src", "deps/hiredis", "deps/linenoise", "deps/lua/src",
+        "deps/hdr_histogram", "deps/fpconv", "deps/jemalloc/src"
+    };
+
+    int count = 0;
+    for (const char* dir : dirs) {
+        if (m_allocator != "jemalloc" && qstrcmp(dir, "deps/jemalloc/src") == 0) {
+            continue;
+        }
+        QDir d(m_sourceDir + "/" + QString::fromLatin1(dir));
+        count += d.entryList(QStringList() << "*.c", QDir::Files).size();
+    }
+    return qMax(1, count);
+}
+
+void RedisBuilder::onReadyRead()
+{
+    QByteArray data = m_process->readAllStandardOutput();
+
+    m_errorTail += data;
+    if (m_errorTail.size() > kErrorTailSize) {
+        m_errorTail = m_errorTail.right(kErrorTailSize);
+    }
+
+    if (m_stage == CleanStage) {
+        return;
+    }
+
+    m_lineBuffer += data;
+    int start = 0;
+    int newline;
+    while ((newline = m_lineBuffer.indexOf('\n', start)) >= 0) {
+        parseLine(m_lineBuffer.mid(start, newline - start));
+        start = newline + 1;
+    }
+    m_lineBuffer.remove(0, start);
+}
+
+void RedisBuilder::parseLine(const QByteArray& line)
+{
+    // Redis 的 Makefile 输出 "    CC adlist.o"，依赖库输出完整的编译命令 "cc ... -c foo.c"。
+    // src/Makefile 的 QUIET_CC 不管是否终端都给 CC 和文件名加颜色（\033[34mCC\033[0m），先去掉转义序列
+    static const QRegularExpression ansiRe("\x1b\\[[0-9;]*m");
+    static const QRegularExpression quietRe("^\\s+CC\\s+(\\S+)");
+    static const QRegularExpression verboseRe("\\s-c\\s.*?(\\S+\\.c)\\s*$");
+
+    QString text = QString::fromLocal8Bit(line).remove(ansiRe);
+    QRegularExpressionMatch match = quietRe.match(text);
+    if (!match.hasMatch()) {
+        match = verboseRe.match(text);
+    }
+    if (!match.hasMatch()) {
+        return;
+    }
+
+    ++m_done;
+    if (m_done >= m_total) {
+        m_total = m_done + 1;
+    }
+
+    qint64 etaMs = -1;
+    if (m_done >= 3) {
+        etaMs = m_clock.elapsed() * (m_total - m_done) / m_done;
+    }
+
+    emit progress(m_done, m_total, etaMs, match.captured(1));
+}
+
+void RedisBuilder::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (!m_lineBuffer.isEmpty()) {
+        parseLine(m_lineBuffer);
+        m_lineBuffer.clear();
+    }
+
+    m_process->deleteLater();
+    m_process = nullptr;
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        qDebug() << "[RedisBuilder] Make compilation failed:" << m_errorTail;
+        finish(false, "编译失败: " + QString::fromLocal8Bit(m_errorTail).trimmed());
+        return;
+    }
+
+    if (m_profile != PgoProfile || m_stage == ProfiledCompileStage) {
+        qDebug() << "[RedisBuilder] Build finished in" << m_clock.elapsed() << "ms";
+        emit progress(m_total, m_total, 0, QString());
+        finish(true);
+        return;
+    }
+
+    if (m_stage == CompileStage) {
+        // 插桩版本跑一轮内置基准负载，生成 .gcda 数据
+        m_stage = TrainStage;
+        emit stageChanged("正在运行 PGO 训练负载...");
+        m_trainer->start(m_sourceDir + "/src");
+    } else if (m_stage == CleanStage) {
+        runMake(ProfiledCompileStage);
+    }
+}
+
+void RedisBuilder::onTrainingFinished(bool success)
+{
+    if (m_stage != TrainStage) {
+        return;
+    }
+
+    if (!success) {
+        finish(false, "PGO 训练失败: " + m_trainer->getLastError());
+        return;
+    }
+
+    if (QDir(profileDataDir()).isEmpty()) {
+        finish(false, "PGO 训练没有生成任何 profile 数据");
+        return;
+    }
+
+    runMake(CleanStage);
+}
+
+void RedisBuilder::onProcessError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart) {
+        return;
+    }
+
+    QString message = "无法启动 make: " + m_process->errorString();
+    m_process->deleteLater();
+    m_process = nullptr;
+    finish(false, message);
+}
+
+void RedisBuilder::finish(bool success, const QString& error)
+{
+    m_lastError = error;
+    m_stage = IdleStage;
+    emit finished(success);
+}
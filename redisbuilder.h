@@ -0,0 +1,106 @@
+#ifndef REDISBUILDER_H
+#define REDISBUILDER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <functional>
+
+class RedisBenchmark;
+
+// 异步编译 Redis 源码：并行 make，实时解析编译输出给出进度和剩余时间，可取消。
+// PGO 配置分两遍：先编译插桩版本并用内置的基准负载训练，再用采集的数据重新编译。
+class RedisBuilder : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Profile {
+        DefaultProfile,     // Redis 自带的编译参数
+        LtoProfile,         // -O3 -flto
+        NativeProfile,      // -march=native，只适合在本机运行
+        PgoProfile          // 两遍编译的 profile-guided optimization
+    };
+
+    explicit RedisBuilder(QObject *parent = nullptr);
+    ~RedisBuilder();
+
+    // 并行任务数，默认等于在线 CPU 数
+    void setJobs(int jobs);
+    int jobs() const { return m_jobs; }
+    static int defaultJobs();
+
+    void setProfile(Profile profile) { m_profile = profile; }
+    Profile profile() const { return m_profile; }
+    static QString profileName(Profile profile);
+    static Profile profileFromName(const QString& name);
+
+    // 内存分配器："jemalloc"（Redis 在 Linux 上的默认值）或 "libc"
+    void setAllocator(const QString& allocator);
+    QString allocator() const { return m_allocator; }
+
+    // 额外传给 make 的变量
+    void setMakeVariables(const QStringList& variables) { m_makeVariables = variables; }
+    QStringList makeVariables() const { return m_makeVariables; }
+
+    // 决定编译产物的参数（不含临时路径），用作编译缓存的键
+    QStringList buildFlags() const;
+
+    void start(const QString& sourceDir);
+    // onStopped 在 make（整个进程组）和 PGO 训练进程都退出后调用，此后才能删除源码目录
+    void cancel(const std::function<void()>& onStopped = std::function<void()>());
+    bool isRunning() const { return m_stage != IdleStage; }
+
+    QString sourceDir() const { return m_sourceDir; }
+    QString getLastError() const { return m_lastError; }
+
+signals:
+    // done/total 为已编译/预计编译的源文件数，etaMs < 0 表示尚无法估计
+    void progress(int done, int total, qint64 etaMs, const QString& currentFile);
+    void stageChanged(const QString& description);
+    void finished(bool success);
+
+private slots:
+    void onReadyRead();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onProcessError(QProcess::ProcessError error);
+    void onTrainingFinished(bool success);
+
+private:
+    enum Stage {
+        IdleStage,
+        CompileStage,
+        TrainStage,
+        CleanStage,
+        ProfiledCompileStage
+    };
+
+    QStringList makeArguments(Stage stage) const;
+    void runMake(Stage stage);
+    void finish(bool success, const QString& error = QString());
+    int countSourceFiles() const;
+    void parseLine(const QByteArray& line);
+    QString profileDataDir() const;
+
+private:
+    QProcess* m_process;
+    RedisBenchmark* m_trainer;
+    QString m_sourceDir;
+    QStringList m_makeVariables;
+    QString m_allocator;
+    QString m_lastError;
+    QByteArray m_lineBuffer;
+    QByteArray m_errorTail;
+    QElapsedTimer m_clock;
+
+    Profile m_profile;
+    Stage m_stage;
+    int m_jobs;
+    int m_done;
+    int m_total;
+};
+
+#endif // REDISBUILDER_H
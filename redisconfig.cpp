@@ -0,0 +1,565 @@
+#include "redisconfig.h"
+#include "versionstore.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QRegularExpression>
+#include <QDebug>
+
+// 值由多个词组成、写入时不加引号的参数
+static const QStringList kMultiWordKeys = QStringList() << "save" << "bind";
+
+namespace {
+
+ConfigParameter makeParameter(const QString& name, ConfigParameter::Type type, const QString& category,
+                              const QString& description, const QString& defaultValue,
+                              qint64 minimum = 0, qint64 maximum = 0, bool runtime = true)
+{
+    ConfigParameter parameter;
+    parameter.name = name;
+    parameter.type = type;
+    parameter.category = category;
+    parameter.description = description;
+    parameter.minimum = minimum;
+    parameter.maximum = maximum;
+    parameter.defaults << qMakePair(QString(), defaultValue);
+    parameter.runtime = runtime;
+    return parameter;
+}
+
+ConfigParameter boolParameter(const QString& name, const QString& category, const QString& description,
+                              const QString& defaultValue, const QString& minVersion = QString())
+{
+    ConfigParameter parameter = makeParameter(name, ConfigParameter::Bool, category, description, defaultValue);
+    parameter.choices << "yes" << "no";
+    parameter.minVersion = minVersion;
+    return parameter;
+}
+
+ConfigParameter enumParameter(const QString& name, const QString& category, const QString& description,
+                              const QStringList& choices, const QString& defaultValue)
+{
+    ConfigParameter parameter = makeParameter(name, ConfigParameter::Enum, category, description, defaultValue);
+    parameter.choices = choices;
+    return parameter;
+}
+
+QList<ConfigParameter> buildSchema()
+{
+    const QString network = "网络";
+    const QString memory = "内存";
+    const QString threads = "线程与事件循环";
+    const QString lazyfree = "惰性释放";
+    const QString defrag = "碎片整理";
+    const QString persistence = "持久化";
+    const QString encoding = "紧凑编码";
+    const QString general = "常规";
+
+    QList<ConfigParameter> schema;
+
+    // 网络
+    schema << makeParameter("bind", ConfigParameter::String, network, "监听地址，多个地址用空格分隔",
+                            "* -::*", 0, 0, false);
+    schema << makeParameter("port", ConfigParameter::Integer, network, "监听端口", "6379", 0, 65535, false);
+    schema << boolParameter("protected-mode", network, "未设置密码时只接受本机连接", "yes");
+    schema << makeParameter("requirepass", ConfigParameter::String, network, "访问密码，留空表示不设密码", "");
+    schema << makeParameter("tcp-backlog", ConfigParameter::Integer, network,
+                            "listen() 的连接队列长度，受 net.core.somaxconn 限制", "511", 0, 65535, false);
+    schema << makeParameter("tcp-keepalive", ConfigParameter::Integer, network,
+                            "TCP keepalive 间隔（秒），0 表示关闭", "300", 0, 7200);
+    schema << makeParameter("timeout", ConfigParameter::Integer, network,
+                            "空闲连接超时（秒），0 表示不超时", "0", 0, 1000000);
+    schema << makeParameter("maxclients", ConfigParameter::Integer, network, "最大客户端连接数", "10000", 1, 1000000);
+
+    // 内存
+    schema << makeParameter("maxmemory", ConfigParameter::Memory, memory, "内存上限，0 表示不限制", "0",
+                            0, Q_INT64_C(1) << 50);
+    schema << enumParameter("maxmemory-policy", memory, "达到内存上限时的淘汰策略",
+                            QStringList() << "noeviction" << "allkeys-lru" << "allkeys-lfu" << "allkeys-random"
+                                          << "volatile-lru" << "volatile-lfu" << "volatile-random" << "volatile-ttl",
+                            "noeviction");
+    schema << makeParameter("maxmemory-samples", ConfigParameter::Integer, memory,
+                            "近似 LRU/LFU 的采样数，越大越精确也越耗 CPU", "5", 1, 64);
+
+    // 线程与事件循环
+    ConfigParameter ioThreads = makeParameter("io-threads", ConfigParameter::Integer, threads,
+                                              "网络 I/O 线程数，1 表示只用主线程", "1", 1, 128, false);
+    ioThreads.minVersion = "6.0";
+    schema << ioThreads;
+    ConfigParameter ioThreadsReads = boolParameter("io-threads-do-reads", threads,
+                                                   "I/O 线程同时负责读取和解析请求", "no", "6.0");
+    ioThreadsReads.runtime = false;
+    schema << ioThreadsReads;
+    schema << makeParameter("hz", ConfigParameter::Integer, threads,
+                            "后台任务（过期键清理、客户端超时）每秒执行次数", "10", 1, 500);
+    schema << boolParameter("dynamic-hz", threads, "连接数多时自动提高 hz", "yes", "5.0");
+
+    // 惰性释放
+    schema << boolParameter("lazyfree-lazy-eviction", lazyfree, "淘汰键时在后台线程释放内存", "no", "4.0");
+    schema << boolParameter("lazyfree-lazy-expire", lazyfree, "过期键在后台线程释放", "no", "4.0");
+    schema << boolParameter("lazyfree-lazy-server-del", lazyfree, "RENAME 等隐式删除在后台释放", "no", "4.0");
+    schema << boolParameter("replica-lazy-flush", lazyfree, "从节点全量同步前在后台清空数据", "no", "5.0");
+    schema << boolParameter("lazyfree-lazy-user-del", lazyfree, "DEL 的行为与 UNLINK 相同", "no", "6.0");
+    schema << boolParameter("lazyfree-lazy-user-flush", lazyfree, "FLUSHALL / FLUSHDB 默认异步执行", "no", "6.2");
+
+    // 碎片整理
+    schema << boolParameter("activedefrag", defrag, "自动在线碎片整理（需要 jemalloc）", "no", "4.0");
+    ConfigParameter ignoreBytes = makeParameter("active-defrag-ignore-bytes", ConfigParameter::Memory, defrag,
+                                                "碎片少于该值时不整理", "100mb", 0, Q_INT64_C(1) << 50);
+    ignoreBytes.minVersion = "4.0";
+    schema << ignoreBytes;
+    ConfigParameter lower = makeParameter("active-defrag-threshold-lower", ConfigParameter::Integer, defrag,
+                                          "碎片率超过该百分比时开始整理", "10", 0, 1000);
+    lower.minVersion = "4.0";
+    schema << lower;
+    ConfigParameter upper = makeParameter("active-defrag-threshold-upper", ConfigParameter::Integer, defrag,
+                                          "碎片率超过该百分比时全力整理", "100", 0, 1000);
+    upper.minVersion = "4.0";
+    schema << upper;
+    ConfigParameter cycleMin = makeParameter("active-defrag-cycle-min", ConfigParameter::Integer, defrag,
+                                             "整理占用 CPU 的最小百分比", "5", 1, 99);
+    cycleMin.minVersion = "4.0";
+    cycleMin.defaults << qMakePair(QString("7.0"), QString("1"));
+    schema << cycleMin;
+    ConfigParameter cycleMax = makeParameter("active-defrag-cycle-max", ConfigParameter::Integer, defrag,
+                                             "整理占用 CPU 的最大百分比", "75", 1, 99);
+    cycleMax.minVersion = "4.0";
+    cycleMax.defaults << qMakePair(QString("7.0"), QString("25"));
+    schema << cycleMax;
+
+    // 持久化
+    ConfigParameter save = makeParameter("save", ConfigParameter::String, persistence,
+                                         "RDB 快照条件：<秒> <修改次数> ...，留空表示关闭 RDB", "900 1 300 10 60 10000");
+    save.defaults << qMakePair(QString("7.0"), QString("3600 1 300 100 60 10000"));
+    schema << save;
+    schema << boolParameter("appendonly", persistence, "开启 AOF", "no");
+    schema << enumParameter("appendfsync", persistence, "AOF 刷盘策略",
+                            QStringList() << "always" << "everysec" << "no", "everysec");
+    schema << boolParameter("no-appendfsync-on-rewrite", persistence, "重写 AOF / BGSAVE 期间不刷盘", "no");
+    schema << makeParameter("auto-aof-rewrite-percentage", ConfigParameter::Integer, persistence,
+                            "AOF 比上次重写后增长该百分比时自动重写，0 表示关闭", "100", 0, 100000);
+    schema << makeParameter("auto-aof-rewrite-min-size", ConfigParameter::Memory, persistence,
+                            "AOF 小于该值时不自动重写", "64mb", 0, Q_INT64_C(1) << 50);
+    ConfigParameter preamble = boolParameter("aof-use-rdb-preamble", persistence,
+                                             "AOF 重写时以 RDB 格式开头，加载更快", "no", "4.0");
+    preamble.defaults << qMakePair(QString("5.0"), QString("yes"));
+    schema << preamble;
+    schema << boolParameter("rdbcompression", persistence, "RDB 使用 LZF 压缩", "yes");
+    schema << boolParameter("stop-writes-on-bgsave-error", persistence, "快照失败时拒绝写入", "yes");
+
+    // 紧凑编码：7.0 起 ziplist 改名为 listpack
+    auto listpack = [&](const QString& name, const QString& description, const QString& defaultValue,
+                        qint64 minimum, const QString& minVersion) {
+        ConfigParameter parameter = makeParameter(name, ConfigParameter::Integer, encoding, description,
+                                                  defaultValue, minimum, Q_INT64_C(1) << 31);
+        parameter.minVersion = minVersion;
+        if (name.contains("listpack") && minVersion.isEmpty()) {
+            parameter.legacyName = QString(name).replace("listpack", "ziplist");
+            parameter.legacyBefore = "7.0";
+        }
+        return parameter;
+    };
+    schema << listpack("hash-max-listpack-entries", "哈希使用紧凑编码的最大字段数", "128", 0, QString());
+    schema << listpack("hash-max-listpack-value", "哈希使用紧凑编码的最大值长度", "64", 0, QString());
+    schema << listpack("zset-max-listpack-entries", "有序集合使用紧凑编码的最大成员数", "128", 0, QString());
+    schema << listpack("zset-max-listpack-value", "有序集合使用紧凑编码的最大成员长度", "64", 0, QString());
+    schema << listpack("list-max-listpack-size", "列表每个节点的大小，负数表示 -1=4KB ... -5=64KB", "-2", -5, QString());
+    schema << listpack("set-max-intset-entries", "整数集合使用 intset 编码的最大成员数", "512", 0, QString());
+    schema << listpack("set-max-listpack-entries", "集合使用紧凑编码的最大成员数", "128", 0, "7.2");
+    schema << listpack("set-max-listpack-value", "集合使用紧凑编码的最大成员长度", "64", 0, "7.2");
+
+    // 常规
+    ConfigParameter databases = makeParameter("databases", ConfigParameter::Integer, general, "数据库个数",
+                                              "16", 1, 1000000, false);
+    schema << databases;
+    schema << enumParameter("loglevel", general, "日志级别",
+                            QStringList() << "debug" << "verbose" << "notice" << "warning", "notice");
+
+    return schema;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- RedisConfigSchema
+
+const QList<ConfigParameter>& RedisConfigSchema::parameters()
+{
+    static const QList<ConfigParameter> schema = buildSchema();
+    return schema;
+}
+
+const ConfigParameter* RedisConfigSchema::find(const QString& name)
+{
+    QString key = name.toLower();
+    for (const ConfigParameter& parameter : parameters()) {
+        if (parameter.name == key || (!parameter.legacyName.isEmpty() && parameter.legacyName == key)) {
+            return &parameter;
+        }
+    }
+    return nullptr;
+}
+
+QList<ConfigParameter> RedisConfigSchema::forVersion(const QString& version)
+{
+    QList<ConfigParameter> result;
+    for (const ConfigParameter& parameter : parameters()) {
+        if (version.isEmpty() || parameter.minVersion.isEmpty()
+            || VersionStore::compareVersions(version, parameter.minVersion) >= 0) {
+            result << parameter;
+        }
+    }
+    return result;
+}
+
+QStringList RedisConfigSchema::categories()
+{
+    QStringList result;
+    for (const ConfigParameter& parameter : parameters()) {
+        if (!result.contains(parameter.category)) {
+            result << parameter.category;
+        }
+    }
+    return result;
+}
+
+QString RedisConfigSchema::defaultValue(const ConfigParameter& parameter, const QString& version)
+{
+    QString value;
+    for (const QPair<QString, QString>& entry : parameter.defaults) {
+        if (entry.first.isEmpty() || version.isEmpty()
+            || VersionStore::compareVersions(version, entry.first) >= 0) {
+            value = entry.second;
+        }
+    }
+    return value;
+}
+
+QString RedisConfigSchema::nameForVersion(const ConfigParameter& parameter, const QString& version)
+{
+    if (!parameter.legacyName.isEmpty() && !version.isEmpty()
+        && VersionStore::compareVersions(version, parameter.legacyBefore) < 0) {
+        return parameter.legacyName;
+    }
+    return parameter.name;
+}
+
+qint64 RedisConfigSchema::parseMemory(const QString& value)
+{
+    // 与 Redis 相同：1k = 1000，1kb = 1024
+    static const QRegularExpression memoryRe("^(\\d+)(k|kb|m|mb|g|gb)?$");
+    QRegularExpressionMatch match = memoryRe.match(value.trimmed().toLower());
+    if (!match.hasMatch()) {
+        return -1;
+    }
+
+    QString unit = match.captured(2);
+    qint64 bytes = match.captured(1).toLongLong();
+    if (unit.isEmpty()) {
+        return bytes;
+    }
+    qint64 base = unit.endsWith('b') ? 1024 : 1000;
+    int power = unit.startsWith('k') ? 1 : unit.startsWith('m') ? 2 : 3;
+    for (int i = 0; i < power; ++i) {
+        bytes *= base;
+    }
+    return bytes;
+}
+
+QString RedisConfigSchema::normalize(const QString& value)
+{
+    QString normalized = value.trimmed().toLower();
+    if (normalized.size() >= 2 && normalized.startsWith('"') && normalized.endsWith('"')) {
+        normalized = normalized.mid(1, normalized.size() - 2);
+    }
+
+    // CONFIG GET 返回字节数，配置里常写成 256mb
+    qint64 bytes = parseMemory(normalized);
+    return bytes >= 0 ? QString::number(bytes) : normalized;
+}
+
+bool RedisConfigSchema::validate(const QString& name, const QString& value, QString* error)
+{
+    const ConfigParameter* parameter = find(name);
+    if (!parameter) {
+        // 未知参数交给 Redis 判断
+        return true;
+    }
+
+    QString message;
+    switch (parameter->type) {
+    case ConfigParameter::Bool:
+    case ConfigParameter::Enum:
+        if (!parameter->choices.contains(value.trimmed().toLower())) {
+            message = QString("%1 只能是 %2").arg(parameter->name, parameter->choices.join(" / "));
+        }
+        break;
+    case ConfigParameter::Integer: {
+        bool ok = false;
+        qint64 number = value.trimmed().toLongLong(&ok);
+        if (!ok || number < parameter->minimum || number > parameter->maximum) {
+            message = QString("%1 必须是 %2 到 %3 之间的整数")
+                          .arg(parameter->name).arg(parameter->minimum).arg(parameter->maximum);
+        }
+        break;
+    }
+    case ConfigParameter::Memory: {
+        qint64 bytes = parseMemory(value);
+        if (bytes < parameter->minimum || bytes > parameter->maximum) {
+            message = QString("%1 必须是字节数，可带 kb / mb / gb 单位").arg(parameter->name);
+        }
+        break;
+    }
+    case ConfigParameter::String:
+        break;
+    }
+
+    if (error) {
+        *error = message;
+    }
+    return message.isEmpty();
+}
+
+// ---------------------------------------------------------------- RedisConfig
+
+bool RedisConfig::load(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+    parse(QString::fromUtf8(file.readAll()));
+    return true;
+}
+
+bool RedisConfig::save(const QString& path) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    file.write(toString().toUtf8());
+    return file.commit();
+}
+
+void RedisConfig::parse(const QString& text)
+{
+    m_lines.clear();
+    QStringList lines = text.split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
+    }
+    for (const QString& line : lines) {
+        m_lines << parseLine(line);
+    }
+}
+
+QString RedisConfig::toString() const
+{
+    QString text;
+    for (const Line& line : m_lines) {
+        text += line.text;
+        text += '\n';
+    }
+    return text;
+}
+
+RedisConfig::Line RedisConfig::parseLine(const QString& text)
+{
+    Line line;
+    line.text = text;
+
+    QString trimmed = text.trimmed();
+    if (trimmed.isEmpty() || trimmed.startsWith('#')) {
+        return line;
+    }
+
+    QStringList args = splitArgs(trimmed);
+    if (args.isEmpty()) {
+        return line;
+    }
+    line.key = args.takeFirst().toLower();
+    line.value = args.join(' ');
+    return line;
+}
+
+QStringList RedisConfig::splitArgs(const QString& line)
+{
+    // 与 Redis 的 sdssplitargs 一致：空白分隔，支持 "..."（带转义）和 '...'
+    QStringList args;
+    int i = 0;
+    const int size = line.size();
+    while (i < size) {
+        while (i < size && line.at(i).isSpace()) {
+            ++i;
+        }
+        if (i >= size) {
+            break;
+        }
+
+        QString current;
+        QChar quote;
+        if (line.at(i) == '"' || line.at(i) == '\'') {
+            quote = line.at(i++);
+        }
+        while (i < size) {
+            QChar c = line.at(i);
+            if (quote.isNull()) {
+                if (c.isSpace()) {
+                    break;
+                }
+                current += c;
+                ++i;
+            } else if (c == quote) {
+                ++i;
+                break;
+            } else if (c == '\\' && quote == '"' && i + 1 < size) {
+                QChar next = line.at(i + 1);
+                current += next == 'n' ? QChar('\n') : next == 't' ? QChar('\t') : next;
+                i += 2;
+            } else {
+                current += c;
+                ++i;
+            }
+        }
+        args << current;
+    }
+    return args;
+}
+
+QString RedisConfig::formatLine(const QString& key, const QString& value)
+{
+    if (kMultiWordKeys.contains(key)) {
+        return value.isEmpty() ? key + " \"\"" : key + " " + value;
+    }
+
+    bool quote = value.isEmpty() || value.contains(' ') || value.contains('"') || value.contains('\'');
+    if (!quote) {
+        return key + " " + value;
+    }
+    QString escaped = value;
+    escaped.replace("\\", "\\\\").replace("\"", "\\\"");
+    return key + " \"" + escaped + "\"";
+}
+
+bool RedisConfig::contains(const QString& key) const
+{
+    QString name = key.toLower();
+    for (const Line& line : m_lines) {
+        if (line.key == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString RedisConfig::value(const QString& key, const QString& defaultValue) const
+{
+    QStringList all = values(key);
+    return all.isEmpty() ? defaultValue : all.last();
+}
+
+QStringList RedisConfig::values(const QString& key) const
+{
+    QString name = key.toLower();
+    QStringList result;
+    for (const Line& line : m_lines) {
+        if (line.key == name) {
+            result << line.value;
+        }
+    }
+    return result;
+}
+
+QStringList RedisConfig::keys() const
+{
+    QStringList result;
+    for (const Line& line : m_lines) {
+        if (!line.key.isEmpty() && !result.contains(line.key)) {
+            result << line.key;
+        }
+    }
+    return result;
+}
+
+void RedisConfig::setValue(const QString& key, const QString& value)
+{
+    // 6.2 之前的 Redis 每行 save 只接受一对 <秒> <修改次数>
+    QStringList words = value.split(' ', Qt::SkipEmptyParts);
+    if (key.toLower() == "save" && words.size() > 2 && words.size() % 2 == 0) {
+        QStringList pairs;
+        for (int i = 0; i < words.size(); i += 2) {
+            pairs << words.at(i) + " " + words.at(i + 1);
+        }
+        setValues(key, pairs);
+        return;
+    }
+    setValues(key, QStringList() << value);
+}
+
+void RedisConfig::setValues(const QString& key, const QStringList& values)
+{
+    QString name = key.toLower();
+    QList<Line> replacement;
+    for (const QString& value : values) {
+        Line line;
+        line.text = formatLine(name, value);
+        line.key = name;
+        line.value = value;
+        replacement << line;
+    }
+
+    int first = -1;
+    for (int i = m_lines.size() - 1; i >= 0; --i) {
+        if (m_lines.at(i).key == name) {
+            m_lines.removeAt(i);
+            first = i;
+        }
+    }
+
+    if (first < 0) {
+        m_lines << replacement;
+        return;
+    }
+    for (int i = 0; i < replacement.size(); ++i) {
+        m_lines.insert(first + i, replacement.at(i));
+    }
+}
+
+void RedisConfig::remove(const QString& key)
+{
+    QString name = key.toLower();
+    for (int i = m_lines.size() - 1; i >= 0; --i) {
+        if (m_lines.at(i).key == name) {
+            m_lines.removeAt(i);
+        }
+    }
+}
+
+void RedisConfig::appendLine(const QString& text)
+{
+    m_lines << parseLine(text);
+}
+
+QStringList RedisConfig::validate(const QString& version) const
+{
+    QStringList errors;
+    for (const QString& key : keys()) {
+        const ConfigParameter* parameter = RedisConfigSchema::find(key);
+        if (!parameter) {
+            continue;
+        }
+        if (!version.isEmpty() && !parameter->minVersion.isEmpty()
+            && VersionStore::compareVersions(version, parameter->minVersion) < 0) {
+            errors << QString("%1 需要 Redis %2 或更高版本").arg(key, parameter->minVersion);
+            continue;
+        }
+        // save 可以出现多次，每行单独检查没有意义
+        if (parameter->type == ConfigParameter::String) {
+            continue;
+        }
+        QString error;
+        if (!RedisConfigSchema::validate(key, value(key), &error)) {
+            errors << error;
+        }
+    }
+    return errors;
+}
@@ -0,0 +1,105 @@
+#ifndef REDISCONFIG_H
+#define REDISCONFIG_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QPair>
+#include <QMap>
+
+// redis.conf 中一个参数的类型、取值范围、默认值以及适用的 Redis 版本
+struct ConfigParameter
+{
+    enum Type {
+        Bool,
+        Integer,
+        Memory,     // 字节数，可带 kb / mb / gb 单位
+        Enum,
+        String
+    };
+
+    QString name;
+    Type type;
+    QString category;
+    QString description;
+    qint64 minimum;
+    qint64 maximum;
+    QStringList choices;
+    // 默认值随版本变化：按版本从旧到新排列的 (起始版本, 默认值)
+    QList<QPair<QString, QString>> defaults;
+    QString minVersion;
+    // 旧版本中的名称，如 7.0 之前的 hash-max-ziplist-entries
+    QString legacyName;
+    QString legacyBefore;
+    // 能否用 CONFIG SET 在运行时修改
+    bool runtime;
+};
+
+// 已知参数的表，覆盖启动时写入的基础配置和常用的性能参数
+class RedisConfigSchema
+{
+public:
+    static const QList<ConfigParameter>& parameters();
+    static const ConfigParameter* find(const QString& name);
+    // 指定版本支持的参数；version 为空时返回全部
+    static QList<ConfigParameter> forVersion(const QString& version);
+    static QStringList categories();
+
+    static QString defaultValue(const ConfigParameter& parameter, const QString& version);
+    // 参数在该版本配置文件中使用的名称
+    static QString nameForVersion(const ConfigParameter& parameter, const QString& version);
+    static bool validate(const QString& name, const QString& value, QString* error = nullptr);
+
+    // 把 256mb、1gb 之类的写法转换为字节数，失败返回 -1
+    static qint64 parseMemory(const QString& value);
+    // 用于比较的规范形式：小写、去引号、内存单位转换为字节数
+    static QString normalize(const QString& value);
+};
+
+// 一个 redis.conf 文件：按行保存原文，未修改的行（包括注释和空行）写回时原样保留。
+// 参数名不区分大小写；同一参数出现多次（如 save）时可以按多行读写
+class RedisConfig
+{
+public:
+    RedisConfig() = default;
+
+    bool load(const QString& path);
+    bool save(const QString& path) const;
+    void parse(const QString& text);
+    QString toString() const;
+
+    bool contains(const QString& key) const;
+    // 参数最后一次出现的值（与 Redis 读取配置的规则一致），参数多于一个词时以空格连接
+    QString value(const QString& key, const QString& defaultValue = QString()) const;
+    // 参数每次出现的值，用于 save 等可重复的参数
+    QStringList values(const QString& key) const;
+    QStringList keys() const;
+
+    // 在原位置替换第一处，删除其余重复的行；不存在时追加到文件末尾
+    void setValue(const QString& key, const QString& value);
+    void setValues(const QString& key, const QStringList& values);
+    void remove(const QString& key);
+    // 在末尾追加一行原文（注释、空行或参数）
+    void appendLine(const QString& text);
+
+    // 按 schema 检查所有已知参数，返回错误描述
+    QStringList validate(const QString& version = QString()) const;
+
+    static QStringList splitArgs(const QString& line);
+    static QString formatLine(const QString& key, const QString& value);
+
+private:
+    struct Line
+    {
+        QString text;
+        // 注释和空行为空
+        QString key;
+        QString value;
+    };
+
+    static Line parseLine(const QString& text);
+
+    QList<Line> m_lines;
+};
+
+#endif // REDISCONFIG_H
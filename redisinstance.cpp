@@ -0,0 +1,369 @@
+#include "redisinstance.h"
+#include "respclient.h"
+#include "readinessprobe.h"
+#include "redisconfig.h"
+#include "latencyprober.h"
+#include "metricsampler.h"
+#include "metricsstore.h"
+#include "serviceconfig.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTimer>
+#include <QTcpSocket>
+#include <QStandardPaths>
+#include <QDebug>
+
+// SHUTDOWN 期间多久没有进展（快照文件不再增长）才升级为信号
+static const qint64 kStopStallMs = 15000;
+
+RedisInstance::RedisInstance(const QString& name, const QString& dir, QObject *parent)
+    : QObject(parent)
+    , m_name(name)
+    , m_dir(dir)
+    , m_state(Stopped)
+    , m_port(0)
+    , m_stopEscalation(0)
+    , m_timeToReadyMs(-1)
+    , m_snapshotBytes(0)
+    , m_stopProgressMs(0)
+    , m_loadingPercent(0)
+{
+    m_client = new RespClient(this);
+    m_readinessProbe = new ReadinessProbe(m_client, this);
+
+    connect(m_readinessProbe, &ReadinessProbe::ready, this, &RedisInstance::onReady);
+    connect(m_readinessProbe, &ReadinessProbe::failed, this, &RedisInstance::onReadinessFailed);
+    connect(m_readinessProbe, &ReadinessProbe::loadingProgress,
+            this, [this](double percent, qint64 etaSeconds) {
+                m_loadingPercent = percent;
+                emit loadingProgress(percent, etaSeconds);
+            });
+
+    m_stopTimer = new QTimer(this);
+    m_stopTimer->setInterval(500);
+    connect(m_stopTimer, &QTimer::timeout, this, &RedisInstance::onStopTick);
+
+    const ServiceConfig& config = ServiceConfig::instance();
+    m_latencyProber = new LatencyProber(this);
+    m_latencyProber->setTag(m_name);
+    m_latencyProber->setCommands(config.getLatencyCommands());
+    m_latencyProber->setProbeInterval(config.getLatencyProbeInterval());
+    m_latencyProber->setConnectionCount(config.getLatencyConnections());
+
+    m_metricsSampler = new MetricsSampler(this);
+    m_metricsSampler->setInterval(config.getMetricsInterval());
+    m_metricsStore = new MetricsStore(
+        QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/metrics/" + m_name, this);
+    connect(m_metricsSampler, &MetricsSampler::sampled, this, [this]() {
+        float values[MetricsStore::kMetricCount];
+        for (int i = 0; i < MetricsStore::kMetricCount; ++i) {
+            values[i] = float(m_metricsSampler->series(MetricsSampler::Metric(i)).last());
+        }
+        m_metricsStore->append(m_metricsSampler->lastSampleTime(), values);
+    });
+
+    // 输出写入各自的 redis.log，这里不读取
+    m_process = new QProcess(this);
+    m_process->setWorkingDirectory(m_dir);
+    m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    m_process->setStandardOutputFile(QProcess::nullDevice());
+
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &RedisInstance::onProcessFinished);
+    connect(m_process, &QProcess::errorOccurred, this, &RedisInstance::onProcessError);
+
+    reloadConfig();
+}
+
+RedisInstance::~RedisInstance()
+{
+    if (m_process->state() != QProcess::NotRunning) {
+        beginShutdown();
+        waitForStopped(30000);
+    }
+}
+
+QString RedisInstance::configPath() const
+{
+    return m_dir + "/redis.conf";
+}
+
+QString RedisInstance::logPath() const
+{
+    return m_dir + "/redis.log";
+}
+
+QString RedisInstance::pidPath() const
+{
+    return m_dir + "/redis.pid";
+}
+
+void RedisInstance::reloadConfig()
+{
+    RedisConfig config;
+    config.load(configPath());
+    m_port = config.value("port", "6379").toInt();
+    m_password = config.value("requirepass");
+
+    // 监听所有地址时通过本机回环连接
+    QString bind = config.value("bind").section(' ', 0, 0);
+    m_host = (bind.isEmpty() || bind == "0.0.0.0" || bind == "*") ? QString("127.0.0.1") : bind;
+}
+
+QString RedisInstance::stateName(State state)
+{
+    switch (state) {
+    case Starting:
+        return "启动中";
+    case Running:
+        return "运行中";
+    case Stopping:
+        return "停止中";
+    case Failed:
+        return "失败";
+    default:
+        return "已停止";
+    }
+}
+
+qint64 RedisInstance::processId() const
+{
+    return m_process->processId();
+}
+
+void RedisInstance::setState(State state)
+{
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    // 只在运行期间探测延迟和采样指标
+    if (state == Running) {
+        m_latencyProber->start();
+        m_metricsSampler->start();
+    } else {
+        m_latencyProber->stop();
+        m_metricsSampler->stop();
+    }
+    emit stateChanged(state);
+}
+
+bool RedisInstance::start(const QString& serverExecutable, const QString& version)
+{
+    if (m_state == Starting || m_state == Running || m_state == Stopping) {
+        return true;
+    }
+    if (m_process->state() != QProcess::NotRunning) {
+        m_lastError = "上次启动的进程仍在运行，请先停止";
+        return false;
+    }
+
+    if (!QFile::exists(serverExecutable)) {
+        m_lastError = "未找到 Redis 可执行文件: " + serverExecutable;
+        setState(Failed);
+        return false;
+    }
+
+    reloadConfig();
+    m_client->setPassword(m_password);
+    m_client->setServer(m_host, quint16(m_port));
+    m_latencyProber->setServer(m_host, quint16(m_port), m_password);
+    m_metricsSampler->setServer(m_host, quint16(m_port), m_password);
+
+    // 上次被强杀时留下的 PID 文件
+    QFile::remove(pidPath());
+
+    m_lastError.clear();
+    m_timeToReadyMs = -1;
+    m_loadingPercent = 0;
+    setState(Starting);
+
+    qDebug() << "[RedisInstance]" << m_name << "starting on port" << m_port << m_placement.description;
+    m_placement.applyTo(m_process);
+    m_process->start(serverExecutable, QStringList() << configPath() << m_placement.redisArguments(version));
+    m_readinessProbe->setDataSize(dataFileSize(m_dir));
+    m_readinessProbe->start();
+    return true;
+}
+
+qint64 RedisInstance::dataFileSize(const QString& dir)
+{
+    qint64 size = QFileInfo(dir + "/dump.rdb").size();
+
+    // AOF 优先于 RDB 加载：Redis 7 的 appendonlydir 或旧版本的 appendonly.aof
+    const QFileInfoList aofFiles = QDir(dir + "/appendonlydir").entryInfoList(QDir::Files);
+    qint64 aofSize = QFileInfo(dir + "/appendonly.aof").size();
+    for (const QFileInfo& file : aofFiles) {
+        aofSize += file.size();
+    }
+    return aofSize > 0 ? aofSize : size;
+}
+
+void RedisInstance::onReady(qint64 elapsedMs, double loadBytesPerSecond)
+{
+    Q_UNUSED(loadBytesPerSecond);
+    m_timeToReadyMs = elapsedMs;
+    m_loadingPercent = 100;
+    qDebug() << "[RedisInstance]" << m_name << "ready in" << elapsedMs << "ms";
+    setState(Running);
+}
+
+void RedisInstance::onReadinessFailed(const QString& error)
+{
+    m_lastError = error;
+    setState(Failed);
+}
+
+void RedisInstance::stop(bool save)
+{
+    if (m_state == Stopping) {
+        return;
+    }
+    if (m_process->state() == QProcess::NotRunning) {
+        m_readinessProbe->stop();
+        setState(Stopped);
+        return;
+    }
+
+    m_readinessProbe->stop();
+    m_snapshotBytes = 0;
+    m_stopProgressMs = 0;
+    m_stopEscalation = 0;
+    m_stopClock.start();
+    m_stopTimer->start();
+    setState(Stopping);
+
+    // 成功时 Redis 直接断开连接而不回复
+    m_client->send(QList<QByteArray>() << "SHUTDOWN" << (save ? "SAVE" : "NOSAVE"),
+                   [this](const RespValue& reply) { onShutdownReply(reply); });
+}
+
+void RedisInstance::onShutdownReply(const RespValue& reply)
+{
+    // 连接断开（包括 SHUTDOWN 成功）时等待进程退出，由 onStopTick 判断是否卡住
+    if (m_state != Stopping || !reply.isError() || !m_client->isConnected()) {
+        return;
+    }
+
+    if (reply.data().startsWith("NOAUTH") || reply.data().startsWith("WRONGPASS")) {
+        escalateStop();
+        return;
+    }
+
+    // 拒绝关闭通常是快照保存失败，强杀会丢数据，保持运行
+    m_stopTimer->stop();
+    m_lastError = "Redis 拒绝关闭: " + reply.toString();
+    qDebug() << "[RedisInstance]" << m_name << m_lastError;
+    setState(Running);
+}
+
+void RedisInstance::onStopTick()
+{
+    qint64 elapsed = m_stopClock.elapsed();
+
+    // 保存时先写 temp-<pid>.rdb，文件还在增长说明没有卡住
+    qint64 written = 0;
+    const QFileInfoList temps = QDir(m_dir).entryInfoList(QStringList() << "temp-*.rdb", QDir::Files);
+    for (const QFileInfo& temp : temps) {
+        written += temp.size();
+    }
+    if (written != m_snapshotBytes) {
+        m_snapshotBytes = written;
+        m_stopProgressMs = elapsed;
+    }
+
+    if (elapsed - m_stopProgressMs >= kStopStallMs) {
+        m_stopProgressMs = elapsed;
+        escalateStop();
+    }
+}
+
+void RedisInstance::escalateStop()
+{
+    if (m_stopEscalation == 0) {
+        m_stopEscalation = 1;
+        qDebug() << "[RedisInstance]" << m_name << "SHUTDOWN stalled, sending SIGTERM";
+        m_process->terminate();
+    } else if (m_stopEscalation == 1) {
+        m_stopEscalation = 2;
+        qDebug() << "[RedisInstance]" << m_name << "still running, killing";
+        m_process->kill();
+    }
+}
+
+void RedisInstance::beginShutdown()
+{
+    m_readinessProbe->stop();
+    m_stopTimer->stop();
+    if (m_process->state() == QProcess::Starting) {
+        m_process->kill();
+        return;
+    }
+    if (m_process->state() != QProcess::Running) {
+        return;
+    }
+    m_state = Stopping;
+
+    // 析构时没有事件循环可用，用阻塞的连接发送
+    QTcpSocket socket;
+    socket.connectToHost(m_host, quint16(m_port));
+    if (socket.waitForConnected(1000)) {
+        QByteArray request;
+        if (!m_password.isEmpty()) {
+            RespClient::encode(QList<QByteArray>() << "AUTH" << m_password.toUtf8(), request);
+        }
+        RespClient::encode(QList<QByteArray>() << "SHUTDOWN" << "SAVE", request);
+        socket.write(request);
+        socket.waitForBytesWritten(1000);
+    } else {
+        m_process->terminate();
+    }
+}
+
+void RedisInstance::waitForStopped(int timeoutMs)
+{
+    if (m_process->state() != QProcess::NotRunning && !m_process->waitForFinished(timeoutMs)) {
+        m_process->terminate();
+        if (!m_process->waitForFinished(5000)) {
+            m_process->kill();
+            m_process->waitForFinished(2000);
+        }
+    }
+    m_client->disconnectFromServer();
+}
+
+void RedisInstance::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    bool wasStarting = m_readinessProbe->isRunning();
+    bool wasStopping = m_state == Stopping;
+    m_readinessProbe->stop();
+    m_stopTimer->stop();
+    m_client->disconnectFromServer();
+
+    if (wasStopping) {
+        qDebug() << "[RedisInstance]" << m_name << "stopped in" << m_stopClock.elapsed() << "ms";
+        setState(Stopped);
+        return;
+    }
+
+    if (wasStarting) {
+        m_lastError = QString("Redis 在就绪前退出（退出码 %1），详见 %2").arg(exitCode).arg(logPath());
+    } else if (exitStatus == QProcess::CrashExit) {
+        m_lastError = "Redis 进程崩溃";
+    } else {
+        m_lastError = QString("Redis 意外退出（退出码 %1）").arg(exitCode);
+    }
+    setState(Failed);
+}
+
+void RedisInstance::onProcessError(QProcess::ProcessError error)
+{
+    // 进程退出的情况由 onProcessFinished 处理
+    if (error != QProcess::FailedToStart) {
+        return;
+    }
+    m_readinessProbe->stop();
+    m_lastError = "Redis 启动失败: " + m_process->errorString();
+    setState(Failed);
+}
@@ -0,0 +1,120 @@
+#ifndef REDISINSTANCE_H
+#define REDISINSTANCE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QElapsedTimer>
+#include "cputopology.h"
+
+class QTimer;
+class RespClient;
+class RespValue;
+class ReadinessProbe;
+class LatencyProber;
+class MetricsSampler;
+class MetricsStore;
+
+// 多实例中的一个 Redis 进程。每个实例有自己的目录：
+//   <dir>/redis.conf   端口、数据、日志、PID 文件都指向本目录
+//   <dir>/dump.rdb、appendonlydir/、redis.log、redis.pid
+// 指标历史写入 <AppLocalData>/metrics/<name>，不放在实例目录里，删除实例后仍可查看。
+// 启动、就绪探测和 SHUTDOWN 停止的方式与 RedisManager 管理的主实例相同，
+// 所有操作都是异步的，多个实例可以同时启动或停止。
+class RedisInstance : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State {
+        Stopped,
+        Starting,   // 进程已拉起，等待 PING 成功、数据加载完
+        Running,
+        Stopping,
+        Failed      // 启动失败或进程意外退出，原因见 lastError()
+    };
+
+    RedisInstance(const QString& name, const QString& dir, QObject *parent = nullptr);
+    ~RedisInstance();
+
+    QString name() const { return m_name; }
+    QString dir() const { return m_dir; }
+    QString configPath() const;
+    QString logPath() const;
+    QString pidPath() const;
+
+    // 端口和密码从 redis.conf 读取
+    int port() const { return m_port; }
+    void reloadConfig();
+
+    State state() const { return m_state; }
+    static QString stateName(State state);
+    qint64 processId() const;
+    QString lastError() const { return m_lastError; }
+    // 从启动到就绪的耗时，未就绪时为 -1
+    qint64 timeToReadyMs() const { return m_timeToReadyMs; }
+    // 加载数据时的进度（百分比）
+    double loadingPercent() const { return m_loadingPercent; }
+    // 运行期间在专用连接上探测命令延迟
+    LatencyProber* latencyProber() const { return m_latencyProber; }
+    // 运行期间定时采样 INFO，每次采样写入本实例的指标历史
+    MetricsSampler* metricsSampler() const { return m_metricsSampler; }
+    MetricsStore* metricsStore() const { return m_metricsStore; }
+
+    // 下次启动时应用的 CPU / NUMA 放置，运行中修改不影响当前进程
+    void setPlacement(const Placement& placement) { m_placement = placement; }
+    Placement placement() const { return m_placement; }
+
+    // version 用于判断 redis-server 是否支持按线程类型绑核的参数
+    bool start(const QString& serverExecutable, const QString& version = QString());
+    // SHUTDOWN SAVE|NOSAVE，长时间没有进展才依次 SIGTERM / SIGKILL
+    void stop(bool save = true);
+    // 发出 SHUTDOWN 但不等待，配合 waitForStopped() 让多个实例并行退出
+    void beginShutdown();
+    void waitForStopped(int timeoutMs);
+
+    // dump.rdb 或 AOF 的大小，用于估算加载速度
+    static qint64 dataFileSize(const QString& dir);
+
+signals:
+    void stateChanged(RedisInstance::State state);
+    void loadingProgress(double percent, qint64 etaSeconds);
+
+private slots:
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onProcessError(QProcess::ProcessError error);
+    void onReady(qint64 elapsedMs, double loadBytesPerSecond);
+    void onReadinessFailed(const QString& error);
+    void onStopTick();
+
+private:
+    void setState(State state);
+    void onShutdownReply(const RespValue& reply);
+    void escalateStop();
+
+private:
+    QString m_name;
+    QString m_dir;
+    QString m_host;
+    QString m_password;
+    QString m_lastError;
+    QProcess* m_process;
+    RespClient* m_client;
+    ReadinessProbe* m_readinessProbe;
+    LatencyProber* m_latencyProber;
+    MetricsSampler* m_metricsSampler;
+    MetricsStore* m_metricsStore;
+    QTimer* m_stopTimer;
+    QElapsedTimer m_stopClock;
+    Placement m_placement;
+
+    State m_state;
+    int m_port;
+    int m_stopEscalation;
+    qint64 m_timeToReadyMs;
+    qint64 m_snapshotBytes;
+    qint64 m_stopProgressMs;
+    double m_loadingPercent;
+};
+
+#endif // REDISINSTANCE_H
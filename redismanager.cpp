@@ -1,72 +1,189 @@
 #include "redismanager.h"
+#include "artifactcache.h"
+#include "buildcache.h"
+#include "redisbuilder.h"
+#include "redisbenchmark.h"
+#include "installjob.h"
+#include "versionstore.h"
+#include "serviceconfig.h"
+#include "respclient.h"
+#include "readinessprobe.h"
+#include "redisconfig.h"
+#include "resourcesizer.h"
+#include "redisinstance.h"
+#include "instanceregistry.h"
+#include "cputopology.h"
+#include "logbuffer.h"
+#include "logtailer.h"
+#include "healthmonitor.h"
+#include "metricsampler.h"
+#include "metricsstore.h"
+#include "latencyprober.h"
 #include <QDir>
 #include <QFile>
 #include <QStandardPaths>
-#include <QTextStream>
 #include <QFileInfo>
 #include <QCoreApplication>
-#include <QThread>
+#include <QCryptographicHash>
+#include <QTimer>
+#include <QTcpSocket>
+#include <memory>
 #include <QDebug>
 
-#ifdef Q_OS_WIN
-#include <windows.h>
-#include <tlhelp32.h>
-#else
-#include <signal.h>
-#endif
+// SHUTDOWN 期间多久没有进展（快照文件不再增长）才升级为信号
+static const qint64 kStopStallMs = 15000;
 
 RedisManager::RedisManager(QObject *parent)
     : QObject(parent)
     , m_networkManager(nullptr)
-    , m_downloadReply(nullptr)
+    , m_artifactCache(nullptr)
+    , m_buildCache(nullptr)
+    , m_benchmark(nullptr)
+    , m_versionStore(nullptr)
+    , m_primaryJob(nullptr)
     , m_redisProcess(nullptr)
+    , m_client(nullptr)
+    , m_readinessProbe(nullptr)
+    , m_stopTimer(nullptr)
+    , m_instanceRegistry(nullptr)
+    , m_logBuffer(nullptr)
+    , m_logTailer(nullptr)
+    , m_healthMonitor(nullptr)
+    , m_metricsSampler(nullptr)
+    , m_metricsStore(nullptr)
+    , m_latencyProber(nullptr)
+    , m_restartPort(0)
+    , m_snapshotBytes(0)
+    , m_stopProgressMs(0)
+    , m_stopEscalation(0)
+    , m_benchmarkAfterBuild(true)
     , m_isInstalled(false)
     , m_isRunning(false)
+    , m_isReady(false)
+    , m_isStopping(false)
+    , m_restartPending(false)
 {
     m_networkManager = new QNetworkAccessManager(this);
+    
+    m_artifactCache = new ArtifactCache(
+        QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/cache/artifacts", this);
+    m_artifactCache->setMaxSize(ServiceConfig::instance().getArtifactCacheMaxSize());
+    
+    m_buildCache = new BuildCache(
+        QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/cache/builds", this);
+    
+    m_buildProfile = ServiceConfig::instance().getBuildProfile();
+    m_buildAllocator = ServiceConfig::instance().getBuildAllocator();
+    m_benchmarkAfterBuild = ServiceConfig::instance().isBenchmarkAfterBuild();
+    
+    m_benchmark = new RedisBenchmark(this);
+    
+    connect(m_benchmark, &RedisBenchmark::finished,
+            this, &RedisManager::onBenchmarkFinished);
+    
+    m_client = new RespClient(this);
+    m_readinessProbe = new ReadinessProbe(m_client, this);
+    
+    connect(m_readinessProbe, &ReadinessProbe::ready,
+            this, &RedisManager::onRedisReady);
+    connect(m_readinessProbe, &ReadinessProbe::failed,
+            this, &RedisManager::onReadinessFailed);
+    connect(m_readinessProbe, &ReadinessProbe::loadingProgress,
+            this, &RedisManager::redisLoadingProgress);
+    
+    // 心跳使用单独的连接，不会排在配置命令后面
+    m_healthMonitor = new HealthMonitor(this);
+    connect(m_healthMonitor, &HealthMonitor::stateChanged,
+            this, [this](HealthMonitor::State state) {
+                if (state != HealthMonitor::Unknown) {
+                    emit redisHealthChanged(state == HealthMonitor::Responsive);
+                }
+            });
+    
+    m_metricsSampler = new MetricsSampler(this);
+    m_metricsSampler->setInterval(ServiceConfig::instance().getMetricsInterval());
+
+    // 每次采样同时写入磁盘历史
+    static_assert(MetricsSampler::MetricCount == MetricsStore::kMetricCount,
+                  "MetricsStore 的记录宽度必须和采样的指标数一致");
+    m_metricsStore = new MetricsStore(
+        QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/metrics/main", this);
+    connect(m_metricsSampler, &MetricsSampler::sampled, this, [this]() {
+        float values[MetricsStore::kMetricCount];
+        for (int i = 0; i < MetricsStore::kMetricCount; ++i) {
+            values[i] = float(m_metricsSampler->series(MetricsSampler::Metric(i)).last());
+        }
+        m_metricsStore->append(m_metricsSampler->lastSampleTime(), values);
+    });
+
+    const ServiceConfig& latencyConfig = ServiceConfig::instance();
+    m_latencyProber = new LatencyProber(this);
+    m_latencyProber->setTag("main");
+    m_latencyProber->setCommands(latencyConfig.getLatencyCommands());
+    m_latencyProber->setProbeInterval(latencyConfig.getLatencyProbeInterval());
+    m_latencyProber->setConnectionCount(latencyConfig.getLatencyConnections());
+    
+    m_stopTimer = new QTimer(this);
+    m_stopTimer->setInterval(500);
+    connect(m_stopTimer, &QTimer::timeout, this, &RedisManager::onStopTick);
+    
     m_redisProcess = new QProcess(this);
     
     connect(m_redisProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &RedisManager::onRedisProcessFinished);
     connect(m_redisProcess, &QProcess::errorOccurred,
             this, &RedisManager::onRedisProcessError);
+    connect(m_redisProcess, &QProcess::started,
+            this, &RedisManager::redisStarted);
+    // 配置了 logfile 后标准输出只有启动前的少量内容，与 redis.log 一起进入日志缓冲区
+    m_logBuffer = new LogRingBuffer(8 * 1024 * 1024, this);
     connect(m_redisProcess, &QProcess::readyReadStandardOutput,
             this, [this]() {
-                QString output = QString::fromUtf8(m_redisProcess->readAllStandardOutput());
-                if (!output.isEmpty()) {
-                    qDebug() << "[Redis Output]" << output.trimmed();
-                }
+                m_logBuffer->append(m_redisProcess->readAllStandardOutput());
             });
     connect(m_redisProcess, &QProcess::readyReadStandardError,
             this, [this]() {
-                QString error = QString::fromUtf8(m_redisProcess->readAllStandardError());
-                if (!error.isEmpty()) {
-                    qDebug() << "[Redis Error]" << error.trimmed();
-                }
+                m_logBuffer->append(m_redisProcess->readAllStandardError());
             });
     
-    // 检查 Redis 是否已安装
+    // 检查 Redis 是否已安装：各版本并存于 m_redisPath 下，配置和数据在根目录共用
     m_redisPath = getDefaultInstallPath();
     m_redisConfigPath = m_redisPath + "/redis.conf";
     
-#ifdef Q_OS_WIN
-    QString redisExe = m_redisPath + "/redis-server.exe";
-#else
-    QString redisExe = m_redisPath + "/redis-server";
-#endif
+    m_versionStore = new VersionStore(m_redisPath, this);
+    m_versionStore->migrateLegacyLayout();
+    connect(m_versionStore, &VersionStore::committed,
+            this, &RedisManager::onVersionCommitted);
+    
+    m_isInstalled = QFile::exists(redisExecutable("redis-server"));
     
-    m_isInstalled = QFile::exists(redisExe);
+    m_logTailer = new LogTailer(m_logBuffer, this);
+    if (m_isInstalled) {
+        m_logTailer->start(redisLogPath());
+    }
+    
+    // 多实例与主实例共用当前版本的程序
+    m_instanceRegistry = new InstanceRegistry(m_redisPath + "/instances", this);
+    m_instanceRegistry->setPortRange(ServiceConfig::instance().getInstancePortStart(),
+                                     ServiceConfig::instance().getInstancePortEnd());
+    m_instanceRegistry->setServerExecutable(redisExecutable("redis-server"), activeVersion());
+    connect(this, &RedisManager::activeVersionChanged, this, [this](const QString& version) {
+        m_instanceRegistry->setServerExecutable(redisExecutable("redis-server"), version);
+    });
 }
 
 RedisManager::~RedisManager()
 {
     if (m_isRunning) {
-        stopRedis();
+        shutdownAndWait(30000);
     }
+    m_instanceRegistry->shutdownAll(30000);
     
-    if (m_downloadReply) {
-        m_downloadReply->abort();
-        m_downloadReply->deleteLater();
+    m_benchmark->abort();
+    const QList<InstallJob*> jobs = m_installJobs;
+    for (InstallJob* job : jobs) {
+        job->disconnect(this);
+        job->cancel();
     }
 }
 
@@ -85,294 +202,481 @@ QString RedisManager::getDefaultInstallPath() const
 #endif
 }
 
-QString RedisManager::getRedisDownloadUrl() const
+QString RedisManager::redisExecutable(const QString& name) const
+{
+#ifdef Q_OS_WIN
+    return m_versionStore->activeDir() + "/" + name + ".exe";
+#else
+    return m_versionStore->activeDir() + "/" + name;
+#endif
+}
+
+QString RedisManager::getRedisDownloadUrl(const QString& version) const
 {
 #ifdef Q_OS_WIN
     // Windows Redis download URL
-    return "https://github.com/tporadowski/redis/releases/download/v5.0.14.1/Redis-x64-5.0.14.1.zip";
+    QString windowsVersion = version == "latest" ? QString("5.0.14.1") : version;
+    return QString("https://github.com/tporadowski/redis/releases/download/v%1/Redis-x64-%1.zip")
+        .arg(windowsVersion);
 #else
     // Linux - compile from source or use package manager
-    return "https://download.redis.io/redis-stable.tar.gz";
+    if (version == "latest") {
+        return "https://download.redis.io/redis-stable.tar.gz";
+    }
+    return QString("https://download.redis.io/releases/redis-%1.tar.gz").arg(version);
 #endif
 }
 
-void RedisManager::downloadRedis(const QString& version)
+QStringList RedisManager::installedVersions() const
 {
-    QString url = getRedisDownloadUrl();
-    
-    QNetworkRequest request(url);
-    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, 
-                        QNetworkRequest::NoLessSafeRedirectPolicy);
-    
-    if (m_downloadReply) {
-        m_downloadReply->abort();
-        m_downloadReply->deleteLater();
+    return m_versionStore->versions();
+}
+
+QString RedisManager::activeVersion() const
+{
+    return m_versionStore->activeVersion();
+}
+
+bool RedisManager::activateVersion(const QString& version)
+{
+    if (!m_versionStore->activate(version)) {
+        m_lastError = m_versionStore->getLastError();
+        return false;
     }
     
-    m_downloadReply = m_networkManager->get(request);
-    
-    connect(m_downloadReply, &QNetworkReply::downloadProgress,
-            this, &RedisManager::onDownloadProgress);
-    connect(m_downloadReply, &QNetworkReply::finished,
-            this, &RedisManager::onDownloadFinished);
-    
-    emit installationProgress("正在下载 Redis...");
+    m_isInstalled = true;
+    emit activeVersionChanged(version);
+    return true;
 }
 
-void RedisManager::onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+bool RedisManager::removeVersion(const QString& version)
 {
-    emit downloadProgress(bytesReceived, bytesTotal);
+    if (!m_versionStore->remove(version)) {
+        m_lastError = m_versionStore->getLastError();
+        return false;
+    }
+    return true;
 }
 
-void RedisManager::onDownloadFinished()
+QStringList RedisManager::garbageCollectVersions(int keep)
 {
-    if (!m_downloadReply) {
-        return;
+    if (m_primaryJob) {
+        // 暂存目录正在被安装任务使用
+        m_lastError = "安装进行中，稍后再清理";
+        return QStringList();
     }
-    
-    if (m_downloadReply->error() != QNetworkReply::NoError) {
-        m_lastError = "下载失败: " + m_downloadReply->errorString();
-        emit errorOccurred(m_lastError);
-        emit downloadFinished(false);
-        m_downloadReply->deleteLater();
-        m_downloadReply = nullptr;
+    return m_versionStore->garbageCollect(keep);
+}
+
+void RedisManager::downloadRedis(const QString& version)
+{
+    if (m_primaryJob) {
         return;
     }
     
-    // 保存下载文件
-    QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-#ifdef Q_OS_WIN
-    m_downloadedFilePath = tempDir + "/redis.zip";
-#else
-    m_downloadedFilePath = tempDir + "/redis.tar.gz";
-#endif
-    
-    QFile file(m_downloadedFilePath);
-    if (!file.open(QIODevice::WriteOnly)) {
-        m_lastError = "无法保存下载文件";
-        emit errorOccurred(m_lastError);
-        emit downloadFinished(false);
-        m_downloadReply->deleteLater();
-        m_downloadReply = nullptr;
+    // 已安装过的版本直接切换，不必重新下载和编译
+    if (version != "latest" && m_versionStore->contains(version)) {
+        if (activateVersion(version)) {
+            emit installationFinished(true);
+        } else {
+            emit errorOccurred(m_lastError);
+            emit installationFinished(false);
+        }
         return;
     }
     
-    file.write(m_downloadReply->readAll());
-    file.close();
+    InstallJob* job = createInstallJob(m_versionStore->createStagingDir(), version);
+    
+    // 固定的下载文件名，中断后重新安装仍能断点续传
+    QByteArray tag = QCryptographicHash::hash(job->downloadUrl().toString().toUtf8(),
+                                              QCryptographicHash::Sha1).toHex().left(8);
+    job->setArchivePath(QStandardPaths::writableLocation(QStandardPaths::TempLocation)
+                        + "/redis-" + QString::fromLatin1(tag) + "-" + job->downloadUrl().fileName());
+    
+    // 配置文件由所有版本共用，升级时保留已有配置
+    job->setConfigurator([this](const QString&, const QString& version) {
+        return QFile::exists(m_redisConfigPath)
+               || writeRedisConfig(m_redisConfigPath, "0.0.0.0", 10833, QString(), version);
+    });
+    
+    connect(job, &InstallJob::downloadProgress,
+            this, &RedisManager::downloadProgress);
+    connect(job, &InstallJob::progressMessage,
+            this, &RedisManager::installationProgress);
+    connect(job, &InstallJob::stepFinished,
+            this, [this](InstallJob::Step step, qint64 elapsedMs) {
+                emit installationStepFinished(InstallJob::stepName(step), elapsedMs);
+                if (step == InstallJob::DownloadStep) {
+                    emit downloadFinished(true);
+                }
+            });
     
-    m_downloadReply->deleteLater();
-    m_downloadReply = nullptr;
+    m_primaryJob = job;
+    m_installJobs.append(job);
+    job->start();
+}
+
+void RedisManager::installRedis(const QString& installPath)
+{
+    startInstallation(installPath);
+}
+
+InstallJob* RedisManager::startInstallation(const QString& installPath, const QString& version)
+{
+    const QList<InstallJob*> jobs = m_installJobs;
+    for (InstallJob* job : jobs) {
+        if (job->installPath() == installPath) {
+            // 同一目录已有安装在进行
+            return job;
+        }
+    }
     
-    emit downloadFinished(true);
-    emit installationProgress("下载完成，开始安装...");
+    InstallJob* job = createInstallJob(installPath, version);
+    job->setConfigurator([](const QString& path, const QString& version) {
+        return writeRedisConfig(path + "/redis.conf", "0.0.0.0", 10833, QString(), version);
+    });
     
-    // 下载后自动安装
-    installRedis(m_redisPath);
+    m_installJobs.append(job);
+    job->start();
+    return job;
 }
 
-void RedisManager::installRedis(const QString& installPath)
+InstallJob* RedisManager::createInstallJob(const QString& installPath, const QString& version)
 {
-    if (m_downloadedFilePath.isEmpty() || !QFile::exists(m_downloadedFilePath)) {
-        m_lastError = "未找到下载的 Redis 文件";
-        emit errorOccurred(m_lastError);
-        emit installationFinished(false);
+    m_artifactCache->setMaxSize(ServiceConfig::instance().getArtifactCacheMaxSize());
+    
+    InstallJob* job = new InstallJob(m_networkManager, m_artifactCache, m_buildCache, this);
+    job->setInstallPath(installPath);
+    job->setDownloadUrl(QUrl(getRedisDownloadUrl(version)));
+    job->setMirrors(ServiceConfig::instance().getMirrors());
+    job->setResumable(ServiceConfig::instance().isResumableDownload());
+    job->setDownloadSegments(ServiceConfig::instance().getDownloadSegments());
+    job->setStreaming(ServiceConfig::instance().isStreamingInstall());
+    
+    job->builder()->setJobs(ServiceConfig::instance().getBuildJobs());
+    job->builder()->setProfile(RedisBuilder::profileFromName(m_buildProfile));
+    job->builder()->setAllocator(m_buildAllocator);
+    
+    connect(job, &InstallJob::finished,
+            this, &RedisManager::onInstallJobFinished);
+    return job;
+}
+
+void RedisManager::onInstallJobFinished(bool success)
+{
+    InstallJob* job = qobject_cast<InstallJob*>(sender());
+    if (!job) {
         return;
     }
     
-    // 创建安装目录
-    QDir dir;
-    if (!dir.mkpath(installPath)) {
-        m_lastError = "无法创建安装目录";
-        emit errorOccurred(m_lastError);
-        emit installationFinished(false);
+    m_installJobs.removeAll(job);
+    
+    QStringList timings;
+    const QList<QPair<InstallJob::Step, qint64>> steps = job->stepTimings();
+    for (const auto& step : steps) {
+        timings << QString("%1 %2 ms").arg(InstallJob::stepName(step.first)).arg(step.second);
+    }
+    qDebug() << "[RedisManager] Installation in" << job->installPath()
+             << (success ? "succeeded" : "failed") << ":" << timings.join(", ");
+    
+    if (job != m_primaryJob) {
+        job->deleteLater();
         return;
     }
     
-    m_redisPath = installPath;
+    if (success) {
+        // 暂存目录转为正式版本（移动和去重在工作线程中进行），完成后在 onVersionCommitted 中切换；
+        // 在此之前 m_primaryJob 保持不变，避免再次安装或清理版本时动到暂存目录
+        emit installationProgress("正在保存版本...");
+        m_versionStore->commitAsync(job->installPath(), job->installedVersion());
+        return;
+    }
     
-    emit installationProgress("正在解压文件...");
+    m_primaryJob = nullptr;
+    job->deleteLater();
+    m_lastError = job->getLastError();
+    m_versionStore->discardStaging(job->installPath());
     
-    // 解压压缩包
-    if (!extractRedisArchive(m_downloadedFilePath, installPath)) {
-        m_lastError = "解压失败";
+    bool canceled = job->step() == InstallJob::CanceledStep;
+    if (!canceled) {
         emit errorOccurred(m_lastError);
-        emit installationFinished(false);
+    }
+    // 下载阶段失败时界面按下载失败处理
+    if (!canceled && steps.isEmpty()) {
+        emit downloadFinished(false);
+        return;
+    }
+    emit installationProgress(m_lastError);
+    emit installationFinished(false);
+}
+
+void RedisManager::onVersionCommitted(const QString& stagingDir, const QString& version, const QString& error)
+{
+    if (!m_primaryJob || m_primaryJob->installPath() != stagingDir) {
         return;
     }
+    InstallJob* job = m_primaryJob;
+    m_primaryJob = nullptr;
+    job->deleteLater();
     
-    // 创建默认配置
-    emit installationProgress("正在创建配置文件...");
-    if (!createRedisConfig("0.0.0.0", 10833)) {
-        m_lastError = "创建配置文件失败";
+    if (version.isEmpty() || !m_versionStore->activate(version)) {
+        m_lastError = version.isEmpty() ? error : m_versionStore->getLastError();
         emit errorOccurred(m_lastError);
+        emit installationProgress(m_lastError);
         emit installationFinished(false);
         return;
     }
     
     m_isInstalled = true;
-    emit installationProgress("安装完成！");
+    emit activeVersionChanged(version);
     emit installationFinished(true);
     
-    // 清理下载文件
-    QFile::remove(m_downloadedFilePath);
-    m_downloadedFilePath.clear();
+    if (job->builtFromSource() && m_benchmarkAfterBuild) {
+        emit installationProgress(QString("正在对 %1 编译结果做基准测试...").arg(buildName()));
+        m_benchmark->start(m_versionStore->activeDir());
+    }
 }
 
-bool RedisManager::extractRedisArchive(const QString& archivePath, const QString& destPath)
+void RedisManager::cancelInstallation()
 {
-#ifdef Q_OS_WIN
-    QProcess process;
-    QString command = QString("powershell -command \"Expand-Archive -Path '%1' -DestinationPath '%2' -Force\"")
-                         .arg(archivePath)
-                         .arg(destPath);
-    
-    process.start(command);
-    process.waitForFinished(60000);
+    m_benchmark->abort();
     
-    return process.exitCode() == 0;
-#else
-    // Linux: 解压并编译 Redis
-    QProcess process;
-    process.setWorkingDirectory(destPath);
-    
-    process.start("tar", QStringList() << "-xzf" << archivePath);
-    if (!process.waitForFinished(120000)) {
-        qDebug() << "Tar extraction timeout";
-        return false;
+    const QList<InstallJob*> jobs = m_installJobs;
+    for (InstallJob* job : jobs) {
+        job->cancel();
     }
-    
-    if (process.exitCode() != 0) {
-        qDebug() << "Tar extraction failed:" << process.readAllStandardError();
-        return false;
+}
+
+QString RedisManager::buildName() const
+{
+    return RedisBuilder::profileName(RedisBuilder::profileFromName(m_buildProfile)) + "-" + m_buildAllocator;
+}
+
+void RedisManager::onBenchmarkFinished(bool success)
+{
+    if (!success) {
+        qDebug() << "[RedisManager] Benchmark failed:" << m_benchmark->getLastError();
+        emit installationProgress("基准测试失败: " + m_benchmark->getLastError());
+        return;
     }
     
-    // 查找 redis 目录
-    QDir dir(destPath);
-    QStringList redisDirs = dir.entryList(QStringList() << "redis-*", QDir::Dirs);
-    if (redisDirs.isEmpty()) {
-        qDebug() << "Redis directory not found";
-        return false;
+    QMap<QString, double> results = m_benchmark->results();
+    QVariantMap stored;
+    for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+        stored.insert(it.key(), it.value());
     }
+    ServiceConfig::instance().setBenchmarkResults(buildName(), stored);
+    ServiceConfig::instance().save();
     
-    QString redisSourceDir = destPath + "/" + redisDirs.first();
-    qDebug() << "Redis source directory:" << redisSourceDir;
-    
-    // 编译 Redis
-    emit installationProgress("正在编译 Redis...");
-    process.setWorkingDirectory(redisSourceDir);
-    process.start("make", QStringList());
-    
-    if (!process.waitForFinished(300000)) {
-        qDebug() << "Make compilation timeout";
-        return false;
+    qDebug() << "[RedisManager] Benchmark" << buildName() << results;
+    emit benchmarkFinished(buildName(), results);
+}
+
+bool RedisManager::writeRedisConfig(const QString& configPath, const QString& ip, int port,
+                                    const QString& password, const QString& version)
+{
+    RedisConfig config;
+    if (!config.load(configPath)) {
+        // 新建的配置文件：基础参数；选过负载类型后内存和持久化按本机资源推荐
+        config.parse("# Redis Configuration File\n"
+                     "# Generated by RedisInstall\n"
+                     "\n");
+        config.setValue("bind", ip);
+        config.setValue("port", QString::number(port));
+        config.setValue("protected-mode", "yes");
+        config.setValue("daemonize", "no");
+        config.setValue("pidfile", "redis.pid");
+        config.setValue("loglevel", "notice");
+        config.setValue("logfile", "redis.log");
+        config.setValue("databases", "16");
+        config.setValue("stop-writes-on-bgsave-error", "yes");
+        config.setValue("rdbcompression", "yes");
+        config.setValue("rdbchecksum", "yes");
+        config.setValue("dbfilename", "dump.rdb");
+        config.setValue("dir", "./");
+        
+        QString profile = ServiceConfig::instance().getWorkloadProfile();
+        if (profile.isEmpty()) {
+            // 用户还没选过负载类型，不替他关掉持久化
+            config.setValue("save", "900 1 300 10 60 10000");
+            config.setValue("maxmemory", "256mb");
+            config.setValue("maxmemory-policy", "allkeys-lru");
+        } else {
+            ResourceSizer::Workload workload = ResourceSizer::workloadFromName(profile);
+            ResourceSizer::Proposal proposal =
+                ResourceSizer::propose(HostResources::detect(QFileInfo(configPath).path()), workload, version);
+            config.appendLine(QString());
+            config.appendLine("# " + ResourceSizer::workloadDescription(workload) + "：" + proposal.notes.join("；"));
+            for (auto it = proposal.values.constBegin(); it != proposal.values.constEnd(); ++it) {
+                config.setValue(it.key(), it.value());
+            }
+        }
     }
     
-    if (process.exitCode() != 0) {
-        qDebug() << "Make compilation failed:" << process.readAllStandardError();
-        return false;
+    // 已有的配置文件只改这三项，保留注释、CONFIG REWRITE 写回的参数和手工修改
+    config.setValue("bind", ip);
+    config.setValue("port", QString::number(port));
+    if (password.isEmpty()) {
+        config.remove("requirepass");
+    } else {
+        config.setValue("requirepass", password);
     }
     
-    // 复制二进制文件
-    QString srcDir = redisSourceDir + "/src";
-    QFile::copy(srcDir + "/redis-server", destPath + "/redis-server");
-    QFile::copy(srcDir + "/redis-cli", destPath + "/redis-cli");
-    
-    // 设置执行权限
-    QFile::setPermissions(destPath + "/redis-server", 
-                          QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner |
-                          QFile::ReadGroup | QFile::ExeGroup |
-                          QFile::ReadOther | QFile::ExeOther);
-    QFile::setPermissions(destPath + "/redis-cli",
-                          QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner |
-                          QFile::ReadGroup | QFile::ExeGroup |
-                          QFile::ReadOther | QFile::ExeOther);
-    
-    // 清理源代码目录
-    QDir(redisSourceDir).removeRecursively();
-    
-    return true;
-#endif
+    return config.save(configPath);
+}
+
+void RedisManager::updateRedisConfig(const QString& ip, int port, const QString& password)
+{
+    writeRedisConfig(m_redisConfigPath, ip, port, password, activeVersion());
 }
 
-bool RedisManager::createRedisConfig(const QString& ip, int port)
+RedisConfig RedisManager::loadRedisConfig() const
 {
-    m_redisConfigPath = m_redisPath + "/redis.conf";
-    
-    QFile file(m_redisConfigPath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        return false;
+    RedisConfig config;
+    config.load(m_redisConfigPath);
+    return config;
+}
+
+bool RedisManager::setConfigFileValues(const QString& configPath, const QMap<QString, QString>& values)
+{
+    RedisConfig config;
+    config.load(configPath);
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        // save 留空表示关闭 RDB，其他参数留空表示恢复默认值
+        if (it.value().isEmpty() && it.key() != "save") {
+            config.remove(it.key());
+        } else {
+            config.setValue(it.key(), it.value());
+        }
     }
-    
-    QTextStream out(&file);
-    out << "# Redis Configuration File\n";
-    out << "# Generated by RedisInstall\n\n";
-    out << "bind " << ip << "\n";
-    out << "port " << port << "\n";
-    out << "protected-mode yes\n";
-    out << "daemonize no\n";
-    out << "pidfile redis.pid\n";
-    out << "loglevel notice\n";
-    out << "logfile \"redis.log\"\n";
-    out << "databases 16\n";
-    out << "save 900 1\n";
-    out << "save 300 10\n";
-    out << "save 60 10000\n";
-    out << "stop-writes-on-bgsave-error yes\n";
-    out << "rdbcompression yes\n";
-    out << "rdbchecksum yes\n";
-    out << "dbfilename dump.rdb\n";
-    out << "dir ./\n";
-    out << "maxmemory 256mb\n";
-    out << "maxmemory-policy allkeys-lru\n";
-    
-    file.close();
-    return true;
+    return config.save(configPath);
 }
 
-bool RedisManager::createRedisConfigWithPassword(const QString& ip, int port, const QString& password)
+void RedisManager::applyConfig(const QMap<QString, QString>& desired)
 {
-    m_redisConfigPath = m_redisPath + "/redis.conf";
-    
-    QFile file(m_redisConfigPath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        return false;
+    if (!m_isReady) {
+        // 未运行：只写配置文件，下次启动生效
+        bool ok = setConfigFileValues(m_redisConfigPath, desired);
+        if (!ok) {
+            m_lastError = "无法写入配置文件 " + m_redisConfigPath;
+            emit errorOccurred(m_lastError);
+        }
+        emit configApplied(QStringList(), ok ? desired.keys() : QStringList(),
+                           ok ? QStringList() : desired.keys());
+        return;
     }
     
-    QTextStream out(&file);
-    out << "# Redis Configuration File\n";
-    out << "# Generated by RedisInstall\n\n";
-    out << "bind " << ip << "\n";
-    out << "port " << port << "\n";
-    out << "protected-mode yes\n";
-    
-    // 如果提供了密码，则添加
-    if (!password.isEmpty()) {
-        out << "requirepass " << password << "\n";
-    }
-    
-    out << "daemonize no\n";
-    out << "pidfile redis.pid\n";
-    out << "loglevel notice\n";
-    out << "logfile \"redis.log\"\n";
-    out << "databases 16\n";
-    out << "save 900 1\n";
-    out << "save 300 10\n";
-    out << "save 60 10000\n";
-    out << "stop-writes-on-bgsave-error yes\n";
-    out << "rdbcompression yes\n";
-    out << "rdbchecksum yes\n";
-    out << "dbfilename dump.rdb\n";
-    out << "dir ./\n";
-    out << "maxmemory 256mb\n";
-    out << "maxmemory-policy allkeys-lru\n";
-    
-    file.close();
-    return true;
+    m_client->send(QList<QByteArray>() << "CONFIG" << "GET" << "*",
+                   [this, desired](const RespValue& reply) {
+        QMap<QString, QString> current;
+        if (reply.isError()) {
+            qDebug() << "[RedisManager] CONFIG GET failed:" << reply.toString();
+        } else {
+            // RESP2 为键值交替的数组，RESP3 的 Map 也按同样顺序展开
+            const QList<RespValue>& items = reply.elements();
+            for (int i = 0; i + 1 < items.size(); i += 2) {
+                current.insert(items.at(i).toString().toLower(), items.at(i + 1).toString());
+            }
+        }
+        applyConfigDiff(desired, current);
+    });
 }
 
-void RedisManager::updateRedisConfig(const QString& ip, int port, const QString& password)
+namespace {
+struct ConfigApplyResult
 {
-    createRedisConfigWithPassword(ip, port, password);
+    QStringList appliedLive;
+    QStringList restartRequired;
+    QStringList failed;
+    // 需要由我们写入配置文件的参数
+    QMap<QString, QString> fileValues;
+};
+}
+
+void RedisManager::applyConfigDiff(const QMap<QString, QString>& desired, const QMap<QString, QString>& current)
+{
+    // 改变监听地址会影响本程序和其他客户端的连接，统一留到重启时生效；
+    // schema 中标记为不能运行时修改的参数（io-threads、tcp-backlog 等）同样如此
+    static const QStringList restartOnly = QStringList() << "unixsocket" << "daemonize" << "pidfile";
+    
+    // 参数名不区分大小写
+    QMap<QString, QString> wanted;
+    for (auto it = desired.constBegin(); it != desired.constEnd(); ++it) {
+        wanted.insert(it.key().toLower(), it.value());
+    }
+    
+    auto result = std::make_shared<ConfigApplyResult>();
+    QStringList changed;
+    for (auto it = wanted.constBegin(); it != wanted.constEnd(); ++it) {
+        const QString& key = it.key();
+        QString error;
+        if (!RedisConfigSchema::validate(key, it.value(), &error)) {
+            result->failed << key + ": " + error;
+            continue;
+        }
+        if (current.contains(key)
+            && RedisConfigSchema::normalize(current.value(key)) == RedisConfigSchema::normalize(it.value())) {
+            continue;
+        }
+        const ConfigParameter* parameter = RedisConfigSchema::find(key);
+        if (restartOnly.contains(key) || (parameter && !parameter->runtime)) {
+            result->restartRequired << key;
+            result->fileValues.insert(key, it.value());
+        } else {
+            changed << key;
+        }
+    }
+    
+    auto finish = [this, result]() {
+        if (!result->fileValues.isEmpty() && !setConfigFileValues(m_redisConfigPath, result->fileValues)) {
+            for (auto it = result->fileValues.constBegin(); it != result->fileValues.constEnd(); ++it) {
+                result->failed << it.key() + ": 无法写入配置文件";
+            }
+        }
+        qDebug() << "[RedisManager] Config applied live:" << result->appliedLive
+                 << "restart required:" << result->restartRequired << "failed:" << result->failed;
+        emit configApplied(result->appliedLive, result->restartRequired, result->failed);
+    };
+    
+    if (changed.isEmpty()) {
+        finish();
+        return;
+    }
+    
+    // 所有 CONFIG SET 和最后的 CONFIG REWRITE 一起流水线发出，回复按顺序到达
+    for (const QString& key : changed) {
+        QString value = wanted.value(key);
+        m_client->send(QList<QByteArray>() << "CONFIG" << "SET" << key.toUtf8() << value.toUtf8(),
+                       [this, result, key, value](const RespValue& reply) {
+            if (!reply.isError()) {
+                result->appliedLive << key;
+                if (key == "requirepass") {
+                    // 之后重连时使用新密码
+                    m_client->setPassword(value);
+                    m_healthMonitor->setServer(m_client->host(), m_client->port(), value);
+                    m_metricsSampler->setServer(m_client->host(), m_client->port(), value);
+                    m_latencyProber->setServer(m_client->host(), m_client->port(), value);
+                }
+            } else if (reply.data().contains("immutable") || reply.data().contains("can't set")) {
+                result->restartRequired << key;
+                result->fileValues.insert(key, value);
+            } else {
+                result->failed << key + ": " + reply.toString();
+            }
+        });
+    }
+    
+    m_client->send(QList<QByteArray>() << "CONFIG" << "REWRITE",
+                   [result, wanted, finish](const RespValue& reply) {
+        if (reply.isError() && !result->appliedLive.isEmpty()) {
+            // Redis 无法写回（例如没有配置文件的写权限）时由我们自己写入
+            qDebug() << "[RedisManager] CONFIG REWRITE failed:" << reply.toString();
+            for (const QString& key : result->appliedLive) {
+                result->fileValues.insert(key, wanted.value(key));
+            }
+        }
+        finish();
+    });
 }
 
 bool RedisManager::startRedis(const QString& ip, int port, const QString& password)
@@ -390,11 +694,7 @@ bool RedisManager::startRedis(const QString& ip, int port, const QString& passwo
     // 更新配置
     updateRedisConfig(ip, port, password);
     
-#ifdef Q_OS_WIN
-    QString redisExe = m_redisPath + "/redis-server.exe";
-#else
-    QString redisExe = m_redisPath + "/redis-server";
-#endif
+    QString redisExe = redisExecutable("redis-server");
     
     qDebug() << "[RedisManager] Attempting to start Redis:";
     qDebug() << "  - Executable:" << redisExe;
@@ -421,93 +721,237 @@ bool RedisManager::startRedis(const QString& ip, int port, const QString& passwo
     
     m_redisProcess->setWorkingDirectory(m_redisPath);
     m_redisProcess->setProcessChannelMode(QProcess::MergedChannels);
-    m_redisProcess->start(redisExe, QStringList() << m_redisConfigPath);
-    
-    if (!m_redisProcess->waitForStarted(5000)) {
-        m_lastError = "Redis 启动失败: " + m_redisProcess->errorString();
-        qDebug() << "[RedisManager] Error:" << m_lastError;
-        qDebug() << "  - Process state:" << m_redisProcess->state();
-        qDebug() << "  - Process error:" << m_redisProcess->error();
-        qDebug() << "  - Stderr:" << m_redisProcess->readAllStandardError();
-        return false;
-    }
-    
+    // 监听所有地址时通过本机回环连接
+    QString clientHost = (ip.isEmpty() || ip == "0.0.0.0") ? QString("127.0.0.1") : ip;
+    m_client->setPassword(password);
+    m_client->setServer(clientHost, quint16(port));
+    m_healthMonitor->stop();
+    m_healthMonitor->setServer(clientHost, quint16(port), password);
+    m_metricsSampler->stop();
+    m_metricsSampler->setServer(clientHost, quint16(port), password);
+    m_latencyProber->stop();
+    m_latencyProber->setServer(clientHost, quint16(port), password);
+    
+    // CPU / NUMA 放置；多实例时主实例占分散放置的第 0 个位置
+    const ServiceConfig& config = ServiceConfig::instance();
+    m_placement = PlacementPolicy::compute(CpuTopology::detect(),
+                                           PlacementPolicy::modeFromName(config.getPlacementMode()),
+                                           config.getPlacementCpus(), config.getPlacementNode(),
+                                           0, m_instanceRegistry->count() + 1);
+    m_placement.applyTo(m_redisProcess);
+    
+    m_redisProcess->start(redisExe, QStringList() << m_redisConfigPath
+                                                  << m_placement.redisArguments(activeVersion()));
+    
+    // 启动失败由 errorOccurred 异步报告；就绪与否由探测结果决定
     m_isRunning = true;
-    qDebug() << "[RedisManager] Redis started successfully!";
-    emit redisStarted();
+    m_isReady = false;
+    m_readinessProbe->setDataSize(dataFileSize());
+    m_readinessProbe->start();
+    if (!m_logTailer->isRunning()) {
+        m_logTailer->start(redisLogPath());
+    }
+    qDebug() << "[RedisManager] Redis launched, waiting for readiness";
     return true;
 }
 
-bool RedisManager::stopRedis()
+qint64 RedisManager::dataFileSize() const
 {
-    if (!m_isRunning) {
+    return RedisInstance::dataFileSize(m_redisPath);
+}
+
+void RedisManager::onRedisReady(qint64 elapsedMs, double loadBytesPerSecond)
+{
+    m_isReady = true;
+    m_healthMonitor->start();
+    m_metricsSampler->start();
+    m_latencyProber->start();
+    qDebug() << "[RedisManager] Redis ready in" << elapsedMs << "ms";
+    emit redisReady(elapsedMs, loadBytesPerSecond);
+}
+
+void RedisManager::onReadinessFailed(const QString& error)
+{
+    m_lastError = error;
+    emit redisStartFailed(error);
+}
+
+bool RedisManager::stopRedis(bool save)
+{
+    if (!m_isRunning || m_isStopping) {
         return true;
     }
     
-    if (m_redisProcess->state() == QProcess::Running) {
-        m_redisProcess->terminate();
-        
-        if (!m_redisProcess->waitForFinished(5000)) {
-            m_redisProcess->kill();
-            m_redisProcess->waitForFinished(2000);
-        }
+    m_isStopping = true;
+    m_readinessProbe->stop();
+    m_healthMonitor->stop();
+    m_metricsSampler->stop();
+    m_latencyProber->stop();
+    m_snapshotBytes = 0;
+    m_stopProgressMs = 0;
+    m_stopEscalation = 0;
+    m_stopClock.start();
+    m_stopTimer->start();
+    
+    // 成功时 Redis 直接断开连接而不回复；SAVE 会等最后一次 RDB 写完、AOF 刷盘后才退出
+    qDebug() << "[RedisManager] Sending SHUTDOWN" << (save ? "SAVE" : "NOSAVE");
+    m_client->send(QList<QByteArray>() << "SHUTDOWN" << (save ? "SAVE" : "NOSAVE"),
+                   [this](const RespValue& reply) { onShutdownReply(reply); });
+    return true;
+}
+
+void RedisManager::onShutdownReply(const RespValue& reply)
+{
+    // 连接断开（包括 SHUTDOWN 成功）时等待进程退出，由 onStopTick 判断是否卡住
+    if (!m_isStopping || !reply.isError() || !m_client->isConnected()) {
+        return;
     }
     
-    // 杀死孤儿进程
-    killRedisProcess();
+    if (reply.data().startsWith("NOAUTH") || reply.data().startsWith("WRONGPASS")) {
+        // 无法通过协议关闭（例如密码已修改），直接改用信号
+        escalateStop();
+        return;
+    }
     
-    m_isRunning = false;
-    emit redisStopped();
-    return true;
+    // Redis 拒绝关闭，通常是快照保存失败；此时强杀会丢数据，交给用户决定是否 NOSAVE
+    m_stopTimer->stop();
+    m_isStopping = false;
+    m_restartPending = false;
+    m_lastError = "Redis 拒绝关闭: " + reply.toString();
+    qDebug() << "[RedisManager]" << m_lastError;
+    emit redisStopFailed(m_lastError);
 }
 
-bool RedisManager::killRedisProcess()
+void RedisManager::onStopTick()
 {
-#ifdef Q_OS_WIN
-    HANDLE hProcessSnap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (hProcessSnap == INVALID_HANDLE_VALUE) {
-        return false;
+    qint64 elapsed = m_stopClock.elapsed();
+    
+    // 保存时先写 temp-<pid>.rdb，完成后再改名为 dump.rdb
+    qint64 written = 0;
+    const QFileInfoList temps = QDir(m_redisPath).entryInfoList(QStringList() << "temp-*.rdb", QDir::Files);
+    for (const QFileInfo& temp : temps) {
+        written += temp.size();
+    }
+    if (written != m_snapshotBytes) {
+        m_snapshotBytes = written;
+        m_stopProgressMs = elapsed;
     }
     
-    PROCESSENTRY32 pe32;
-    pe32.dwSize = sizeof(PROCESSENTRY32);
+    QString message = "正在停止 Redis...";
+    if (written > 0) {
+        message = QString("正在保存快照 %1 MB").arg(written / (1024.0 * 1024.0), 0, 'f', 1);
+        qint64 previous = QFileInfo(m_redisPath + "/dump.rdb").size();
+        if (previous > 0) {
+            message += QString(" / 约 %1 MB").arg(previous / (1024.0 * 1024.0), 0, 'f', 1);
+        }
+    }
+    emit redisStopProgress(message, elapsed);
     
-    if (Process32First(hProcessSnap, &pe32)) {
-        do {
-            QString processName = QString::fromWCharArray(pe32.szExeFile);
-            if (processName.contains("redis-server", Qt::CaseInsensitive)) {
-                HANDLE hProcess = OpenProcess(PROCESS_TERMINATE, FALSE, pe32.th32ProcessID);
-                if (hProcess) {
-                    TerminateProcess(hProcess, 0);
-                    CloseHandle(hProcess);
-                }
+    if (elapsed - m_stopProgressMs >= kStopStallMs) {
+        m_stopProgressMs = elapsed;
+        escalateStop();
+    }
+}
+
+void RedisManager::escalateStop()
+{
+    // 只针对自己启动的这个进程，不影响本机上的其他 Redis 实例
+    qint64 pid = m_redisProcess->processId();
+    if (m_stopEscalation == 0) {
+        m_stopEscalation = 1;
+        qDebug() << "[RedisManager] SHUTDOWN stalled, sending SIGTERM to pid" << pid;
+        m_redisProcess->terminate();
+    } else if (m_stopEscalation == 1) {
+        m_stopEscalation = 2;
+        qDebug() << "[RedisManager] Still running, killing pid" << pid;
+        m_redisProcess->kill();
+    }
+}
+
+void RedisManager::shutdownAndWait(int timeoutMs)
+{
+    m_readinessProbe->stop();
+    m_stopTimer->stop();
+    m_isStopping = true;
+    m_restartPending = false;
+    
+    if (m_redisProcess->state() == QProcess::Running) {
+        QTcpSocket socket;
+        socket.connectToHost(m_client->host(), m_client->port());
+        if (socket.waitForConnected(1000)) {
+            QByteArray request;
+            if (!m_client->password().isEmpty()) {
+                RespClient::encode(QList<QByteArray>() << "AUTH" << m_client->password().toUtf8(), request);
             }
-        } while (Process32Next(hProcessSnap, &pe32));
+            RespClient::encode(QList<QByteArray>() << "SHUTDOWN" << "SAVE", request);
+            socket.write(request);
+            socket.waitForBytesWritten(1000);
+        }
+        
+        if (!m_redisProcess->waitForFinished(timeoutMs)) {
+            m_redisProcess->terminate();
+            if (!m_redisProcess->waitForFinished(5000)) {
+                m_redisProcess->kill();
+                m_redisProcess->waitForFinished(2000);
+            }
+        }
+    } else if (m_redisProcess->state() == QProcess::Starting) {
+        m_redisProcess->kill();
+        m_redisProcess->waitForFinished(2000);
     }
     
-    CloseHandle(hProcessSnap);
-    return true;
-#else
-    QProcess::execute("pkill", QStringList() << "-9" << "redis-server");
-    return true;
-#endif
+    m_client->disconnectFromServer();
+    m_isStopping = false;
+    m_isRunning = false;
+    m_isReady = false;
 }
 
 bool RedisManager::restartRedis(const QString& ip, int port, const QString& password)
 {
-    stopRedis();
-    QThread::msleep(500);
-    return startRedis(ip, port, password);
+    if (!m_isRunning) {
+        return startRedis(ip, port, password);
+    }
+    
+    // 旧进程退出、端口释放后在 onRedisProcessFinished 中启动，新进程的就绪由探测判断
+    m_restartPending = true;
+    m_restartIp = ip;
+    m_restartPort = port;
+    m_restartPassword = password;
+    return stopRedis();
 }
 
 bool RedisManager::isRedisRunning() const
 {
-    return m_isRunning && m_redisProcess->state() == QProcess::Running;
+    return m_isRunning && m_redisProcess->state() != QProcess::NotRunning;
+}
+
+bool RedisManager::isRedisResponsive() const
+{
+    return m_healthMonitor->state() != HealthMonitor::Unresponsive;
+}
+
+qint64 RedisManager::redisUnresponsiveMs() const
+{
+    return m_healthMonitor->unresponsiveMs();
+}
+
+void RedisManager::setStatusMonitorBackground(bool background)
+{
+    m_healthMonitor->setBackground(background);
 }
 
 void RedisManager::uninstallRedis()
 {
-    stopRedis();
+    if (m_isRunning) {
+        shutdownAndWait(30000);
+    }
+    m_instanceRegistry->shutdownAll(30000);
+    const QList<RedisInstance*> instances = m_instanceRegistry->instances();
+    for (RedisInstance* instance : instances) {
+        m_instanceRegistry->removeInstance(instance->name());
+    }
+    m_logTailer->stop();
+    m_logBuffer->clear();
     
     QDir dir(m_redisPath);
     if (dir.exists()) {
@@ -523,11 +967,7 @@ QString RedisManager::getRedisVersion() const
         return "未安装";
     }
     
-#ifdef Q_OS_WIN
-    QString redisExe = m_redisPath + "/redis-server.exe";
-#else
-    QString redisExe = m_redisPath + "/redis-server";
-#endif
+    QString redisExe = redisExecutable("redis-server");
     
     QProcess process;
     process.start(redisExe, QStringList() << "--version");
@@ -544,23 +984,60 @@ QString RedisManager::getRedisPath() const
 
 void RedisManager::onRedisProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    // 主动停止时探测已先停下，这里只处理启动过程中意外退出的情况
+    bool wasStarting = m_readinessProbe->isRunning();
+    bool wasStopping = m_isStopping;
     m_isRunning = false;
+    m_isReady = false;
+    m_isStopping = false;
+    m_readinessProbe->stop();
+    m_healthMonitor->stop();
+    m_metricsSampler->stop();
+    m_latencyProber->stop();
+    m_stopTimer->stop();
+    m_client->disconnectFromServer();
+    
+    if (wasStopping) {
+        qDebug() << "[RedisManager] Redis stopped in" << m_stopClock.elapsed() << "ms";
+    }
+    
+    if (wasStarting) {
+        m_lastError = QString("Redis 在就绪前退出（退出码 %1），详见 redis.log").arg(exitCode);
+        emit redisStartFailed(m_lastError);
+    }
     
-    if (exitStatus == QProcess::CrashExit) {
+    // 升级为 SIGKILL 时的非正常退出是预期的，不算崩溃
+    if (exitStatus == QProcess::CrashExit && !wasStopping) {
         m_lastError = "Redis 进程崩溃";
         emit errorOccurred(m_lastError);
     }
     
     emit redisStopped();
+    
+    if (m_restartPending) {
+        m_restartPending = false;
+        startRedis(m_restartIp, m_restartPort, m_restartPassword);
+    }
 }
 
 void RedisManager::onRedisProcessError(QProcess::ProcessError error)
 {
+    if (m_isStopping && error == QProcess::Crashed) {
+        // 停止过程中被信号结束，由 onRedisProcessFinished 收尾
+        return;
+    }
+    
+    bool wasStarting = m_readinessProbe->isRunning();
+    m_readinessProbe->stop();
+    m_healthMonitor->stop();
+    m_metricsSampler->stop();
+    m_latencyProber->stop();
     m_isRunning = false;
+    m_isReady = false;
     
     switch (error) {
     case QProcess::FailedToStart:
-        m_lastError = "Redis 启动失败";
+        m_lastError = "Redis 启动失败: " + m_redisProcess->errorString();
         break;
     case QProcess::Crashed:
         m_lastError = "Redis 进程崩溃";
@@ -573,5 +1050,8 @@ void RedisManager::onRedisProcessError(QProcess::ProcessError error)
         break;
     }
     
+    if (wasStarting) {
+        emit redisStartFailed(m_lastError);
+    }
     emit errorOccurred(m_lastError);
 }
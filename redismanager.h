@@ -4,8 +4,30 @@
 #include <QObject>
 #include <QProcess>
 #include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QList>
 #include <QNetworkAccessManager>
-#include <QNetworkReply>
+#include <QElapsedTimer>
+#include "cputopology.h"
+
+class ArtifactCache;
+class BuildCache;
+class RedisBenchmark;
+class InstallJob;
+class VersionStore;
+class RespClient;
+class RespValue;
+class RedisConfig;
+class ReadinessProbe;
+class QTimer;
+class InstanceRegistry;
+class LogRingBuffer;
+class LogTailer;
+class HealthMonitor;
+class MetricsSampler;
+class MetricsStore;
+class LatencyProber;
 
 class RedisManager : public QObject
 {
@@ -20,54 +42,179 @@ public:
     void downloadRedis(const QString& version = "latest");
     void installRedis(const QString& installPath);
     void uninstallRedis();
+    void cancelInstallation();
+    
+    // 在指定目录启动一次完整的异步安装并返回安装任务；不同目录的安装可以同时进行。
+    // 默认安装目录的任务进度通过下面的 download*/installation* 信号转发
+    InstallJob* startInstallation(const QString& installPath, const QString& version = "latest");
+    QList<InstallJob*> installJobs() const { return m_installJobs; }
+    
+    // 编译配置（default / lto / native / pgo）和内存分配器（jemalloc / libc），仅 Linux 源码编译有效
+    void setBuildProfile(const QString& profile) { m_buildProfile = profile; }
+    QString buildProfile() const { return m_buildProfile; }
+    void setBuildAllocator(const QString& allocator) { m_buildAllocator = allocator; }
+    QString buildAllocator() const { return m_buildAllocator; }
+    
+    // 编译安装后用 redis-benchmark 跑一轮短测试，结果通过 benchmarkFinished 发出
+    void setBenchmarkAfterBuild(bool enabled) { m_benchmarkAfterBuild = enabled; }
+    bool isBenchmarkAfterBuild() const { return m_benchmarkAfterBuild; }
+    // 编译配置的标识，如 "pgo-jemalloc"，用于保存和对比基准测试结果
+    QString buildName() const;
+    
+    // 多版本并存：<安装目录>/<版本>/ 下各自一套程序，current 指向当前版本。
+    // downloadRedis() 安装到新的版本目录并切换过去；已安装的版本直接切换。
+    // 切换后需重启 Redis 才会使用新版本
+    QStringList installedVersions() const;
+    QString activeVersion() const;
+    bool activateVersion(const QString& version);
+    bool removeVersion(const QString& version);
+    // 只保留 keep 个非当前版本，返回删除的版本
+    QStringList garbageCollectVersions(int keep = 1);
     
     // Redis service control
+    // startRedis() 只负责拉起进程，不等待；能接受请求（PING 成功且数据加载完）时发出 redisReady，
+    // 启动失败时发出 redisStartFailed
     bool startRedis(const QString& ip, int port, const QString& password = "");
-    bool stopRedis();
+    // 通过 SHUTDOWN SAVE|NOSAVE 优雅停止，等待最后一次快照写完，期间发出 redisStopProgress；
+    // 长时间没有进展时才依次发送 SIGTERM / SIGKILL，且只发给自己启动的进程。
+    // 停止完成发出 redisStopped，Redis 拒绝关闭（如快照保存失败）时发出 redisStopFailed
+    bool stopRedis(bool save = true);
+    // 旧进程退出后再启动新进程
     bool restartRedis(const QString& ip, int port, const QString& password = "");
     bool isRedisRunning() const;
+    bool isRedisStopping() const { return m_isStopping; }
+    bool isRedisReady() const { return m_isReady; }
+    // 就绪后由心跳判断：进程还在但超过 3 秒不回复 PING 时为 false，并给出已持续的时间
+    bool isRedisResponsive() const;
+    qint64 redisUnresponsiveMs() const;
+    // 界面不可见时放慢心跳
+    void setStatusMonitorBackground(bool background);
+    // 主实例的进程号和启动时应用的 CPU / NUMA 放置，未运行时进程号为 0
+    qint64 redisProcessId() const { return m_redisProcess->processId(); }
+    Placement redisPlacement() const { return m_placement; }
     
     // Configuration
+    // 写入配置文件（已存在时只修改 bind / port / requirepass，保留其他参数）
     void updateRedisConfig(const QString& ip, int port, const QString& password = "");
+    // 不重启地应用配置：与运行中实例的 CONFIG GET * 对比，变化的参数用 CONFIG SET 立即生效、
+    // CONFIG REWRITE 写回配置文件；bind / port 以及 Redis 不允许运行时修改的参数写入配置文件，
+    // 下次启动生效。结果通过 configApplied 发出。Redis 未就绪时只写配置文件
+    void applyConfig(const QMap<QString, QString>& desired);
+    // 当前的 redis.conf，参数的类型和取值范围见 RedisConfigSchema
+    RedisConfig loadRedisConfig() const;
     QString getRedisVersion() const;
     QString getRedisPath() const;
     QString getLastError() const { return m_lastError; }
     
+    // 与正在运行的 Redis 之间共用的异步连接，startRedis() 时按地址和密码配置，
+    // 断开后下次发送命令时自动重连
+    RespClient* client() const { return m_client; }
+    
+    // 同一台机器上的其他 Redis 实例（<安装目录>/instances/），各自独立的配置、端口和数据
+    InstanceRegistry* instanceRegistry() const { return m_instanceRegistry; }
+    
+    // 主实例的日志：redis.log 的新增内容和进程的标准输出都写入固定大小的环形缓冲区
+    LogRingBuffer* logBuffer() const { return m_logBuffer; }
+    QString redisLogPath() const { return m_redisPath + "/redis.log"; }
+    
+    // 主实例就绪后按 ServiceConfig 中的间隔采样 INFO，停止时暂停
+    MetricsSampler* metricsSampler() const { return m_metricsSampler; }
+    // 采样结果的磁盘历史（<应用数据目录>/metrics/main/），按时间范围查询
+    MetricsStore* metricsStore() const { return m_metricsStore; }
+    // 主实例就绪后在专用连接上探测命令延迟
+    LatencyProber* latencyProber() const { return m_latencyProber; }
+    
 signals:
     void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
     void downloadFinished(bool success);
     void installationProgress(const QString& message);
+    void activeVersionChanged(const QString& version);
+    void installationStepFinished(const QString& step, qint64 elapsedMs);
     void installationFinished(bool success);
     void redisStarted();
+    // 从启动到可以处理命令的耗时，以及 RDB/AOF 的加载速度（字节/秒，无数据时为 0）
+    void redisReady(qint64 timeToReadyMs, double loadBytesPerSecond);
+    void redisLoadingProgress(double percent, qint64 etaSeconds);
+    void redisStartFailed(const QString& error);
     void redisStopped();
+    void redisStopProgress(const QString& message, qint64 elapsedMs);
+    void redisStopFailed(const QString& error);
+    // 运行中的 Redis 停止或恢复响应心跳
+    void redisHealthChanged(bool responsive);
+    // 已立即生效的参数、需要重启才生效的参数、设置失败的参数（附错误信息）
+    void configApplied(const QStringList& appliedLive, const QStringList& restartRequired,
+                       const QStringList& failed);
     void errorOccurred(const QString& error);
+    void benchmarkFinished(const QString& build, const QMap<QString, double>& results);
     
 private slots:
-    void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
-    void onDownloadFinished();
+    void onInstallJobFinished(bool success);
+    void onVersionCommitted(const QString& stagingDir, const QString& version, const QString& error);
+    void onBenchmarkFinished(bool success);
     void onRedisProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onRedisProcessError(QProcess::ProcessError error);
+    void onRedisReady(qint64 elapsedMs, double loadBytesPerSecond);
+    void onReadinessFailed(const QString& error);
+    void onStopTick();
     
 private:
-    bool extractRedisArchive(const QString& archivePath, const QString& destPath);
-    bool createRedisConfig(const QString& ip, int port);
-    bool createRedisConfigWithPassword(const QString& ip, int port, const QString& password);
-    QString getRedisDownloadUrl() const;
+    // 配置文件不存在时按基础参数新建，存在时只修改 bind / port / requirepass
+    static bool writeRedisConfig(const QString& configPath, const QString& ip, int port,
+                                 const QString& password, const QString& version);
+    // 在配置文件中原地修改指定参数，其余内容不变；值为空时删除该参数
+    static bool setConfigFileValues(const QString& configPath, const QMap<QString, QString>& values);
+    void applyConfigDiff(const QMap<QString, QString>& desired, const QMap<QString, QString>& current);
+    QString getRedisDownloadUrl(const QString& version) const;
+    QString redisExecutable(const QString& name) const;
+    InstallJob* createInstallJob(const QString& installPath, const QString& version);
     QString getDefaultInstallPath() const;
-    bool killRedisProcess();
+    void onShutdownReply(const RespValue& reply);
+    void escalateStop();
+    // 析构、卸载时没有事件循环可用，阻塞地发送 SHUTDOWN 并等待进程退出
+    void shutdownAndWait(int timeoutMs);
+    qint64 dataFileSize() const;
     
 private:
     QNetworkAccessManager* m_networkManager;
-    QNetworkReply* m_downloadReply;
+    ArtifactCache* m_artifactCache;
+    BuildCache* m_buildCache;
+    RedisBenchmark* m_benchmark;
+    VersionStore* m_versionStore;
+    InstallJob* m_primaryJob;
     QProcess* m_redisProcess;
+    RespClient* m_client;
+    ReadinessProbe* m_readinessProbe;
+    QTimer* m_stopTimer;
+    InstanceRegistry* m_instanceRegistry;
+    LogRingBuffer* m_logBuffer;
+    LogTailer* m_logTailer;
+    HealthMonitor* m_healthMonitor;
+    MetricsSampler* m_metricsSampler;
+    MetricsStore* m_metricsStore;
+    LatencyProber* m_latencyProber;
+    QElapsedTimer m_stopClock;
+    Placement m_placement;
+    QList<InstallJob*> m_installJobs;
     
     QString m_redisPath;
     QString m_redisConfigPath;
-    QString m_downloadedFilePath;
+    QString m_buildProfile;
+    QString m_buildAllocator;
     QString m_lastError;
     
+    QString m_restartIp;
+    QString m_restartPassword;
+    int m_restartPort;
+    qint64 m_snapshotBytes;
+    qint64 m_stopProgressMs;
+    int m_stopEscalation;
+    
+    bool m_benchmarkAfterBuild;
     bool m_isInstalled;
     bool m_isRunning;
+    bool m_isReady;
+    bool m_isStopping;
+    bool m_restartPending;
 };
 
 #endif // REDISMANAGER_H
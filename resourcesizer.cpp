@@ -0,0 +1,287 @@
+#include "resourcesizer.h"
+#include "redisconfig.h"
+#include "versionstore.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <QThread>
+#include <QDebug>
+#include <cmath>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <sched.h>
+#endif
+
+static const qint64 kMegabyte = 1024 * 1024;
+static const qint64 kGigabyte = 1024 * kMegabyte;
+
+qint64 HostResources::memoryBudget() const
+{
+    if (cgroupMemoryLimit > 0 && (totalMemory <= 0 || cgroupMemoryLimit < totalMemory)) {
+        return cgroupMemoryLimit;
+    }
+    return totalMemory;
+}
+
+#ifdef Q_OS_LINUX
+static QByteArray readSysFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll().trimmed();
+}
+
+// 当前进程所在的 cgroup v2 目录；v1 或没有挂载时返回空
+static QString cgroupDir()
+{
+    const QList<QByteArray> lines = readSysFile("/proc/self/cgroup").split('\n');
+    for (const QByteArray& line : lines) {
+        if (line.startsWith("0::")) {
+            return "/sys/fs/cgroup" + QString::fromUtf8(line.mid(3));
+        }
+    }
+    return QString();
+}
+#endif
+
+HostResources HostResources::detect(const QString& dataDir)
+{
+    HostResources host;
+
+#ifdef Q_OS_WIN
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status)) {
+        host.totalMemory = qint64(status.ullTotalPhys);
+        host.availableMemory = qint64(status.ullAvailPhys);
+    }
+#else
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && pageSize > 0) {
+        host.totalMemory = qint64(pages) * pageSize;
+    }
+#endif
+
+#ifdef Q_OS_LINUX
+    // 单位为 kB
+    const QList<QByteArray> meminfo = readSysFile("/proc/meminfo").split('\n');
+    for (const QByteArray& line : meminfo) {
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() < 2) {
+            continue;
+        }
+        if (fields.at(0) == "MemTotal:") {
+            host.totalMemory = fields.at(1).toLongLong() * 1024;
+        } else if (fields.at(0) == "MemAvailable:") {
+            host.availableMemory = fields.at(1).toLongLong() * 1024;
+        }
+    }
+
+    // 容器中的限制可能设在任何一级父 cgroup 上，取最小值
+    QString dir = cgroupDir();
+    double cpuQuota = 0;
+    while (!dir.isEmpty() && dir.startsWith("/sys/fs/cgroup")) {
+        QByteArray memoryMax = readSysFile(dir + "/memory.max");
+        if (!memoryMax.isEmpty() && memoryMax != "max") {
+            qint64 limit = memoryMax.toLongLong();
+            if (limit > 0 && (host.cgroupMemoryLimit < 0 || limit < host.cgroupMemoryLimit)) {
+                host.cgroupMemoryLimit = limit;
+            }
+        }
+
+        // cpu.max: "<配额> <周期>"，配额为 max 表示不限制
+        const QList<QByteArray> cpuMax = readSysFile(dir + "/cpu.max").split(' ');
+        if (cpuMax.size() == 2 && cpuMax.at(0) != "max" && cpuMax.at(1).toDouble() > 0) {
+            double quota = cpuMax.at(0).toDouble() / cpuMax.at(1).toDouble();
+            if (cpuQuota <= 0 || quota < cpuQuota) {
+                cpuQuota = quota;
+            }
+        }
+
+        if (dir == "/sys/fs/cgroup") {
+            break;
+        }
+        dir = QFileInfo(dir).path();
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    host.cpuCount = sched_getaffinity(0, sizeof(cpus), &cpus) == 0 ? CPU_COUNT(&cpus)
+                                                                    : QThread::idealThreadCount();
+    if (cpuQuota > 0) {
+        host.cpuCount = qMax(1, qMin(host.cpuCount, int(std::ceil(cpuQuota))));
+    }
+#else
+    host.cpuCount = qMax(1, QThread::idealThreadCount());
+#endif
+
+    // 数据目录可能还没创建，向上找到第一个存在的目录
+    QString path = dataDir;
+    while (!path.isEmpty() && !QFileInfo::exists(path) && QFileInfo(path).path() != path) {
+        path = QFileInfo(path).path();
+    }
+    QStorageInfo storage(path);
+    if (storage.isValid()) {
+        host.diskFree = storage.bytesAvailable();
+        host.diskTotal = storage.bytesTotal();
+    }
+
+    qDebug() << "[ResourceSizer] Memory:" << host.totalMemory << "cgroup limit:" << host.cgroupMemoryLimit
+             << "CPUs:" << host.cpuCount << "disk free:" << host.diskFree;
+    return host;
+}
+
+QString ResourceSizer::workloadName(Workload workload)
+{
+    switch (workload) {
+    case DurableWorkload:
+        return "durable";
+    case QueueWorkload:
+        return "queue";
+    default:
+        return "cache";
+    }
+}
+
+ResourceSizer::Workload ResourceSizer::workloadFromName(const QString& name)
+{
+    if (name == "durable") {
+        return DurableWorkload;
+    }
+    if (name == "cache") {
+        return CacheWorkload;
+    }
+    if (name == "queue") {
+        return QueueWorkload;
+    }
+    // 未选择或无法识别时按持久存储处理，宁可多写盘也不丢数据
+    return DurableWorkload;
+}
+
+QString ResourceSizer::workloadDescription(Workload workload)
+{
+    switch (workload) {
+    case DurableWorkload:
+        return "持久存储（RDB + AOF，不淘汰数据）";
+    case QueueWorkload:
+        return "队列（写入密集，AOF，不淘汰数据）";
+    default:
+        return "缓存（不持久化，内存满时淘汰）";
+    }
+}
+
+QString ResourceSizer::formatBytes(qint64 bytes)
+{
+    if (bytes >= kGigabyte) {
+        return QString("%1 GB").arg(bytes / double(kGigabyte), 0, 'f', 1);
+    }
+    return QString("%1 MB").arg(bytes / kMegabyte);
+}
+
+ResourceSizer::Proposal ResourceSizer::propose(const HostResources& host, Workload workload, const QString& version)
+{
+    Proposal proposal;
+
+    qint64 budget = host.memoryBudget();
+    if (budget <= 0) {
+        budget = kGigabyte;
+        proposal.notes << "无法检测内存大小，按 1 GB 计算";
+    } else if (host.cgroupMemoryLimit > 0 && host.cgroupMemoryLimit == budget) {
+        proposal.notes << "受 cgroup 内存限制 " + formatBytes(budget);
+    } else {
+        proposal.notes << "物理内存 " + formatBytes(budget);
+    }
+
+    // 给系统和其他进程留 10%，至少 256 MB，但不超过一半
+    qint64 reserve = qMin(qMax(256 * kMegabyte, budget / 10), budget / 2);
+    qint64 usable = budget - reserve;
+
+    // maxmemory 只统计数据本身：另外约 10% 用于内存碎片和客户端缓冲区；
+    // fork 后父进程每改写一页就复制一页，写得越多需要的 COW 余量越大
+    const double overhead = 0.10;
+    double cow = 0.0;
+    bool persistent = workload != CacheWorkload;
+    if (workload == DurableWorkload) {
+        cow = 0.5;
+    } else if (workload == QueueWorkload) {
+        cow = 0.75;
+    }
+    qint64 maxmemory = qint64(usable / (1.0 + overhead + cow));
+    if (persistent) {
+        proposal.notes << QString("为 BGSAVE / AOF 重写的写时复制预留 %1% 的数据量").arg(int(cow * 100));
+    }
+
+    // 落盘需要的空间：RDB 与数据量相当，AOF 重写期间新旧文件并存
+    if (persistent && host.diskFree > 0) {
+        double diskFactor = workload == DurableWorkload ? 3.0 : 2.0;
+        qint64 diskCap = qint64(host.diskFree * 0.9 / diskFactor);
+        if (diskCap < maxmemory) {
+            maxmemory = diskCap;
+            proposal.notes << QString("数据目录可用空间只有 %1，按磁盘容量限制 maxmemory")
+                                  .arg(formatBytes(host.diskFree));
+        }
+    }
+
+    maxmemory = qMax(64 * kMegabyte, maxmemory / kMegabyte * kMegabyte);
+    proposal.maxmemory = maxmemory;
+    proposal.values.insert("maxmemory", QString("%1mb").arg(maxmemory / kMegabyte));
+
+    switch (workload) {
+    case CacheWorkload:
+        proposal.values.insert("maxmemory-policy", "allkeys-lru");
+        proposal.values.insert("save", "");
+        proposal.values.insert("appendonly", "no");
+        proposal.notes << "缓存不持久化，不会 fork，内存几乎全部用于数据";
+        break;
+    case DurableWorkload:
+        proposal.values.insert("maxmemory-policy", "noeviction");
+        proposal.values.insert("save", "900 1 300 10 60 10000");
+        proposal.values.insert("appendonly", "yes");
+        proposal.values.insert("appendfsync", "everysec");
+        proposal.values.insert("aof-use-rdb-preamble", "yes");
+        proposal.notes << "AOF 每秒刷盘，最多丢失 1 秒的写入";
+        break;
+    case QueueWorkload:
+        proposal.values.insert("maxmemory-policy", "noeviction");
+        proposal.values.insert("save", "");
+        proposal.values.insert("appendonly", "yes");
+        proposal.values.insert("appendfsync", "everysec");
+        proposal.values.insert("aof-use-rdb-preamble", "yes");
+        proposal.notes << "队列只用 AOF，避免定时 RDB 快照与持续写入争抢 COW";
+        break;
+    }
+
+    if (persistent && maxmemory > 24 * kGigabyte) {
+        proposal.notes << "单实例数据量较大，fork 可能阻塞数百毫秒，建议拆分为多个实例";
+    }
+
+    // 主线程之外的 I/O 线程；核数少时只会互相争抢
+    if (host.cpuCount >= 4) {
+        int ioThreads = qMin(8, host.cpuCount >= 8 ? host.cpuCount - 2 : host.cpuCount / 2);
+        proposal.values.insert("io-threads", QString::number(ioThreads));
+        proposal.notes << QString("%1 个 CPU，使用 %2 个 I/O 线程").arg(host.cpuCount).arg(ioThreads);
+    }
+
+    if (!version.isEmpty()) {
+        const QStringList keys = proposal.values.keys();
+        for (const QString& key : keys) {
+            const ConfigParameter* parameter = RedisConfigSchema::find(key);
+            if (parameter && !parameter->minVersion.isEmpty()
+                && VersionStore::compareVersions(version, parameter->minVersion) < 0) {
+                proposal.values.remove(key);
+            }
+        }
+    }
+
+    return proposal;
+}
@@ -0,0 +1,55 @@
+#ifndef RESOURCESIZER_H
+#define RESOURCESIZER_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+
+// 本机可供 Redis 使用的资源
+struct HostResources
+{
+    qint64 totalMemory = 0;       // 物理内存（/proc/meminfo MemTotal）
+    qint64 availableMemory = 0;   // 当前可用内存（MemAvailable）
+    qint64 cgroupMemoryLimit = -1; // cgroup v2 memory.max，-1 表示不限制
+    int cpuCount = 1;             // 可用 CPU 数，已考虑 cgroup cpu.max 配额
+    qint64 diskFree = -1;         // 数据目录所在分区的可用空间，-1 表示未知
+    qint64 diskTotal = -1;
+
+    // 实际能用的内存：物理内存和 cgroup 限制中较小的一个
+    qint64 memoryBudget() const;
+
+    static HostResources detect(const QString& dataDir);
+};
+
+// 根据本机资源和负载类型推荐 maxmemory、淘汰策略、RDB / AOF 参数和 io-threads。
+// 开启持久化时 BGSAVE / AOF 重写会 fork 子进程，写入越频繁，写时复制（COW）
+// 复制的页越多，maxmemory 需要给它留出相应的余量。
+class ResourceSizer
+{
+public:
+    enum Workload {
+        CacheWorkload,    // 纯缓存：不持久化，满了就淘汰
+        DurableWorkload,  // 持久存储：RDB + AOF，不淘汰
+        QueueWorkload     // 队列：写入密集，只用 AOF，不淘汰
+    };
+
+    struct Proposal
+    {
+        // 参数名 → 推荐值，可直接交给 RedisManager::applyConfig
+        QMap<QString, QString> values;
+        qint64 maxmemory = 0;
+        // 推荐依据，用于显示给用户
+        QStringList notes;
+    };
+
+    static QString workloadName(Workload workload);
+    static Workload workloadFromName(const QString& name);
+    static QString workloadDescription(Workload workload);
+
+    // version 用于跳过该版本不支持的参数（如 6.0 之前没有 io-threads），为空时不检查
+    static Proposal propose(const HostResources& host, Workload workload, const QString& version = QString());
+
+    static QString formatBytes(qint64 bytes);
+};
+
+#endif // RESOURCESIZER_H
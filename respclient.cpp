@@ -0,0 +1,631 @@
+#include "respclient.h"
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QMetaObject>
+#include <QDebug>
+#include <cstring>
+
+// 嵌套聚合类型的最大深度，防止恶意或损坏的数据把栈耗尽
+static const int kMaxNestingDepth = 64;
+// 读缓冲区中已消费部分超过这个大小且超过一半时才前移数据
+static const qsizetype kCompactThreshold = 64 * 1024;
+
+// ---------------------------------------------------------------- RespValue
+
+RespValue RespValue::error(const QByteArray& message)
+{
+    RespValue value(Error);
+    value.m_data = message;
+    return value;
+}
+
+qint64 RespValue::toInteger() const
+{
+    switch (m_type) {
+    case Integer:
+    case Boolean:
+        return m_integer;
+    case Double:
+        return qint64(m_double);
+    default:
+        return m_data.toLongLong();
+    }
+}
+
+double RespValue::toDouble() const
+{
+    switch (m_type) {
+    case Double:
+        return m_double;
+    case Integer:
+    case Boolean:
+        return double(m_integer);
+    default:
+        return m_data.toDouble();
+    }
+}
+
+bool RespValue::toBool() const
+{
+    switch (m_type) {
+    case Integer:
+    case Boolean:
+        return m_integer != 0;
+    case SimpleString:
+        return m_data == "OK";
+    default:
+        return false;
+    }
+}
+
+// ---------------------------------------------------------------- RespParser
+
+RespParser::Result RespParser::parse(const char* data, qsizetype size, qsizetype* consumed, RespValue* value)
+{
+    qsizetype pos = 0;
+    RespValue result;
+    Result status = parseValue(data, size, pos, result, 0);
+    if (status == Complete) {
+        *consumed = pos;
+        *value = std::move(result);
+    } else {
+        *consumed = 0;
+    }
+    return status;
+}
+
+bool RespParser::readLine(const char* data, qsizetype size, qsizetype& pos,
+                          qsizetype& lineStart, qsizetype& lineEnd)
+{
+    const char* begin = data + pos;
+    const char* newline = static_cast<const char*>(std::memchr(begin, '\n', size_t(size - pos)));
+    if (!newline) {
+        return false;
+    }
+
+    lineStart = pos;
+    lineEnd = newline - data;
+    if (lineEnd > lineStart && data[lineEnd - 1] == '\r') {
+        --lineEnd;
+    }
+    pos = (newline - data) + 1;
+    return true;
+}
+
+bool RespParser::parseInteger(const char* begin, const char* end, qint64& result)
+{
+    if (begin == end) {
+        return false;
+    }
+
+    bool negative = false;
+    if (*begin == '-' || *begin == '+') {
+        negative = *begin == '-';
+        ++begin;
+    }
+    if (begin == end) {
+        return false;
+    }
+
+    qint64 value = 0;
+    for (const char* p = begin; p != end; ++p) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        value = value * 10 + (*p - '0');
+    }
+    result = negative ? -value : value;
+    return true;
+}
+
+RespParser::Result RespParser::parseValue(const char* data, qsizetype size, qsizetype& pos,
+                                          RespValue& value, int depth)
+{
+    if (depth > kMaxNestingDepth) {
+        return ProtocolError;
+    }
+    if (pos >= size) {
+        return Incomplete;
+    }
+
+    const char type = data[pos++];
+    qsizetype lineStart = 0;
+    qsizetype lineEnd = 0;
+    if (!readLine(data, size, pos, lineStart, lineEnd)) {
+        return Incomplete;
+    }
+    const char* line = data + lineStart;
+    const char* lineStop = data + lineEnd;
+
+    switch (type) {
+    case '+':
+    case '-':
+    case '(':
+        value.m_type = type == '+' ? RespValue::SimpleString
+                     : type == '-' ? RespValue::Error
+                                   : RespValue::BigNumber;
+        value.m_data = QByteArray(line, lineEnd - lineStart);
+        return Complete;
+
+    case ':':
+        value.m_type = RespValue::Integer;
+        return parseInteger(line, lineStop, value.m_integer) ? Complete : ProtocolError;
+
+    case '_':
+        value.m_type = RespValue::Null;
+        return Complete;
+
+    case '#':
+        value.m_type = RespValue::Boolean;
+        value.m_integer = (lineEnd > lineStart && *line == 't') ? 1 : 0;
+        return Complete;
+
+    case ',': {
+        value.m_type = RespValue::Double;
+        bool ok = false;
+        value.m_double = QByteArray::fromRawData(line, lineEnd - lineStart).toDouble(&ok);
+        return ok ? Complete : ProtocolError;
+    }
+
+    case '$':
+    case '=':
+    case '!': {
+        qint64 length = 0;
+        if (!parseInteger(line, lineStop, length)) {
+            return ProtocolError;
+        }
+        if (length < 0) {
+            value.m_type = RespValue::Null;
+            return Complete;
+        }
+        // 内容加结尾的 \r\n
+        if (size - pos < length + 2) {
+            return Incomplete;
+        }
+
+        value.m_type = type == '$' ? RespValue::BulkString
+                     : type == '=' ? RespValue::VerbatimString
+                                   : RespValue::Error;
+        const char* content = data + pos;
+        qsizetype contentLength = qsizetype(length);
+        if (type == '=' && contentLength >= 4) {
+            // 去掉 "txt:" 之类的格式前缀
+            content += 4;
+            contentLength -= 4;
+        }
+        value.m_data = QByteArray(content, contentLength);
+        pos += qsizetype(length) + 2;
+        return Complete;
+    }
+
+    case '*':
+    case '~':
+    case '>':
+    case '%':
+    case '|': {
+        qint64 count = 0;
+        if (!parseInteger(line, lineStop, count)) {
+            return ProtocolError;
+        }
+        if (count < 0) {
+            value.m_type = RespValue::Null;
+            return Complete;
+        }
+        if (type == '%' || type == '|') {
+            count *= 2;
+        }
+        // 每个元素至少 3 个字节，数据明显不够时不必逐个尝试
+        if (count > (size - pos) / 3) {
+            return Incomplete;
+        }
+
+        QList<RespValue> elements;
+        elements.reserve(qsizetype(count));
+        for (qint64 i = 0; i < count; ++i) {
+            RespValue element;
+            Result status = parseValue(data, size, pos, element, depth + 1);
+            if (status != Complete) {
+                return status;
+            }
+            elements.append(std::move(element));
+        }
+
+        if (type == '|') {
+            // 属性只是附加信息，跳过后解析真正的回复
+            return parseValue(data, size, pos, value, depth + 1);
+        }
+
+        value.m_type = type == '*' ? RespValue::Array
+                     : type == '~' ? RespValue::Set
+                     : type == '>' ? RespValue::Push
+                                   : RespValue::Map;
+        value.m_elements = std::move(elements);
+        return Complete;
+    }
+
+    default:
+        return ProtocolError;
+    }
+}
+
+// ---------------------------------------------------------------- RespClient
+
+RespClient::RespClient(QObject *parent)
+    : QObject(parent)
+    , m_socket(nullptr)
+    , m_tcpSocket(nullptr)
+    , m_localSocket(nullptr)
+    , m_port(0)
+    , m_readPos(0)
+    , m_state(UnconnectedState)
+    , m_requestedProtocol(2)
+    , m_protocol(2)
+    , m_flushScheduled(false)
+{
+}
+
+RespClient::~RespClient()
+{
+    closeSocket();
+}
+
+void RespClient::encode(const QList<QByteArray>& args, QByteArray& out)
+{
+    out += '*';
+    out += QByteArray::number(args.size());
+    out += "\r\n";
+    for (const QByteArray& arg : args) {
+        out += '$';
+        out += QByteArray::number(arg.size());
+        out += "\r\n";
+        out += arg;
+        out += "\r\n";
+    }
+}
+
+QMap<QByteArray, QByteArray> RespClient::parseInfo(const QByteArray& info)
+{
+    QMap<QByteArray, QByteArray> fields;
+    qsizetype pos = 0;
+    while (pos < info.size()) {
+        qsizetype end = info.indexOf('\n', pos);
+        if (end < 0) {
+            end = info.size();
+        }
+        qsizetype lineEnd = (end > pos && info.at(end - 1) == '\r') ? end - 1 : end;
+        if (lineEnd > pos && info.at(pos) != '#') {
+            qsizetype colon = info.indexOf(':', pos);
+            if (colon > pos && colon < lineEnd) {
+                fields.insert(info.mid(pos, colon - pos), info.mid(colon + 1, lineEnd - colon - 1));
+            }
+        }
+        pos = end + 1;
+    }
+    return fields;
+}
+
+void RespClient::setServer(const QString& host, quint16 port)
+{
+    if (m_socketPath.isEmpty() && m_host == host && m_port == port) {
+        return;
+    }
+
+    disconnectFromServer();
+    m_host = host;
+    m_port = port;
+    m_socketPath.clear();
+}
+
+void RespClient::connectToHost(const QString& host, quint16 port)
+{
+    if (m_state != UnconnectedState && m_socketPath.isEmpty() && m_host == host && m_port == port) {
+        // 复用已有连接
+        return;
+    }
+
+    disconnectFromServer();
+    m_host = host;
+    m_port = port;
+    m_socketPath.clear();
+    openSocket();
+}
+
+void RespClient::connectToServer(const QString& socketPath)
+{
+    if (m_state != UnconnectedState && m_socketPath == socketPath) {
+        return;
+    }
+
+    disconnectFromServer();
+    m_socketPath = socketPath;
+    m_host.clear();
+    m_port = 0;
+    openSocket();
+}
+
+void RespClient::disconnectFromServer()
+{
+    bool wasConnected = m_state == ReadyState;
+    closeSocket();
+    failPending("ERR connection closed");
+    if (wasConnected) {
+        emit disconnected();
+    }
+}
+
+void RespClient::openSocket()
+{
+    if (m_host.isEmpty() && m_socketPath.isEmpty()) {
+        return;
+    }
+
+    m_readBuffer.resize(0);
+    m_readPos = 0;
+    m_protocol = 2;
+    m_state = ConnectingState;
+
+    if (!m_socketPath.isEmpty()) {
+        m_localSocket = new QLocalSocket(this);
+        m_socket = m_localSocket;
+        connect(m_localSocket, &QLocalSocket::connected, this, &RespClient::onSocketConnected);
+        connect(m_localSocket, &QLocalSocket::disconnected, this, &RespClient::onSocketDisconnected);
+        connect(m_localSocket, &QLocalSocket::readyRead, this, &RespClient::onReadyRead);
+        connect(m_localSocket, &QLocalSocket::errorOccurred, this, &RespClient::onSocketError);
+        m_localSocket->connectToServer(m_socketPath);
+    } else {
+        m_tcpSocket = new QTcpSocket(this);
+        m_socket = m_tcpSocket;
+        connect(m_tcpSocket, &QTcpSocket::connected, this, &RespClient::onSocketConnected);
+        connect(m_tcpSocket, &QTcpSocket::disconnected, this, &RespClient::onSocketDisconnected);
+        connect(m_tcpSocket, &QTcpSocket::readyRead, this, &RespClient::onReadyRead);
+        connect(m_tcpSocket, &QTcpSocket::errorOccurred, this, &RespClient::onSocketError);
+        m_tcpSocket->connectToHost(m_host, m_port);
+    }
+}
+
+void RespClient::closeSocket()
+{
+    if (m_socket) {
+        m_socket->disconnect(this);
+        if (m_tcpSocket) {
+            m_tcpSocket->abort();
+        } else {
+            m_localSocket->abort();
+        }
+        m_socket->deleteLater();
+    }
+
+    m_socket = nullptr;
+    m_tcpSocket = nullptr;
+    m_localSocket = nullptr;
+    m_state = UnconnectedState;
+}
+
+void RespClient::onSocketConnected()
+{
+    if (m_tcpSocket) {
+        // 命令都很小，关掉 Nagle 避免 40ms 的延迟确认
+        m_tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    }
+
+    m_state = HandshakeState;
+    startHandshake();
+}
+
+void RespClient::startHandshake()
+{
+    auto becomeReady = [this]() {
+        m_state = ReadyState;
+        emit connected();
+        flush();
+    };
+
+    QByteArray handshake;
+
+    if (m_requestedProtocol == 3) {
+        QList<QByteArray> hello;
+        hello << "HELLO" << "3";
+        if (!m_password.isEmpty()) {
+            hello << "AUTH" << (m_username.isEmpty() ? QByteArray("default") : m_username.toUtf8())
+                  << m_password.toUtf8();
+        }
+        encode(hello, handshake);
+
+        // HELLO 的结果决定协议版本，排队的命令等它返回后再发
+        m_callbacks.enqueue([this, becomeReady](const RespValue& reply) {
+            if (!reply.isError()) {
+                m_protocol = 3;
+                becomeReady();
+                return;
+            }
+            if (reply.data().startsWith("WRONGPASS") || reply.data().startsWith("NOPERM")) {
+                emit errorOccurred("Redis 认证失败: " + reply.toString());
+                disconnectFromServer();
+                return;
+            }
+
+            // Redis 6 之前没有 HELLO，改用 RESP2 + AUTH
+            if (!m_password.isEmpty()) {
+                QByteArray auth;
+                encode(QList<QByteArray>() << "AUTH" << m_password.toUtf8(), auth);
+                m_callbacks.enqueue([this](const RespValue& authReply) {
+                    if (authReply.isError()) {
+                        emit errorOccurred("Redis 认证失败: " + authReply.toString());
+                    }
+                });
+                m_socket->write(auth);
+            }
+            becomeReady();
+        });
+        m_socket->write(handshake);
+        return;
+    }
+
+    if (!m_password.isEmpty()) {
+        QList<QByteArray> auth;
+        auth << "AUTH";
+        if (!m_username.isEmpty()) {
+            auth << m_username.toUtf8();
+        }
+        auth << m_password.toUtf8();
+        encode(auth, handshake);
+
+        // AUTH 与排队的命令一起流水线发出，失败时后续命令会收到 NOAUTH 错误
+        m_callbacks.enqueue([this](const RespValue& reply) {
+            if (reply.isError()) {
+                emit errorOccurred("Redis 认证失败: " + reply.toString());
+            }
+        });
+        m_socket->write(handshake);
+    }
+
+    becomeReady();
+}
+
+void RespClient::send(const QByteArray& command, const Callback& callback)
+{
+    send(command.split(' '), callback);
+}
+
+void RespClient::send(const QList<QByteArray>& args, const Callback& callback)
+{
+    encode(args, m_writeBuffer);
+    m_queuedCallbacks.enqueue(callback);
+
+    if (m_state == UnconnectedState) {
+        if (m_host.isEmpty() && m_socketPath.isEmpty()) {
+            failPending("ERR not connected");
+            return;
+        }
+        // 连接断开后按需重连
+        openSocket();
+        return;
+    }
+
+    if (m_state == ReadyState) {
+        scheduleFlush();
+    }
+}
+
+void RespClient::scheduleFlush()
+{
+    if (m_flushScheduled) {
+        return;
+    }
+
+    // 同一轮事件循环中的所有命令合并成一次写入
+    m_flushScheduled = true;
+    QMetaObject::invokeMethod(this, &RespClient::flush, Qt::QueuedConnection);
+}
+
+void RespClient::flush()
+{
+    m_flushScheduled = false;
+    if (m_state != ReadyState || m_writeBuffer.isEmpty()) {
+        return;
+    }
+
+    m_socket->write(m_writeBuffer);
+    m_writeBuffer.resize(0);
+    while (!m_queuedCallbacks.isEmpty()) {
+        m_callbacks.enqueue(m_queuedCallbacks.dequeue());
+    }
+}
+
+void RespClient::onReadyRead()
+{
+    // 直接读进复用的缓冲区，避免 readAll() 产生临时对象
+    qint64 available = m_socket->bytesAvailable();
+    if (available <= 0) {
+        return;
+    }
+    qsizetype oldSize = m_readBuffer.size();
+    m_readBuffer.resize(oldSize + qsizetype(available));
+    qint64 read = m_socket->read(m_readBuffer.data() + oldSize, available);
+    m_readBuffer.resize(oldSize + qsizetype(qMax<qint64>(0, read)));
+
+    while (m_readPos < m_readBuffer.size()) {
+        qsizetype consumed = 0;
+        RespValue reply;
+        RespParser::Result status = RespParser::parse(m_readBuffer.constData() + m_readPos,
+                                                      m_readBuffer.size() - m_readPos,
+                                                      &consumed, &reply);
+        if (status == RespParser::Incomplete) {
+            break;
+        }
+        if (status == RespParser::ProtocolError) {
+            qDebug() << "[RespClient] Protocol error, dropping connection";
+            closeSocket();
+            failPending("ERR protocol error");
+            emit errorOccurred("Redis 协议错误");
+            return;
+        }
+
+        m_readPos += consumed;
+
+        if (reply.type() == RespValue::Push) {
+            emit pushReceived(reply);
+        } else if (!m_callbacks.isEmpty()) {
+            Callback callback = m_callbacks.dequeue();
+            if (callback) {
+                callback(reply);
+            }
+        }
+
+        // 回调中可能断开了连接
+        if (m_state == UnconnectedState) {
+            return;
+        }
+    }
+
+    if (m_readPos == m_readBuffer.size()) {
+        m_readBuffer.resize(0);
+        m_readPos = 0;
+    } else if (m_readPos > kCompactThreshold && m_readPos > m_readBuffer.size() / 2) {
+        m_readBuffer.remove(0, m_readPos);
+        m_readPos = 0;
+    }
+}
+
+void RespClient::onSocketDisconnected()
+{
+    bool wasConnected = m_state == ReadyState;
+    closeSocket();
+    failPending("ERR connection lost");
+    if (wasConnected) {
+        emit disconnected();
+    }
+}
+
+void RespClient::onSocketError()
+{
+    // 对端关闭时 Qt 先报错误再发 disconnected，这里统一处理，后者不会再收到
+    bool wasConnected = m_state == ReadyState;
+    QString error = m_socket->errorString();
+    closeSocket();
+    failPending("ERR " + error.toUtf8());
+    emit errorOccurred(error);
+    if (wasConnected) {
+        emit disconnected();
+    }
+}
+
+void RespClient::failPending(const QByteArray& message)
+{
+    QQueue<Callback> callbacks;
+    callbacks.swap(m_callbacks);
+    while (!m_queuedCallbacks.isEmpty()) {
+        callbacks.enqueue(m_queuedCallbacks.dequeue());
+    }
+    m_writeBuffer.resize(0);
+    m_readBuffer.resize(0);
+    m_readPos = 0;
+
+    RespValue error = RespValue::error(message);
+    while (!callbacks.isEmpty()) {
+        Callback callback = callbacks.dequeue();
+        if (callback) {
+            callback(error);
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#ifndef RESPCLIENT_H
+#define RESPCLIENT_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QQueue>
+#include <QMap>
+#include <functional>
+
+class QIODevice;
+class QTcpSocket;
+class QLocalSocket;
+
+// RESP2 / RESP3 的一个回复值。Map 按 键, 值, 键, 值 ... 的顺序展开在 elements() 中
+class RespValue
+{
+public:
+    enum Type {
+        Invalid,
+        SimpleString,
+        Error,
+        Integer,
+        BulkString,
+        Array,
+        Null,
+        Double,
+        Boolean,
+        BigNumber,
+        VerbatimString,
+        Map,
+        Set,
+        Push
+    };
+
+    RespValue() : m_type(Invalid), m_integer(0), m_double(0) {}
+    explicit RespValue(Type type) : m_type(type), m_integer(0), m_double(0) {}
+
+    static RespValue error(const QByteArray& message);
+
+    Type type() const { return m_type; }
+    bool isValid() const { return m_type != Invalid; }
+    bool isError() const { return m_type == Error; }
+    bool isNull() const { return m_type == Null; }
+    bool isAggregate() const { return m_type == Array || m_type == Map || m_type == Set || m_type == Push; }
+
+    // 字符串类（含错误信息、大数）的原始内容
+    const QByteArray& data() const { return m_data; }
+    QString toString() const { return QString::fromUtf8(m_data); }
+    qint64 toInteger() const;
+    double toDouble() const;
+    bool toBool() const;
+    const QList<RespValue>& elements() const { return m_elements; }
+
+private:
+    friend class RespParser;
+
+    Type m_type;
+    QByteArray m_data;
+    qint64 m_integer;
+    double m_double;
+    QList<RespValue> m_elements;
+};
+
+// 在调用方的缓冲区上原地解析回复：行和整数直接从缓冲区读取，不产生中间拷贝，
+// 只有最终的字符串值会复制一次。数据不完整时不消费任何字节。
+class RespParser
+{
+public:
+    enum Result {
+        Incomplete,
+        Complete,
+        ProtocolError
+    };
+
+    static Result parse(const char* data, qsizetype size, qsizetype* consumed, RespValue* value);
+
+private:
+    static Result parseValue(const char* data, qsizetype size, qsizetype& pos, RespValue& value, int depth);
+    static bool readLine(const char* data, qsizetype size, qsizetype& pos, qsizetype& lineStart, qsizetype& lineEnd);
+    static bool parseInteger(const char* begin, const char* end, qint64& result);
+};
+
+// 非阻塞的 Redis 客户端，直接跑在 Qt 事件循环上：
+// - TCP（QTcpSocket）或 Unix 套接字 / 命名管道（QLocalSocket）
+// - 同一轮事件循环中发出的命令合并成一次写入（pipelining），回复按顺序回调
+// - 读缓冲区复用，已消费的数据超过一半时才整体前移
+// - 连接后自动 AUTH（RESP3 用 HELLO 3 AUTH），断开后下次发送命令时自动重连
+class RespClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(const RespValue& reply)>;
+
+    explicit RespClient(QObject *parent = nullptr);
+    ~RespClient();
+
+    void setPassword(const QString& password) { m_password = password; }
+    QString password() const { return m_password; }
+    void setUsername(const QString& username) { m_username = username; }
+    // 2 或 3；服务器不支持 HELLO（Redis 6 之前）时自动退回 RESP2
+    void setProtocol(int protocol) { m_requestedProtocol = protocol == 3 ? 3 : 2; }
+    int protocol() const { return m_protocol; }
+
+    // 只记录服务器地址，第一次 send() 时再连接
+    void setServer(const QString& host, quint16 port);
+    void connectToHost(const QString& host, quint16 port);
+    void connectToServer(const QString& socketPath);
+    void disconnectFromServer();
+
+    bool isConnected() const { return m_state == ReadyState; }
+    QString host() const { return m_host; }
+    quint16 port() const { return m_port; }
+
+    // 发送命令。未连接时先排队，连接建立（并认证）后一起发出
+    void send(const QList<QByteArray>& args, const Callback& callback = Callback());
+    void send(const QByteArray& command, const Callback& callback = Callback());
+
+    // 已发出但还没收到回复的命令数
+    int pendingCount() const { return m_callbacks.size(); }
+
+    static void encode(const QList<QByteArray>& args, QByteArray& out);
+    // 把 INFO 的回复解析为 字段 → 值，忽略 "# Section" 标题行
+    static QMap<QByteArray, QByteArray> parseInfo(const QByteArray& info);
+
+signals:
+    void connected();
+    void disconnected();
+    void errorOccurred(const QString& error);
+    // RESP3 推送消息（如客户端缓存失效通知），不对应任何命令
+    void pushReceived(const RespValue& message);
+
+private slots:
+    void onSocketConnected();
+    void onSocketDisconnected();
+    void onSocketError();
+    void onReadyRead();
+    void flush();
+
+private:
+    enum State {
+        UnconnectedState,
+        ConnectingState,
+        HandshakeState,
+        ReadyState
+    };
+
+    void openSocket();
+    void closeSocket();
+    void startHandshake();
+    void scheduleFlush();
+    void failPending(const QByteArray& message);
+
+private:
+    QIODevice* m_socket;
+    QTcpSocket* m_tcpSocket;
+    QLocalSocket* m_localSocket;
+
+    QString m_host;
+    quint16 m_port;
+    QString m_socketPath;
+    QString m_username;
+    QString m_password;
+
+    // 已写入套接字的命令的回调，按发送顺序排列
+    QQueue<Callback> m_callbacks;
+    // 连接就绪前或本轮事件循环中积累的命令
+    QByteArray m_writeBuffer;
+    QQueue<Callback> m_queuedCallbacks;
+
+    QByteArray m_readBuffer;
+    qsizetype m_readPos;
+
+    State m_state;
+    int m_requestedProtocol;
+    int m_protocol;
+    bool m_flushScheduled;
+};
+
+#endif // RESPCLIENT_H
@@ -0,0 +1,484 @@
+#include "segmenteddownloader.h"
+#include "filedownloader.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTimer>
+#include <QDebug>
+
+// 每段最小长度，文件太小时减少段数
+static const qint64 kMinSegmentSize = 1024 * 1024;
+// QNetworkAccessManager 对同一主机最多并发 6 条 HTTP/1.1 连接
+static const int kMaxSegments = 6;
+static const qint64 kSegmentChunkSize = 64 * 1024;
+static const qint64 kSegmentReadBufferSize = 256 * 1024;
+static const int kSegmentMaxRetries = 3;
+static const int kTransferTimeoutMs = 30000;
+// 所有段合计每写入这么多数据刷新一次续传描述文件
+static const qint64 kResumeSaveInterval = 4 * 1024 * 1024;
+
+SegmentedDownloader::SegmentedDownloader(QNetworkAccessManager* networkManager, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(networkManager)
+    , m_probeReply(nullptr)
+    , m_totalSize(0)
+    , m_lastSavedBytes(0)
+    , m_segmentCount(4)
+    , m_finishedSegments(0)
+    , m_resumable(true)
+{
+}
+
+SegmentedDownloader::~SegmentedDownloader()
+{
+    abort();
+}
+
+void SegmentedDownloader::setSegmentCount(int count)
+{
+    m_segmentCount = qBound(1, count, kMaxSegments);
+}
+
+bool SegmentedDownloader::hasResumeState(const QString& destPath)
+{
+    QFile meta(destPath + ".part.meta");
+    if (!meta.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    return QJsonDocument::fromJson(meta.readAll()).object().contains("segments");
+}
+
+void SegmentedDownloader::start(const QUrl& url, const QString& destPath)
+{
+    abort();
+
+    m_url = url;
+    m_resolvedUrl = url;
+    m_destPath = destPath;
+    m_lastError.clear();
+    m_etag.clear();
+    m_lastModified.clear();
+    m_totalSize = 0;
+    m_finishedSegments = 0;
+
+    QNetworkRequest request(m_url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                        QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setTransferTimeout(kTransferTimeoutMs);
+
+    m_probeReply = m_networkManager->head(request);
+    connect(m_probeReply, &QNetworkReply::finished,
+            this, &SegmentedDownloader::onProbeFinished);
+}
+
+void SegmentedDownloader::abort()
+{
+    if (m_probeReply) {
+        m_probeReply->disconnect(this);
+        m_probeReply->abort();
+        m_probeReply->deleteLater();
+        m_probeReply = nullptr;
+    }
+
+    if (m_segments.isEmpty()) {
+        return;
+    }
+
+    // 和单连接下载一样，可续传时保留部分文件和各段进度
+    bool canResume = m_resumable && (!m_etag.isEmpty() || !m_lastModified.isEmpty());
+    if (canResume) {
+        saveResumeState();
+    }
+    closeSegments();
+    if (!canResume) {
+        QFile::remove(partPath());
+        clearResumeState();
+    }
+}
+
+void SegmentedDownloader::onProbeFinished()
+{
+    QNetworkReply* reply = m_probeReply;
+    m_probeReply = nullptr;
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        // HEAD 失败不代表 GET 也失败，交给单连接下载处理
+        qDebug() << "[SegmentedDownloader] HEAD failed:" << reply->errorString();
+        emit rangesUnsupported();
+        return;
+    }
+
+    // 重定向后以最终地址发起分段请求
+    m_resolvedUrl = reply->url();
+    m_totalSize = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+    bool acceptsRanges = reply->rawHeader("Accept-Ranges").trimmed().toLower() == "bytes";
+
+    int count = m_segmentCount;
+    if (m_totalSize > 0) {
+        count = qMin<qint64>(count, qMax<qint64>(1, m_totalSize / kMinSegmentSize));
+    }
+
+    if (!acceptsRanges || m_totalSize <= 0 || count < 2) {
+        qDebug() << "[SegmentedDownloader] Segmented download disabled (Accept-Ranges:"
+                 << reply->rawHeader("Accept-Ranges") << ", size:" << m_totalSize << ")";
+        emit rangesUnsupported();
+        return;
+    }
+
+    // 各段用 If-Range 保证拿到的是同一个版本的文件；弱校验值不能用于 If-Range
+    QByteArray etag = reply->rawHeader("ETag");
+    m_etag = etag.startsWith("W/") ? QByteArray() : etag;
+    m_lastModified = reply->rawHeader("Last-Modified");
+
+    m_chunk.resize(kSegmentChunkSize);
+
+    if (m_resumable && loadResumeState()) {
+        qDebug() << "[SegmentedDownloader] Resuming" << m_segments.size() << "segments of"
+                 << m_totalSize << "bytes";
+    } else {
+        QFile::remove(metaPath());
+        QFile file(partPath());
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || !file.resize(m_totalSize)) {
+            fail("无法创建下载文件: " + file.errorString());
+            return;
+        }
+        file.close();
+
+        qDebug() << "[SegmentedDownloader] Downloading" << m_totalSize << "bytes in"
+                 << count << "segments";
+
+        qint64 segmentSize = m_totalSize / count;
+        for (int i = 0; i < count; ++i) {
+            addSegment(i * segmentSize, (i == count - 1) ? m_totalSize - 1 : (i + 1) * segmentSize - 1, 0);
+        }
+    }
+
+    m_lastSavedBytes = 0;
+    for (const Segment* segment : m_segments) {
+        m_lastSavedBytes += segment->written;
+    }
+
+    const QList<Segment*> segments = m_segments;
+    for (Segment* segment : segments) {
+        if (segment->written > segment->end - segment->start) {
+            // 续传时已经下完的段
+            ++m_finishedSegments;
+            continue;
+        }
+        startSegment(segment);
+        if (m_segments.isEmpty()) {
+            return;
+        }
+    }
+
+    if (m_finishedSegments == m_segments.size()) {
+        complete();
+    }
+}
+
+SegmentedDownloader::Segment* SegmentedDownloader::addSegment(qint64 start, qint64 end, qint64 written)
+{
+    Segment* segment = new Segment;
+    segment->start = start;
+    segment->end = end;
+    segment->written = written;
+    segment->retries = 0;
+    segment->reply = nullptr;
+    segment->file = nullptr;
+    segment->retryTimer = nullptr;
+    m_segments.append(segment);
+    return segment;
+}
+
+bool SegmentedDownloader::loadResumeState()
+{
+    QFile meta(metaPath());
+    if (!meta.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QJsonObject obj = QJsonDocument::fromJson(meta.readAll()).object();
+    meta.close();
+
+    // 地址、文件大小和校验值都对得上才能沿用，否则服务器上的文件已经变了
+    if (obj.value("url").toString() != m_url.toString()
+        || obj.value("size").toInteger() != m_totalSize
+        || obj.value("etag").toString().toLatin1() != m_etag
+        || obj.value("lastModified").toString().toLatin1() != m_lastModified
+        || QFileInfo(partPath()).size() != m_totalSize) {
+        return false;
+    }
+
+    const QJsonArray segments = obj.value("segments").toArray();
+    qint64 expectedStart = 0;
+    for (const QJsonValue& value : segments) {
+        QJsonObject entry = value.toObject();
+        qint64 start = entry.value("start").toInteger();
+        qint64 end = entry.value("end").toInteger();
+        qint64 written = entry.value("written").toInteger();
+        if (start != expectedStart || end < start || written < 0 || written > end - start + 1) {
+            closeSegments();
+            return false;
+        }
+        addSegment(start, end, written);
+        expectedStart = end + 1;
+    }
+
+    if (m_segments.isEmpty() || expectedStart != m_totalSize) {
+        closeSegments();
+        return false;
+    }
+    return true;
+}
+
+void SegmentedDownloader::saveResumeState()
+{
+    if (m_segments.isEmpty() || (m_etag.isEmpty() && m_lastModified.isEmpty())) {
+        return;
+    }
+
+    // 先把各段已写入的数据落盘，描述文件里的进度不能超前
+    qint64 received = 0;
+    QJsonArray segments;
+    for (const Segment* segment : m_segments) {
+        if (segment->file && !segment->file->flush()) {
+            return;
+        }
+        QJsonObject entry;
+        entry["start"] = segment->start;
+        entry["end"] = segment->end;
+        entry["written"] = segment->written;
+        segments.append(entry);
+        received += segment->written;
+    }
+
+    QJsonObject obj;
+    obj["url"] = m_url.toString();
+    obj["etag"] = QString::fromLatin1(m_etag);
+    obj["lastModified"] = QString::fromLatin1(m_lastModified);
+    obj["size"] = m_totalSize;
+    // 第一段从 0 开始连续写入，退回单连接下载时从这里续传
+    obj["offset"] = m_segments.first()->written;
+    obj["segments"] = segments;
+
+    QSaveFile meta(metaPath());
+    if (meta.open(QIODevice::WriteOnly)) {
+        meta.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+        if (meta.commit()) {
+            m_lastSavedBytes = received;
+        }
+    }
+}
+
+void SegmentedDownloader::clearResumeState()
+{
+    QFile::remove(metaPath());
+}
+
+void SegmentedDownloader::startSegment(Segment* segment)
+{
+    if (!segment->file) {
+        segment->file = new QFile(partPath(), this);
+        if (!segment->file->open(QIODevice::ReadWrite)) {
+            fail("无法写入下载文件: " + segment->file->errorString());
+            return;
+        }
+    }
+
+    qint64 from = segment->start + segment->written;
+    if (!segment->file->seek(from)) {
+        fail("无法写入下载文件: " + segment->file->errorString());
+        return;
+    }
+
+    QNetworkRequest request(m_resolvedUrl);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                        QNetworkRequest::NoLessSafeRedirectPolicy);
+    // HTTP/2 会把所有段复用到同一条连接上，分段就失去意义
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+    request.setTransferTimeout(kTransferTimeoutMs);
+    request.setRawHeader("Range", "bytes=" + QByteArray::number(from) + "-"
+                                  + QByteArray::number(segment->end));
+    if (!m_etag.isEmpty() || !m_lastModified.isEmpty()) {
+        request.setRawHeader("If-Range", !m_etag.isEmpty() ? m_etag : m_lastModified);
+    }
+
+    segment->reply = m_networkManager->get(request);
+    segment->reply->setReadBufferSize(kSegmentReadBufferSize);
+
+    connect(segment->reply, &QNetworkReply::readyRead,
+            this, [this, segment]() { onSegmentReadyRead(segment); });
+    connect(segment->reply, &QNetworkReply::finished,
+            this, [this, segment]() { onSegmentFinished(segment); });
+}
+
+void SegmentedDownloader::onSegmentReadyRead(Segment* segment)
+{
+    QNetworkReply* reply = segment->reply;
+    if (!reply) {
+        return;
+    }
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status != 206) {
+        // 200 说明 If-Range 不再匹配（文件已变化）或服务器忽略了 Range，不能按偏移写入；
+        // 不读走数据的话读缓冲满后连接会一直挂到超时，所以立即放弃分段。错误响应等 finished 处理
+        if (status > 0 && status < 400) {
+            fallBack(status);
+        }
+        return;
+    }
+
+    qint64 remaining = segment->end - segment->start + 1 - segment->written;
+    while (remaining > 0 && reply->bytesAvailable() > 0) {
+        qint64 n = reply->read(m_chunk.data(), qMin<qint64>(m_chunk.size(), remaining));
+        if (n <= 0) {
+            break;
+        }
+
+        if (segment->file->write(m_chunk.constData(), n) != n) {
+            fail("写入下载文件失败: " + segment->file->errorString());
+            return;
+        }
+        segment->written += n;
+        remaining -= n;
+    }
+
+    emitProgress();
+}
+
+void SegmentedDownloader::onSegmentFinished(Segment* segment)
+{
+    QNetworkReply* reply = segment->reply;
+    if (!reply) {
+        return;
+    }
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() == QNetworkReply::NoError && status != 206) {
+        fallBack(status);
+        return;
+    }
+
+    onSegmentReadyRead(segment);
+    if (m_segments.isEmpty()) {
+        return;
+    }
+
+    qint64 length = segment->end - segment->start + 1;
+    if (reply->error() != QNetworkReply::NoError || segment->written < length) {
+        QString error = reply->errorString();
+        reply->disconnect(this);
+        reply->deleteLater();
+        segment->reply = nullptr;
+
+        // 单段失败时只重试这一段剩余的部分，和单连接下载一样按 1s、2s、4s 退避
+        if (segment->retries < kSegmentMaxRetries) {
+            int delay = 1000 << segment->retries;
+            ++segment->retries;
+            qDebug() << "[SegmentedDownloader] Segment" << segment->start << "-" << segment->end
+                     << "failed:" << error << "- retry" << segment->retries << "in" << delay << "ms";
+            if (!segment->retryTimer) {
+                segment->retryTimer = new QTimer(this);
+                segment->retryTimer->setSingleShot(true);
+                connect(segment->retryTimer, &QTimer::timeout,
+                        this, [this, segment]() { startSegment(segment); });
+            }
+            segment->retryTimer->start(delay);
+            return;
+        }
+
+        fail("下载失败: " + error);
+        return;
+    }
+
+    reply->disconnect(this);
+    reply->deleteLater();
+    segment->reply = nullptr;
+    segment->file->close();
+
+    if (++m_finishedSegments == m_segments.size()) {
+        complete();
+    }
+}
+
+void SegmentedDownloader::complete()
+{
+    closeSegments();
+    clearResumeState();
+
+    if (!FileDownloader::replaceFile(partPath(), m_destPath)) {
+        QFile::remove(partPath());
+        m_lastError = "无法保存下载文件";
+        emit finished(false);
+        return;
+    }
+
+    emit progress(m_totalSize, m_totalSize);
+    emit finished(true);
+}
+
+void SegmentedDownloader::closeSegment(Segment* segment)
+{
+    if (segment->retryTimer) {
+        delete segment->retryTimer;
+        segment->retryTimer = nullptr;
+    }
+
+    if (segment->reply) {
+        segment->reply->disconnect(this);
+        segment->reply->abort();
+        segment->reply->deleteLater();
+        segment->reply = nullptr;
+    }
+
+    if (segment->file) {
+        segment->file->close();
+        delete segment->file;
+        segment->file = nullptr;
+    }
+}
+
+void SegmentedDownloader::closeSegments()
+{
+    for (Segment* segment : m_segments) {
+        closeSegment(segment);
+        delete segment;
+    }
+    m_segments.clear();
+}
+
+void SegmentedDownloader::fallBack(int status)
+{
+    // 已下载的各段可能属于旧版本的文件，全部丢弃，由调用方从头单连接下载
+    qDebug() << "[SegmentedDownloader] Server answered HTTP" << status
+             << "to a range request, falling back to a single connection";
+    closeSegments();
+    QFile::remove(partPath());
+    clearResumeState();
+    emit rangesUnsupported();
+}
+
+void SegmentedDownloader::fail(const QString& error)
+{
+    abort();
+    m_lastError = error;
+    emit finished(false);
+}
+
+void SegmentedDownloader::emitProgress()
+{
+    qint64 received = 0;
+    for (const Segment* segment : m_segments) {
+        received += segment->written;
+    }
+
+    if (m_resumable && received - m_lastSavedBytes >= kResumeSaveInterval) {
+        saveResumeState();
+    }
+
+    emit progress(received, m_totalSize);
+}
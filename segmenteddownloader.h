@@ -0,0 +1,102 @@
+#ifndef SEGMENTEDDOWNLOADER_H
+#define SEGMENTEDDOWNLOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QList>
+#include <QByteArray>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+class QFile;
+class QTimer;
+
+// 多连接分段下载器：先用 HEAD 探测 Accept-Ranges 和文件大小，
+// 再把文件切成 N 段并发下载，各段直接写入预分配文件的对应偏移。
+// 服务器不支持 Range（或某一段拿到的不是 206）时发出 rangesUnsupported()，由调用方退回单连接下载。
+// 可续传模式下各段进度写入 .part.meta，下次从各段断点继续；
+// 第一段的连续部分同时记为 offset，单连接下载器也能接着续传。
+class SegmentedDownloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SegmentedDownloader(QNetworkAccessManager* networkManager, QObject *parent = nullptr);
+    ~SegmentedDownloader();
+
+    void setSegmentCount(int count);
+    int segmentCount() const { return m_segmentCount; }
+
+    void setResumable(bool enabled) { m_resumable = enabled; }
+    bool isResumable() const { return m_resumable; }
+
+    // destPath 是否留有分段下载的续传状态
+    static bool hasResumeState(const QString& destPath);
+
+    void start(const QUrl& url, const QString& destPath);
+    void abort();
+    bool isRunning() const { return m_probeReply != nullptr || !m_segments.isEmpty(); }
+
+    QString getLastError() const { return m_lastError; }
+    // 最近一次下载的服务器校验值（强 ETag 和 Last-Modified）
+    QByteArray etag() const { return m_etag; }
+    QByteArray lastModified() const { return m_lastModified; }
+
+signals:
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
+    void finished(bool success);
+    void rangesUnsupported();
+
+private slots:
+    void onProbeFinished();
+
+private:
+    struct Segment
+    {
+        qint64 start;
+        qint64 end;        // 包含
+        qint64 written;
+        int retries;
+        QNetworkReply* reply;
+        QFile* file;
+        QTimer* retryTimer;
+    };
+
+    Segment* addSegment(qint64 start, qint64 end, qint64 written);
+    bool loadResumeState();
+    void saveResumeState();
+    void clearResumeState();
+    void startSegment(Segment* segment);
+    void onSegmentReadyRead(Segment* segment);
+    void onSegmentFinished(Segment* segment);
+    void complete();
+    void closeSegment(Segment* segment);
+    void closeSegments();
+    void fallBack(int status);
+    void fail(const QString& error);
+    void emitProgress();
+    QString partPath() const { return m_destPath + ".part"; }
+    QString metaPath() const { return m_destPath + ".part.meta"; }
+
+private:
+    QNetworkAccessManager* m_networkManager;
+    QNetworkReply* m_probeReply;
+    QList<Segment*> m_segments;
+    QByteArray m_chunk;
+
+    QUrl m_url;            // 调用方给出的地址，续传状态按它匹配
+    QUrl m_resolvedUrl;    // 重定向后的地址，各段向它请求
+    QString m_destPath;
+    QString m_lastError;
+    QByteArray m_etag;
+    QByteArray m_lastModified;
+
+    qint64 m_totalSize;
+    qint64 m_lastSavedBytes;
+    int m_segmentCount;
+    int m_finishedSegments;
+    bool m_resumable;
+};
+
+#endif // SEGMENTEDDOWNLOADER_H
@@ -15,6 +15,23 @@ ServiceConfig::ServiceConfig()
     , m_password("")
     , m_autoStart(true)
     , m_serviceInstalled(false)
+    , m_artifactCacheMaxSize(2LL * 1024 * 1024 * 1024)
+    , m_downloadSegments(4)
+    , m_resumableDownload(true)
+    , m_streamingInstall(false)
+    , m_buildProfile("default")
+    , m_buildAllocator("jemalloc")
+    , m_benchmarkAfterBuild(true)
+    , m_buildJobs(0)
+    , m_workloadProfile()
+    , m_instancePortStart(10900)
+    , m_instancePortEnd(10999)
+    , m_placementMode("none")
+    , m_placementNode(0)
+    , m_metricsInterval(1000)
+    , m_latencyCommands({"PING", "GET __latency_probe__"})
+    , m_latencyProbeInterval(10)
+    , m_latencyConnections(2)
 {
     QString configPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
     QDir dir;
@@ -74,6 +91,206 @@ void ServiceConfig::setServiceInstalled(bool installed)
     m_serviceInstalled = installed;
 }
 
+QStringList ServiceConfig::getMirrors() const
+{
+    return m_mirrors;
+}
+
+void ServiceConfig::setMirrors(const QStringList& mirrors)
+{
+    m_mirrors = mirrors;
+}
+
+qint64 ServiceConfig::getArtifactCacheMaxSize() const
+{
+    return m_artifactCacheMaxSize;
+}
+
+void ServiceConfig::setArtifactCacheMaxSize(qint64 bytes)
+{
+    m_artifactCacheMaxSize = bytes;
+}
+
+int ServiceConfig::getDownloadSegments() const
+{
+    return m_downloadSegments;
+}
+
+void ServiceConfig::setDownloadSegments(int segments)
+{
+    m_downloadSegments = segments;
+}
+
+bool ServiceConfig::isResumableDownload() const
+{
+    return m_resumableDownload;
+}
+
+void ServiceConfig::setResumableDownload(bool enabled)
+{
+    m_resumableDownload = enabled;
+}
+
+bool ServiceConfig::isStreamingInstall() const
+{
+    return m_streamingInstall;
+}
+
+void ServiceConfig::setStreamingInstall(bool enabled)
+{
+    m_streamingInstall = enabled;
+}
+
+QString ServiceConfig::getBuildProfile() const
+{
+    return m_buildProfile;
+}
+
+void ServiceConfig::setBuildProfile(const QString& profile)
+{
+    m_buildProfile = profile;
+}
+
+QString ServiceConfig::getBuildAllocator() const
+{
+    return m_buildAllocator;
+}
+
+void ServiceConfig::setBuildAllocator(const QString& allocator)
+{
+    m_buildAllocator = allocator;
+}
+
+bool ServiceConfig::isBenchmarkAfterBuild() const
+{
+    return m_benchmarkAfterBuild;
+}
+
+void ServiceConfig::setBenchmarkAfterBuild(bool enabled)
+{
+    m_benchmarkAfterBuild = enabled;
+}
+
+int ServiceConfig::getBuildJobs() const
+{
+    return m_buildJobs;
+}
+
+void ServiceConfig::setBuildJobs(int jobs)
+{
+    m_buildJobs = jobs;
+}
+
+QString ServiceConfig::getWorkloadProfile() const
+{
+    return m_workloadProfile;
+}
+
+void ServiceConfig::setWorkloadProfile(const QString& profile)
+{
+    m_workloadProfile = profile;
+}
+
+int ServiceConfig::getInstancePortStart() const
+{
+    return m_instancePortStart;
+}
+
+void ServiceConfig::setInstancePortStart(int port)
+{
+    m_instancePortStart = port;
+}
+
+int ServiceConfig::getInstancePortEnd() const
+{
+    return m_instancePortEnd;
+}
+
+void ServiceConfig::setInstancePortEnd(int port)
+{
+    m_instancePortEnd = port;
+}
+
+QString ServiceConfig::getPlacementMode() const
+{
+    return m_placementMode;
+}
+
+void ServiceConfig::setPlacementMode(const QString& mode)
+{
+    m_placementMode = mode;
+}
+
+QString ServiceConfig::getPlacementCpus() const
+{
+    return m_placementCpus;
+}
+
+void ServiceConfig::setPlacementCpus(const QString& cpus)
+{
+    m_placementCpus = cpus;
+}
+
+int ServiceConfig::getPlacementNode() const
+{
+    return m_placementNode;
+}
+
+void ServiceConfig::setPlacementNode(int node)
+{
+    m_placementNode = node;
+}
+
+int ServiceConfig::getMetricsInterval() const
+{
+    return m_metricsInterval;
+}
+
+void ServiceConfig::setMetricsInterval(int ms)
+{
+    m_metricsInterval = ms;
+}
+
+QStringList ServiceConfig::getLatencyCommands() const
+{
+    return m_latencyCommands;
+}
+
+void ServiceConfig::setLatencyCommands(const QStringList& commands)
+{
+    m_latencyCommands = commands;
+}
+
+int ServiceConfig::getLatencyProbeInterval() const
+{
+    return m_latencyProbeInterval;
+}
+
+void ServiceConfig::setLatencyProbeInterval(int ms)
+{
+    m_latencyProbeInterval = ms;
+}
+
+int ServiceConfig::getLatencyConnections() const
+{
+    return m_latencyConnections;
+}
+
+void ServiceConfig::setLatencyConnections(int count)
+{
+    m_latencyConnections = count;
+}
+
+QVariantMap ServiceConfig::getBenchmarkResults(const QString& build) const
+{
+    return m_benchmarkResults.value(build).toMap();
+}
+
+void ServiceConfig::setBenchmarkResults(const QString& build, const QVariantMap& results)
+{
+    m_benchmarkResults.insert(build, results);
+}
+
 void ServiceConfig::save()
 {
     m_settings->beginGroup("Service");
@@ -83,6 +300,52 @@ void ServiceConfig::save()
     m_settings->setValue("AutoStart", m_autoStart);
     m_settings->setValue("Installed", m_serviceInstalled);
     m_settings->endGroup();
+    
+    m_settings->beginGroup("Download");
+    m_settings->setValue("Mirrors", m_mirrors);
+    m_settings->setValue("CacheMaxSize", m_artifactCacheMaxSize);
+    m_settings->setValue("Segments", m_downloadSegments);
+    m_settings->setValue("Resumable", m_resumableDownload);
+    m_settings->setValue("Streaming", m_streamingInstall);
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Build");
+    m_settings->setValue("Profile", m_buildProfile);
+    m_settings->setValue("Allocator", m_buildAllocator);
+    m_settings->setValue("BenchmarkAfterBuild", m_benchmarkAfterBuild);
+    m_settings->setValue("Jobs", m_buildJobs);
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Sizing");
+    m_settings->setValue("Workload", m_workloadProfile);
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Instances");
+    m_settings->setValue("PortRangeStart", m_instancePortStart);
+    m_settings->setValue("PortRangeEnd", m_instancePortEnd);
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Placement");
+    m_settings->setValue("Mode", m_placementMode);
+    m_settings->setValue("Cpus", m_placementCpus);
+    m_settings->setValue("Node", m_placementNode);
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Metrics");
+    m_settings->setValue("IntervalMs", m_metricsInterval);
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Latency");
+    m_settings->setValue("Commands", m_latencyCommands);
+    m_settings->setValue("ProbeIntervalMs", m_latencyProbeInterval);
+    m_settings->setValue("Connections", m_latencyConnections);
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Benchmarks");
+    for (auto it = m_benchmarkResults.constBegin(); it != m_benchmarkResults.constEnd(); ++it) {
+        m_settings->setValue(it.key(), it.value());
+    }
+    m_settings->endGroup();
     m_settings->sync();
 }
 
@@ -95,4 +358,52 @@ void ServiceConfig::load()
     m_autoStart = m_settings->value("AutoStart", true).toBool();
     m_serviceInstalled = m_settings->value("Installed", false).toBool();
     m_settings->endGroup();
+    
+    m_settings->beginGroup("Download");
+    m_mirrors = m_settings->value("Mirrors").toStringList();
+    m_artifactCacheMaxSize = m_settings->value("CacheMaxSize", 2LL * 1024 * 1024 * 1024).toLongLong();
+    m_downloadSegments = m_settings->value("Segments", 4).toInt();
+    m_resumableDownload = m_settings->value("Resumable", true).toBool();
+    m_streamingInstall = m_settings->value("Streaming", false).toBool();
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Build");
+    m_buildProfile = m_settings->value("Profile", "default").toString();
+    m_buildAllocator = m_settings->value("Allocator", "jemalloc").toString();
+    m_benchmarkAfterBuild = m_settings->value("BenchmarkAfterBuild", true).toBool();
+    m_buildJobs = m_settings->value("Jobs", 0).toInt();
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Sizing");
+    m_workloadProfile = m_settings->value("Workload", QString()).toString();
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Instances");
+    m_instancePortStart = m_settings->value("PortRangeStart", 10900).toInt();
+    m_instancePortEnd = m_settings->value("PortRangeEnd", 10999).toInt();
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Placement");
+    m_placementMode = m_settings->value("Mode", "none").toString();
+    m_placementCpus = m_settings->value("Cpus").toString();
+    m_placementNode = m_settings->value("Node", 0).toInt();
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Metrics");
+    m_metricsInterval = m_settings->value("IntervalMs", 1000).toInt();
+    m_settings->endGroup();
+    
+    m_settings->beginGroup("Latency");
+    m_latencyCommands = m_settings->value("Commands", QStringList() << "PING" << "GET __latency_probe__").toStringList();
+    m_latencyProbeInterval = m_settings->value("ProbeIntervalMs", 10).toInt();
+    m_latencyConnections = m_settings->value("Connections", 2).toInt();
+    m_settings->endGroup();
+    
+    m_benchmarkResults.clear();
+    m_settings->beginGroup("Benchmarks");
+    const QStringList builds = m_settings->childKeys();
+    for (const QString& build : builds) {
+        m_benchmarkResults.insert(build, m_settings->value(build).toMap());
+    }
+    m_settings->endGroup();
 }
@@ -3,6 +3,8 @@
 
 #include <QString>
 #include <QSettings>
+#include <QStringList>
+#include <QVariantMap>
 
 class ServiceConfig
 {
@@ -24,6 +26,71 @@ public:
     bool isServiceInstalled() const;
     void setServiceInstalled(bool installed);
     
+    // 安装包镜像列表（http(s):// 或 file:// 目录），按顺序优先于官方地址
+    QStringList getMirrors() const;
+    void setMirrors(const QStringList& mirrors);
+    
+    qint64 getArtifactCacheMaxSize() const;
+    void setArtifactCacheMaxSize(qint64 bytes);
+    
+    // 分段并发下载的连接数（1 为单连接）、断点续传，以及 Linux 上边下载边解压的流式安装
+    int getDownloadSegments() const;
+    void setDownloadSegments(int segments);
+    bool isResumableDownload() const;
+    void setResumableDownload(bool enabled);
+    bool isStreamingInstall() const;
+    void setStreamingInstall(bool enabled);
+    
+    // 源码编译配置：default / lto / native / pgo，分配器 jemalloc / libc
+    QString getBuildProfile() const;
+    void setBuildProfile(const QString& profile);
+    
+    QString getBuildAllocator() const;
+    void setBuildAllocator(const QString& allocator);
+    
+    bool isBenchmarkAfterBuild() const;
+    void setBenchmarkAfterBuild(bool enabled);
+    
+    // 编译的并行任务数，0 表示按在线 CPU 数
+    int getBuildJobs() const;
+    void setBuildJobs(int jobs);
+    
+    // 新建配置文件时按哪种负载推荐内存和持久化参数：cache / durable / queue；
+    // 为空表示用户还没在性能参数里选过，新建的配置沿用默认的 RDB 快照和 256mb 上限
+    QString getWorkloadProfile() const;
+    void setWorkloadProfile(const QString& profile);
+    
+    // 多实例分配端口的范围
+    int getInstancePortStart() const;
+    void setInstancePortStart(int port);
+    int getInstancePortEnd() const;
+    void setInstancePortEnd(int port);
+    
+    // 启动 redis-server 时的 CPU / NUMA 放置：none / pin / node / spread，
+    // pin 使用 CPU 列表（如 "2-5"），node 使用节点编号
+    QString getPlacementMode() const;
+    void setPlacementMode(const QString& mode);
+    QString getPlacementCpus() const;
+    void setPlacementCpus(const QString& cpus);
+    int getPlacementNode() const;
+    void setPlacementNode(int node);
+    
+    // 指标面板采样 INFO 的间隔（毫秒）
+    int getMetricsInterval() const;
+    void setMetricsInterval(int ms);
+    
+    // 延迟探测：轮流发送的命令（每条一个完整命令，如 "GET key"）、发送间隔和专用连接数
+    QStringList getLatencyCommands() const;
+    void setLatencyCommands(const QStringList& commands);
+    int getLatencyProbeInterval() const;
+    void setLatencyProbeInterval(int ms);
+    int getLatencyConnections() const;
+    void setLatencyConnections(int count);
+    
+    // 每种编译配置最近一次的基准测试结果（测试名 → 每秒请求数）
+    QVariantMap getBenchmarkResults(const QString& build) const;
+    void setBenchmarkResults(const QString& build, const QVariantMap& results);
+    
     void save();
     void load();
     
@@ -38,6 +105,26 @@ private:
     QString m_password;
     bool m_autoStart;
     bool m_serviceInstalled;
+    QStringList m_mirrors;
+    qint64 m_artifactCacheMaxSize;
+    int m_downloadSegments;
+    bool m_resumableDownload;
+    bool m_streamingInstall;
+    QString m_buildProfile;
+    QString m_buildAllocator;
+    bool m_benchmarkAfterBuild;
+    int m_buildJobs;
+    QString m_workloadProfile;
+    int m_instancePortStart;
+    int m_instancePortEnd;
+    QString m_placementMode;
+    QString m_placementCpus;
+    int m_placementNode;
+    int m_metricsInterval;
+    QStringList m_latencyCommands;
+    int m_latencyProbeInterval;
+    int m_latencyConnections;
+    QVariantMap m_benchmarkResults;
     
     QSettings* m_settings;
 };
@@ -0,0 +1,116 @@
+#include "sparkline.h"
+#include "metricsampler.h"
+#include <QPainter>
+#include <QPaintEvent>
+
+// 相邻两个采样点之间的水平距离
+static const int kStep = 2;
+// 纵轴上方留出的余量
+static const double kHeadroom = 1.25;
+
+Sparkline::Sparkline(QWidget *parent)
+    : QWidget(parent)
+    , m_series(nullptr)
+    , m_color("#3498db")
+    , m_scale(1)
+    , m_sinceRescale(0)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumHeight(32);
+}
+
+void Sparkline::setSeries(const MetricSeries* series)
+{
+    m_series = series;
+    redrawAll();
+}
+
+QSize Sparkline::sizeHint() const
+{
+    return QSize(300, 40);
+}
+
+int Sparkline::visibleCount() const
+{
+    return width() / kStep + 1;
+}
+
+double Sparkline::yFor(double value) const
+{
+    const int h = m_pixmap.height() - 2;
+    return 1 + h - (value / m_scale) * h;
+}
+
+void Sparkline::redrawAll()
+{
+    if (width() <= 0 || height() <= 0) {
+        return;
+    }
+    if (m_pixmap.size() != size()) {
+        m_pixmap = QPixmap(size());
+    }
+    m_pixmap.fill(palette().color(QPalette::Base));
+    m_sinceRescale = 0;
+    if (!m_series || m_series->isEmpty()) {
+        update();
+        return;
+    }
+
+    const int count = qMin(visibleCount(), m_series->size());
+    double maximum = m_series->maximum(count);
+    m_scale = maximum > 0 ? maximum * kHeadroom : 1;
+
+    QPainter painter(&m_pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(m_color, 1.5));
+    const int first = m_series->size() - count;
+    const int right = m_pixmap.width() - 1;
+    QPolygonF line;
+    line.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        line << QPointF(right - (count - 1 - i) * kStep, yFor(m_series->at(first + i)));
+    }
+    painter.drawPolyline(line);
+    update();
+}
+
+void Sparkline::appendLatest()
+{
+    if (!m_series || m_series->isEmpty()) {
+        return;
+    }
+    double value = m_series->last();
+    // 超出纵轴范围，或最大值已经移出窗口、曲线只占下面一小部分时才重新确定范围
+    bool rescale = m_pixmap.size() != size() || value > m_scale || m_series->size() < 2;
+    if (!rescale && ++m_sinceRescale >= visibleCount()) {
+        rescale = m_series->maximum(visibleCount()) * kHeadroom < m_scale / 2;
+        m_sinceRescale = 0;
+    }
+    if (rescale) {
+        redrawAll();
+        return;
+    }
+
+    const int w = m_pixmap.width();
+    m_pixmap.scroll(-kStep, 0, m_pixmap.rect());
+
+    QPainter painter(&m_pixmap);
+    painter.fillRect(QRect(w - kStep, 0, kStep, m_pixmap.height()), palette().color(QPalette::Base));
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(m_color, 1.5));
+    double previous = m_series->at(m_series->size() - 2);
+    painter.drawLine(QPointF(w - 1 - kStep, yFor(previous)), QPointF(w - 1, yFor(value)));
+    update();
+}
+
+void Sparkline::paintEvent(QPaintEvent* event)
+{
+    QPainter painter(this);
+    painter.drawPixmap(event->rect(), m_pixmap, event->rect());
+}
+
+void Sparkline::resizeEvent(QResizeEvent* event)
+{
+    QWidget::resizeEvent(event);
+    redrawAll();
+}
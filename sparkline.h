@@ -0,0 +1,43 @@
+#ifndef SPARKLINE_H
+#define SPARKLINE_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <QColor>
+
+class MetricSeries;
+
+// 迷你折线图。图像缓存在 QPixmap 中：追加一个值时把已有图像左移一步，只画最新的一段；
+// 只有纵轴范围变化或窗口大小改变时才整体重画
+class Sparkline : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit Sparkline(QWidget *parent = nullptr);
+
+    void setSeries(const MetricSeries* series);
+    void setColor(const QColor& color) { m_color = color; }
+    // series 追加了一个值后调用
+    void appendLatest();
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    void redrawAll();
+    int visibleCount() const;
+    double yFor(double value) const;
+
+private:
+    const MetricSeries* m_series;
+    QPixmap m_pixmap;
+    QColor m_color;
+    double m_scale;
+    int m_sinceRescale;
+};
+
+#endif // SPARKLINE_H
@@ -0,0 +1,242 @@
+#include "testhttpserver.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QCryptographicHash>
+#include <QList>
+
+// 每次写入套接字的块大小，和允许积压在套接字里的数据上限
+static const qint64 kServerChunkSize = 64 * 1024;
+static const qint64 kServerMaxPending = 256 * 1024;
+// 限速时的检查间隔
+static const int kThrottleTickMs = 5;
+
+struct TestHttpServer::Connection
+{
+    QTcpSocket* socket = nullptr;
+    QTimer* throttleTimer = nullptr;
+    QElapsedTimer clock;
+    QByteArray request;
+    QByteArray chunk;
+    qint64 position = 0;
+    qint64 end = 0;        // 不包含
+    qint64 sent = 0;
+    qint64 dropAt = 0;
+    bool responding = false;
+};
+
+TestHttpServer::TestHttpServer(qint64 contentSize, QObject *parent)
+    : QObject(parent)
+    , m_contentSize(contentSize)
+    , m_bytesPerSecond(0)
+    , m_dropAfter(0)
+    , m_rangesSupported(true)
+    , m_getRequests(0)
+    , m_rangeRequests(0)
+{
+    m_server = new QTcpServer(this);
+    connect(m_server, &QTcpServer::newConnection, this, &TestHttpServer::onNewConnection);
+}
+
+bool TestHttpServer::listen()
+{
+    return m_server->listen(QHostAddress::LocalHost, 0);
+}
+
+QUrl TestHttpServer::url() const
+{
+    return QUrl(QString("http://127.0.0.1:%1/redis-test.tar.gz").arg(m_server->serverPort()));
+}
+
+void TestHttpServer::fill(char* dest, qint64 offset, qint64 length)
+{
+    // splitmix64，按 8 字节一组生成，任意偏移都能直接算出
+    for (qint64 i = 0; i < length; ++i) {
+        quint64 word = quint64((offset + i) >> 3) + 0x9E3779B97F4A7C15ULL;
+        word = (word ^ (word >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        word = (word ^ (word >> 27)) * 0x94D049BB133111EBULL;
+        word ^= word >> 31;
+        dest[i] = char(word >> (((offset + i) & 7) * 8));
+    }
+}
+
+QByteArray TestHttpServer::contentSha256() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    QByteArray chunk(1024 * 1024, Qt::Uninitialized);
+    for (qint64 offset = 0; offset < m_contentSize; offset += chunk.size()) {
+        qint64 n = qMin<qint64>(chunk.size(), m_contentSize - offset);
+        fill(chunk.data(), offset, n);
+        hash.addData(QByteArrayView(chunk.constData(), n));
+    }
+    return hash.result().toHex();
+}
+
+bool TestHttpServer::matchesFile(const QString& path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() != m_contentSize) {
+        return false;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return false;
+    }
+    return hash.result().toHex() == contentSha256();
+}
+
+void TestHttpServer::onNewConnection()
+{
+    while (QTcpSocket* socket = m_server->nextPendingConnection()) {
+        Connection* connection = new Connection;
+        connection->socket = socket;
+        connection->throttleTimer = new QTimer(socket);
+        connection->throttleTimer->setSingleShot(true);
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, connection]() {
+            onReadyRead(connection);
+        });
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, connection]() {
+            pump(connection);
+        });
+        connect(connection->throttleTimer, &QTimer::timeout, this, [this, connection]() {
+            pump(connection);
+        });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QObject::destroyed, [connection]() {
+            delete connection;
+        });
+    }
+}
+
+void TestHttpServer::onReadyRead(Connection* connection)
+{
+    connection->request += connection->socket->readAll();
+    if (connection->responding) {
+        return;
+    }
+    int headerEnd = connection->request.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+
+    const QList<QByteArray> lines = connection->request.left(headerEnd).split('\n');
+    QByteArray method = lines.value(0).split(' ').value(0).trimmed();
+    QByteArray range;
+    for (const QByteArray& line : lines) {
+        int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "range") {
+            range = line.mid(colon + 1).trimmed();
+        }
+    }
+    connection->responding = true;
+    respond(connection, method, range);
+}
+
+void TestHttpServer::respond(Connection* connection, const QByteArray& method, const QByteArray& range)
+{
+    qint64 start = 0;
+    qint64 last = m_contentSize - 1;
+    bool partial = false;
+
+    if (method == "GET") {
+        ++m_getRequests;
+    }
+    if (!range.isEmpty() && method == "GET") {
+        ++m_rangeRequests;
+    }
+
+    // Range: bytes=<start>-[<end>]
+    if (m_rangesSupported && range.startsWith("bytes=")) {
+        QByteArray spec = range.mid(6);
+        int dash = spec.indexOf('-');
+        bool ok = dash > 0;
+        qint64 from = ok ? spec.left(dash).toLongLong(&ok) : 0;
+        if (ok) {
+            if (from >= m_contentSize) {
+                connection->socket->write("HTTP/1.1 416 Range Not Satisfiable\r\n"
+                                          "Content-Range: bytes */" + QByteArray::number(m_contentSize) + "\r\n"
+                                          "Content-Length: 0\r\nConnection: close\r\n\r\n");
+                connection->socket->disconnectFromHost();
+                return;
+            }
+            QByteArray to = spec.mid(dash + 1).trimmed();
+            start = from;
+            last = to.isEmpty() ? m_contentSize - 1 : qMin(to.toLongLong(), m_contentSize - 1);
+            partial = true;
+        }
+    }
+
+    QByteArray header = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+    header += "Content-Type: application/octet-stream\r\n";
+    header += "Content-Length: " + QByteArray::number(last - start + 1) + "\r\n";
+    if (partial) {
+        header += "Content-Range: bytes " + QByteArray::number(start) + "-" + QByteArray::number(last)
+                  + "/" + QByteArray::number(m_contentSize) + "\r\n";
+    }
+    header += m_rangesSupported ? "Accept-Ranges: bytes\r\n" : "Accept-Ranges: none\r\n";
+    header += "ETag: \"test-content\"\r\n";
+    header += "Last-Modified: Sat, 01 Jan 2000 00:00:00 GMT\r\n";
+    header += "Connection: close\r\n\r\n";
+    connection->socket->write(header);
+
+    if (method != "GET") {
+        connection->socket->disconnectFromHost();
+        return;
+    }
+
+    connection->position = start;
+    connection->end = last + 1;
+    connection->chunk.resize(kServerChunkSize);
+    if (m_dropAfter > 0) {
+        connection->dropAt = m_dropAfter;
+        m_dropAfter = 0;
+    }
+    connection->clock.start();
+    pump(connection);
+}
+
+void TestHttpServer::pump(Connection* connection)
+{
+    QTcpSocket* socket = connection->socket;
+    if (!connection->responding || socket->state() != QAbstractSocket::ConnectedState) {
+        return;
+    }
+
+    while (connection->position < connection->end && socket->bytesToWrite() < kServerMaxPending) {
+        qint64 n = qMin<qint64>(kServerChunkSize, connection->end - connection->position);
+        if (m_bytesPerSecond > 0) {
+            qint64 allowed = connection->clock.elapsed() * m_bytesPerSecond / 1000 - connection->sent;
+            if (allowed <= 0) {
+                if (!connection->throttleTimer->isActive()) {
+                    connection->throttleTimer->start(kThrottleTickMs);
+                }
+                return;
+            }
+            n = qMin(n, allowed);
+        }
+        if (connection->dropAt > 0) {
+            n = qMin(n, connection->dropAt - connection->sent);
+        }
+
+        fill(connection->chunk.data(), connection->position, n);
+        socket->write(connection->chunk.constData(), n);
+        connection->position += n;
+        connection->sent += n;
+
+        if (connection->dropAt > 0 && connection->sent >= connection->dropAt) {
+            // 比 Content-Length 少发，客户端看到的是连接中途被关闭
+            connection->responding = false;
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+
+    if (connection->position >= connection->end) {
+        connection->responding = false;
+        socket->disconnectFromHost();
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef TESTHTTPSERVER_H
+#define TESTHTTPSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QUrl>
+
+class QTcpServer;
+class QTcpSocket;
+
+// 测试用的本地 HTTP 服务器，代替真实的下载站点：
+// 内容按偏移现场生成，不占内存，可以提供任意大的文件；支持 GET / HEAD / Range，
+// 可以按连接限速、关闭 Range 支持，或在发送一定字节后断开连接模拟网络中断。
+// 每个请求一个连接（Connection: close）。
+class TestHttpServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TestHttpServer(qint64 contentSize, QObject *parent = nullptr);
+
+    bool listen();
+    QUrl url() const;
+
+    qint64 contentSize() const { return m_contentSize; }
+    void setRangesSupported(bool enabled) { m_rangesSupported = enabled; }
+    // 每个连接每秒最多发送的字节数，0 为不限速
+    void setBytesPerSecond(qint64 rate) { m_bytesPerSecond = rate; }
+    // 下一个 GET 响应发出这么多字节后断开连接，0 为不断开
+    void setDropAfter(qint64 bytes) { m_dropAfter = bytes; }
+
+    int getRequests() const { return m_getRequests; }
+    int rangeRequests() const { return m_rangeRequests; }
+
+    // 内容中 [offset, offset + length) 的字节
+    static void fill(char* dest, qint64 offset, qint64 length);
+    // 整个内容的 SHA-256（十六进制）
+    QByteArray contentSha256() const;
+    // 文件内容与服务器提供的内容一致
+    bool matchesFile(const QString& path) const;
+
+private:
+    struct Connection;
+
+    void onNewConnection();
+    void onReadyRead(Connection* connection);
+    void respond(Connection* connection, const QByteArray& method, const QByteArray& range);
+    void pump(Connection* connection);
+
+private:
+    QTcpServer* m_server;
+    qint64 m_contentSize;
+    qint64 m_bytesPerSecond;
+    qint64 m_dropAfter;
+    bool m_rangesSupported;
+    int m_getRequests;
+    int m_rangeRequests;
+};
+
+#endif // TESTHTTPSERVER_H
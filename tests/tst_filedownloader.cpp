@@ -0,0 +1,156 @@
+#include "filedownloader.h"
+#include "testhttpserver.h"
+#include <QtTest>
+#include <QNetworkAccessManager>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+// 大文件下载：内存占用不随文件大小增长，内容完整，完成前目标文件不出现或保持旧内容
+static const qint64 kLargeFileSize = 256LL * 1024 * 1024;
+// 下载期间允许增加的峰值 RSS
+static const qint64 kMaxRssGrowth = 48LL * 1024 * 1024;
+static const int kDownloadTimeoutMs = 120000;
+static const char kOldContent[] = "old archive";
+
+// 进程的峰值 RSS（字节），不支持时返回 -1
+static qint64 peakRss()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#ifdef Q_OS_MACOS
+    return qint64(usage.ru_maxrss);
+#else
+    return qint64(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return -1;
+#endif
+}
+
+class TestFileDownloader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void largeFileStreamsToDisk();
+    void resumesAfterDroppedConnection();
+    void restartsWhenRangesUnsupported();
+
+private:
+    bool download(FileDownloader& downloader, const QUrl& url, const QString& destPath);
+};
+
+bool TestFileDownloader::download(FileDownloader& downloader, const QUrl& url, const QString& destPath)
+{
+    QSignalSpy finished(&downloader, &FileDownloader::finished);
+    downloader.start(url, destPath);
+    if (!finished.wait(kDownloadTimeoutMs)) {
+        qWarning() << "download timed out";
+        return false;
+    }
+    if (!finished.first().first().toBool()) {
+        qWarning() << "download failed:" << downloader.getLastError();
+        return false;
+    }
+    return true;
+}
+
+void TestFileDownloader::largeFileStreamsToDisk()
+{
+    TestHttpServer server(kLargeFileSize);
+    QVERIFY(server.listen());
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString destPath = dir.filePath("redis.tar.gz");
+
+    // 目标位置已有旧文件：下载期间必须保持原样，完成时一次替换
+    {
+        QFile old(destPath);
+        QVERIFY(old.open(QIODevice::WriteOnly));
+        old.write(kOldContent);
+    }
+
+    QNetworkAccessManager manager;
+    FileDownloader downloader(&manager);
+    downloader.setResumable(true);
+
+    bool replacedEarly = false;
+    connect(&downloader, &FileDownloader::progress, this, [&](qint64 received, qint64 total) {
+        if (received < total && QFileInfo(destPath).size() != qint64(qstrlen(kOldContent))) {
+            replacedEarly = true;
+        }
+    });
+
+    const qint64 rssBefore = peakRss();
+    QVERIFY(download(downloader, server.url(), destPath));
+    const qint64 rssAfter = peakRss();
+
+    QVERIFY(!replacedEarly);
+    QVERIFY(!QFile::exists(destPath + ".part"));
+    QVERIFY(!QFile::exists(destPath + ".part.meta"));
+    QVERIFY(server.matchesFile(destPath));
+    QCOMPARE(server.getRequests(), 1);
+
+    if (rssBefore < 0) {
+        QSKIP("peak RSS is not available on this platform");
+    }
+    qInfo() << "peak RSS grew by" << (rssAfter - rssBefore) / 1024 << "KiB for a"
+            << kLargeFileSize / (1024 * 1024) << "MiB download";
+    QVERIFY2(rssAfter - rssBefore < kMaxRssGrowth,
+             qPrintable(QString("peak RSS grew by %1 MiB").arg((rssAfter - rssBefore) / (1024 * 1024))));
+}
+
+void TestFileDownloader::resumesAfterDroppedConnection()
+{
+    TestHttpServer server(16 * 1024 * 1024);
+    server.setDropAfter(5 * 1024 * 1024 + 123);
+    QVERIFY(server.listen());
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString destPath = dir.filePath("redis.tar.gz");
+
+    QNetworkAccessManager manager;
+    FileDownloader downloader(&manager);
+    downloader.setResumable(true);
+
+    QVERIFY(download(downloader, server.url(), destPath));
+    // 第二次请求带 Range，从断点继续而不是重新下载
+    QCOMPARE(server.getRequests(), 2);
+    QCOMPARE(server.rangeRequests(), 1);
+    QVERIFY(!QFile::exists(destPath + ".part"));
+    QVERIFY(server.matchesFile(destPath));
+}
+
+void TestFileDownloader::restartsWhenRangesUnsupported()
+{
+    TestHttpServer server(16 * 1024 * 1024);
+    server.setRangesSupported(false);
+    server.setDropAfter(3 * 1024 * 1024);
+    QVERIFY(server.listen());
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString destPath = dir.filePath("redis.tar.gz");
+
+    QNetworkAccessManager manager;
+    FileDownloader downloader(&manager);
+    downloader.setResumable(true);
+
+    // 服务器忽略 Range 返回 200，部分文件必须丢弃，不能把完整内容接在断点后面
+    QVERIFY(download(downloader, server.url(), destPath));
+    QCOMPARE(server.getRequests(), 2);
+    QVERIFY(server.matchesFile(destPath));
+}
+
+QTEST_GUILESS_MAIN(TestFileDownloader)
+#include "tst_filedownloader.moc"
@@ -0,0 +1,128 @@
+#include "segmenteddownloader.h"
+#include "filedownloader.h"
+#include "testhttpserver.h"
+#include <QtTest>
+#include <QNetworkAccessManager>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
+// 分段下载对比单连接下载：服务器对每个连接单独限速，模拟单条 TCP 连接跑不满带宽的线路
+static const qint64 kBenchFileSize = 24LL * 1024 * 1024;
+static const qint64 kPerConnectionRate = 4LL * 1024 * 1024;
+static const int kDownloadTimeoutMs = 60000;
+// 4 段至少要比单连接快这么多（理想情况下耗时约为 1/4）
+static const double kMinSpeedup = 2.0;
+
+class TestSegmentedDownloader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void segmentedBeatsSingleStream();
+    void fallsBackWithoutRanges();
+
+private:
+    // 返回耗时（毫秒），失败返回 -1
+    qint64 downloadSingle(TestHttpServer& server, const QString& destPath);
+    qint64 downloadSegmented(TestHttpServer& server, int segments, const QString& destPath);
+};
+
+qint64 TestSegmentedDownloader::downloadSingle(TestHttpServer& server, const QString& destPath)
+{
+    QNetworkAccessManager manager;
+    FileDownloader downloader(&manager);
+    downloader.setResumable(false);
+
+    QSignalSpy finished(&downloader, &FileDownloader::finished);
+    QElapsedTimer clock;
+    clock.start();
+    downloader.start(server.url(), destPath);
+    if (!finished.wait(kDownloadTimeoutMs) || !finished.first().first().toBool()) {
+        qWarning() << "single-stream download failed:" << downloader.getLastError();
+        return -1;
+    }
+    return clock.elapsed();
+}
+
+qint64 TestSegmentedDownloader::downloadSegmented(TestHttpServer& server, int segments, const QString& destPath)
+{
+    QNetworkAccessManager manager;
+    SegmentedDownloader downloader(&manager);
+    downloader.setSegmentCount(segments);
+    downloader.setResumable(false);
+
+    QSignalSpy finished(&downloader, &SegmentedDownloader::finished);
+    QSignalSpy unsupported(&downloader, &SegmentedDownloader::rangesUnsupported);
+    QElapsedTimer clock;
+    clock.start();
+    downloader.start(server.url(), destPath);
+    if (!finished.wait(kDownloadTimeoutMs) || !finished.first().first().toBool() || !unsupported.isEmpty()) {
+        qWarning() << "segmented download failed:" << downloader.getLastError();
+        return -1;
+    }
+    return clock.elapsed();
+}
+
+void TestSegmentedDownloader::segmentedBeatsSingleStream()
+{
+    TestHttpServer server(kBenchFileSize);
+    server.setBytesPerSecond(kPerConnectionRate);
+    QVERIFY(server.listen());
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const double sizeMiB = double(kBenchFileSize) / (1024 * 1024);
+    auto report = [sizeMiB](const QString& name, qint64 elapsedMs) {
+        qInfo().noquote() << QString("%1 %2 ms, %3 MiB/s")
+                             .arg(name.leftJustified(12))
+                             .arg(elapsedMs)
+                             .arg(sizeMiB * 1000.0 / qMax<qint64>(1, elapsedMs), 0, 'f', 1);
+    };
+
+    const QString singlePath = dir.filePath("single.tar.gz");
+    qint64 single = downloadSingle(server, singlePath);
+    QVERIFY(single > 0);
+    QVERIFY(server.matchesFile(singlePath));
+    report("1 stream", single);
+
+    qint64 fourSegments = 0;
+    const int counts[] = { 2, 4 };
+    for (int segments : counts) {
+        const QString path = dir.filePath(QString("segmented-%1.tar.gz").arg(segments));
+        qint64 elapsed = downloadSegmented(server, segments, path);
+        QVERIFY(elapsed > 0);
+        QVERIFY(server.matchesFile(path));
+        QVERIFY(!QFile::exists(path + ".part"));
+        report(QString("%1 segments").arg(segments), elapsed);
+        if (segments == 4) {
+            fourSegments = elapsed;
+        }
+    }
+
+    QVERIFY2(single >= fourSegments * kMinSpeedup,
+             qPrintable(QString("4 segments took %1 ms, single stream %2 ms").arg(fourSegments).arg(single)));
+}
+
+void TestSegmentedDownloader::fallsBackWithoutRanges()
+{
+    TestHttpServer server(4 * 1024 * 1024);
+    server.setRangesSupported(false);
+    QVERIFY(server.listen());
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    QNetworkAccessManager manager;
+    SegmentedDownloader downloader(&manager);
+    downloader.setSegmentCount(4);
+
+    // 只发 HEAD 探测，不发任何 GET，由调用方退回单连接下载
+    QSignalSpy unsupported(&downloader, &SegmentedDownloader::rangesUnsupported);
+    downloader.start(server.url(), dir.filePath("redis.tar.gz"));
+    QVERIFY(unsupported.wait(kDownloadTimeoutMs));
+    QCOMPARE(server.getRequests(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestSegmentedDownloader)
+#include "tst_segmenteddownloader.moc"
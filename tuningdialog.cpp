@@ -0,0 +1,256 @@
+#include "tuningdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QTabWidget>
+#include <QScrollArea>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QLineEdit>
+#include <QLabel>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QMessageBox>
+#include <climits>
+
+// 在主窗口中单独设置的参数
+static const QStringList kExcludedKeys = QStringList() << "bind" << "port" << "requirepass" << "protected-mode";
+
+TuningDialog::TuningDialog(const RedisConfig& config, const QString& version, const HostResources& host,
+                           const QString& workload, QWidget *parent)
+    : QDialog(parent)
+    , m_version(version)
+    , m_host(host)
+    , m_workloadChosen(!workload.isEmpty())
+{
+    setWindowTitle("性能参数");
+    setMinimumSize(640, 520);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QLabel* hintLabel = new QLabel(version.isEmpty()
+                                       ? QString("修改后点击确定；运行中的 Redis 会立即应用可热更新的参数。")
+                                       : QString("Redis %1。修改后点击确定；运行中的 Redis 会立即应用可热更新的参数。").arg(version));
+    hintLabel->setWordWrap(true);
+    mainLayout->addWidget(hintLabel);
+
+    QWidget* sizingWidget = new QWidget();
+    QHBoxLayout* sizingLayout = new QHBoxLayout(sizingWidget);
+    sizingLayout->setContentsMargins(0, 0, 0, 0);
+
+    m_workloadCombo = new QComboBox();
+    const QList<ResourceSizer::Workload> workloads = QList<ResourceSizer::Workload>()
+        << ResourceSizer::CacheWorkload << ResourceSizer::DurableWorkload << ResourceSizer::QueueWorkload;
+    for (ResourceSizer::Workload item : workloads) {
+        m_workloadCombo->addItem(ResourceSizer::workloadDescription(item), ResourceSizer::workloadName(item));
+    }
+    // 还没选过时默认显示持久存储，但只有用户动过选择才会记住
+    m_workloadCombo->setCurrentIndex(qMax(0, m_workloadCombo->findData(
+        workload.isEmpty() ? ResourceSizer::workloadName(ResourceSizer::DurableWorkload) : workload)));
+    connect(m_workloadCombo, QOverload<int>::of(&QComboBox::activated), this, [this]() {
+        m_workloadChosen = true;
+    });
+
+    QPushButton* recommendButton = new QPushButton("按本机资源推荐");
+    connect(recommendButton, &QPushButton::clicked, this, &TuningDialog::onRecommend);
+
+    sizingLayout->addWidget(new QLabel("负载类型:"));
+    sizingLayout->addWidget(m_workloadCombo, 1);
+    sizingLayout->addWidget(recommendButton);
+    mainLayout->addWidget(sizingWidget);
+
+    m_sizingLabel = new QLabel(QString("本机：内存 %1%2，%3 个 CPU，数据目录可用 %4")
+                                   .arg(ResourceSizer::formatBytes(host.memoryBudget()))
+                                   .arg(host.cgroupMemoryLimit > 0 ? QString("（cgroup 限制）") : QString())
+                                   .arg(host.cpuCount)
+                                   .arg(host.diskFree >= 0 ? ResourceSizer::formatBytes(host.diskFree) : QString("未知")));
+    m_sizingLabel->setObjectName("hintLabel");
+    m_sizingLabel->setWordWrap(true);
+    mainLayout->addWidget(m_sizingLabel);
+
+    QTabWidget* tabs = new QTabWidget();
+    QMap<QString, QFormLayout*> forms;
+
+    for (const ConfigParameter& parameter : RedisConfigSchema::forVersion(version)) {
+        if (kExcludedKeys.contains(parameter.name)) {
+            continue;
+        }
+
+        QFormLayout* form = forms.value(parameter.category);
+        if (!form) {
+            QWidget* page = new QWidget();
+            form = new QFormLayout(page);
+            QScrollArea* scroll = new QScrollArea();
+            scroll->setWidget(page);
+            scroll->setWidgetResizable(true);
+            tabs->addTab(scroll, parameter.category);
+            forms.insert(parameter.category, form);
+        }
+
+        // 配置文件里可能是旧名称（ziplist）或新名称（listpack）
+        QString name = RedisConfigSchema::nameForVersion(parameter, version);
+        QString value;
+        if (parameter.name == "save" && config.contains("save")) {
+            value = config.values("save").join(' ');
+        } else if (config.contains(name)) {
+            value = config.value(name);
+        } else if (config.contains(parameter.name)) {
+            value = config.value(parameter.name);
+        } else {
+            value = RedisConfigSchema::defaultValue(parameter, version);
+        }
+
+        QWidget* editor = createEditor(parameter, value);
+        QString tooltip = parameter.description + "\n默认值: "
+                          + RedisConfigSchema::defaultValue(parameter, version)
+                          + (parameter.runtime ? QString() : QString("\n修改后需要重启 Redis"));
+        editor->setToolTip(tooltip);
+
+        QLabel* label = new QLabel(parameter.runtime ? name : name + " *");
+        label->setToolTip(tooltip);
+        form->addRow(label, editor);
+
+        m_parameters << parameter;
+        m_editors.insert(parameter.name, editor);
+        m_initialValues.insert(parameter.name, editorValue(parameter, editor));
+    }
+
+    mainLayout->addWidget(tabs);
+
+    QLabel* restartLabel = new QLabel("* 需要重启 Redis 才能生效");
+    restartLabel->setObjectName("hintLabel");
+    mainLayout->addWidget(restartLabel);
+
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    QPushButton* resetButton = buttons->addButton("恢复默认值", QDialogButtonBox::ResetRole);
+    connect(buttons, &QDialogButtonBox::accepted, this, &TuningDialog::onAccept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    connect(resetButton, &QPushButton::clicked, this, &TuningDialog::onResetDefaults);
+    mainLayout->addWidget(buttons);
+}
+
+QWidget* TuningDialog::createEditor(const ConfigParameter& parameter, const QString& value)
+{
+    QWidget* editor = nullptr;
+    switch (parameter.type) {
+    case ConfigParameter::Bool:
+        editor = new QCheckBox();
+        break;
+    case ConfigParameter::Enum: {
+        QComboBox* combo = new QComboBox();
+        combo->addItems(parameter.choices);
+        editor = combo;
+        break;
+    }
+    case ConfigParameter::Integer: {
+        QSpinBox* spin = new QSpinBox();
+        spin->setRange(int(qMax<qint64>(parameter.minimum, INT_MIN)),
+                       int(qMin<qint64>(parameter.maximum, INT_MAX)));
+        editor = spin;
+        break;
+    }
+    case ConfigParameter::Memory:
+    case ConfigParameter::String:
+        editor = new QLineEdit();
+        break;
+    }
+
+    setEditorValue(parameter, editor, value);
+    return editor;
+}
+
+void TuningDialog::setEditorValue(const ConfigParameter& parameter, QWidget* editor, const QString& value)
+{
+    switch (parameter.type) {
+    case ConfigParameter::Bool:
+        static_cast<QCheckBox*>(editor)->setChecked(value.trimmed().toLower() == "yes");
+        break;
+    case ConfigParameter::Enum: {
+        QComboBox* combo = static_cast<QComboBox*>(editor);
+        combo->setCurrentIndex(qMax(0, combo->findText(value.trimmed().toLower())));
+        break;
+    }
+    case ConfigParameter::Integer:
+        static_cast<QSpinBox*>(editor)->setValue(value.trimmed().toInt());
+        break;
+    case ConfigParameter::Memory:
+    case ConfigParameter::String:
+        static_cast<QLineEdit*>(editor)->setText(value);
+        break;
+    }
+}
+
+QString TuningDialog::editorValue(const ConfigParameter& parameter, QWidget* editor) const
+{
+    switch (parameter.type) {
+    case ConfigParameter::Bool:
+        return static_cast<QCheckBox*>(editor)->isChecked() ? "yes" : "no";
+    case ConfigParameter::Enum:
+        return static_cast<QComboBox*>(editor)->currentText();
+    case ConfigParameter::Integer:
+        return QString::number(static_cast<QSpinBox*>(editor)->value());
+    case ConfigParameter::Memory:
+    case ConfigParameter::String:
+        return static_cast<QLineEdit*>(editor)->text().trimmed();
+    }
+    return QString();
+}
+
+QMap<QString, QString> TuningDialog::changedValues() const
+{
+    QMap<QString, QString> changed;
+    for (const ConfigParameter& parameter : m_parameters) {
+        QString value = editorValue(parameter, m_editors.value(parameter.name));
+        if (RedisConfigSchema::normalize(value) != RedisConfigSchema::normalize(m_initialValues.value(parameter.name))) {
+            changed.insert(RedisConfigSchema::nameForVersion(parameter, m_version), value);
+        }
+    }
+    return changed;
+}
+
+void TuningDialog::onAccept()
+{
+    QStringList errors;
+    const QMap<QString, QString> changed = changedValues();
+    for (auto it = changed.constBegin(); it != changed.constEnd(); ++it) {
+        QString error;
+        if (!RedisConfigSchema::validate(it.key(), it.value(), &error)) {
+            errors << error;
+        }
+    }
+
+    if (!errors.isEmpty()) {
+        QMessageBox::warning(this, "参数无效", errors.join("\n"));
+        return;
+    }
+    accept();
+}
+
+void TuningDialog::onResetDefaults()
+{
+    for (const ConfigParameter& parameter : m_parameters) {
+        setEditorValue(parameter, m_editors.value(parameter.name),
+                       RedisConfigSchema::defaultValue(parameter, m_version));
+    }
+}
+
+QString TuningDialog::workload() const
+{
+    return m_workloadChosen ? m_workloadCombo->currentData().toString() : QString();
+}
+
+void TuningDialog::onRecommend()
+{
+    m_workloadChosen = true;
+    ResourceSizer::Proposal proposal =
+        ResourceSizer::propose(m_host, ResourceSizer::workloadFromName(workload()), m_version);
+
+    for (const ConfigParameter& parameter : m_parameters) {
+        if (proposal.values.contains(parameter.name)) {
+            setEditorValue(parameter, m_editors.value(parameter.name), proposal.values.value(parameter.name));
+        }
+    }
+    m_sizingLabel->setText("推荐 maxmemory " + ResourceSizer::formatBytes(proposal.maxmemory) + "：\n"
+                           + proposal.notes.join("\n"));
+}
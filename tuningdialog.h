@@ -0,0 +1,51 @@
+#ifndef TUNINGDIALOG_H
+#define TUNINGDIALOG_H
+
+#include <QDialog>
+#include <QMap>
+#include <QString>
+#include <QList>
+#include "redisconfig.h"
+#include "resourcesizer.h"
+
+class QComboBox;
+class QLabel;
+
+// 按 RedisConfigSchema 生成的性能参数编辑界面，每个分类一页；
+// 只列出当前 Redis 版本支持的参数，未在配置文件中出现的显示该版本的默认值。
+// 顶部可按负载类型和本机资源一键填入推荐的内存与持久化参数
+class TuningDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    TuningDialog(const RedisConfig& config, const QString& version, const HostResources& host,
+                 const QString& workload, QWidget *parent = nullptr);
+
+    // 与打开时相比修改过的参数，键为该版本使用的参数名
+    QMap<QString, QString> changedValues() const;
+    // 当前选择的负载类型（cache / durable / queue）；用户没有动过选择时为空
+    QString workload() const;
+
+private slots:
+    void onAccept();
+    void onResetDefaults();
+    void onRecommend();
+
+private:
+    QWidget* createEditor(const ConfigParameter& parameter, const QString& value);
+    void setEditorValue(const ConfigParameter& parameter, QWidget* editor, const QString& value);
+    QString editorValue(const ConfigParameter& parameter, QWidget* editor) const;
+
+private:
+    QString m_version;
+    HostResources m_host;
+    QComboBox* m_workloadCombo;
+    bool m_workloadChosen;
+    QLabel* m_sizingLabel;
+    QList<ConfigParameter> m_parameters;
+    QMap<QString, QWidget*> m_editors;
+    QMap<QString, QString> m_initialValues;
+};
+
+#endif // TUNINGDIALOG_H
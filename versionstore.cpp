@@ -0,0 +1,340 @@
+#include "versionstore.h"
+#include "artifactcache.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+#include <memory>
+
+#ifndef Q_OS_WIN
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+VersionStore::VersionStore(const QString& root, QObject *parent)
+    : QObject(parent)
+    , m_root(root)
+{
+}
+
+bool VersionStore::isVersionName(const QString& name)
+{
+    static const QRegularExpression versionRe("^\\d+(\\.\\d+)*$");
+    return versionRe.match(name).hasMatch();
+}
+
+int VersionStore::compareVersions(const QString& a, const QString& b)
+{
+    const QStringList pa = a.split('.');
+    const QStringList pb = b.split('.');
+    for (int i = 0; i < qMax(pa.size(), pb.size()); ++i) {
+        int va = i < pa.size() ? pa.at(i).toInt() : 0;
+        int vb = i < pb.size() ? pb.at(i).toInt() : 0;
+        if (va != vb) {
+            return va < vb ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+QStringList VersionStore::versions() const
+{
+    return versionsIn(m_root);
+}
+
+QStringList VersionStore::versionsIn(const QString& root)
+{
+    QStringList result;
+    const QStringList entries = QDir(root).entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    for (const QString& entry : entries) {
+        if (isVersionName(entry)) {
+            result << entry;
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const QString& a, const QString& b) {
+        return compareVersions(a, b) < 0;
+    });
+    return result;
+}
+
+bool VersionStore::contains(const QString& version) const
+{
+    return isVersionName(version) && QFileInfo(versionPath(version)).isDir();
+}
+
+QString VersionStore::versionPath(const QString& version) const
+{
+    return m_root + "/" + version;
+}
+
+QString VersionStore::activeVersion() const
+{
+#ifdef Q_OS_WIN
+    QFile file(m_root + "/current.txt");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    QString version = QString::fromUtf8(file.readAll()).trimmed();
+#else
+    QString version = QFileInfo(QFileInfo(m_root + "/current").symLinkTarget()).fileName();
+#endif
+    return contains(version) ? version : QString();
+}
+
+QString VersionStore::activeDir() const
+{
+    QString version = activeVersion();
+    if (version.isEmpty()) {
+        return QString();
+    }
+#ifdef Q_OS_WIN
+    return versionPath(version);
+#else
+    // 经由 current 链接访问，切换版本后新启动的进程自动使用新版本
+    return m_root + "/current";
+#endif
+}
+
+bool VersionStore::activate(const QString& version)
+{
+    if (!contains(version)) {
+        m_lastError = "版本不存在: " + version;
+        return false;
+    }
+
+#ifdef Q_OS_WIN
+    QSaveFile file(m_root + "/current.txt");
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_lastError = "无法写入当前版本记录";
+        return false;
+    }
+    file.write(version.toUtf8());
+    if (!file.commit()) {
+        m_lastError = "无法写入当前版本记录";
+        return false;
+    }
+#else
+    // 先建临时链接再 rename 覆盖，任何时刻 current 都指向一个完整的版本
+    QByteArray tmpLink = QFile::encodeName(m_root + "/current.tmp");
+    QByteArray link = QFile::encodeName(m_root + "/current");
+    ::unlink(tmpLink.constData());
+    if (::symlink(QFile::encodeName(version).constData(), tmpLink.constData()) != 0
+        || ::rename(tmpLink.constData(), link.constData()) != 0) {
+        ::unlink(tmpLink.constData());
+        m_lastError = "无法切换当前版本";
+        return false;
+    }
+#endif
+
+    qDebug() << "[VersionStore] Active version:" << version;
+    return true;
+}
+
+QString VersionStore::createStagingDir()
+{
+    QString path = m_root + "/.staging-" + QString::number(QDateTime::currentMSecsSinceEpoch());
+    QDir().mkpath(path);
+    return path;
+}
+
+QString VersionStore::detectVersion(const QString& binaryDir)
+{
+#ifdef Q_OS_WIN
+    QString redisExe = binaryDir + "/redis-server.exe";
+#else
+    QString redisExe = binaryDir + "/redis-server";
+#endif
+
+    QProcess process;
+    process.start(redisExe, QStringList() << "--version");
+    if (!process.waitForFinished(3000)) {
+        process.kill();
+        return QString();
+    }
+    return parseVersion(process.readAllStandardOutput());
+}
+
+QString VersionStore::parseVersion(const QByteArray& output)
+{
+    // 输出形如 "Redis server v=7.2.4 sha=00000000:0 malloc=jemalloc-5.3.0 bits=64 build=..."
+    static const QRegularExpression versionRe("v=(\\d+(?:\\.\\d+)*)");
+    QRegularExpressionMatch match = versionRe.match(QString::fromLocal8Bit(output));
+    return match.hasMatch() ? match.captured(1) : QString();
+}
+
+void VersionStore::commitAsync(const QString& stagingDir, const QString& version)
+{
+    QString root = m_root;
+    auto error = std::make_shared<QString>();
+    auto ok = std::make_shared<bool>(false);
+    QThread* thread = QThread::create([root, stagingDir, version, error, ok]() {
+        *ok = commitDir(root, stagingDir, version, error.get());
+        if (!*ok) {
+            QDir(stagingDir).removeRecursively();
+        }
+    });
+    connect(thread, &QThread::finished, this, [this, stagingDir, version, error, ok]() {
+        m_lastError = *error;
+        emit committed(stagingDir, *ok ? version : QString(), *error);
+    });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start();
+}
+
+void VersionStore::discardStaging(const QString& stagingDir)
+{
+    QThread* thread = QThread::create([stagingDir]() {
+        QDir(stagingDir).removeRecursively();
+    });
+    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start();
+}
+
+bool VersionStore::commitDir(const QString& root, const QString& stagingDir, const QString& version, QString* error)
+{
+    if (!isVersionName(version)) {
+        *error = "无法识别安装的 Redis 版本";
+        return false;
+    }
+
+    QString target = root + "/" + version;
+    QString old = target + ".old";
+    QDir(old).removeRecursively();
+
+    // 同版本重装（例如换了编译配置）时整体替换目录；current 只在两次 rename 之间短暂失效
+    if (QFileInfo(target).isDir() && !QDir().rename(target, old)) {
+        *error = "无法替换已安装的版本 " + version;
+        return false;
+    }
+    if (!QDir().rename(stagingDir, target)) {
+        QDir().rename(old, target);
+        *error = "无法保存版本目录 " + version;
+        return false;
+    }
+    QDir(old).removeRecursively();
+
+    deduplicate(root, version);
+    qDebug() << "[VersionStore] Installed version" << version << "at" << target;
+    return true;
+}
+
+void VersionStore::deduplicate(const QString& root, const QString& version)
+{
+    QDir dir(root + "/" + version);
+    const QFileInfoList files = dir.entryInfoList(QDir::Files | QDir::NoSymLinks);
+    const QStringList others = versionsIn(root);
+
+    for (const QFileInfo& file : files) {
+        QByteArray sha256;
+        for (const QString& other : others) {
+            if (other == version) {
+                continue;
+            }
+
+            QFileInfo candidate(root + "/" + other + "/" + file.fileName());
+            if (!candidate.isFile() || candidate.size() != file.size()) {
+                continue;
+            }
+
+            if (sha256.isEmpty()) {
+                sha256 = ArtifactCache::sha256OfFile(file.filePath());
+            }
+            if (ArtifactCache::sha256OfFile(candidate.filePath()) != sha256) {
+                continue;
+            }
+
+            QFile::Permissions permissions = file.permissions();
+            if (ArtifactCache::materialize(candidate.filePath(), file.filePath())) {
+                QFile::setPermissions(file.filePath(), permissions);
+                qDebug() << "[VersionStore] Deduplicated" << file.fileName() << "with version" << other;
+            }
+            break;
+        }
+    }
+}
+
+bool VersionStore::remove(const QString& version)
+{
+    if (!contains(version)) {
+        m_lastError = "版本不存在: " + version;
+        return false;
+    }
+    if (version == activeVersion()) {
+        m_lastError = "不能删除当前使用的版本";
+        return false;
+    }
+
+    // 其他版本的硬链接不受影响
+    return QDir(versionPath(version)).removeRecursively();
+}
+
+QStringList VersionStore::garbageCollect(int keep)
+{
+    QStringList removed;
+
+    const QStringList staging = QDir(m_root).entryList(QStringList() << ".staging-*" << "*.old",
+                                                       QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden);
+    for (const QString& entry : staging) {
+        QDir(m_root + "/" + entry).removeRecursively();
+    }
+
+    QString active = activeVersion();
+    QStringList candidates = versions();
+    candidates.removeAll(active);
+
+    while (candidates.size() > qMax(0, keep)) {
+        QString version = candidates.takeFirst();
+        if (remove(version)) {
+            removed << version;
+        }
+    }
+
+    qDebug() << "[VersionStore] Garbage collected versions:" << removed;
+    return removed;
+}
+
+void VersionStore::migrateLegacyLayout()
+{
+#ifdef Q_OS_WIN
+    const QString legacyServer = m_root + "/redis-server.exe";
+#else
+    const QString legacyServer = m_root + "/redis-server";
+#endif
+    if (!QFileInfo(legacyServer).isFile() || !activeVersion().isEmpty()) {
+        return;
+    }
+
+    QString staging = createStagingDir();
+
+    // 配置、数据和日志留在根目录，其余文件（程序、DLL）移入版本目录
+    static const QStringList shared = QStringList() << "redis.conf" << "redis.log" << "redis.pid"
+                                                    << "dump.rdb" << "appendonly.aof" << "appendonlydir";
+    const QStringList entries = QDir(m_root).entryList(QDir::Files | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        if (shared.contains(entry) || entry == "current.txt") {
+            continue;
+        }
+        QFile::rename(m_root + "/" + entry, staging + "/" + entry);
+    }
+
+    // 只在升级后第一次启动时执行一次，同步完成
+    QString version = detectVersion(staging);
+    if (!commitDir(m_root, staging, version, &m_lastError)) {
+        // 迁移失败时把文件放回原处，保持旧布局可用
+        qDebug() << "[VersionStore] Legacy migration failed:" << m_lastError;
+        const QStringList moved = QDir(staging).entryList(QDir::Files | QDir::NoDotAndDotDot);
+        for (const QString& entry : moved) {
+            QFile::rename(staging + "/" + entry, m_root + "/" + entry);
+        }
+        QDir(staging).removeRecursively();
+        return;
+    }
+    activate(version);
+}
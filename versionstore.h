@@ -0,0 +1,73 @@
+#ifndef VERSIONSTORE_H
+#define VERSIONSTORE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+// 多版本并存的 Redis 安装目录：
+//   <root>/7.2.4/、<root>/7.4.0/   各版本的程序文件，相同文件之间用硬链接去重
+//   <root>/current                指向当前版本的符号链接，切换时原子替换
+//   <root>/redis.conf、数据和日志  所有版本共用
+// Windows 上普通用户无法创建符号链接，改用 current.txt 记录当前版本（同样原子写入）。
+// 提交新版本要移动、哈希整个目录，在工作线程中进行，结果通过 committed() 返回。
+class VersionStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VersionStore(const QString& root, QObject *parent = nullptr);
+
+    QString root() const { return m_root; }
+
+    // 已安装的版本，按版本号从旧到新排序
+    QStringList versions() const;
+    bool contains(const QString& version) const;
+    QString versionPath(const QString& version) const;
+
+    QString activeVersion() const;
+    // 当前版本的程序目录，没有任何版本时返回空
+    QString activeDir() const;
+    bool activate(const QString& version);
+
+    // 新建一个暂存目录供安装任务写入，完成后用 commitAsync() 转为正式版本
+    QString createStagingDir();
+    // 在工作线程中把暂存目录移动到 <root>/<version>/ 并与其他版本去重，完成后发出 committed()；
+    // 失败时暂存目录一并删除
+    void commitAsync(const QString& stagingDir, const QString& version);
+    // 在工作线程中删除失败或取消的安装留下的暂存目录
+    void discardStaging(const QString& stagingDir);
+
+    bool remove(const QString& version);
+    // 删除当前版本以外最旧的版本，只保留 keep 个非当前版本；同时清理残留的暂存目录，
+    // 所以不能在安装进行中调用。返回删除的版本
+    QStringList garbageCollect(int keep);
+
+    // 旧版本把程序直接装在 <root> 下，迁移到版本目录
+    void migrateLegacyLayout();
+
+    // 运行 redis-server --version 并等待结果，只在启动时迁移旧布局用；安装流程异步读取后用 parseVersion()
+    static QString detectVersion(const QString& binaryDir);
+    // 从 redis-server --version 的输出中取出版本号
+    static QString parseVersion(const QByteArray& output);
+    static int compareVersions(const QString& a, const QString& b);
+
+    QString getLastError() const { return m_lastError; }
+
+signals:
+    // version 为空表示失败，error 为原因
+    void committed(const QString& stagingDir, const QString& version, const QString& error);
+
+private:
+    static bool isVersionName(const QString& name);
+    static QStringList versionsIn(const QString& root);
+    // 以下只操作给定目录，可以在工作线程中调用
+    static bool commitDir(const QString& root, const QString& stagingDir, const QString& version, QString* error);
+    static void deduplicate(const QString& root, const QString& version);
+
+private:
+    QString m_root;
+    QString m_lastError;
+};
+
+#endif // VERSIONSTORE_H